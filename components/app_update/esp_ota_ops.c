@@ -50,6 +50,7 @@ typedef struct ota_ops_entry_ {
     uint32_t wrote_size;
     uint8_t partial_bytes;
     uint8_t partial_data[16];
+    bool sequential_erase;
     LIST_ENTRY(ota_ops_entry_) entries;
 } ota_ops_entry_t;
 
@@ -100,56 +101,121 @@ static bool is_ota_partition(const esp_partition_t *p)
             && p->subtype < ESP_PARTITION_SUBTYPE_APP_OTA_MAX);
 }
 
-esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle)
+static esp_err_t ota_check_partition(const esp_partition_t **partition)
 {
-    ota_ops_entry_t *new_entry;
-    esp_err_t ret = ESP_OK;
+    const esp_partition_t *p = esp_partition_verify(*partition);
+    if (p == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
 
-    if ((partition == NULL) || (out_handle == NULL)) {
+    if (!is_ota_partition(p)) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    partition = esp_partition_verify(partition);
-    if (partition == NULL) {
-        return ESP_ERR_NOT_FOUND;
+    if (p == esp_ota_get_running_partition()) {
+        return ESP_ERR_OTA_PARTITION_CONFLICT;
     }
 
-    if (!is_ota_partition(partition)) {
+    *partition = p;
+    return ESP_OK;
+}
+
+static esp_err_t ota_new_entry(const esp_partition_t *partition, uint32_t erased_size, uint32_t wrote_size,
+                               bool sequential_erase, esp_ota_handle_t *out_handle)
+{
+    ota_ops_entry_t *new_entry = (ota_ops_entry_t *) calloc(sizeof(ota_ops_entry_t), 1);
+    if (new_entry == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    LIST_INSERT_HEAD(&s_ota_ops_entries_head, new_entry, entries);
+
+    new_entry->part = partition;
+    new_entry->erased_size = erased_size;
+    new_entry->wrote_size = wrote_size;
+    new_entry->sequential_erase = sequential_erase;
+    new_entry->handle = ++s_ota_ops_last_handle;
+    *out_handle = new_entry->handle;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t image_size, esp_ota_handle_t *out_handle)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t erased_size;
+
+    if ((partition == NULL) || (out_handle == NULL)) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (partition == esp_ota_get_running_partition()) {
-        return ESP_ERR_OTA_PARTITION_CONFLICT;
+    ret = ota_check_partition(&partition);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (image_size == OTA_WITH_SEQUENTIAL_WRITES) {
+        return ota_new_entry(partition, 0, 0, true, out_handle);
     }
 
     // If input image size is 0 or OTA_SIZE_UNKNOWN, erase entire partition
     if ((image_size == 0) || (image_size == OTA_SIZE_UNKNOWN)) {
         ret = esp_partition_erase_range(partition, 0, partition->size);
+        erased_size = partition->size;
     } else {
         ret = esp_partition_erase_range(partition, 0, (image_size / SPI_FLASH_SEC_SIZE + 1) * SPI_FLASH_SEC_SIZE);
+        erased_size = image_size;
     }
 
     if (ret != ESP_OK) {
         return ret;
     }
 
-    new_entry = (ota_ops_entry_t *) calloc(sizeof(ota_ops_entry_t), 1);
-    if (new_entry == NULL) {
-        return ESP_ERR_NO_MEM;
+    return ota_new_entry(partition, erased_size, 0, false, out_handle);
+}
+
+esp_err_t esp_ota_resume(const esp_partition_t *partition, size_t image_offset, esp_ota_handle_t *out_handle)
+{
+    esp_err_t ret;
+
+    if ((partition == NULL) || (out_handle == NULL)) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    LIST_INSERT_HEAD(&s_ota_ops_entries_head, new_entry, entries);
+    ret = ota_check_partition(&partition);
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
-    if ((image_size == 0) || (image_size == OTA_SIZE_UNKNOWN)) {
-        new_entry->erased_size = partition->size;
-    } else {
-        new_entry->erased_size = image_size;
+    // The sector holding the write pointer gets erased, it must not contain any data to keep
+    if ((image_offset % SPI_FLASH_SEC_SIZE) != 0 || image_offset >= partition->size) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    new_entry->part = partition;
-    new_entry->handle = ++s_ota_ops_last_handle;
-    *out_handle = new_entry->handle;
-    return ESP_OK;
+    return ota_new_entry(partition, image_offset, image_offset, true, out_handle);
+}
+
+/* Erase the sectors that the next `size` bytes are going to be written to */
+static esp_err_t ota_erase_on_demand(ota_ops_entry_t *it, size_t size, bool clip)
+{
+    uint32_t end = it->wrote_size + size;
+
+    end = (end + SPI_FLASH_SEC_SIZE - 1) & ~(SPI_FLASH_SEC_SIZE - 1);
+    if (end > it->part->size) {
+        if (!clip) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        end = it->part->size;
+    }
+
+    if (end <= it->erased_size) {
+        return ESP_OK;
+    }
+
+    esp_err_t ret = esp_partition_erase_range(it->part, it->erased_size, end - it->erased_size);
+    if (ret == ESP_OK) {
+        it->erased_size = end;
+    }
+    return ret;
 }
 
 esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
@@ -167,7 +233,7 @@ esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
     for (it = LIST_FIRST(&s_ota_ops_entries_head); it != NULL; it = LIST_NEXT(it, entries)) {
         if (it->handle == handle) {
             // must erase the partition before writing to it
-            assert(it->erased_size > 0 && "must erase the partition before writing to it");
+            assert((it->erased_size > 0 || it->sequential_erase) && "must erase the partition before writing to it");
 
             if(it->wrote_size == 0 && size > 0 && data_bytes[0] != 0xE9) {
                 ESP_LOGE(TAG, "OTA image has invalid magic byte (expected 0xE9, saw 0x%02x", data_bytes[0]);
@@ -208,6 +274,13 @@ esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
             }
 
 #endif
+            if (it->sequential_erase) {
+                ret = ota_erase_on_demand(it, size, false);
+                if (ret != ESP_OK) {
+                    return ret;
+                }
+            }
+
             ret = esp_partition_write(it->part, it->wrote_size, data_bytes, size);
             if(ret == ESP_OK){
                 it->wrote_size += size;
@@ -221,6 +294,22 @@ esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
     return ESP_ERR_INVALID_ARG;
 }
 
+esp_err_t esp_ota_erase_ahead(esp_ota_handle_t handle, size_t size)
+{
+    ota_ops_entry_t *it;
+
+    for (it = LIST_FIRST(&s_ota_ops_entries_head); it != NULL; it = LIST_NEXT(it, entries)) {
+        if (it->handle == handle) {
+            if (!it->sequential_erase) {
+                return ESP_ERR_INVALID_STATE;
+            }
+            return ota_erase_on_demand(it, size, true);
+        }
+    }
+
+    return ESP_ERR_NOT_FOUND;
+}
+
 esp_err_t esp_ota_end(esp_ota_handle_t handle)
 {
     ota_ops_entry_t *it;
@@ -287,6 +376,25 @@ esp_err_t esp_ota_end(esp_ota_handle_t handle)
     return ret;
 }
 
+esp_err_t esp_ota_abort(esp_ota_handle_t handle)
+{
+    ota_ops_entry_t *it;
+
+    for (it = LIST_FIRST(&s_ota_ops_entries_head); it != NULL; it = LIST_NEXT(it, entries)) {
+        if (it->handle == handle) {
+            break;
+        }
+    }
+
+    if (it == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    LIST_REMOVE(it, entries);
+    free(it);
+    return ESP_OK;
+}
+
 static uint32_t ota_select_crc(const ota_select *s)
 {
     return crc32_le(UINT32_MAX, (uint8_t *)&s->ota_seq, 4);
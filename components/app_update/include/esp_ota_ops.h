@@ -29,6 +29,7 @@ extern "C"
 #endif
 
 #define OTA_SIZE_UNKNOWN 0xffffffff /*!< Used for esp_ota_begin() if new image size is unknown */
+#define OTA_WITH_SEQUENTIAL_WRITES 0xfffffffe /*!< Used for esp_ota_begin() if new image size is unknown and erase can be done in successive writes */
 
 #define ESP_ERR_OTA_BASE                         0x1500                     /*!< Base error code for ota_ops api */
 #define ESP_ERR_OTA_PARTITION_CONFLICT           (ESP_ERR_OTA_BASE + 0x01)  /*!< Error if request was to write or erase the current running partition */
@@ -49,13 +50,15 @@ typedef uint32_t esp_ota_handle_t;
  * The specified partition is erased to the specified image size.
  *
  * If image size is not yet known, pass OTA_SIZE_UNKNOWN which will
- * cause the entire partition to be erased.
+ * cause the entire partition to be erased, or OTA_WITH_SEQUENTIAL_WRITES
+ * to erase each sector only when esp_ota_write() reaches it.
  *
  * On success, this function allocates memory that remains in use
  * until esp_ota_end() is called with the returned handle.
  *
  * @param partition Pointer to info for partition which will receive the OTA update. Required.
  * @param image_size Size of new OTA app image. Partition will be erased in order to receive this size of image. If 0 or OTA_SIZE_UNKNOWN, the entire partition is erased.
+ *                   If OTA_WITH_SEQUENTIAL_WRITES, nothing is erased here.
  * @param out_handle On success, returns a handle which should be used for subsequent esp_ota_write() and esp_ota_end() calls.
 
  * @return
@@ -70,6 +73,28 @@ typedef uint32_t esp_ota_handle_t;
  */
 esp_err_t esp_ota_begin(const esp_partition_t* partition, size_t image_size, esp_ota_handle_t* out_handle);
 
+/**
+ * @brief   Continue an interrupted OTA update of the specified partition.
+ *
+ * The first image_offset bytes of the partition are assumed to hold the beginning
+ * of the image, written by an earlier OTA operation. They are kept as is, the next
+ * esp_ota_write() continues right after them. The rest of the partition is erased
+ * sector by sector as the data is written, like with OTA_WITH_SEQUENTIAL_WRITES.
+ *
+ * @param partition Pointer to info for partition which receives the OTA update. Required.
+ * @param image_offset Number of bytes of the image already in the partition, it must be a multiple of SPI_FLASH_SEC_SIZE.
+ * @param out_handle On success, returns a handle which should be used for subsequent esp_ota_write() and esp_ota_end() calls.
+ *
+ * @return
+ *    - ESP_OK: OTA operation resumed successfully.
+ *    - ESP_ERR_INVALID_ARG: partition or out_handle arguments were NULL, partition doesn't point to an OTA app partition,
+ *                           or image_offset is not sector aligned or beyond the partition.
+ *    - ESP_ERR_NO_MEM: Cannot allocate memory for OTA operation.
+ *    - ESP_ERR_OTA_PARTITION_CONFLICT: Partition holds the currently running firmware, cannot update in place.
+ *    - ESP_ERR_NOT_FOUND: Partition argument not found in partition table.
+ */
+esp_err_t esp_ota_resume(const esp_partition_t *partition, size_t image_offset, esp_ota_handle_t *out_handle);
+
 
 uint8_t get_ota_partition_count(void);
 
@@ -93,6 +118,25 @@ uint8_t get_ota_partition_count(void);
  */
 esp_err_t esp_ota_write(esp_ota_handle_t handle, const void* data, size_t size);
 
+/**
+ * @brief   Erase in advance the flash that the next esp_ota_write() calls are going to write
+ *
+ * With OTA_WITH_SEQUENTIAL_WRITES (or after esp_ota_resume()), esp_ota_write() erases each
+ * sector when it reaches it. Calling this function while waiting for the next data, e.g. from
+ * a task that writes the data received by an other one, takes this time out of esp_ota_write().
+ *
+ * @param handle  Handle obtained from esp_ota_begin() or esp_ota_resume()
+ * @param size    Number of bytes after the data already written to have erased. It is
+ *                rounded up to whole sectors and limited to the end of the partition.
+ *
+ * @return
+ *    - ESP_OK: The flash is erased as requested.
+ *    - ESP_ERR_NOT_FOUND: OTA handle was not found.
+ *    - ESP_ERR_INVALID_STATE: The handle doesn't erase sequentially, its whole image is already erased.
+ *    - ESP_ERR_FLASH_OP_TIMEOUT or ESP_ERR_FLASH_OP_FAIL: Flash erase failed.
+ */
+esp_err_t esp_ota_erase_ahead(esp_ota_handle_t handle, size_t size);
+
 /**
  * @brief Finish OTA update and validate newly written app image.
  *
@@ -109,6 +153,20 @@ esp_err_t esp_ota_write(esp_ota_handle_t handle, const void* data, size_t size);
  */
 esp_err_t esp_ota_end(esp_ota_handle_t handle);
 
+/**
+ * @brief Abort OTA update, free the handle and memory associated with it.
+ *
+ * The data already written is left in the partition, so the update can be
+ * continued later with esp_ota_resume().
+ *
+ * @param handle  Handle obtained from esp_ota_begin() or esp_ota_resume().
+ *
+ * @return
+ *    - ESP_OK: Handle and its associated memory is freed successfully.
+ *    - ESP_ERR_NOT_FOUND: OTA handle was not found.
+ */
+esp_err_t esp_ota_abort(esp_ota_handle_t handle);
+
 /**
  * @brief Configure OTA data for a new boot partition
  *
@@ -54,6 +54,10 @@ static const char *TAG = "esp-tls";
 #define _esp_tls_set_global_ca_store        esp_mbedtls_set_global_ca_store                 /*!< Callback function for setting global CA store data for TLS/SSL */
 #define _esp_tls_get_global_ca_store        esp_mbedtls_get_global_ca_store
 #define _esp_tls_free_global_ca_store       esp_mbedtls_free_global_ca_store                /*!< Callback function for freeing global ca store for TLS/SSL */
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+#define _esp_tls_get_client_session         esp_mbedtls_get_client_session
+#define _esp_tls_free_client_session        esp_mbedtls_free_client_session
+#endif  /* CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
 #elif CONFIG_ESP_TLS_USING_WOLFSSL /* CONFIG_ESP_TLS_USING_MBEDTLS */
 #define _esp_create_ssl_handle              esp_create_wolfssl_handle
 #define _esp_tls_handshake                  esp_wolfssl_handshake
@@ -268,13 +272,16 @@ static int esp_tls_low_level_conn(const char *hostname, int hostlen, int port, c
             ms_to_timeval(cfg->timeout_ms, &tv);
 
             /* In case of non-blocking I/O, we use the select() API to check whether
-               connection has been established or not*/
-            if (select(tls->sockfd + 1, &tls->rset, &tls->wset, NULL,
-                       cfg->timeout_ms>0 ? &tv : NULL) == 0) {
+               connection has been established or not. select() overwrites the sets,
+               so work on copies to be able to call it again on timeout */
+            fd_set rset = tls->rset;
+            fd_set wset = tls->wset;
+            if (select(tls->sockfd + 1, &rset, &wset, NULL,
+                       cfg->timeout_ms >= 0 ? &tv : NULL) == 0) {
                 ESP_LOGD(TAG, "select() timed out");
                 return 0;
             }
-            if (FD_ISSET(tls->sockfd, &tls->rset) || FD_ISSET(tls->sockfd, &tls->wset)) {
+            if (FD_ISSET(tls->sockfd, &rset) || FD_ISSET(tls->sockfd, &wset)) {
                 int error;
                 unsigned int len = sizeof(error);
                 /* pending error check */
@@ -438,6 +445,17 @@ mbedtls_x509_crt *esp_tls_get_global_ca_store(void)
 }
 
 #endif /* CONFIG_ESP_TLS_USING_MBEDTLS */
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+esp_tls_client_session_t *esp_tls_get_client_session(esp_tls_t *tls)
+{
+    return _esp_tls_get_client_session(tls);
+}
+
+void esp_tls_free_client_session(esp_tls_client_session_t *client_session)
+{
+    _esp_tls_free_client_session(client_session);
+}
+#endif /* CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
 #ifdef CONFIG_ESP_TLS_SERVER
 /**
  * @brief      Create a server side TLS/SSL connection
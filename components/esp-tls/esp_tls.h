@@ -109,6 +109,15 @@ typedef struct psk_key_hint {
     const char* hint;                       /*!< hint in PSK authentication mode in string format */
 } psk_hint_key_t;
 
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+/**
+ * @brief Data structure for saving a client TLS session
+ */
+typedef struct esp_tls_client_session {
+    mbedtls_ssl_session saved_session;
+} esp_tls_client_session_t;
+#endif /* CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
+
 /**
  * @brief      ESP-TLS configuration parameters
  *
@@ -201,6 +210,11 @@ typedef struct esp_tls_cfg {
                                             /*!< Function pointer to esp_crt_bundle_attach. Enables the use of certification
                                                  bundle for server verification, must be enabled in menuconfig */
 
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    esp_tls_client_session_t *client_session; /*!< Pointer for the client session ticket context. If not NULL
+                                                 the connection tries to resume this session; the session
+                                                 is copied during the handshake setup */
+#endif /* CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
 } esp_tls_cfg_t;
 
 #ifdef CONFIG_ESP_TLS_SERVER
@@ -575,6 +589,32 @@ esp_err_t esp_tls_get_and_clear_last_error(esp_tls_error_handle_t h, int *esp_tl
 mbedtls_x509_crt *esp_tls_get_global_ca_store(void);
 
 #endif /* CONFIG_ESP_TLS_USING_MBEDTLS */
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+/**
+ * @brief      Obtain the client session ticket
+ *
+ * This function should be called when the TLS connection is already established.
+ * The returned session can be set in esp_tls_cfg_t of a later connection to the
+ * same server in order to resume the session.
+ *
+ * @param[in]  tls  pointer to esp-tls as esp-tls handle.
+ *
+ * @return
+ *          - Pointer to the saved client session, must be freed with esp_tls_free_client_session()
+ *          - NULL on Failure
+ */
+esp_tls_client_session_t *esp_tls_get_client_session(esp_tls_t *tls);
+
+/**
+ * @brief      Free the client session
+ *
+ * This function should be called when the client session obtained from
+ * esp_tls_get_client_session() is no longer needed.
+ *
+ * @param[in]  client_session  Pointer to the client session, may be NULL
+ */
+void esp_tls_free_client_session(esp_tls_client_session_t *client_session);
+#endif /* CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
 #ifdef CONFIG_ESP_TLS_SERVER
 /**
  * @brief      Create TLS/SSL server session
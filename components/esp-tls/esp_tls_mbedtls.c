@@ -96,6 +96,15 @@ esp_err_t esp_create_mbedtls_handle(const char *hostname, size_t hostlen, const
         esp_ret = ESP_ERR_MBEDTLS_SSL_SETUP_FAILED;
         goto exit;
     }
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    if (tls->role == ESP_TLS_CLIENT && ((esp_tls_cfg_t *)cfg)->client_session != NULL) {
+        ESP_LOGD(TAG, "Reusing the already saved client session context");
+        if ((ret = mbedtls_ssl_set_session(&tls->ssl, &(((esp_tls_cfg_t *)cfg)->client_session->saved_session))) != 0) {
+            /* Not fatal, the handshake falls back to a full one */
+            ESP_LOGW(TAG, "mbedtls_ssl_set_session returned -0x%x", -ret);
+        }
+    }
+#endif
     mbedtls_ssl_set_bio(&tls->ssl, &tls->server_fd, mbedtls_net_send, mbedtls_net_recv, NULL);
 
     return ESP_OK;
@@ -394,6 +403,9 @@ esp_err_t set_client_config(const char *hostname, size_t hostlen, esp_tls_cfg_t
         return ESP_ERR_MBEDTLS_SSL_CONFIG_DEFAULTS_FAILED;
     }
 
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    mbedtls_ssl_conf_session_tickets(&tls->conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
 
     if (cfg->alpn_protos) {
 #ifdef CONFIG_MBEDTLS_SSL_ALPN
@@ -569,3 +581,36 @@ void esp_mbedtls_free_global_ca_store(void)
         global_cacert = NULL;
     }
 }
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+esp_tls_client_session_t *esp_mbedtls_get_client_session(esp_tls_t *tls)
+{
+    if (tls == NULL) {
+        ESP_LOGE(TAG, "esp_tls session context cannot be NULL");
+        return NULL;
+    }
+
+    esp_tls_client_session_t *client_session = (esp_tls_client_session_t*)calloc(1, sizeof(esp_tls_client_session_t));
+    if (client_session == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for client session ctx");
+        return NULL;
+    }
+
+    int ret = mbedtls_ssl_get_session(&tls->ssl, &(client_session->saved_session));
+    if (ret != 0) {
+        ESP_LOGE(TAG, "mbedtls_ssl_get_session returned -0x%x", -ret);
+        esp_mbedtls_free_client_session(client_session);
+        return NULL;
+    }
+
+    return client_session;
+}
+
+void esp_mbedtls_free_client_session(esp_tls_client_session_t *client_session)
+{
+    if (client_session) {
+        mbedtls_ssl_session_free(&(client_session->saved_session));
+        free(client_session);
+    }
+}
+#endif /* CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
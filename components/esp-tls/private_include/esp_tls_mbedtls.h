@@ -102,3 +102,15 @@ mbedtls_x509_crt *esp_mbedtls_get_global_ca_store(void);
  * Callback function for freeing global ca store for TLS/SSL using mbedtls
  */
 void esp_mbedtls_free_global_ca_store(void);
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+/**
+ * Internal Callback for esp_tls_get_client_session
+ */
+esp_tls_client_session_t *esp_mbedtls_get_client_session(esp_tls_t *tls);
+
+/**
+ * Internal Callback for esp_tls_free_client_session
+ */
+void esp_mbedtls_free_client_session(esp_tls_client_session_t *client_session);
+#endif /* CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
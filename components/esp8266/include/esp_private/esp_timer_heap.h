@@ -0,0 +1,128 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Timers armed in the high-resolution esp_timer backend are kept in a binary
+ * min-heap sorted by alarm time. It does not lock, allocate or read the clock,
+ * the caller does.
+ */
+
+#define ESP_TIMER_HEAP_NONE     ((size_t)-1)    ///< Index of the nodes which are not in the heap
+
+/**
+ * @brief A timer in the heap, embedded in the timer object
+ */
+typedef struct {
+    uint64_t    alarm;      ///< Time of the next expiry, in microseconds
+    uint64_t    period;     ///< Period of a periodic timer, 0 for a one-shot timer
+    size_t      index;      ///< Position in the heap, ESP_TIMER_HEAP_NONE when not armed
+} esp_timer_node_t;
+
+/**
+ * @brief Heap of the armed timers
+ */
+typedef struct {
+    esp_timer_node_t    **nodes;    ///< Array of the armed timers, the first expiring one first
+    size_t              count;      ///< Number of armed timers
+    size_t              capacity;   ///< Size of the array
+} esp_timer_heap_t;
+
+/**
+ * @brief Initialize a heap
+ *
+ * @param heap heap to initialize
+ * @param nodes array holding the armed timers
+ * @param capacity size of the array
+ */
+void esp_timer_heap_init(esp_timer_heap_t *heap, esp_timer_node_t **nodes, size_t capacity);
+
+/**
+ * @brief Move the timers to a bigger array
+ *
+ * @param heap heap of the timers
+ * @param nodes new array, at least as large as the number of armed timers
+ * @param capacity size of the new array
+ *
+ * @return the old array
+ */
+esp_timer_node_t **esp_timer_heap_resize(esp_timer_heap_t *heap, esp_timer_node_t **nodes, size_t capacity);
+
+/**
+ * @brief Arm a timer
+ *
+ * The alarm and period fields of the node must be set, the node must not be armed.
+ *
+ * @param heap heap of the timers
+ * @param node timer to arm
+ *
+ * @return true if the timer is the first one to expire now
+ */
+bool esp_timer_heap_push(esp_timer_heap_t *heap, esp_timer_node_t *node);
+
+/**
+ * @brief Disarm a timer, does nothing if the timer is not armed
+ *
+ * @param heap heap of the timers
+ * @param node timer to disarm
+ */
+void esp_timer_heap_remove(esp_timer_heap_t *heap, esp_timer_node_t *node);
+
+/**
+ * @brief Get the first timer to expire
+ *
+ * @param heap heap of the timers
+ *
+ * @return the timer or NULL if no timer is armed
+ */
+static inline esp_timer_node_t *esp_timer_heap_peek(const esp_timer_heap_t *heap)
+{
+    return heap->count ? heap->nodes[0] : NULL;
+}
+
+/**
+ * @brief Take an expired timer
+ *
+ * A one-shot timer is disarmed. A periodic timer is armed again one period
+ * after its previous alarm and not after "now", so it does not drift with
+ * the dispatch latency. When more than one period has been missed, it expires
+ * only once and keeps its phase.
+ *
+ * @param heap heap of the timers
+ * @param now current time in microseconds
+ *
+ * @return the expired timer, NULL if no timer has expired yet
+ */
+esp_timer_node_t *esp_timer_heap_expire(esp_timer_heap_t *heap, uint64_t now);
+
+/**
+ * @brief Check if a timer is armed
+ */
+static inline bool esp_timer_heap_armed(const esp_timer_node_t *node)
+{
+    return node->index != ESP_TIMER_HEAP_NONE;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -48,8 +48,10 @@ extern "C" {
 #endif
 
 /**
- * Important: This function is based on FreeRTOS timer not real time hard timer.
- *            Adding this just for some user passing compiling now.
+ * Important: By default these functions are based on FreeRTOS timers, so the timeouts
+ *            must be multiples of the FreeRTOS tick. With CONFIG_ESP_TIMER_HIGH_RESOLUTION
+ *            they are based on the FRC1 hardware timer, with microsecond resolution and
+ *            ESP_TIMER_ISR dispatch, and the hw_timer driver can not be used.
  */
 
 /**
@@ -69,13 +71,7 @@ typedef void (*esp_timer_cb_t)(void* arg);
  */
 typedef enum {
     ESP_TIMER_TASK,     //!< Callback is called from timer task
-
-    /* Not supported for now, provision to allow callbacks to run directly
-     * from an ISR:
-
-        ESP_TIMER_ISR,      //!< Callback is called from timer ISR
-
-     */
+    ESP_TIMER_ISR,      //!< Callback is called from timer ISR, needs CONFIG_ESP_TIMER_HIGH_RESOLUTION
 } esp_timer_dispatch_t;
 
 /**
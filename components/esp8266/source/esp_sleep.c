@@ -401,6 +401,12 @@ void esp_sleep_set_mode(esp_sleep_mode_t mode)
     s_sleep_mode = mode;
 }
 
+/* The idle task can only wait for interrupts, the FreeRTOS port suppresses the tick then */
+int esp_sleep_is_cpu_wait(void)
+{
+    return cpu_is_wait_mode();
+}
+
 void esp_sleep_start(void)
 {
     const sleep_proc_t proc = {
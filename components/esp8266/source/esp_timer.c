@@ -12,14 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "sdkconfig.h"
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
+#include "esp_attr.h"
 #include "esp_log.h"
 #include "FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/timers.h"
 #include "driver/soc.h"
 
+#ifndef CONFIG_ESP_TIMER_HIGH_RESOLUTION
+
 #define ESP_TIMER_HZ CONFIG_FREERTOS_HZ
 
 typedef enum {
@@ -126,6 +130,9 @@ esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args,
     TimerHandle_t os_timer;
     esp_timer_handle_t esp_timer;
 
+    if (create_args->dispatch_method != ESP_TIMER_TASK)
+        return ESP_ERR_NOT_SUPPORTED;
+
     esp_timer = heap_caps_malloc(sizeof(struct esp_timer), MALLOC_CAP_32BIT);
     if (!esp_timer)
         return ESP_ERR_NO_MEM;
@@ -244,7 +251,9 @@ esp_err_t esp_timer_delete(esp_timer_handle_t timer)
     return ret;
 }
 
-int64_t esp_timer_get_time(void)
+#endif /* !CONFIG_ESP_TIMER_HIGH_RESOLUTION */
+
+int64_t IRAM_ATTR esp_timer_get_time(void)
 {
     extern uint64_t g_esp_os_us;
 
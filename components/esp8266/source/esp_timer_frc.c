@@ -0,0 +1,384 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/queue.h>
+
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_task.h"
+#include "esp_private/esp_timer_heap.h"
+#include "FreeRTOS.h"
+#include "freertos/task.h"
+#include "rom/ets_sys.h"
+#include "esp8266/eagle_soc.h"
+#include "esp8266/timer_struct.h"
+#include "driver/hw_timer.h"
+
+#ifdef CONFIG_ESP_TIMER_HIGH_RESOLUTION
+
+/* FRC1 counts down at 5 MHz, its 23-bit counter lasts a bit more than 1.6 seconds */
+#define FRC_TICKS_PER_US    ((TIMER_BASE_CLK >> TIMER_CLKDIV_16) / 1000000)
+#define FRC_MAX_US          0x199999
+#define FRC_MIN_US          10
+
+#define TIMER_HEAP_MIN_SIZE 8
+
+struct esp_timer {
+    esp_timer_node_t        node;           // first member, the heap returns its address
+
+    esp_timer_cb_t          cb;
+
+    void                    *arg;
+
+    esp_timer_dispatch_t    method;
+
+    const char              *name;
+
+    STAILQ_ENTRY(esp_timer) pending_entry;  // waiting for the timer task
+
+    uint8_t                 pending;
+
+    uint8_t                 deleted;        // freed by the timer task after the callback
+};
+
+static const char *TAG = "esp_timer";
+
+static esp_timer_heap_t s_heap;
+static size_t s_timer_num;
+static STAILQ_HEAD(, esp_timer) s_pending = STAILQ_HEAD_INITIALIZER(s_pending);
+static struct esp_timer *s_running;
+static TaskHandle_t s_timer_task;
+
+/* All the interrupts are level 1, nothing preempts the code running in an ISR */
+static inline void IRAM_ATTR timer_lock(void)
+{
+    if (!xPortInIsrContext())
+        portENTER_CRITICAL();
+}
+
+static inline void IRAM_ATTR timer_unlock(void)
+{
+    if (!xPortInIsrContext())
+        portEXIT_CRITICAL();
+}
+
+/**
+ * @brief Program FRC1 for the first alarm, longer delays take more than one interrupt
+ */
+static void IRAM_ATTR timer_set_alarm(void)
+{
+    esp_timer_node_t *node = esp_timer_heap_peek(&s_heap);
+    uint64_t now, delay;
+
+    frc1.ctrl.en = 0;
+    if (!node)
+        return;
+
+    now = esp_timer_get_time();
+    delay = node->alarm > now ? node->alarm - now : 0;
+    if (delay < FRC_MIN_US)
+        delay = FRC_MIN_US;
+    else if (delay > FRC_MAX_US)
+        delay = FRC_MAX_US;
+
+    frc1.load.data = delay * FRC_TICKS_PER_US;
+    frc1.ctrl.en = 1;
+}
+
+static void IRAM_ATTR timer_isr(void *arg)
+{
+    esp_timer_node_t *node;
+    BaseType_t woken = pdFALSE;
+    bool notify = false;
+    uint64_t now = esp_timer_get_time();
+
+    frc1.ctrl.en = 0;
+
+    while ((node = esp_timer_heap_expire(&s_heap, now))) {
+        struct esp_timer *timer = (struct esp_timer *)node;
+
+        if (timer->method == ESP_TIMER_ISR) {
+            timer->cb(timer->arg);
+        } else if (!timer->pending) {
+            timer->pending = 1;
+            STAILQ_INSERT_TAIL(&s_pending, timer, pending_entry);
+            notify = true;
+        }
+    }
+
+    timer_set_alarm();
+
+    if (notify) {
+        vTaskNotifyGiveFromISR(s_timer_task, &woken);
+        if (woken == pdTRUE)
+            portYIELD_FROM_ISR();
+    }
+}
+
+static void timer_task(void *arg)
+{
+    struct esp_timer *timer;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        timer_lock();
+        while ((timer = STAILQ_FIRST(&s_pending))) {
+            STAILQ_REMOVE_HEAD(&s_pending, pending_entry);
+            timer->pending = 0;
+            s_running = timer;
+            timer_unlock();
+
+            timer->cb(timer->arg);
+
+            timer_lock();
+            s_running = NULL;
+            if (timer->deleted) {
+                timer_unlock();
+                heap_caps_free(timer);
+                timer_lock();
+            }
+        }
+        timer_unlock();
+    }
+}
+
+/**
+ * @brief Make room in the heap for one more timer, it is never armed twice
+ */
+static esp_err_t timer_heap_reserve(void)
+{
+    esp_timer_node_t **nodes = NULL;
+    size_t capacity = 0;
+
+    for (;;) {
+        timer_lock();
+        if (s_timer_num < s_heap.capacity) {
+            s_timer_num++;
+            timer_unlock();
+            break;
+        }
+        if (capacity > s_heap.capacity) {
+            nodes = esp_timer_heap_resize(&s_heap, nodes, capacity);
+            s_timer_num++;
+            timer_unlock();
+            break;
+        }
+        capacity = s_heap.capacity * 2;
+        timer_unlock();
+
+        if (nodes)
+            heap_caps_free(nodes);
+        nodes = heap_caps_malloc(capacity * sizeof(esp_timer_node_t *), MALLOC_CAP_8BIT);
+        if (!nodes)
+            return ESP_ERR_NO_MEM;
+    }
+
+    /* The old array, or the new one if another task made room first */
+    if (nodes)
+        heap_caps_free(nodes);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Initialize esp_timer library
+ */
+esp_err_t esp_timer_init(void)
+{
+    esp_timer_node_t **nodes;
+
+    if (s_timer_task)
+        return ESP_ERR_INVALID_STATE;
+
+    nodes = heap_caps_malloc(TIMER_HEAP_MIN_SIZE * sizeof(esp_timer_node_t *), MALLOC_CAP_8BIT);
+    if (!nodes)
+        return ESP_ERR_NO_MEM;
+    esp_timer_heap_init(&s_heap, nodes, TIMER_HEAP_MIN_SIZE);
+
+    if (xTaskCreate(timer_task, "esp_timer", ESP_TASK_TIMER_STACK, NULL,
+                    ESP_TASK_TIMER_PRIO, &s_timer_task) != pdPASS) {
+        heap_caps_free(nodes);
+        s_heap.nodes = NULL;
+        s_timer_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    portENTER_CRITICAL();
+    frc1.ctrl.val = 0;
+    frc1.ctrl.div = TIMER_CLKDIV_16;
+    frc1.ctrl.intr_type = TIMER_EDGE_INT;
+    _xt_isr_attach(ETS_FRC_TIMER1_INUM, timer_isr, NULL);
+    TM1_EDGE_INT_ENABLE();
+    _xt_isr_unmask(1 << ETS_FRC_TIMER1_INUM);
+    portEXIT_CRITICAL();
+
+    return ESP_OK;
+}
+
+/**
+ * @brief De-initialize esp_timer library
+ */
+esp_err_t esp_timer_deinit(void)
+{
+    if (!s_timer_task || s_timer_num)
+        return ESP_ERR_INVALID_STATE;
+
+    portENTER_CRITICAL();
+    frc1.ctrl.val = 0;
+    _xt_isr_mask(1 << ETS_FRC_TIMER1_INUM);
+    TM1_EDGE_INT_DISABLE();
+    _xt_isr_attach(ETS_FRC_TIMER1_INUM, NULL, NULL);
+    portEXIT_CRITICAL();
+
+    vTaskDelete(s_timer_task);
+    s_timer_task = NULL;
+    heap_caps_free(s_heap.nodes);
+    s_heap.nodes = NULL;
+    s_heap.capacity = 0;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Create an esp_timer instance
+ */
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args,
+                           esp_timer_handle_t* out_handle)
+{
+    assert(create_args);
+    assert(out_handle);
+
+    esp_timer_handle_t timer;
+
+    if (!s_timer_task)
+        return ESP_ERR_INVALID_STATE;
+    if (!create_args->callback || create_args->dispatch_method > ESP_TIMER_ISR)
+        return ESP_ERR_INVALID_ARG;
+
+    timer = heap_caps_malloc(sizeof(struct esp_timer), MALLOC_CAP_32BIT);
+    if (!timer)
+        return ESP_ERR_NO_MEM;
+
+    if (timer_heap_reserve() != ESP_OK) {
+        heap_caps_free(timer);
+        return ESP_ERR_NO_MEM;
+    }
+
+    timer->node.alarm = 0;
+    timer->node.period = 0;
+    timer->node.index = ESP_TIMER_HEAP_NONE;
+    timer->cb = create_args->callback;
+    timer->arg = create_args->arg;
+    timer->method = create_args->dispatch_method;
+    timer->name = create_args->name;
+    timer->pending = 0;
+    timer->deleted = 0;
+    *out_handle = timer;
+
+    return ESP_OK;
+}
+
+static esp_err_t IRAM_ATTR timer_start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period)
+{
+    timer_lock();
+
+    /* Starting a running timer restarts it */
+    esp_timer_heap_remove(&s_heap, &timer->node);
+    timer->node.alarm = esp_timer_get_time() + timeout_us;
+    timer->node.period = period;
+    if (esp_timer_heap_push(&s_heap, &timer->node))
+        timer_set_alarm();
+
+    timer_unlock();
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Start one-shot timer
+ */
+esp_err_t IRAM_ATTR esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    assert(timer);
+
+    return timer_start(timer, timeout_us, 0);
+}
+
+/**
+ * @brief Start a periodic timer
+ */
+esp_err_t IRAM_ATTR esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    assert(timer);
+
+    if (!period)
+        return ESP_ERR_INVALID_ARG;
+
+    return timer_start(timer, period, period);
+}
+
+/**
+ * @brief Stop the timer
+ */
+esp_err_t IRAM_ATTR esp_timer_stop(esp_timer_handle_t timer)
+{
+    assert(timer);
+
+    timer_lock();
+
+    esp_timer_heap_remove(&s_heap, &timer->node);
+    if (timer->pending) {
+        STAILQ_REMOVE(&s_pending, timer, esp_timer, pending_entry);
+        timer->pending = 0;
+    }
+
+    timer_unlock();
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Delete an esp_timer instance
+ */
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    bool running;
+
+    assert(timer);
+
+    esp_timer_stop(timer);
+
+    timer_lock();
+    s_timer_num--;
+    running = s_running == timer;
+    if (running)
+        timer->deleted = 1;
+    timer_unlock();
+
+    if (!running)
+        heap_caps_free(timer);
+    else
+        ESP_LOGD(TAG, "delete timer %s after its callback", timer->name ? timer->name : "");
+
+    return ESP_OK;
+}
+
+#endif /* CONFIG_ESP_TIMER_HIGH_RESOLUTION */
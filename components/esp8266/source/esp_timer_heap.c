@@ -0,0 +1,125 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string.h>
+
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include "esp_private/esp_timer_heap.h"
+
+#ifdef CONFIG_ESP_TIMER_HIGH_RESOLUTION
+
+#define PARENT(i)   (((i) - 1) / 2)
+#define LEFT(i)     (2 * (i) + 1)
+
+static inline void IRAM_ATTR heap_set(esp_timer_heap_t *heap, size_t i, esp_timer_node_t *node)
+{
+    heap->nodes[i] = node;
+    node->index = i;
+}
+
+static void IRAM_ATTR heap_sift_up(esp_timer_heap_t *heap, size_t i)
+{
+    esp_timer_node_t *node = heap->nodes[i];
+
+    while (i && heap->nodes[PARENT(i)]->alarm > node->alarm) {
+        heap_set(heap, i, heap->nodes[PARENT(i)]);
+        i = PARENT(i);
+    }
+    heap_set(heap, i, node);
+}
+
+static void IRAM_ATTR heap_sift_down(esp_timer_heap_t *heap, size_t i)
+{
+    esp_timer_node_t *node = heap->nodes[i];
+    size_t child;
+
+    while ((child = LEFT(i)) < heap->count) {
+        if (child + 1 < heap->count && heap->nodes[child + 1]->alarm < heap->nodes[child]->alarm)
+            child++;
+        if (heap->nodes[child]->alarm >= node->alarm)
+            break;
+        heap_set(heap, i, heap->nodes[child]);
+        i = child;
+    }
+    heap_set(heap, i, node);
+}
+
+void esp_timer_heap_init(esp_timer_heap_t *heap, esp_timer_node_t **nodes, size_t capacity)
+{
+    heap->nodes = nodes;
+    heap->count = 0;
+    heap->capacity = capacity;
+}
+
+esp_timer_node_t **esp_timer_heap_resize(esp_timer_heap_t *heap, esp_timer_node_t **nodes, size_t capacity)
+{
+    esp_timer_node_t **old = heap->nodes;
+
+    memcpy(nodes, old, heap->count * sizeof(esp_timer_node_t *));
+    heap->nodes = nodes;
+    heap->capacity = capacity;
+
+    return old;
+}
+
+bool IRAM_ATTR esp_timer_heap_push(esp_timer_heap_t *heap, esp_timer_node_t *node)
+{
+    heap_set(heap, heap->count++, node);
+    heap_sift_up(heap, node->index);
+
+    return node->index == 0;
+}
+
+void IRAM_ATTR esp_timer_heap_remove(esp_timer_heap_t *heap, esp_timer_node_t *node)
+{
+    size_t i = node->index;
+    esp_timer_node_t *last;
+
+    if (i == ESP_TIMER_HEAP_NONE)
+        return;
+
+    node->index = ESP_TIMER_HEAP_NONE;
+    last = heap->nodes[--heap->count];
+    if (last == node)
+        return;
+
+    /* The last timer takes the place of the removed one and moves up or down */
+    heap_set(heap, i, last);
+    if (i && heap->nodes[PARENT(i)]->alarm > last->alarm)
+        heap_sift_up(heap, i);
+    else
+        heap_sift_down(heap, i);
+}
+
+esp_timer_node_t * IRAM_ATTR esp_timer_heap_expire(esp_timer_heap_t *heap, uint64_t now)
+{
+    esp_timer_node_t *node = esp_timer_heap_peek(heap);
+
+    if (!node || node->alarm > now)
+        return NULL;
+
+    if (node->period) {
+        uint64_t missed = (now - node->alarm) / node->period;
+
+        node->alarm += (missed + 1) * node->period;
+        heap_sift_down(heap, 0);
+    } else {
+        esp_timer_heap_remove(heap, node);
+    }
+
+    return node;
+}
+
+#endif /* CONFIG_ESP_TIMER_HIGH_RESOLUTION */
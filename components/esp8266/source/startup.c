@@ -34,6 +34,7 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "esp_task.h"
+#include "esp_timer.h"
 
 #include "esp_newlib.h"
 
@@ -64,10 +65,18 @@ static void user_init_entry(void *param)
     extern void app_main(void);
     extern uint32_t esp_get_time(void);
 
+#ifdef CONFIG_ESP_TIMER_HIGH_RESOLUTION
+    assert(esp_timer_init() == ESP_OK);
+#endif
+
     /* initialize C++ construture function */
     for (func = &__init_array_start; func < &__init_array_end; func++)
         func[0]();
 
+#ifdef CONFIG_LOG_ASYNC
+    assert(esp_log_async_init() == ESP_OK);
+#endif
+
     esp_phy_init_clk();
     assert(base_gpio_init() == 0);
 
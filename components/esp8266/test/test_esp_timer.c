@@ -111,3 +111,70 @@ TEST_CASE("Test esp_timer create and delete once mode", "[log]")
 
     vSemaphoreDelete(sem);
 }
+
+#ifdef CONFIG_ESP_TIMER_HIGH_RESOLUTION
+
+#define TEST_PERIOD_US  1250
+#define TEST_EXPIRIES   200
+
+static volatile int s_expiries;
+static volatile int64_t s_times[2];
+
+static void test_isr_timer_cb(void *arg)
+{
+    int64_t now = esp_timer_get_time();
+
+    if (s_expiries == 0)
+        s_times[0] = now;
+    if (++s_expiries == TEST_EXPIRIES)
+        s_times[1] = now;
+}
+
+TEST_CASE("Test esp_timer microsecond periodic timer from ISR", "[log]")
+{
+    esp_timer_handle_t timer;
+
+    esp_timer_create_args_t timer_args = {
+        .callback = test_isr_timer_cb,
+        .dispatch_method = ESP_TIMER_ISR,
+        .name = "test_isr_timer",
+    };
+
+    s_expiries = 0;
+    TEST_ESP_OK(esp_timer_create(&timer_args, &timer));
+    TEST_ESP_OK(esp_timer_start_periodic(timer, TEST_PERIOD_US));
+
+    vTaskDelay((TEST_PERIOD_US * (TEST_EXPIRIES + 10) / 1000 + 20) / portTICK_PERIOD_MS);
+
+    TEST_ESP_OK(esp_timer_stop(timer));
+    TEST_ESP_OK(esp_timer_delete(timer));
+
+    /* Not a multiple of the tick, and rescheduled from the alarm so it does not drift */
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_EXPIRIES, s_expiries);
+    TEST_ASSERT_INT32_WITHIN(100, TEST_PERIOD_US * (TEST_EXPIRIES - 1), (int32_t)(s_times[1] - s_times[0]));
+}
+
+TEST_CASE("Test esp_timer one-shot timeout shorter than a tick", "[log]")
+{
+    SemaphoreHandle_t sem;
+    esp_timer_handle_t timer;
+
+    sem = xSemaphoreCreateCounting(1, 0);
+    TEST_ASSERT_NOT_NULL(sem);
+
+    esp_timer_create_args_t timer_args = {
+        .callback = test_timer_cb,
+        .arg = sem,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "test_timer",
+    };
+
+    TEST_ESP_OK(esp_timer_create(&timer_args, &timer));
+    TEST_ESP_OK(esp_timer_start_once(timer, 500));
+    TEST_ASSERT_EQUAL_HEX32(pdPASS, xSemaphoreTake(sem, 2));
+    TEST_ESP_OK(esp_timer_delete(timer));
+
+    vSemaphoreDelete(sem);
+}
+
+#endif
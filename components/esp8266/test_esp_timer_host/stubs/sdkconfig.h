@@ -0,0 +1,3 @@
+#pragma once
+
+#define CONFIG_ESP_TIMER_HIGH_RESOLUTION 1
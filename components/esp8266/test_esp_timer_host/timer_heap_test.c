@@ -0,0 +1,250 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * Drives the esp_timer heap with a simulated microsecond clock, the way the
+ * FRC1 interrupt does: the clock jumps to the first alarm plus a random
+ * interrupt latency, sometimes a long stall, and the expired timers are taken.
+ * Timers are randomly started, restarted and stopped in the meantime.
+ *
+ * Checks that timers expire in order and never early, that nothing expired is
+ * left behind and that periodic timers stay on the grid of their first alarm.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "esp_private/esp_timer_heap.h"
+
+#define CHECK(cond) \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        exit(1); \
+    }
+
+typedef struct {
+    esp_timer_node_t node;      // first member, the heap returns its address
+    uint64_t start;             // first alarm of a periodic timer
+    uint64_t expiries;
+} test_timer_t;
+
+static uint64_t s_now;
+static uint32_t s_seed = 1;
+
+static uint32_t test_rand(void)
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+static void check_heap(const esp_timer_heap_t *heap, test_timer_t *timers, size_t num)
+{
+    size_t armed = 0;
+
+    for (size_t i = 0; i < heap->count; i++) {
+        CHECK(heap->nodes[i]->index == i);
+        if (i)
+            CHECK(heap->nodes[(i - 1) / 2]->alarm <= heap->nodes[i]->alarm);
+    }
+    for (size_t i = 0; i < num; i++) {
+        if (esp_timer_heap_armed(&timers[i].node)) {
+            armed++;
+            CHECK(heap->nodes[timers[i].node.index] == &timers[i].node);
+        }
+    }
+    CHECK(armed == heap->count);
+}
+
+static void test_start(esp_timer_heap_t *heap, test_timer_t *timer, uint64_t timeout, uint64_t period)
+{
+    esp_timer_heap_remove(heap, &timer->node);
+    timer->node.alarm = s_now + timeout;
+    timer->node.period = period;
+    timer->start = timer->node.alarm;
+    esp_timer_heap_push(heap, &timer->node);
+}
+
+static void test_basic(void)
+{
+    esp_timer_node_t *nodes[4];
+    esp_timer_heap_t heap;
+    test_timer_t t[4];
+    uint64_t alarms[] = {300, 100, 400, 200};
+
+    memset(t, 0, sizeof(t));
+    esp_timer_heap_init(&heap, nodes, 4);
+    s_now = 0;
+
+    CHECK(esp_timer_heap_peek(&heap) == NULL);
+    CHECK(esp_timer_heap_expire(&heap, 1000) == NULL);
+
+    for (int i = 0; i < 4; i++) {
+        t[i].node.index = ESP_TIMER_HEAP_NONE;
+        t[i].node.alarm = alarms[i];
+        t[i].node.period = 0;
+        CHECK(esp_timer_heap_push(&heap, &t[i].node) == (i <= 1));
+    }
+    check_heap(&heap, t, 4);
+
+    esp_timer_heap_remove(&heap, &t[3].node);
+    CHECK(!esp_timer_heap_armed(&t[3].node));
+    esp_timer_heap_remove(&heap, &t[3].node);
+    check_heap(&heap, t, 4);
+
+    CHECK(esp_timer_heap_expire(&heap, 99) == NULL);
+    CHECK(esp_timer_heap_expire(&heap, 350) == &t[1].node);
+    CHECK(esp_timer_heap_expire(&heap, 350) == &t[0].node);
+    CHECK(esp_timer_heap_expire(&heap, 350) == NULL);
+    CHECK(esp_timer_heap_peek(&heap) == &t[2].node);
+
+    /* A periodic timer late by 2.5 periods expires once and keeps its phase */
+    t[3].node.alarm = 1000;
+    t[3].node.period = 100;
+    esp_timer_heap_push(&heap, &t[3].node);
+    CHECK(esp_timer_heap_expire(&heap, 400) == &t[2].node);
+    CHECK(esp_timer_heap_expire(&heap, 1250) == &t[3].node);
+    CHECK(esp_timer_heap_expire(&heap, 1250) == NULL);
+    CHECK(t[3].node.alarm == 1300);
+    CHECK(esp_timer_heap_expire(&heap, 1300) == &t[3].node);
+    CHECK(t[3].node.alarm == 1400);
+    check_heap(&heap, t, 4);
+
+    printf("basic: OK\n");
+}
+
+static void test_simulation(size_t num, uint64_t duration)
+{
+    esp_timer_node_t **nodes = malloc(num * sizeof(esp_timer_node_t *));
+    test_timer_t *timers = calloc(num, sizeof(test_timer_t));
+    esp_timer_heap_t heap;
+    uint64_t expiries = 0, late = 0, ops = 0;
+
+    CHECK(nodes && timers);
+
+    esp_timer_heap_init(&heap, nodes, num);
+    s_now = 0;
+
+    for (size_t i = 0; i < num; i++) {
+        timers[i].node.index = ESP_TIMER_HEAP_NONE;
+        if (i & 1)
+            test_start(&heap, &timers[i], 1 + test_rand() % 100000, 0);
+        else
+            test_start(&heap, &timers[i], 1 + test_rand() % 100000, 1 + test_rand() % 50000);
+    }
+    check_heap(&heap, timers, num);
+
+    while (s_now < duration) {
+        esp_timer_node_t *first = esp_timer_heap_peek(&heap), *node;
+
+        /* Interrupt latency, now and then a stall of some milliseconds */
+        if (first) {
+            uint64_t latency = test_rand() % 64 ? test_rand() % 200 : test_rand() % 200000;
+
+            if (first->alarm > s_now)
+                s_now = first->alarm;
+            s_now += latency;
+        } else {
+            s_now += 1000;
+        }
+
+        while ((node = esp_timer_heap_expire(&heap, s_now))) {
+            test_timer_t *timer = (test_timer_t *)node;
+
+            timer->expiries++;
+            expiries++;
+
+            if (node->period) {
+                /* Next alarm on the grid, after now and not more than one period later */
+                CHECK(node->alarm > s_now);
+                CHECK(node->alarm - s_now <= node->period);
+                CHECK((node->alarm - timer->start) % node->period == 0);
+                late += s_now - (node->alarm - node->period);
+            } else {
+                CHECK(!esp_timer_heap_armed(node));
+                CHECK(node->alarm <= s_now);
+                late += s_now - node->alarm;
+            }
+        }
+        node = esp_timer_heap_peek(&heap);
+        CHECK(!node || node->alarm > s_now);
+
+        /* Restart, stop or start some timers, like the callbacks do */
+        for (int i = test_rand() % 4; i; i--) {
+            test_timer_t *timer = &timers[test_rand() % num];
+
+            switch (test_rand() % 4) {
+            case 0:
+                esp_timer_heap_remove(&heap, &timer->node);
+                break;
+            case 1:
+                test_start(&heap, timer, test_rand() % 100000, 1 + test_rand() % 50000);
+                break;
+            default:
+                test_start(&heap, timer, test_rand() % 100000, 0);
+                break;
+            }
+            ops++;
+        }
+        check_heap(&heap, timers, num);
+    }
+
+    printf("simulation: %zu timers, %" PRIu64 " s, %" PRIu64 " expiries, %" PRIu64 " restarts, "
+           "mean lateness %" PRIu64 " us: OK\n",
+           num, duration / 1000000, expiries, ops, expiries ? late / expiries : 0);
+
+    free(timers);
+    free(nodes);
+}
+
+static void test_resize(void)
+{
+    esp_timer_node_t *small[2], **big = malloc(8 * sizeof(esp_timer_node_t *));
+    esp_timer_heap_t heap;
+    test_timer_t t[8];
+
+    CHECK(big);
+    memset(t, 0, sizeof(t));
+    esp_timer_heap_init(&heap, small, 2);
+    s_now = 0;
+
+    for (int i = 0; i < 8; i++) {
+        t[i].node.index = ESP_TIMER_HEAP_NONE;
+        if (heap.count == heap.capacity)
+            CHECK(esp_timer_heap_resize(&heap, big, 8) == small);
+        test_start(&heap, &t[i], 800 - i * 100, 0);
+    }
+    check_heap(&heap, t, 8);
+
+    for (int i = 7; i >= 0; i--)
+        CHECK(esp_timer_heap_expire(&heap, 1000) == &t[i].node);
+    CHECK(heap.count == 0);
+
+    free(big);
+    printf("resize: OK\n");
+}
+
+int main(int argc, char **argv)
+{
+    size_t num = argc > 1 ? strtoul(argv[1], NULL, 0) : 100;
+    uint64_t seconds = argc > 2 ? strtoull(argv[2], NULL, 0) : 60;
+
+    test_basic();
+    test_resize();
+    test_simulation(num ? num : 1, seconds * 1000000);
+
+    return 0;
+}
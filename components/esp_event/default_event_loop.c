@@ -55,6 +55,17 @@ esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id,
             event_data, event_data_size, ticks_to_wait);
 }
 
+esp_err_t esp_event_post_zero_copy(esp_event_base_t event_base, int32_t event_id,
+        void* event_data, esp_event_data_release_t release, TickType_t ticks_to_wait)
+{
+    if (s_default_loop == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return esp_event_post_to_zero_copy(s_default_loop, event_base, event_id,
+            event_data, release, ticks_to_wait);
+}
+
 
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 esp_err_t esp_event_isr_post(esp_event_base_t event_base, int32_t event_id,
@@ -392,18 +392,428 @@ static void loop_node_remove_all_handler(esp_event_loop_node_t* loop_node)
     }
 }
 
-static void inline __attribute__((always_inline)) post_instance_delete(esp_event_post_instance_t* post)
+static void post_data_free(esp_event_loop_instance_t* loop, void* data)
 {
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-    if (post->data_allocated && post->data.ptr) {
-        free(post->data.ptr);
+#ifdef CONFIG_ESP_EVENT_POST_POOL
+    if (loop->post_pool && heap_caps_pool_owns(loop->post_pool, data)) {
+        heap_caps_pool_free(loop->post_pool, data);
+        return;
     }
+#endif
+    free(data);
+}
+
+static void inline __attribute__((always_inline)) post_instance_delete(esp_event_loop_instance_t* loop,
+                                                                       esp_event_post_instance_t* post)
+{
+#if CONFIG_ESP_EVENT_POST_FROM_ISR
+    void* data = post->data_allocated ? post->data.ptr : NULL;
 #else
-    if (post->data) {
-        free(post->data);
+    void* data = post->data;
+#endif
+    if (data) {
+        if (post->release) {
+            post->release(data);
+        } else {
+            post_data_free(loop, data);
+        }
+    }
+    memset(post, 0, sizeof(*post));
+}
+
+static BaseType_t post_instance_send(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post,
+                                     TickType_t ticks_to_wait)
+{
+    BaseType_t result = pdFALSE;
+
+    if (ticks_to_wait == 0) {
+        // Never waits, so it can not deadlock the task running the loop, nor wait for its mutex
+        result = xQueueSendToBack(loop->queue, post, 0);
+    } else if (loop->task == NULL) {
+        // Find the task that currently executes the loop. It is safe to query loop->task since it is
+        // not mutated since loop creation. ENSURE THIS REMAINS TRUE.
+        // The loop has no dedicated task. Find out what task is currently running it.
+        result = xSemaphoreTakeRecursive(loop->mutex, ticks_to_wait);
+
+        if (result == pdTRUE) {
+            if (loop->running_task != xTaskGetCurrentTaskHandle()) {
+                xSemaphoreGiveRecursive(loop->mutex);
+                result = xQueueSendToBack(loop->queue, post, ticks_to_wait);
+            } else {
+                xSemaphoreGiveRecursive(loop->mutex);
+                result = xQueueSendToBack(loop->queue, post, 0);
+            }
+        }
+    } else {
+        // The loop has a dedicated task.
+        if (loop->task != xTaskGetCurrentTaskHandle()) {
+            result = xQueueSendToBack(loop->queue, post, ticks_to_wait);
+        } else {
+            result = xQueueSendToBack(loop->queue, post, 0);
+        }
+    }
+
+    portENTER_CRITICAL();
+    if (result != pdTRUE) {
+        loop->stats.dropped++;
+    } else {
+        loop->stats.posted++;
+    }
+    portEXIT_CRITICAL();
+
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+    if (result != pdTRUE) {
+        atomic_fetch_add(&loop->events_dropped, 1);
+    } else {
+        atomic_fetch_add(&loop->events_recieved, 1);
     }
 #endif
+
+    return result;
+}
+
+static esp_event_coalesce_slot_t* coalesce_slot_find(esp_event_loop_instance_t* loop, esp_event_base_t base, int32_t id)
+{
+    esp_event_coalesce_slot_t* slot;
+
+    // Slots are only inserted at the head, once initialized, and freed with the loop
+    SLIST_FOREACH(slot, &(loop->coalesce_slots), next) {
+        if (slot->base == base && slot->id == id) {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+// Queues a post, or merges it into the pending one if the event is coalesced, without waiting for a full
+// queue. On failure, the post is left to the caller, except for coalesced events: then the latest one is
+// deleted and the post zeroed.
+static BaseType_t post_instance_queue(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post,
+                                      TickType_t ticks_to_wait)
+{
+    esp_event_coalesce_slot_t* slot = NULL;
+
+    if (!SLIST_EMPTY(&(loop->coalesce_slots))) {
+        slot = coalesce_slot_find(loop, post->base, post->id);
+    }
+
+    if (slot == NULL || !slot->enabled) {
+        return post_instance_send(loop, post, ticks_to_wait);
+    }
+
+    esp_event_post_instance_t old;
+    bool merged;
+
+    portENTER_CRITICAL();
+    merged = slot->pending;
+    old = slot->post;
+    slot->post = *post;
+    slot->pending = true;
+    if (merged) {
+        loop->stats.posted++;
+        loop->stats.merged++;
+    }
+    portEXIT_CRITICAL();
+
+    memset(post, 0, sizeof(*post));
+
+    if (merged) {
+        post_instance_delete(loop, &old);
+        return pdTRUE;
+    }
+
+    // Queue an event which takes the latest one out of the slot when dispatched. Until then,
+    // posts of the event are merged into the slot. It is not waited for, the slot would hold
+    // back the posts merged in the meantime.
+    post->base = slot->base;
+    post->id = slot->id;
+    post->slot = slot;
+
+    if (post_instance_send(loop, post, 0) == pdTRUE) {
+        return pdTRUE;
+    }
+
+    portENTER_CRITICAL();
+    old = slot->post;
+    slot->pending = false;
+    memset(&slot->post, 0, sizeof(slot->post));
+    portEXIT_CRITICAL();
+
+    post_instance_delete(loop, &old);
     memset(post, 0, sizeof(*post));
+
+    return pdFALSE;
+}
+
+static void coalesce_slot_take(esp_event_coalesce_slot_t* slot, esp_event_post_instance_t* post)
+{
+    portENTER_CRITICAL();
+    *post = slot->post;
+    slot->pending = false;
+    memset(&slot->post, 0, sizeof(slot->post));
+    portEXIT_CRITICAL();
+}
+
+typedef void (*handler_visit_t)(esp_event_handler_instance_t* handler, void* ctx);
+
+// Visits the handlers to run for an event, in the order they were registered. The lists may be
+// modified by the visited handlers.
+static void handlers_foreach(esp_event_loop_instance_t* loop, esp_event_base_t base, int32_t id,
+                             handler_visit_t visit, void* ctx)
+{
+    esp_event_handler_instance_t *handler;
+    esp_event_loop_node_t *loop_node;
+    esp_event_base_node_t *base_node;
+    esp_event_id_node_t *id_node;
+
+    SLIST_FOREACH(loop_node, &(loop->loop_nodes), next) {
+        // Execute loop level handlers
+        SLIST_FOREACH(handler, &(loop_node->handlers), next) {
+            visit(handler, ctx);
+        }
+
+        SLIST_FOREACH(base_node, &(loop_node->base_nodes), next) {
+            if (base_node->base == base) {
+                // Execute base level handlers
+                SLIST_FOREACH(handler, &(base_node->handlers), next) {
+                    visit(handler, ctx);
+                }
+
+                SLIST_FOREACH(id_node, &(base_node->id_nodes), next) {
+                    if (id_node->id == id) {
+                        // Execute id level handlers
+                        SLIST_FOREACH(handler, &(id_node->handlers), next) {
+                            visit(handler, ctx);
+                        }
+                        // Skip to next base node
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+typedef struct {
+    esp_event_loop_instance_t* loop;
+    esp_event_post_instance_t* post;
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+    uint32_t seq;                                                   // handlers stamped with it were already run, 0 if none
+#endif
+    bool exec;
+} handler_execute_ctx_t;
+
+static void handler_execute_visit(esp_event_handler_instance_t* handler, void* ctx)
+{
+    handler_execute_ctx_t* exec_ctx = (handler_execute_ctx_t*) ctx;
+
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+    // The stamp is on the handler, not its address: a handler registered during the dispatch
+    // may be allocated where one already run was freed
+    if (exec_ctx->seq && handler->dispatch_seq == exec_ctx->seq) {
+        return;
+    }
+#endif
+
+    handler_execute(exec_ctx->loop, handler, *exec_ctx->post);
+    exec_ctx->exec = true;
+}
+
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+#define DISPATCH_CACHE_PROBES       4
+#define DISPATCH_CACHE_MIN_SIZE     8
+
+typedef struct {
+    esp_event_handler_instance_t** handlers;
+    uint32_t size;
+    uint32_t num;                                                   // handlers visited, may be more than size
+} handler_collect_ctx_t;
+
+static void handler_collect_visit(esp_event_handler_instance_t* handler, void* ctx)
+{
+    handler_collect_ctx_t* collect_ctx = (handler_collect_ctx_t*) ctx;
+
+    if (collect_ctx->num < collect_ctx->size) {
+        collect_ctx->handlers[collect_ctx->num] = handler;
+    }
+    collect_ctx->num++;
+}
+
+static inline uint32_t dispatch_cache_hash(esp_event_base_t base, int32_t id)
+{
+    uint32_t hash = ((uint32_t) base >> 2) ^ ((uint32_t) id * 2654435761U);
+
+    return hash ^ (hash >> 16);
+}
+
+// Doubles the number of entries, the valid ones are moved and the stale ones dropped.
+static esp_err_t dispatch_cache_grow(esp_event_loop_instance_t* loop)
+{
+    uint32_t size = loop->dispatch_cache_size * 2;
+    esp_event_dispatch_entry_t* cache = calloc(size, sizeof(esp_event_dispatch_entry_t));
+
+    if (!cache) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (uint32_t i = 0; i < loop->dispatch_cache_size; i++) {
+        esp_event_dispatch_entry_t* entry = &loop->dispatch_cache[i];
+        bool moved = false;
+
+        if (entry->gen == loop->handlers_gen) {
+            uint32_t hash = dispatch_cache_hash(entry->base, entry->id);
+
+            for (uint32_t n = 0; n < DISPATCH_CACHE_PROBES && !moved; n++) {
+                esp_event_dispatch_entry_t* it = &cache[(hash + n) & (size - 1)];
+
+                if (it->gen != loop->handlers_gen) {
+                    *it = *entry;
+                    moved = true;
+                }
+            }
+        }
+        if (!moved) {
+            free(entry->handlers);
+        }
+    }
+
+    free(loop->dispatch_cache);
+    loop->dispatch_cache = cache;
+    loop->dispatch_cache_size = size;
+
+    return ESP_OK;
+}
+
+// Finds the handlers of an event, resolving them if they are not in the cache or stale.
+// Returns NULL when they can not be cached, the lists have to be walked instead.
+static esp_event_dispatch_entry_t* dispatch_cache_lookup(esp_event_loop_instance_t* loop, esp_event_base_t base, int32_t id)
+{
+    esp_event_dispatch_entry_t* entry = NULL;
+
+    // Events dispatched from handlers could evict the entry being run
+    if (!loop->dispatch_cache || loop->dispatch_depth) {
+        return NULL;
+    }
+
+    uint32_t hash = dispatch_cache_hash(base, id);
+
+    for (;;) {
+        for (uint32_t n = 0; n < DISPATCH_CACHE_PROBES; n++) {
+            esp_event_dispatch_entry_t* it = &loop->dispatch_cache[(hash + n) & (loop->dispatch_cache_size - 1)];
+
+            if (it->gen != loop->handlers_gen) {
+                // Reuse the first stale entry
+                if (!entry) {
+                    entry = it;
+                }
+            } else if (it->base == base && it->id == id) {
+                return it;
+            }
+        }
+
+        if (entry) {
+            break;
+        }
+
+        // All the entries the event could use are taken by others
+        if (loop->dispatch_cache_size * 2 > CONFIG_ESP_EVENT_DISPATCH_CACHE_SIZE ||
+            dispatch_cache_grow(loop) != ESP_OK) {
+            entry = &loop->dispatch_cache[hash & (loop->dispatch_cache_size - 1)];
+            break;
+        }
+    }
+
+    // The entry may still hold the handlers of another event, which are overwritten below:
+    // left stale until they are all collected, should the realloc fail
+    entry->gen = loop->handlers_gen - 1;
+
+    handler_collect_ctx_t ctx = { .handlers = entry->handlers, .size = entry->handlers_size, .num = 0 };
+    handlers_foreach(loop, base, id, handler_collect_visit, &ctx);
+
+    if (ctx.num > ctx.size) {
+        // Too many handlers for the current array, collect them again in a bigger one
+        void* handlers = realloc(entry->handlers, ctx.num * sizeof(*entry->handlers));
+
+        if (!handlers) {
+            return NULL;
+        }
+        entry->handlers = handlers;
+        entry->handlers_size = ctx.num;
+
+        ctx.handlers = entry->handlers;
+        ctx.size = entry->handlers_size;
+        ctx.num = 0;
+        handlers_foreach(loop, base, id, handler_collect_visit, &ctx);
+    }
+
+    entry->base = base;
+    entry->id = id;
+    entry->num = ctx.num;
+    entry->gen = loop->handlers_gen;
+
+    return entry;
+}
+
+static void dispatch_cache_invalidate(esp_event_loop_instance_t* loop)
+{
+    // The entries are resolved again when looked up, so that the one being run stays valid
+    loop->handlers_gen++;
+}
+
+static void dispatch_cache_delete(esp_event_loop_instance_t* loop)
+{
+    if (loop->dispatch_cache) {
+        for (uint32_t i = 0; i < loop->dispatch_cache_size; i++) {
+            free(loop->dispatch_cache[i].handlers);
+        }
+        free(loop->dispatch_cache);
+        loop->dispatch_cache = NULL;
+    }
+}
+#endif
+
+// Runs the handlers of a posted event, returns whether there were any
+static bool post_instance_dispatch(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post)
+{
+    handler_execute_ctx_t ctx = { .loop = loop, .post = post, .exec = false };
+
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+    esp_event_dispatch_entry_t* entry = dispatch_cache_lookup(loop, post->base, post->id);
+
+    ctx.seq = 0;
+
+    if (entry) {
+        uint32_t gen = loop->handlers_gen;
+        uint32_t i;
+
+        if (++loop->dispatch_seq == 0) {
+            loop->dispatch_seq = 1;
+        }
+        loop->dispatch_depth++;
+
+        for (i = 0; i < entry->num && loop->handlers_gen == gen; i++) {
+            // Stamped before it runs, as it may unregister itself
+            entry->handlers[i]->dispatch_seq = loop->dispatch_seq;
+            handler_execute(loop, entry->handlers[i], *post);
+        }
+
+        if (i < entry->num) {
+            // A handler registered or unregistered handlers: the ones left may have been freed,
+            // run the current handlers of the event that were not run yet.
+            ctx.seq = loop->dispatch_seq;
+            handlers_foreach(loop, post->base, post->id, handler_execute_visit, &ctx);
+        }
+
+        loop->dispatch_depth--;
+
+        return i > 0 || ctx.exec;
+    }
+#endif
+
+    handlers_foreach(loop, post->base, post->id, handler_execute_visit, &ctx);
+
+    return ctx.exec;
 }
 
 /* ---------------------------- Public API --------------------------------- */
@@ -441,7 +851,32 @@ esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, es
     }
 #endif
 
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+    // Entries are zeroed, hence stale until resolved at the first generation
+    loop->handlers_gen = 1;
+    loop->dispatch_cache_size = DISPATCH_CACHE_MIN_SIZE;
+    loop->dispatch_cache = calloc(loop->dispatch_cache_size, sizeof(esp_event_dispatch_entry_t));
+    if (loop->dispatch_cache == NULL) {
+        ESP_LOGW(TAG, "alloc for event loop dispatch cache failed, handlers are looked up on each event");
+    }
+#endif
+
+#ifdef CONFIG_ESP_EVENT_POST_POOL
+    // No more buffers can be in use than events waiting in the queue
+    size_t pool_num = CONFIG_ESP_EVENT_POST_POOL_BUF_NUM;
+    if (pool_num > (size_t) event_loop_args->queue_size) {
+        pool_num = (size_t) event_loop_args->queue_size;
+    }
+    loop->post_pool = heap_caps_pool_create(CONFIG_ESP_EVENT_POST_POOL_BUF_SIZE, pool_num, MALLOC_CAP_8BIT);
+    if (loop->post_pool == NULL) {
+        ESP_LOGW(TAG, "create event loop post pool failed, event data is copied to the heap");
+    }
+#endif
+
     SLIST_INIT(&(loop->loop_nodes));
+    SLIST_INIT(&(loop->coalesce_slots));
+
+    loop->batch_size = event_loop_args->batch_size ? event_loop_args->batch_size : CONFIG_ESP_EVENT_LOOP_BATCH_SIZE;
 
     // Create the loop task if requested
     if (event_loop_args->task_name != NULL) {
@@ -492,6 +927,14 @@ on_err:
     }
 #endif
 
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+    dispatch_cache_delete(loop);
+#endif
+
+#ifdef CONFIG_ESP_EVENT_POST_POOL
+    heap_caps_pool_delete(loop->post_pool);
+#endif
+
     free(loop);
 
     return err;
@@ -502,7 +945,8 @@ on_err:
 // (https://github.com/freebsd/freebsd/blob/master/sys/sys/tree.h)
 // indicate that the difference is not that substantial, especially considering the additional
 // pointers per node of rbtrees. Code for the rbtree implementation of the event loop library is archived
-// in feature/esp_event_loop_library_rbtrees if needed.
+// in feature/esp_event_loop_library_rbtrees if needed. With CONFIG_ESP_EVENT_DISPATCH_CACHE, the lists are
+// only walked when an event is not found in the hash table of the loop.
 esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t ticks_to_run)
 {
     assert(event_loop);
@@ -524,67 +968,46 @@ esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t tick
 
         loop->running_task = xTaskGetCurrentTaskHandle();
 
-        bool exec = false;
+        // Dispatch the events already queued along, up to the batch size, without releasing the mutex
+        uint32_t batch = 0;
+        bool expired = false;
 
-        esp_event_handler_instance_t *handler;
-        esp_event_loop_node_t *loop_node;
-        esp_event_base_node_t *base_node;
-        esp_event_id_node_t *id_node;
-
-        SLIST_FOREACH(loop_node, &(loop->loop_nodes), next) {
-            // Execute loop level handlers
-            SLIST_FOREACH(handler, &(loop_node->handlers), next) {
-                handler_execute(loop, handler, post);
-                exec |= true;
+        do {
+            if (post.slot) {
+                coalesce_slot_take(post.slot, &post);
             }
 
-            SLIST_FOREACH(base_node, &(loop_node->base_nodes), next) {
-                if (base_node->base == post.base) {
-                    // Execute base level handlers
-                    SLIST_FOREACH(handler, &(base_node->handlers), next) {
-                        handler_execute(loop, handler, post);
-                        exec |= true;
-                    }
+            bool exec = post_instance_dispatch(loop, &post);
 
-                    SLIST_FOREACH(id_node, &(base_node->id_nodes), next) {
-                        if (id_node->id == post.id) {
-                            // Execute id level handlers
-                            SLIST_FOREACH(handler, &(id_node->handlers), next) {
-                                handler_execute(loop, handler, post);
-                                exec |= true;
-                            }
-                            // Skip to next base node
-                            break;
-                        }
-                    }
-                }
+            if (!exec) {
+                // No handlers were registered, not even loop/base level handlers
+                ESP_LOGD(TAG, "no handlers have been registered for event %s:%d posted to loop %p", post.base, post.id, event_loop);
             }
-        }
-
-        esp_event_base_t base = post.base;
-        int32_t id = post.id;
 
-        post_instance_delete(&post);
-
-        if (ticks_to_run != portMAX_DELAY) {
-            end = xTaskGetTickCount();
-            remaining_ticks -= end - marker;
-            // If the ticks to run expired, return to the caller
-            if (remaining_ticks <= 0) {
-                xSemaphoreGiveRecursive(loop->mutex);
-                break;
-            } else {
-                marker = end;
+            post_instance_delete(loop, &post);
+            batch++;
+
+            if (ticks_to_run != portMAX_DELAY) {
+                end = xTaskGetTickCount();
+                remaining_ticks -= end - marker;
+                // If the ticks to run expired, return to the caller
+                if (remaining_ticks <= 0) {
+                    expired = true;
+                } else {
+                    marker = end;
+                }
             }
-        }
+        } while (!expired && batch < loop->batch_size && xQueueReceive(loop->queue, &post, 0) == pdTRUE);
+
+        loop->stats.dispatched += batch;
+        loop->stats.batches++;
 
         loop->running_task = NULL;
 
         xSemaphoreGiveRecursive(loop->mutex);
 
-        if (!exec) {
-            // No handlers were registered, not even loop/base level handlers
-            ESP_LOGD(TAG, "no handlers have been registered for event %s:%d posted to loop %p", base, id, event_loop);
+        if (expired) {
+            break;
         }
     }
 
@@ -626,11 +1049,24 @@ esp_err_t esp_event_loop_delete(esp_event_loop_handle_t event_loop)
     // Drop existing posts on the queue
     esp_event_post_instance_t post;
     while(xQueueReceive(loop->queue, &post, 0) == pdTRUE) {
-        post_instance_delete(&post);
+        post_instance_delete(loop, &post);
+    }
+
+    // Drop the coalesced events
+    esp_event_coalesce_slot_t *slot, *slot_temp;
+    SLIST_FOREACH_SAFE(slot, &(loop->coalesce_slots), next, slot_temp) {
+        post_instance_delete(loop, &(slot->post));
+        free(slot);
     }
 
     // Cleanup loop
     vQueueDelete(loop->queue);
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+    dispatch_cache_delete(loop);
+#endif
+#ifdef CONFIG_ESP_EVENT_POST_POOL
+    heap_caps_pool_delete(loop->post_pool);
+#endif
     free(loop);
     // Free loop mutex before deleting
     xSemaphoreGiveRecursive(loop_mutex);
@@ -704,6 +1140,12 @@ esp_err_t esp_event_handler_register_with(esp_event_loop_handle_t event_loop, es
         err = loop_node_add_handler(last_loop_node, event_base, event_id, event_handler, event_handler_arg);
     }
 
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+    if (err == ESP_OK) {
+        dispatch_cache_invalidate(loop);
+    }
+#endif
+
 on_err:
     xSemaphoreGiveRecursive(loop->mutex);
     return err;
@@ -740,11 +1182,70 @@ esp_err_t esp_event_handler_unregister_with(esp_event_loop_handle_t event_loop,
         }
     }
 
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+    dispatch_cache_invalidate(loop);
+#endif
+
     xSemaphoreGiveRecursive(loop->mutex);
 
     return ESP_OK;
 }
 
+esp_err_t esp_event_loop_set_coalescing(esp_event_loop_handle_t event_loop, esp_event_base_t event_base,
+                                        int32_t event_id, bool enable)
+{
+    assert(event_loop);
+
+    if (event_base == ESP_EVENT_ANY_BASE || event_id == ESP_EVENT_ANY_ID) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_event_loop_instance_t* loop = (esp_event_loop_instance_t*) event_loop;
+    esp_err_t err = ESP_OK;
+
+    xSemaphoreTakeRecursive(loop->mutex, portMAX_DELAY);
+
+    // Slots of events no longer coalesced are kept, a queued event may still refer to them
+    esp_event_coalesce_slot_t* slot = coalesce_slot_find(loop, event_base, event_id);
+
+    if (slot) {
+        slot->enabled = enable;
+    } else if (enable) {
+        slot = calloc(1, sizeof(*slot));
+
+        if (slot) {
+            slot->base = event_base;
+            slot->id = event_id;
+            slot->enabled = true;
+
+            portENTER_CRITICAL();
+            SLIST_INSERT_HEAD(&(loop->coalesce_slots), slot, next);
+            portEXIT_CRITICAL();
+        } else {
+            ESP_LOGE(TAG, "alloc for coalesced event failed");
+            err = ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreGiveRecursive(loop->mutex);
+
+    return err;
+}
+
+esp_err_t esp_event_loop_get_stats(esp_event_loop_handle_t event_loop, esp_event_loop_stats_t* stats)
+{
+    assert(event_loop);
+    assert(stats);
+
+    esp_event_loop_instance_t* loop = (esp_event_loop_instance_t*) event_loop;
+
+    portENTER_CRITICAL();
+    *stats = loop->stats;
+    portEXIT_CRITICAL();
+
+    return ESP_OK;
+}
+
 esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
                             void* event_data, size_t event_data_size, TickType_t ticks_to_wait)
 {
@@ -760,11 +1261,20 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t
     memset((void*)(&post), 0, sizeof(post));
 
     if (event_data != NULL && event_data_size != 0) {
-        // Make persistent copy of event data on heap.
-        void* event_data_copy = calloc(1, event_data_size);
+        // Make persistent copy of event data, in the pool of the loop if it fits.
+        void* event_data_copy = NULL;
 
+#ifdef CONFIG_ESP_EVENT_POST_POOL
+        if (event_data_size <= CONFIG_ESP_EVENT_POST_POOL_BUF_SIZE && loop->post_pool) {
+            event_data_copy = heap_caps_pool_alloc(loop->post_pool);
+        }
+#endif
         if (event_data_copy == NULL) {
-            return ESP_ERR_NO_MEM;
+            event_data_copy = malloc(event_data_size);
+
+            if (event_data_copy == NULL) {
+                return ESP_ERR_NO_MEM;
+            }
         }
 
         memcpy(event_data_copy, event_data, event_data_size);
@@ -779,45 +1289,45 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t
     post.base = event_base;
     post.id = event_id;
 
-    BaseType_t result = pdFALSE;
+    if (post_instance_queue(loop, &post, ticks_to_wait) != pdTRUE) {
+        post_instance_delete(loop, &post);
+        return ESP_ERR_TIMEOUT;
+    }
 
-    // Find the task that currently executes the loop. It is safe to query loop->task since it is
-    // not mutated since loop creation. ENSURE THIS REMAINS TRUE.
-    if (loop->task == NULL) {
-        // The loop has no dedicated task. Find out what task is currently running it.
-        result = xSemaphoreTakeRecursive(loop->mutex, ticks_to_wait);
+    return ESP_OK;
+}
 
-        if (result == pdTRUE) {
-            if (loop->running_task != xTaskGetCurrentTaskHandle()) {
-                xSemaphoreGiveRecursive(loop->mutex);
-                result = xQueueSendToBack(loop->queue, &post, ticks_to_wait);
-            } else {
-                xSemaphoreGiveRecursive(loop->mutex);
-                result = xQueueSendToBack(loop->queue, &post, 0);
-            }
-        }
-    } else {
-        // The loop has a dedicated task.
-        if (loop->task != xTaskGetCurrentTaskHandle()) {
-            result = xQueueSendToBack(loop->queue, &post, ticks_to_wait);
-        } else {
-            result = xQueueSendToBack(loop->queue, &post, 0);
-        }
+esp_err_t esp_event_post_to_zero_copy(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
+                            void* event_data, esp_event_data_release_t release, TickType_t ticks_to_wait)
+{
+    assert(event_loop);
+
+    if (event_base == ESP_EVENT_ANY_BASE || event_id == ESP_EVENT_ANY_ID ||
+        event_data == NULL || release == NULL) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    if (result != pdTRUE) {
-        post_instance_delete(&post);
+    esp_event_loop_instance_t* loop = (esp_event_loop_instance_t*) event_loop;
 
-#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
-        atomic_fetch_add(&loop->events_dropped, 1);
+    esp_event_post_instance_t post;
+    memset((void*)(&post), 0, sizeof(post));
+
+#if CONFIG_ESP_EVENT_POST_FROM_ISR
+    post.data.ptr = event_data;
+    post.data_allocated = true;
+    post.data_set = true;
+#else
+    post.data = event_data;
 #endif
+    post.release = release;
+    post.base = event_base;
+    post.id = event_id;
+
+    // The data is only owned once queued, on failure it is left to the caller, unless coalesced.
+    if (post_instance_queue(loop, &post, ticks_to_wait) != pdTRUE) {
         return ESP_ERR_TIMEOUT;
     }
 
-#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
-    atomic_fetch_add(&loop->events_recieved, 1);
-#endif
-
     return ESP_OK;
 }
 
@@ -854,7 +1364,8 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop, esp_event_ba
     result = xQueueSendToBackFromISR(loop->queue, &post, task_unblocked);
 
     if (result != pdTRUE) {
-        post_instance_delete(&post);
+        loop->stats.dropped++;
+        post_instance_delete(loop, &post);
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
         atomic_fetch_add(&loop->events_dropped, 1);
@@ -862,6 +1373,8 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop, esp_event_ba
         return ESP_FAIL;
     }
 
+    loop->stats.posted++;
+
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     atomic_fetch_add(&loop->events_recieved, 1);
 #endif
@@ -15,6 +15,8 @@
 #ifndef ESP_EVENT_H_
 #define ESP_EVENT_H_
 
+#include <stdbool.h>
+
 #include "esp_err.h"
 
 #include "freertos/FreeRTOS.h"
@@ -38,8 +40,19 @@ typedef struct {
     uint32_t task_stack_size;                   /**< stack size of the event loop task, ignored if task name is NULL */
     BaseType_t task_core_id;                    /**< core to which the event loop task is pinned to,
                                                         ignored if task name is NULL */
+    uint32_t batch_size;                        /**< maximum number of events dispatched each time the loop
+                                                        wakes up, 0 for CONFIG_ESP_EVENT_LOOP_BATCH_SIZE */
 } esp_event_loop_args_t;
 
+/// Statistics of an event loop, since its creation
+typedef struct {
+    uint32_t posted;                            /**< events posted to the loop, merged ones included */
+    uint32_t dropped;                           /**< events not posted or discarded as the queue was full */
+    uint32_t merged;                            /**< coalesced events which replaced a pending one */
+    uint32_t dispatched;                        /**< events dispatched */
+    uint32_t batches;                           /**< number of batches the events were dispatched in */
+} esp_event_loop_stats_t;
+
 /**
  * @brief Create a new event loop.
  *
@@ -113,6 +126,44 @@ esp_err_t esp_event_loop_delete_default();
  */
 esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t ticks_to_run);
 
+/**
+ * @brief Enable or disable coalescing of an event posted to an event loop.
+ *
+ * While a coalesced event waits in the queue, posting it again replaces its data instead of queuing a new
+ * event: handlers which fall behind only see the latest value, e.g. of a high-rate sensor. Posting a coalesced
+ * event never blocks, ticks_to_wait is ignored: when the queue is full, the event is dropped, its data released
+ * and ESP_ERR_TIMEOUT returned.
+ *
+ * @param[in] event_loop the event loop the event is posted to
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event id that identifies the event
+ * @param[in] enable whether to coalesce the event
+ *
+ * @note events posted from interrupt handlers are never coalesced
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_NO_MEM: Cannot allocate memory for the event
+ *  - ESP_ERR_INVALID_ARG: ESP_EVENT_ANY_BASE or ESP_EVENT_ANY_ID given
+ *  - Others: Fail
+ */
+esp_err_t esp_event_loop_set_coalescing(esp_event_loop_handle_t event_loop,
+                                        esp_event_base_t event_base,
+                                        int32_t event_id,
+                                        bool enable);
+
+/**
+ * @brief Get the statistics of an event loop.
+ *
+ * @param[in] event_loop the event loop
+ * @param[out] stats filled with the statistics of the loop
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - Others: Fail
+ */
+esp_err_t esp_event_loop_get_stats(esp_event_loop_handle_t event_loop, esp_event_loop_stats_t* stats);
+
 /**
  * @brief Register an event handler to the system event loop.
  *
@@ -270,6 +321,61 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop,
                             size_t event_data_size,
                             TickType_t ticks_to_wait);
 
+/**
+ * @brief Posts an event to the system default event loop without copying event_data. The ownership of
+ * event_data passes to the event loop library, which calls release once all the handlers have run.
+ *
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event id that identifies the event
+ * @param[in] event_data the data, specific to the event occurence, that gets passed to the handler
+ * @param[in] release the function called with event_data after dispatch, free() for data allocated with malloc()
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @note when the event can not be posted, the caller keeps the ownership of event_data and release is not called,
+ *       unless the event is coalesced (see esp_event_loop_set_coalescing)
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event id, event_data or release is NULL
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_zero_copy(esp_event_base_t event_base,
+                            int32_t event_id,
+                            void* event_data,
+                            esp_event_data_release_t release,
+                            TickType_t ticks_to_wait);
+
+/**
+ * @brief Posts an event to the specified event loop without copying event_data. The ownership of
+ * event_data passes to the event loop library, which calls release once all the handlers have run.
+ *
+ * This function behaves in the same manner as esp_event_post_zero_copy, except the additional specification
+ * of the event loop to post the event to.
+ *
+ * @param[in] event_loop the event loop to post to
+ * @param[in] event_base the event base that identifies the event
+ * @param[in] event_id the event id that identifies the event
+ * @param[in] event_data the data, specific to the event occurence, that gets passed to the handler
+ * @param[in] release the function called with event_data after dispatch, free() for data allocated with malloc()
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue
+ *
+ * @note when the event can not be posted, the caller keeps the ownership of event_data and release is not called,
+ *       unless the event is coalesced (see esp_event_loop_set_coalescing)
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event id, event_data or release is NULL
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_to_zero_copy(esp_event_loop_handle_t event_loop,
+                            esp_event_base_t event_base,
+                            int32_t event_id,
+                            void* event_data,
+                            esp_event_data_release_t release,
+                            TickType_t ticks_to_wait);
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 /**
  * @brief Special variant of esp_event_post for posting events from interrupt handlers.
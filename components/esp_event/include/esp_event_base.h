@@ -30,6 +30,8 @@ typedef void         (*esp_event_handler_t)(void* event_handler_arg,
                                         esp_event_base_t event_base, 
                                         int32_t event_id, 
                                         void* event_data); /**< function called when an event is posted to the queue */
+typedef void         (*esp_event_data_release_t)(void* event_data); /**< function called once the handlers are done
+                                                                         with event data posted without a copy */
 
 
 // Defines for registering/unregistering event handlers
@@ -17,6 +17,10 @@
 
 #include "esp_event.h"
 #include "stdatomic.h"
+#ifdef CONFIG_ESP_EVENT_POST_POOL
+#include "esp_heap_caps.h"
+#include "esp_heap_pool.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +35,9 @@ typedef struct esp_event_handler_instance {
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     uint32_t invoked;                                               /**< number of times this handler has been invoked */
     int64_t time;                                                   /**< total runtime of this handler across all calls */
+#endif
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+    uint32_t dispatch_seq;                                          /**< last cached dispatch which ran this handler */
 #endif
     SLIST_ENTRY(esp_event_handler_instance) next;                   /**< next event handler in the list */
 } esp_event_handler_instance_t;
@@ -67,6 +74,21 @@ typedef struct esp_event_loop_node {
 
 typedef SLIST_HEAD(esp_event_loop_nodes, esp_event_loop_node) esp_event_loop_nodes_t;
 
+/// Handlers resolved for an event
+typedef struct esp_event_dispatch_entry {
+    esp_event_base_t base;                                          /**< base of the event */
+    int32_t id;                                                     /**< id of the event */
+    uint32_t gen;                                                   /**< handler generation of the loop the entry
+                                                                            was resolved at, stale once it changes */
+    uint16_t num;                                                   /**< number of handlers */
+    uint16_t handlers_size;                                         /**< number of handlers the array can hold */
+    esp_event_handler_instance_t** handlers;                        /**< handlers, in the order they are run */
+} esp_event_dispatch_entry_t;
+
+struct esp_event_coalesce_slot;
+
+typedef SLIST_HEAD(esp_event_coalesce_slots, esp_event_coalesce_slot) esp_event_coalesce_slots_t;
+
 /// Event loop
 typedef struct esp_event_loop_instance {
     const char* name;                                               /**< name of this event loop */
@@ -77,6 +99,19 @@ typedef struct esp_event_loop_instance {
     SemaphoreHandle_t mutex;                                        /**< mutex for updating the events linked list */
     esp_event_loop_nodes_t loop_nodes;                              /**< set of linked lists containing the
                                                                             registered handlers for the loop */
+    uint32_t batch_size;                                            /**< maximum number of events dispatched per wakeup */
+    esp_event_coalesce_slots_t coalesce_slots;                      /**< events which are coalesced */
+    esp_event_loop_stats_t stats;                                   /**< statistics of the loop */
+#ifdef CONFIG_ESP_EVENT_DISPATCH_CACHE
+    esp_event_dispatch_entry_t* dispatch_cache;                     /**< handlers of the recently posted events */
+    uint32_t dispatch_cache_size;                                   /**< number of entries, a power of two */
+    uint32_t handlers_gen;                                          /**< incremented on every (un)registration */
+    uint32_t dispatch_depth;                                        /**< number of events being dispatched */
+    uint32_t dispatch_seq;                                          /**< number of events dispatched from the cache */
+#endif
+#ifdef CONFIG_ESP_EVENT_POST_POOL
+    heap_caps_pool_handle_t post_pool;                              /**< buffers for the copies of small event data */
+#endif
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     atomic_uint_least32_t events_recieved;                          /**< number of events successfully posted to the loop */
     atomic_uint_least32_t events_dropped;                           /**< number of events dropped due to queue being full */
@@ -103,8 +138,23 @@ typedef struct esp_event_post_instance {
     esp_event_base_t base;                                           /**< the event base */
     int32_t id;                                                      /**< the event id */
     esp_event_post_data_t data;                                      /**< data associated with the event */
+    esp_event_data_release_t release;                                /**< releases data posted without a copy,
+                                                                            NULL for the copies made by the library */
+    struct esp_event_coalesce_slot* slot;                            /**< for coalesced events, the slot holding
+                                                                            the latest event, data is then unset */
 } esp_event_post_instance_t;
 
+/// Coalesced event
+typedef struct esp_event_coalesce_slot {
+    esp_event_base_t base;                                           /**< the event base */
+    int32_t id;                                                      /**< the event id */
+    bool enabled;                                                    /**< whether posts are coalesced */
+    bool pending;                                                    /**< whether the event is queued */
+    esp_event_post_instance_t post;                                  /**< latest event posted, taken out of the
+                                                                            slot when the queued event is dispatched */
+    SLIST_ENTRY(esp_event_coalesce_slot) next;                       /**< next coalesced event of the loop */
+} esp_event_coalesce_slot_t;
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
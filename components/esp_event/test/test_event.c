@@ -881,6 +881,321 @@ TEST_CASE("performance test - no dedicated task", "[event]")
     performance_test(false);
 }
 
+#define TEST_CONFIG_THROUGHPUT_EVENTS       1000
+
+static int s_test_released;
+
+static void test_event_release(void* event_data)
+{
+    s_test_released++;
+}
+
+typedef enum {
+    TEST_POST_COPY_SMALL,
+    TEST_POST_COPY_LARGE,
+    TEST_POST_ZERO_COPY,
+    TEST_POST_MAX
+} test_post_mode_t;
+
+static int throughput_test(esp_event_loop_handle_t loop, test_post_mode_t mode)
+{
+    // Small data fits in the post pool, large data is always copied to the heap
+    static uint8_t event_data[128];
+    size_t event_data_size = (mode == TEST_POST_COPY_SMALL) ? 16 : sizeof(event_data);
+    performance_data_t data;
+
+    data.performed = 0;
+    data.expected = TEST_CONFIG_THROUGHPUT_EVENTS;
+    data.done = xSemaphoreCreateBinary();
+    s_test_released = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_event_performance_handler, &data));
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < TEST_CONFIG_THROUGHPUT_EVENTS; i++) {
+        if (mode == TEST_POST_ZERO_COPY) {
+            TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to_zero_copy(loop, s_test_base1, TEST_EVENT_BASE1_EV1, event_data, test_event_release, portMAX_DELAY));
+        } else {
+            TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, event_data, event_data_size, portMAX_DELAY));
+        }
+    }
+    xSemaphoreTake(data.done, portMAX_DELAY);
+    int64_t elapsed = esp_timer_get_time() - start;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_unregister_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_event_performance_handler));
+    vSemaphoreDelete(data.done);
+
+    TEST_ASSERT_EQUAL(data.expected, data.performed);
+    if (mode == TEST_POST_ZERO_COPY) {
+        // The last release happens after the last handler returns
+        vTaskDelay(1);
+        TEST_ASSERT_EQUAL(data.expected, s_test_released);
+    }
+
+    return (int) (data.performed / (elapsed / 1000000.0));
+}
+
+TEST_CASE("performance test - event data copy and zero-copy", "[event]")
+{
+    static const char* mode_names[TEST_POST_MAX] = { "16 byte copy", "128 byte copy", "zero-copy" };
+
+    TEST_SETUP();
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    esp_event_loop_handle_t loop;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_create(&loop_args, &loop));
+
+    for (int mode = 0; mode < TEST_POST_MAX; mode++) {
+        int events = throughput_test(loop, mode);
+        ESP_LOGI(TAG, "%s: %d events dispatched/second", mode_names[mode], events);
+    }
+
+    // Ownership of the data stays with the caller when the event can not be posted
+    s_test_released = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_event_post_to_zero_copy(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &loop, NULL, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_event_post_to_zero_copy(loop, s_test_base1, ESP_EVENT_ANY_ID, &loop, test_event_release, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(0, s_test_released);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_delete(loop));
+
+    TEST_TEARDOWN();
+}
+
+#ifdef CONFIG_ESP_EVENT_POST_POOL
+TEST_CASE("can release zero-copy event data left on deleted loop", "[event]")
+{
+    TEST_SETUP();
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    esp_event_loop_handle_t loop;
+
+    loop_args.task_name = NULL;
+    loop_args.queue_size = CONFIG_ESP_EVENT_POST_POOL_BUF_NUM + 2;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_create(&loop_args, &loop));
+
+    int sample = 0;
+    s_test_released = 0;
+
+    // Both the pooled copies and the zero-copy data are released when dropped
+    for (int i = 0; i < CONFIG_ESP_EVENT_POST_POOL_BUF_NUM + 1; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &sample, sizeof(sample), 0));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to_zero_copy(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &sample, test_event_release, 0));
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_delete(loop));
+    TEST_ASSERT_EQUAL(1, s_test_released);
+
+    TEST_TEARDOWN();
+}
+#endif
+
+#define TEST_CONFIG_SENSOR_IDS              200
+
+static void test_event_count_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    (*(int*) event_handler_arg)++;
+}
+
+TEST_CASE("can dispatch to many ids as handlers are registered and unregistered", "[event]")
+{
+    TEST_SETUP();
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    esp_event_loop_handle_t loop;
+
+    loop_args.task_name = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_create(&loop_args, &loop));
+
+    int count = 0;
+
+    // One handler per id, as for per-sensor events
+    for (int id = 0; id < TEST_CONFIG_SENSOR_IDS; id++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_register_with(loop, s_test_base1, id, test_event_count_handler, &count));
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (int round = 0; round < 2; round++) {
+        for (int id = 0; id < TEST_CONFIG_SENSOR_IDS; id++) {
+            TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, id, NULL, 0, portMAX_DELAY));
+            TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_run(loop, 0));
+        }
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    TEST_ASSERT_EQUAL(2 * TEST_CONFIG_SENSOR_IDS, count);
+    ESP_LOGI(TAG, "%d ids: %d events dispatched/second", TEST_CONFIG_SENSOR_IDS, (int) (2 * TEST_CONFIG_SENSOR_IDS / (elapsed / 1000000.0)));
+
+    // Handlers of events already dispatched are looked up again once the registrations change
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_register_with(loop, s_test_base1, ESP_EVENT_ANY_ID, test_event_count_handler, &count));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_unregister_with(loop, s_test_base1, 0, test_event_count_handler));
+
+    count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, 0, NULL, 0, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, 1, NULL, 0, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_run(loop, pdMS_TO_TICKS(10)));
+    TEST_ASSERT_EQUAL(3, count);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_delete(loop));
+
+    TEST_TEARDOWN();
+}
+
+typedef struct {
+    esp_event_loop_handle_t loop;
+    int id;
+    int late_id;                                                    // of the handler registered on change
+    bool change;
+} test_changing_arg_t;
+
+static void test_event_ordered_dispatch_late(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    test_event_ordered_dispatch(event_handler_arg, event_base, event_id, event_data);
+}
+
+static void test_event_changing_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    test_changing_arg_t* arg = (test_changing_arg_t*) event_handler_arg;
+
+    test_event_ordered_dispatch(&arg->id, event_base, event_id, event_data);
+
+    if (arg->change) {
+        // Frees a handler already run and one not run yet, the new one may take the place of either
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_unregister_with(arg->loop, s_test_base1, ESP_EVENT_ANY_ID, test_event_ordered_dispatch));
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_unregister_with(arg->loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_event_ordered_dispatch));
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_register_with(arg->loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_event_ordered_dispatch_late, &arg->late_id));
+        arg->change = false;
+    }
+}
+
+TEST_CASE("can register and unregister handlers of the event being dispatched", "[event]")
+{
+    TEST_SETUP();
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    esp_event_loop_handle_t loop;
+
+    loop_args.task_name = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_create(&loop_args, &loop));
+
+    int id_arr[] = { 0, 2 };
+    test_changing_arg_t changing = {
+        .loop = loop,
+        .id = 1,
+        .late_id = 3,
+        .change = false
+    };
+    int data_arr[12] = {0};
+    ordered_data_t data = {
+        .arr = data_arr,
+        .index = 0
+    };
+    ordered_data_t* dptr = &data;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_register_with(loop, s_test_base1, ESP_EVENT_ANY_ID, test_event_ordered_dispatch, id_arr + 0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_event_changing_handler, &changing));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_event_ordered_dispatch, id_arr + 1));
+
+    // The first dispatch caches the handlers, the second one changes them half-way
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &dptr, sizeof(dptr), portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_run(loop, 0));
+    changing.change = true;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &dptr, sizeof(dptr), portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_run(loop, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &dptr, sizeof(dptr), portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_run(loop, 0));
+
+    // As walking the lists: the handlers already run are not run again, the removed one is not
+    // run and the added one is
+    int ref_arr[8] = {0, 1, 2, 0, 1, 3, 1, 3};
+
+    TEST_ASSERT_EQUAL(8, data.index);
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL(ref_arr[i], data_arr[i]);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_delete(loop));
+
+    TEST_TEARDOWN();
+}
+
+static void test_event_latest_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    int* latest = (int*) event_handler_arg;
+
+    latest[0]++;
+    latest[1] = *((int*) event_data);
+}
+
+TEST_CASE("can coalesce events and dispatch them in batches", "[event]")
+{
+    TEST_SETUP();
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    esp_event_loop_handle_t loop;
+    esp_event_loop_stats_t stats;
+
+    loop_args.task_name = NULL;
+    loop_args.queue_size = 4;
+    loop_args.batch_size = 2;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_create(&loop_args, &loop));
+
+    int latest[2] = { 0 };
+    int count = 0;
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_event_latest_handler, latest));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV2, test_event_count_handler, &count));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_event_loop_set_coalescing(loop, s_test_base1, ESP_EVENT_ANY_ID, true));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_set_coalescing(loop, s_test_base1, TEST_EVENT_BASE1_EV1, true));
+
+    // Only one of the coalesced events is queued, with the latest data
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &i, sizeof(i), 0));
+    }
+    for (int i = 0; i < loop_args.queue_size - 1; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV2, &i, sizeof(i), 0));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV2, &latest, sizeof(int), 0));
+
+    esp_event_loop_get_stats(loop, &stats);
+    TEST_ASSERT_EQUAL(99, stats.merged);
+    TEST_ASSERT_EQUAL(1, stats.dropped);
+    TEST_ASSERT_EQUAL(100 + loop_args.queue_size - 1, stats.posted);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_run(loop, pdMS_TO_TICKS(100)));
+    TEST_ASSERT_EQUAL(1, latest[0]);
+    TEST_ASSERT_EQUAL(99, latest[1]);
+    TEST_ASSERT_EQUAL(loop_args.queue_size - 1, count);
+
+    esp_event_loop_get_stats(loop, &stats);
+    TEST_ASSERT_EQUAL(loop_args.queue_size, stats.dispatched);
+    TEST_ASSERT_EQUAL(loop_args.queue_size / loop_args.batch_size, stats.batches);
+
+    // Once disabled, every post is dispatched
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_set_coalescing(loop, s_test_base1, TEST_EVENT_BASE1_EV1, false));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &count, sizeof(count), 0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &count, sizeof(count), 0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_run(loop, pdMS_TO_TICKS(100)));
+    TEST_ASSERT_EQUAL(3, latest[0]);
+
+    // A coalesced event does not wait for room in the queue
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_set_coalescing(loop, s_test_base1, TEST_EVENT_BASE1_EV1, true));
+    for (int i = 0; i < loop_args.queue_size; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV2, &i, sizeof(i), 0));
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &count, sizeof(count), portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_run(loop, pdMS_TO_TICKS(100)));
+    TEST_ASSERT_EQUAL(3, latest[0]);
+
+    // The dropped event is not left pending
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &count, sizeof(count), 0));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_run(loop, pdMS_TO_TICKS(100)));
+    TEST_ASSERT_EQUAL(4, latest[0]);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_event_loop_delete(loop));
+
+    TEST_TEARDOWN();
+}
+
 TEST_CASE("can post to loop from handler - dedicated task", "[event]")
 {
     TEST_SETUP();
@@ -15,6 +15,9 @@
 
 #include <string.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
 #include "esp_system.h"
 #include "esp_log.h"
 
@@ -23,6 +26,7 @@
 #include "esp_transport_tcp.h"
 #include "http_utils.h"
 #include "http_auth.h"
+#include "http_conn_pool.h"
 #include "sdkconfig.h"
 #include "esp_http_client.h"
 #include "errno.h"
@@ -67,7 +71,11 @@ typedef struct {
     char                         *password;
     char                         *path;
     char                         *query;
-    char                         *cert_pem;
+    const char                   *cert_pem;
+    const char                   *client_cert_pem;
+    const char                   *client_key_pem;
+    bool                         use_global_ca_store;
+    bool                         skip_cert_common_name_check;
     esp_http_client_method_t     method;
     esp_http_client_auth_type_t  auth_type;
     esp_http_client_transport_t  transport_type;
@@ -119,6 +127,13 @@ struct esp_http_client {
     bool                        first_line_prepared;
     int                         header_index;
     bool                        is_async;
+    struct esp_http_client_multi    *multi;         /*!< The driver this async handle was added to */
+    STAILQ_ENTRY(esp_http_client)   multi_next;
+    TickType_t                  async_activity;     /*!< Last time the driver made progress on this handle */
+    bool                        async_handshaking;  /*!< Socket connected, waiting for the TLS handshake */
+#ifdef CONFIG_ESP_HTTP_CLIENT_CONN_POOL
+    http_conn_pool_key_t        pool_key;       /*!< Where the current connection goes to, scheme and host are allocated */
+#endif
 };
 
 typedef struct esp_http_client esp_http_client_t;
@@ -156,6 +171,7 @@ static const char *HTTP_METHOD_MAPPING[] = {
 static esp_err_t esp_http_client_request_send(esp_http_client_handle_t client, int write_len);
 static esp_err_t esp_http_client_connect(esp_http_client_handle_t client);
 static esp_err_t esp_http_client_send_post_data(esp_http_client_handle_t client);
+static esp_err_t esp_http_client_close_or_park(esp_http_client_handle_t client);
 
 static esp_err_t http_dispatch_event(esp_http_client_t *client, esp_http_client_event_id_t event_id, void *data, int len)
 {
@@ -171,6 +187,32 @@ static esp_err_t http_dispatch_event(esp_http_client_t *client, esp_http_client_
     return ESP_OK;
 }
 
+/**
+ * In async mode the transport is polled without waiting, and "would block" is reported with errno EAGAIN.
+ * Reads then return -1 (0 would tell the parser the connection was closed), writes return 0.
+ */
+static int http_transport_read(esp_http_client_t *client, char *buffer, int len)
+{
+    errno = 0;
+    int rlen = esp_transport_read(client->transport, buffer, len, client->is_async ? 0 : client->timeout_ms);
+    if (client->is_async && (rlen == 0 || (rlen < 0 && errno == EAGAIN))) {
+        errno = EAGAIN;
+        return -1;
+    }
+    return rlen;
+}
+
+static int http_transport_write(esp_http_client_t *client, const char *buffer, int len)
+{
+    errno = 0;
+    int wlen = esp_transport_write(client->transport, buffer, len, client->is_async ? 0 : client->timeout_ms);
+    if (client->is_async && (wlen == 0 || (wlen < 0 && errno == EAGAIN))) {
+        errno = EAGAIN;
+        return 0;
+    }
+    return wlen;
+}
+
 static int http_on_message_begin(http_parser *parser)
 {
     esp_http_client_t *client = parser->data;
@@ -353,6 +395,11 @@ static esp_err_t _set_config(esp_http_client_handle_t client, const esp_http_cli
     client->buffer_size_rx = config->buffer_size;
     client->buffer_size_tx = config->buffer_size_tx;
     client->disable_auto_redirect = config->disable_auto_redirect;
+    client->connection_info.cert_pem = config->cert_pem;
+    client->connection_info.client_cert_pem = config->client_cert_pem;
+    client->connection_info.client_key_pem = config->client_key_pem;
+    client->connection_info.use_global_ca_store = config->use_global_ca_store;
+    client->connection_info.skip_cert_common_name_check = config->skip_cert_common_name_check;
 
     if (config->buffer_size == 0) {
         client->buffer_size_rx = DEFAULT_HTTP_BUF_SIZE;
@@ -488,31 +535,11 @@ static esp_err_t esp_http_client_prepare(esp_http_client_handle_t client)
     return ESP_OK;
 }
 
-esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+static esp_err_t _init_transports(esp_http_client_handle_t client)
 {
-
-    esp_http_client_handle_t client;
     esp_transport_handle_t tcp;
     bool _success;
 
-    _success = (
-                   (client                         = calloc(1, sizeof(esp_http_client_t)))           &&
-                   (client->parser                 = calloc(1, sizeof(struct http_parser)))          &&
-                   (client->parser_settings        = calloc(1, sizeof(struct http_parser_settings))) &&
-                   (client->auth_data              = calloc(1, sizeof(esp_http_auth_data_t)))        &&
-                   (client->request                = calloc(1, sizeof(esp_http_data_t)))             &&
-                   (client->request->headers       = http_header_init())                             &&
-                   (client->request->buffer        = calloc(1, sizeof(esp_http_buffer_t)))           &&
-                   (client->response               = calloc(1, sizeof(esp_http_data_t)))             &&
-                   (client->response->headers      = http_header_init())                             &&
-                   (client->response->buffer       = calloc(1, sizeof(esp_http_buffer_t)))
-               );
-
-    if (!_success) {
-        ESP_LOGE(TAG, "Error allocate memory");
-        goto error;
-    }
-
     _success = (
                    (client->transport_list = esp_transport_list_init()) &&
                    (tcp = esp_transport_tcp_init()) &&
@@ -521,7 +548,7 @@ esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *co
                );
     if (!_success) {
         ESP_LOGE(TAG, "Error initialize transport");
-        goto error;
+        return ESP_FAIL;
     }
 #ifdef CONFIG_ESP_HTTP_CLIENT_ENABLE_HTTPS
     esp_transport_handle_t ssl;
@@ -533,32 +560,63 @@ esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *co
 
     if (!_success) {
         ESP_LOGE(TAG, "Error initialize SSL Transport");
-        goto error;
+        return ESP_FAIL;
     }
 
-    if (config->use_global_ca_store == true) {
+    if (client->connection_info.use_global_ca_store == true) {
         esp_transport_ssl_enable_global_ca_store(ssl);
-    } else if (config->cert_pem) {
-        esp_transport_ssl_set_cert_data(ssl, config->cert_pem, strlen(config->cert_pem));
+    } else if (client->connection_info.cert_pem) {
+        esp_transport_ssl_set_cert_data(ssl, client->connection_info.cert_pem, strlen(client->connection_info.cert_pem));
     }
 
-    if (config->client_cert_pem) {
-        esp_transport_ssl_set_client_cert_data(ssl, config->client_cert_pem, strlen(config->client_cert_pem));
+    if (client->connection_info.client_cert_pem) {
+        esp_transport_ssl_set_client_cert_data(ssl, client->connection_info.client_cert_pem, strlen(client->connection_info.client_cert_pem));
     }
 
-    if (config->client_key_pem) {
-        esp_transport_ssl_set_client_key_data(ssl, config->client_key_pem, strlen(config->client_key_pem));
+    if (client->connection_info.client_key_pem) {
+        esp_transport_ssl_set_client_key_data(ssl, client->connection_info.client_key_pem, strlen(client->connection_info.client_key_pem));
     }
 
-    if (config->skip_cert_common_name_check) {
+    if (client->connection_info.skip_cert_common_name_check) {
         esp_transport_ssl_skip_common_name_check(ssl);
     }
 #endif
+    return ESP_OK;
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+
+    esp_http_client_handle_t client;
+    bool _success;
+
+    _success = (
+                   (client                         = calloc(1, sizeof(esp_http_client_t)))           &&
+                   (client->parser                 = calloc(1, sizeof(struct http_parser)))          &&
+                   (client->parser_settings        = calloc(1, sizeof(struct http_parser_settings))) &&
+                   (client->auth_data              = calloc(1, sizeof(esp_http_auth_data_t)))        &&
+                   (client->request                = calloc(1, sizeof(esp_http_data_t)))             &&
+                   (client->request->headers       = http_header_init())                             &&
+                   (client->request->buffer        = calloc(1, sizeof(esp_http_buffer_t)))           &&
+                   (client->response               = calloc(1, sizeof(esp_http_data_t)))             &&
+                   (client->response->headers      = http_header_init())                             &&
+                   (client->response->buffer       = calloc(1, sizeof(esp_http_buffer_t)))
+               );
+
+    if (!_success) {
+        ESP_LOGE(TAG, "Error allocate memory");
+        goto error;
+    }
 
     if (_set_config(client, config) != ESP_OK) {
         ESP_LOGE(TAG, "Error set configurations");
         goto error;
     }
+
+    if (_init_transports(client) != ESP_OK) {
+        goto error;
+    }
+
     _success = (
                    (client->request->buffer->data  = malloc(client->buffer_size_tx))  &&
                    (client->response->buffer->data = malloc(client->buffer_size_rx))
@@ -614,13 +672,137 @@ error:
     return NULL;
 }
 
+#ifdef CONFIG_ESP_HTTP_CLIENT_CONN_POOL
+static void _clear_pool_key(esp_http_client_handle_t client)
+{
+    free((char *)client->pool_key.scheme);
+    free((char *)client->pool_key.host);
+    memset(&client->pool_key, 0, sizeof(http_conn_pool_key_t));
+}
+
+static void _set_pool_key(esp_http_client_handle_t client)
+{
+    _clear_pool_key(client);
+    client->pool_key.scheme = strdup(client->connection_info.scheme);
+    client->pool_key.host = strdup(client->connection_info.host);
+    client->pool_key.port = client->connection_info.port;
+    client->pool_key.cert_pem = client->connection_info.cert_pem;
+    client->pool_key.client_cert_pem = client->connection_info.client_cert_pem;
+    client->pool_key.client_key_pem = client->connection_info.client_key_pem;
+    client->pool_key.use_global_ca_store = client->connection_info.use_global_ca_store;
+    client->pool_key.skip_cert_common_name_check = client->connection_info.skip_cert_common_name_check;
+}
+
+static bool _is_connection_reusable(esp_http_client_handle_t client)
+{
+    if (client->is_async || client->transport == NULL || client->pool_key.host == NULL) {
+        return false;
+    }
+    if (client->state == HTTP_STATE_CONNECTED) {
+        /* Either nothing was sent yet, or the previous response was fully processed by esp_http_client_perform() */
+        return !client->first_line_prepared;
+    }
+    return client->state >= HTTP_STATE_RES_COMPLETE_HEADER
+           && esp_http_client_is_complete_data_received(client)
+           && http_should_keep_alive(client->parser);
+}
+
+/**
+ * Hand the connection over to the pool instead of closing it.
+ * If `keep_transports` is set, the handle gets a new, unconnected transport list to continue with
+ */
+static bool _park_connection(esp_http_client_handle_t client, bool keep_transports)
+{
+    if (!_is_connection_reusable(client)) {
+        return false;
+    }
+    esp_transport_list_handle_t list = client->transport_list;
+    esp_transport_handle_t transport = client->transport;
+    if (keep_transports && _init_transports(client) != ESP_OK) {
+        if (client->transport_list) {
+            esp_transport_list_destroy(client->transport_list);
+        }
+        client->transport_list = list;
+        return false;
+    }
+    /* No HTTP_EVENT_DISCONNECTED, the connection stays open in the pool */
+    client->state = HTTP_STATE_INIT;
+    if (!keep_transports) {
+        client->transport_list = NULL;
+    }
+    client->transport = NULL;
+    if (!http_conn_pool_release(&client->pool_key, list, transport)) {
+        esp_transport_list_destroy(list);
+    }
+    _clear_pool_key(client);
+    return true;
+}
+
+/**
+ * Take over an idle connection of an other handle (or of an earlier request of this one)
+ */
+static bool _adopt_pooled_connection(esp_http_client_handle_t client)
+{
+    esp_transport_list_handle_t list;
+    esp_transport_handle_t transport;
+
+    if (client->is_async) {
+        return false;
+    }
+    _set_pool_key(client);
+    if (!http_conn_pool_acquire(&client->pool_key, &list, &transport)) {
+        return false;
+    }
+    esp_transport_list_destroy(client->transport_list);
+    client->transport_list = list;
+    client->transport = transport;
+    return true;
+}
+#endif
+
+static int _transport_connect(esp_http_client_handle_t client)
+{
+#ifdef CONFIG_ESP_HTTP_CLIENT_TLS_SESSION_RESUMPTION
+    esp_tls_client_session_t *session = NULL;
+    bool is_ssl = esp_http_client_get_transport_type(client) == HTTP_TRANSPORT_OVER_SSL;
+    if (is_ssl) {
+        session = http_conn_pool_take_session(&client->pool_key);
+        esp_transport_ssl_set_client_session(client->transport, session);
+    }
+#endif
+    int ret = esp_transport_connect(client->transport, client->connection_info.host, client->connection_info.port, client->timeout_ms);
+#ifdef CONFIG_ESP_HTTP_CLIENT_TLS_SESSION_RESUMPTION
+    if (is_ssl) {
+        esp_transport_ssl_set_client_session(client->transport, NULL);
+        esp_tls_free_client_session(session);
+        if (ret >= 0) {
+            /* Servers may rotate the tickets, so always keep the latest one */
+            http_conn_pool_store_session(&client->pool_key, esp_transport_ssl_get_client_session(client->transport));
+        }
+    }
+#endif
+    return ret;
+}
+
 esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
 {
     if (client == NULL) {
         return ESP_FAIL;
     }
+    if (client->multi) {
+        esp_http_client_multi_remove(client->multi, client);
+    }
+#ifdef CONFIG_ESP_HTTP_CLIENT_CONN_POOL
+    if (!_park_connection(client, false)) {
+        esp_http_client_close(client);
+    }
+    _clear_pool_key(client);
+#else
     esp_http_client_close(client);
-    esp_transport_list_destroy(client->transport_list);
+#endif
+    if (client->transport_list) {
+        esp_transport_list_destroy(client->transport_list);
+    }
     if (client->request) {
         http_header_destroy(client->request->headers);
         if (client->request->buffer) {
@@ -721,7 +903,7 @@ esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *u
             free(old_host);
             return ESP_ERR_NO_MEM;
         }
-        esp_http_client_close(client);
+        esp_http_client_close_or_park(client);
     }
 
     if (old_host) {
@@ -745,7 +927,7 @@ esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *u
     }
 
     if (old_port != client->connection_info.port) {
-        esp_http_client_close(client);
+        esp_http_client_close_or_park(client);
     }
 
     if (purl.field_data[UF_USERINFO].len) {
@@ -807,7 +989,7 @@ static int esp_http_client_get_data(esp_http_client_handle_t client)
 
     ESP_LOGD(TAG, "data_process=%d, content_length=%d", client->response->data_process, client->response->content_length);
 
-    int rlen = esp_transport_read(client->transport, res_buffer->data, client->buffer_size_rx, client->timeout_ms);
+    int rlen = http_transport_read(client, res_buffer->data, client->buffer_size_rx);
     if (rlen >= 0) {
         http_parser_execute(client->parser, client->parser_settings, res_buffer->data, rlen);
     }
@@ -861,11 +1043,13 @@ int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len)
         if (byte_to_read > client->buffer_size_rx) {
             byte_to_read = client->buffer_size_rx;
         }
-        errno = 0;
-        rlen = esp_transport_read(client->transport, res_buffer->data, byte_to_read, client->timeout_ms);
+        rlen = http_transport_read(client, res_buffer->data, byte_to_read);
         ESP_LOGD(TAG, "need_read=%d, byte_to_read=%d, rlen=%d, ridx=%d", need_read, byte_to_read, rlen, ridx);
 
         if (rlen <= 0) {
+            if (client->is_async && errno == EAGAIN) {
+                return ridx > 0 ? ridx : -ESP_ERR_HTTP_EAGAIN;
+            }
             if (errno != 0) {
                 esp_log_level_t sev = ESP_LOG_WARN;
                 /* On connection close from server, recv should ideally return 0 but we have error conversion
@@ -993,7 +1177,7 @@ int esp_http_client_fetch_headers(esp_http_client_handle_t client)
     client->response->status_code = -1;
 
     while (client->state < HTTP_STATE_RES_COMPLETE_HEADER) {
-        buffer->len = esp_transport_read(client->transport, buffer->data, client->buffer_size_rx, client->timeout_ms);
+        buffer->len = http_transport_read(client, buffer->data, client->buffer_size_rx);
         if (buffer->len <= 0) {
             return ESP_FAIL;
         }
@@ -1034,19 +1218,24 @@ static esp_err_t esp_http_client_connect(esp_http_client_handle_t client)
 #endif
             return ESP_ERR_HTTP_INVALID_TRANSPORT;
         }
+#ifdef CONFIG_ESP_HTTP_CLIENT_CONN_POOL
+        if (_adopt_pooled_connection(client)) {
+            ESP_LOGD(TAG, "Reusing idle connection");
+            client->state = HTTP_STATE_CONNECTED;
+            http_dispatch_event(client, HTTP_EVENT_ON_CONNECTED, NULL, 0);
+            return ESP_OK;
+        }
+#endif
         if (!client->is_async) {
-            if (esp_transport_connect(client->transport, client->connection_info.host, client->connection_info.port, client->timeout_ms) < 0) {
+            if (_transport_connect(client) < 0) {
                 ESP_LOGE(TAG, "Connection failed, sock < 0");
                 return ESP_ERR_HTTP_CONNECT;
             }
         } else {
-            int ret = esp_transport_connect_async(client->transport, client->connection_info.host, client->connection_info.port, client->timeout_ms);
+            /* Only check the progress, the caller waits for the socket (see esp_http_client_multi_perform()) */
+            int ret = esp_transport_connect_async(client->transport, client->connection_info.host, client->connection_info.port, 0);
             if (ret == ASYNC_TRANS_CONNECT_FAIL) {
                 ESP_LOGE(TAG, "Connection failed");
-                if (strcasecmp(client->connection_info.scheme, "http") == 0) {
-                    ESP_LOGE(TAG, "Asynchronous mode doesn't work for HTTP based connection");
-                    return ESP_ERR_INVALID_ARG;
-                }
                 return ESP_ERR_HTTP_CONNECT;
             } else if (ret == ASYNC_TRANS_CONNECTING) {
                 ESP_LOGD(TAG, "Connection not yet established");
@@ -1113,13 +1302,14 @@ static esp_err_t esp_http_client_request_send(esp_http_client_handle_t client, i
     if (client->data_write_left > 0) {
         /* sending leftover data from previous call to esp_http_client_request_send() API */
         int wret = 0;
-        if (((wret = esp_http_client_write(client, client->request->buffer->data + client->data_written_index, client->data_write_left)) < 0)) {
+        if (((wret = http_transport_write(client, client->request->buffer->data + client->data_written_index, client->data_write_left)) < 0)) {
             ESP_LOGE(TAG, "Error write request");
             return ESP_ERR_HTTP_WRITE_DATA;
         }
         client->data_write_left -= wret;
         client->data_written_index += wret;
         if (client->is_async && client->data_write_left > 0) {
+            errno = EAGAIN;
             return ESP_ERR_HTTP_WRITE_DATA;      /* In case of EAGAIN error, we return ESP_ERR_HTTP_WRITE_DATA,
                                                  and the handling of EAGAIN should be done in the higher level APIs. */
         }
@@ -1140,8 +1330,12 @@ static esp_err_t esp_http_client_request_send(esp_http_client_handle_t client, i
         client->data_write_left = wlen;
         client->data_written_index = 0;
         while (client->data_write_left > 0) {
-            int wret = esp_transport_write(client->transport, client->request->buffer->data + client->data_written_index, client->data_write_left, client->timeout_ms);
+            int wret = http_transport_write(client, client->request->buffer->data + client->data_written_index, client->data_write_left);
             if (wret <= 0) {
+                if (client->is_async && errno == EAGAIN) {
+                    /* The rest of this chunk is sent by the next call */
+                    return ESP_ERR_HTTP_WRITE_DATA;
+                }
                 ESP_LOGE(TAG, "Error write request");
                 esp_http_client_close(client);
                 return ESP_ERR_HTTP_WRITE_DATA;
@@ -1179,6 +1373,9 @@ static esp_err_t esp_http_client_send_post_data(esp_http_client_handle_t client)
     if (client->data_write_left <= 0) {
         goto success;
     } else {
+        if (client->is_async) {
+            errno = EAGAIN;
+        }
         return ESP_ERR_HTTP_WRITE_DATA;
     }
 
@@ -1208,7 +1405,7 @@ int esp_http_client_write(esp_http_client_handle_t client, const char *buffer, i
 
     int wlen = 0, widx = 0;
     while (len > 0) {
-        wlen = esp_transport_write(client->transport, buffer + widx, len, client->timeout_ms);
+        wlen = http_transport_write(client, buffer + widx, len);
         /* client->async_block is initialised in case of non-blocking IO, and in this case we return how
            much ever data was written by the esp_transport_write() API. */
         if (client->is_async || wlen <= 0) {
@@ -1230,6 +1427,26 @@ esp_err_t esp_http_client_close(esp_http_client_handle_t client)
     return ESP_OK;
 }
 
+static esp_err_t esp_http_client_close_or_park(esp_http_client_handle_t client)
+{
+#ifdef CONFIG_ESP_HTTP_CLIENT_CONN_POOL
+    if (_park_connection(client, true)) {
+        return ESP_OK;
+    }
+#endif
+    return esp_http_client_close(client);
+}
+
+esp_err_t esp_http_client_pool_flush(void)
+{
+#ifdef CONFIG_ESP_HTTP_CLIENT_CONN_POOL
+    http_conn_pool_flush();
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len)
 {
     esp_err_t err = ESP_OK;
@@ -1357,3 +1574,144 @@ esp_err_t esp_http_client_get_url(esp_http_client_handle_t client, char *url, co
     }
     return ESP_FAIL;
 }
+
+struct esp_http_client_multi {
+    STAILQ_HEAD(esp_http_client_multi_list, esp_http_client) clients;
+};
+
+esp_http_client_multi_handle_t esp_http_client_multi_init(void)
+{
+    esp_http_client_multi_handle_t multi = calloc(1, sizeof(struct esp_http_client_multi));
+    HTTP_MEM_CHECK(TAG, multi, return NULL);
+    STAILQ_INIT(&multi->clients);
+    return multi;
+}
+
+esp_err_t esp_http_client_multi_add(esp_http_client_multi_handle_t multi, esp_http_client_handle_t client)
+{
+    if (multi == NULL || client == NULL || client->multi) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!client->is_async) {
+        ESP_LOGE(TAG, "Only clients created with is_async can be added");
+        return ESP_ERR_INVALID_ARG;
+    }
+    client->multi = multi;
+    client->async_activity = xTaskGetTickCount();
+    client->async_handshaking = false;
+    STAILQ_INSERT_TAIL(&multi->clients, client, multi_next);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_multi_remove(esp_http_client_multi_handle_t multi, esp_http_client_handle_t client)
+{
+    if (multi == NULL || client == NULL || client->multi != multi) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    STAILQ_REMOVE(&multi->clients, client, esp_http_client, multi_next);
+    client->multi = NULL;
+    return ESP_OK;
+}
+
+/* Which way the request is blocked, for the states esp_http_client_perform() returns ESP_ERR_HTTP_EAGAIN from */
+static bool http_async_wants_read(esp_http_client_handle_t client)
+{
+    if (client->state == HTTP_STATE_INIT) {
+        return client->async_handshaking;
+    }
+    return client->state >= HTTP_STATE_REQ_COMPLETE_DATA;
+}
+
+esp_err_t esp_http_client_multi_perform(esp_http_client_multi_handle_t multi, int timeout_ms, int *running)
+{
+    esp_http_client_handle_t client, tmp;
+    struct timeval tv;
+    fd_set rset, wset;
+    int maxfd = -1;
+    bool start_now = false;
+
+    if (multi == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    FD_ZERO(&rset);
+    FD_ZERO(&wset);
+    STAILQ_FOREACH(client, &multi->clients, multi_next) {
+        int fd = esp_transport_get_socket(client->transport);
+        if (fd < 0) {
+            /* Not connecting yet */
+            start_now = true;
+            continue;
+        }
+        FD_SET(fd, http_async_wants_read(client) ? &rset : &wset);
+        if (fd > maxfd) {
+            maxfd = fd;
+        }
+    }
+
+    if (maxfd >= 0 || start_now) {
+        tv.tv_sec = start_now ? 0 : timeout_ms / 1000;
+        tv.tv_usec = start_now ? 0 : (timeout_ms % 1000) * 1000;
+        if (select(maxfd + 1, &rset, &wset, NULL, (timeout_ms < 0 && !start_now) ? NULL : &tv) < 0) {
+            ESP_LOGE(TAG, "select() failed, errno=%d", errno);
+            return ESP_FAIL;
+        }
+    }
+
+    TickType_t now = xTaskGetTickCount();
+    int count = 0;
+    STAILQ_FOREACH_SAFE(client, &multi->clients, multi_next, tmp) {
+        int fd = esp_transport_get_socket(client->transport);
+        bool writable = fd >= 0 && FD_ISSET(fd, &wset);
+        if (fd >= 0 && !writable && !FD_ISSET(fd, &rset)) {
+            if (now - client->async_activity < pdMS_TO_TICKS(client->timeout_ms)) {
+                count++;
+                continue;
+            }
+            ESP_LOGE(TAG, "Request to %s timed out", client->connection_info.host);
+            http_dispatch_event(client, HTTP_EVENT_ERROR, NULL, 0);
+            esp_http_client_close(client);
+            esp_http_client_multi_remove(multi, client);
+            continue;
+        }
+
+        client->async_activity = now;
+        esp_err_t err = esp_http_client_perform(client);
+        if (err == ESP_ERR_HTTP_EAGAIN) {
+            if (client->state == HTTP_STATE_INIT && writable) {
+                /* TCP is up, the TLS handshake waits for the server now */
+                client->async_handshaking = true;
+            } else if (client->state != HTTP_STATE_INIT) {
+                client->async_handshaking = false;
+            }
+            count++;
+            continue;
+        }
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Request to %s failed, err=0x%x", client->connection_info.host, err);
+            http_dispatch_event(client, HTTP_EVENT_ERROR, NULL, 0);
+            esp_http_client_close(client);
+        }
+        /* HTTP_EVENT_ON_FINISH was dispatched on success */
+        esp_http_client_multi_remove(multi, client);
+    }
+
+    if (running) {
+        *running = count;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_multi_cleanup(esp_http_client_multi_handle_t multi)
+{
+    esp_http_client_handle_t client, tmp;
+
+    if (multi == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    STAILQ_FOREACH_SAFE(client, &multi->clients, multi_next, tmp) {
+        client->multi = NULL;
+    }
+    free(multi);
+    return ESP_OK;
+}
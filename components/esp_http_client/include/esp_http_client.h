@@ -27,6 +27,7 @@ extern "C" {
 #define DEFAULT_HTTP_BUF_SIZE    CONFIG_HTTP_BUF_SIZE
 
 typedef struct esp_http_client *esp_http_client_handle_t;
+typedef struct esp_http_client_multi *esp_http_client_multi_handle_t;
 typedef struct esp_http_client_event *esp_http_client_event_handle_t;
 
 /**
@@ -119,7 +120,7 @@ typedef struct {
     int                         buffer_size;              /*!< HTTP receive buffer size */
     int                         buffer_size_tx;           /*!< HTTP transmit buffer size */
     void                        *user_data;               /*!< HTTP user_data context */
-    bool                        is_async;                 /*!< Set asynchronous mode, only supported with HTTPS for now */
+    bool                        is_async;                 /*!< Set asynchronous mode: the I/O functions never wait for the network, see esp_http_client_multi_perform() */
     bool                        use_global_ca_store;      /*!< Use a global ca_store for all the connections in which this bool is set. */
     bool                        skip_cert_common_name_check;    /*!< Skip any validation of server certificate CN field */
 } esp_http_client_config_t;
@@ -399,6 +400,7 @@ bool esp_http_client_is_chunked_response(esp_http_client_handle_t client);
  *
  * @return
  *     - (-1) if any errors
+ *     - (-ESP_ERR_HTTP_EAGAIN) if no data is available yet, only in asynchronous mode
  *     - Length of data was read
  */
 int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len);
@@ -450,6 +452,22 @@ esp_err_t esp_http_client_close(esp_http_client_handle_t client);
  */
 esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client);
 
+/**
+ * @brief      Close all the idle connections kept by the connection pool and drop the saved TLS sessions.
+ *             Call it, for example, before changing the network interface or the global CA store.
+ *
+ * @note       When CONFIG_ESP_HTTP_CLIENT_CONN_POOL is enabled, esp_http_client_cleanup() (and
+ *             esp_http_client_set_url() with a new host) keeps a connection open if the response was
+ *             fully read and the server allows keep-alive. A later handle connecting to the same server
+ *             with the same certificate settings then takes it over instead of connecting again.
+ *             HTTP_EVENT_DISCONNECTED is not dispatched for a connection kept in the pool.
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_NOT_SUPPORTED if the connection pool is disabled in menuconfig
+ */
+esp_err_t esp_http_client_pool_flush(void);
+
 /**
  * @brief      Get transport type
  *
@@ -525,6 +543,74 @@ int esp_http_client_read_response(esp_http_client_handle_t client, char *buffer,
 
 esp_err_t esp_http_client_get_url(esp_http_client_handle_t client, char *url, const int len);
 
+/**
+ * @brief      Create a driver for asynchronous requests.
+ *             A single task can run any number of requests with it, each request needs its own
+ *             esp_http_client_handle_t created with `is_async` set. The response is delivered through
+ *             the events of each handle: HTTP_EVENT_ON_DATA while it arrives, then HTTP_EVENT_ON_FINISH,
+ *             or HTTP_EVENT_ERROR if the request failed or made no progress for `timeout_ms` of the handle.
+ *
+ * @return
+ *     - The driver handle
+ *     - NULL if out of memory
+ */
+esp_http_client_multi_handle_t esp_http_client_multi_init(void);
+
+/**
+ * @brief      Add an asynchronous request to the driver. The request starts with the next
+ *             esp_http_client_multi_perform() and the handle is removed from the driver once it finished.
+ *             Add it again (after setting up the next request) to reuse the connection.
+ *
+ * @param[in]  multi   The driver handle
+ * @param[in]  client  The esp_http_client handle, created with `is_async` set
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG if the handle is not asynchronous or already added to a driver
+ */
+esp_err_t esp_http_client_multi_add(esp_http_client_multi_handle_t multi, esp_http_client_handle_t client);
+
+/**
+ * @brief      Remove a request from the driver before it finished, the connection is left as it is.
+ *             esp_http_client_cleanup() does it implicitly.
+ *
+ * @param[in]  multi   The driver handle
+ * @param[in]  client  The esp_http_client handle
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG if the handle was not added to this driver
+ */
+esp_err_t esp_http_client_multi_remove(esp_http_client_multi_handle_t multi, esp_http_client_handle_t client);
+
+/**
+ * @brief      Wait until any of the requests can make progress, then advance all those which can
+ *             without blocking. Call it in a loop from the driver task.
+ *
+ * @note       Host name resolution is still blocking.
+ *
+ * @param[in]  multi       The driver handle
+ * @param[in]  timeout_ms  Maximum time to wait for the sockets, -1 to wait forever
+ * @param[out] running     Number of requests still in progress (may be NULL)
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ *     - ESP_FAIL if select() failed
+ */
+esp_err_t esp_http_client_multi_perform(esp_http_client_multi_handle_t multi, int timeout_ms, int *running);
+
+/**
+ * @brief      Destroy the driver. The handles which are still added are only detached, not cleaned up.
+ *
+ * @param[in]  multi   The driver handle
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_ERR_INVALID_ARG
+ */
+esp_err_t esp_http_client_multi_cleanup(esp_http_client_multi_handle_t multi);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,289 @@
+// Copyright 2015-2018 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/lock.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "http_conn_pool.h"
+
+#ifdef CONFIG_ESP_HTTP_CLIENT_CONN_POOL
+
+static const char *TAG = "HTTP_CONN_POOL";
+
+#define POOL_SIZE           CONFIG_ESP_HTTP_CLIENT_CONN_POOL_SIZE
+#define POOL_IDLE_TICKS     pdMS_TO_TICKS(CONFIG_ESP_HTTP_CLIENT_CONN_POOL_IDLE_TIMEOUT * 1000)
+
+typedef struct {
+    http_conn_pool_key_t        key;        /*!< Private copy, scheme and host are allocated */
+    esp_transport_list_handle_t list;       /*!< NULL if the slot is free */
+    esp_transport_handle_t      transport;
+    TickType_t                  idle_since;
+} http_conn_entry_t;
+
+static http_conn_entry_t s_conn[POOL_SIZE];
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+typedef struct {
+    http_conn_pool_key_t        key;
+    esp_tls_client_session_t    *session;   /*!< NULL if the slot is free */
+    TickType_t                  last_used;
+} http_session_entry_t;
+
+static http_session_entry_t s_session[POOL_SIZE];
+#endif
+
+/* Connections are closed only after this lock is released, closing
+ * a TLS connection sends close_notify and may block */
+static _lock_t s_pool_lock;
+
+static bool key_match(const http_conn_pool_key_t *a, const http_conn_pool_key_t *b)
+{
+    return a->port == b->port
+           && a->cert_pem == b->cert_pem
+           && a->client_cert_pem == b->client_cert_pem
+           && a->client_key_pem == b->client_key_pem
+           && a->use_global_ca_store == b->use_global_ca_store
+           && a->skip_cert_common_name_check == b->skip_cert_common_name_check
+           && strcasecmp(a->scheme, b->scheme) == 0
+           && strcasecmp(a->host, b->host) == 0;
+}
+
+static bool key_copy(http_conn_pool_key_t *dst, const http_conn_pool_key_t *src)
+{
+    *dst = *src;
+    dst->scheme = strdup(src->scheme);
+    dst->host = strdup(src->host);
+    if (dst->scheme == NULL || dst->host == NULL) {
+        free((char *)dst->scheme);
+        free((char *)dst->host);
+        memset(dst, 0, sizeof(http_conn_pool_key_t));
+        return false;
+    }
+    return true;
+}
+
+static void key_free(http_conn_pool_key_t *key)
+{
+    free((char *)key->scheme);
+    free((char *)key->host);
+    memset(key, 0, sizeof(http_conn_pool_key_t));
+}
+
+/* Must be called with s_pool_lock held. The lists of the evicted entries are
+ * moved to `victims` so that the caller can destroy them after unlocking */
+static int evict_expired(TickType_t now, esp_transport_list_handle_t *victims)
+{
+    int n = 0;
+    for (int i = 0; i < POOL_SIZE; i++) {
+        if (s_conn[i].list && (now - s_conn[i].idle_since) >= POOL_IDLE_TICKS) {
+            ESP_LOGD(TAG, "Evict idle connection to %s:%d", s_conn[i].key.host, s_conn[i].key.port);
+            victims[n++] = s_conn[i].list;
+            s_conn[i].list = NULL;
+            key_free(&s_conn[i].key);
+        }
+    }
+    return n;
+}
+
+static void destroy_victims(esp_transport_list_handle_t *victims, int n)
+{
+    for (int i = 0; i < n; i++) {
+        esp_transport_list_destroy(victims[i]);
+    }
+}
+
+bool http_conn_pool_acquire(const http_conn_pool_key_t *key, esp_transport_list_handle_t *list, esp_transport_handle_t *transport)
+{
+    esp_transport_list_handle_t victims[POOL_SIZE];
+    int n_victims;
+    int found;
+
+    if (key->scheme == NULL || key->host == NULL) {
+        return false;
+    }
+
+    do {
+        found = -1;
+        _lock_acquire(&s_pool_lock);
+        n_victims = evict_expired(xTaskGetTickCount(), victims);
+        for (int i = 0; i < POOL_SIZE; i++) {
+            if (s_conn[i].list == NULL || !key_match(&s_conn[i].key, key)) {
+                continue;
+            }
+            /* Prefer the most recently parked one, it is the least likely to be closed by the server */
+            if (found < 0 || (int)(s_conn[i].idle_since - s_conn[found].idle_since) > 0) {
+                found = i;
+            }
+        }
+        if (found >= 0) {
+            *list = s_conn[found].list;
+            *transport = s_conn[found].transport;
+            s_conn[found].list = NULL;
+            key_free(&s_conn[found].key);
+        }
+        _lock_release(&s_pool_lock);
+        destroy_victims(victims, n_victims);
+
+        if (found < 0) {
+            return false;
+        }
+        /* Nothing is expected on an idle connection: if it is readable,
+         * the server has closed it (or sent garbage), so it can't be reused */
+        if (esp_transport_poll_read(*transport, 0) == 0) {
+            ESP_LOGD(TAG, "Reuse connection to %s:%d", key->host, key->port);
+            return true;
+        }
+        ESP_LOGD(TAG, "Drop stale connection to %s:%d", key->host, key->port);
+        esp_transport_list_destroy(*list);
+        *list = NULL;
+        *transport = NULL;
+    } while (1);
+}
+
+bool http_conn_pool_release(const http_conn_pool_key_t *key, esp_transport_list_handle_t list, esp_transport_handle_t transport)
+{
+    esp_transport_list_handle_t victims[POOL_SIZE + 1];
+    int n_victims;
+    int slot = -1;
+    http_conn_pool_key_t copy;
+
+    if (key->scheme == NULL || key->host == NULL || !key_copy(&copy, key)) {
+        return false;
+    }
+
+    TickType_t now = xTaskGetTickCount();
+    _lock_acquire(&s_pool_lock);
+    n_victims = evict_expired(now, victims);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        if (s_conn[i].list == NULL) {
+            slot = i;
+            break;
+        }
+        if (slot < 0 || (int)(s_conn[i].idle_since - s_conn[slot].idle_since) < 0) {
+            slot = i;
+        }
+    }
+    if (s_conn[slot].list) {
+        ESP_LOGD(TAG, "Pool full, evict connection to %s:%d", s_conn[slot].key.host, s_conn[slot].key.port);
+        victims[n_victims++] = s_conn[slot].list;
+        key_free(&s_conn[slot].key);
+    }
+    s_conn[slot].key = copy;
+    s_conn[slot].list = list;
+    s_conn[slot].transport = transport;
+    s_conn[slot].idle_since = now;
+    _lock_release(&s_pool_lock);
+    destroy_victims(victims, n_victims);
+    ESP_LOGD(TAG, "Park connection to %s:%d", key->host, key->port);
+    return true;
+}
+
+void http_conn_pool_flush(void)
+{
+    esp_transport_list_handle_t victims[POOL_SIZE];
+    int n_victims = 0;
+
+    _lock_acquire(&s_pool_lock);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        if (s_conn[i].list) {
+            victims[n_victims++] = s_conn[i].list;
+            s_conn[i].list = NULL;
+            key_free(&s_conn[i].key);
+        }
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        if (s_session[i].session) {
+            esp_tls_free_client_session(s_session[i].session);
+            s_session[i].session = NULL;
+            key_free(&s_session[i].key);
+        }
+#endif
+    }
+    _lock_release(&s_pool_lock);
+    destroy_victims(victims, n_victims);
+}
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+esp_tls_client_session_t *http_conn_pool_take_session(const http_conn_pool_key_t *key)
+{
+    esp_tls_client_session_t *session = NULL;
+
+    if (key->scheme == NULL || key->host == NULL) {
+        return NULL;
+    }
+    _lock_acquire(&s_pool_lock);
+    for (int i = 0; i < POOL_SIZE; i++) {
+        if (s_session[i].session && key_match(&s_session[i].key, key)) {
+            session = s_session[i].session;
+            s_session[i].session = NULL;
+            key_free(&s_session[i].key);
+            break;
+        }
+    }
+    _lock_release(&s_pool_lock);
+    return session;
+}
+
+void http_conn_pool_store_session(const http_conn_pool_key_t *key, esp_tls_client_session_t *session)
+{
+    esp_tls_client_session_t *old = NULL;
+    http_conn_pool_key_t copy;
+    int slot = -1;
+
+    if (session == NULL) {
+        return;
+    }
+    if (key->scheme == NULL || key->host == NULL || !key_copy(&copy, key)) {
+        esp_tls_free_client_session(session);
+        return;
+    }
+
+    _lock_acquire(&s_pool_lock);
+    /* Replace the session of the same server, else use a free slot, else the least recently used one */
+    for (int i = 0; i < POOL_SIZE; i++) {
+        if (s_session[i].session && key_match(&s_session[i].key, key)) {
+            slot = i;
+            break;
+        }
+    }
+    for (int i = 0; slot < 0 && i < POOL_SIZE; i++) {
+        if (s_session[i].session == NULL) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        slot = 0;
+        for (int i = 1; i < POOL_SIZE; i++) {
+            if ((int)(s_session[i].last_used - s_session[slot].last_used) < 0) {
+                slot = i;
+            }
+        }
+    }
+    if (s_session[slot].session) {
+        old = s_session[slot].session;
+        key_free(&s_session[slot].key);
+    }
+    s_session[slot].key = copy;
+    s_session[slot].session = session;
+    s_session[slot].last_used = xTaskGetTickCount();
+    _lock_release(&s_pool_lock);
+    esp_tls_free_client_session(old);
+}
+#endif /* CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
+
+#endif /* CONFIG_ESP_HTTP_CLIENT_CONN_POOL */
@@ -0,0 +1,106 @@
+// Copyright 2015-2018 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef _HTTP_CONN_POOL_H_
+#define _HTTP_CONN_POOL_H_
+
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_transport.h"
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+#include "esp_tls.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Identifies the connections which may be shared between client handles.
+ * Two handles can share a connection only if they talk to the same server
+ * and would have verified it in the same way, so the certificate pointers
+ * are part of the key (they are compared by address, not content).
+ */
+typedef struct {
+    const char  *scheme;
+    const char  *host;
+    int         port;
+    const char  *cert_pem;
+    const char  *client_cert_pem;
+    const char  *client_key_pem;
+    bool        use_global_ca_store;
+    bool        skip_cert_common_name_check;
+} http_conn_pool_key_t;
+
+/**
+ * @brief      Take an idle connection matching the key out of the pool.
+ *             Connections that expired, or that the server has closed in
+ *             the meantime, are dropped on the way.
+ *
+ * @param[in]  key        The connection key
+ * @param[out] list       The transport list owning the connection
+ * @param[out] transport  The connected transport within the list
+ *
+ * @return
+ *     - true   A connected transport was handed over to the caller
+ *     - false  Nothing reusable in the pool
+ */
+bool http_conn_pool_acquire(const http_conn_pool_key_t *key, esp_transport_list_handle_t *list, esp_transport_handle_t *transport);
+
+/**
+ * @brief      Park a connected transport in the pool. If the pool is full
+ *             the least recently used connection is closed to make room.
+ *
+ * @param[in]  key        The connection key
+ * @param[in]  list       The transport list owning the connection
+ * @param[in]  transport  The connected transport within the list
+ *
+ * @return
+ *     - true   The pool took the ownership of the list
+ *     - false  The caller still owns the list
+ */
+bool http_conn_pool_release(const http_conn_pool_key_t *key, esp_transport_list_handle_t list, esp_transport_handle_t transport);
+
+/**
+ * @brief      Close every idle connection and drop the saved TLS sessions
+ */
+void http_conn_pool_flush(void);
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+/**
+ * @brief      Take the TLS session saved for the key, the caller owns it afterwards
+ *
+ * @param[in]  key   The connection key
+ *
+ * @return     The session, NULL if there is none
+ */
+esp_tls_client_session_t *http_conn_pool_take_session(const http_conn_pool_key_t *key);
+
+/**
+ * @brief      Save the TLS session for the key, replacing the previous one.
+ *             The pool takes the ownership of the session.
+ *
+ * @param[in]  key      The connection key
+ * @param[in]  session  The session
+ */
+void http_conn_pool_store_session(const http_conn_pool_key_t *key, esp_tls_client_session_t *session);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -137,3 +137,23 @@ TEST_CASE("Username and password will not reset if new absolute URL doesnot spec
     TEST_ASSERT_NOT_NULL(value);
     esp_http_client_cleanup(client);
 }
+
+/**
+ * Test case to test that a handle which never connected leaves nothing behind in the
+ * connection pool, and that the pool can be flushed at any time.
+ */
+TEST_CASE("Cleanup of an unconnected client keeps the connection pool empty", "[ESP HTTP CLIENT]")
+{
+    esp_http_client_config_t config = {
+        .url = "http://httpbin.org/get",
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    TEST_ASSERT_NOT_NULL(client);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_set_url(client, "http://example.com:8080/"));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_cleanup(client));
+#ifdef CONFIG_ESP_HTTP_CLIENT_CONN_POOL
+    TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_pool_flush());
+#else
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, esp_http_client_pool_flush());
+#endif
+}
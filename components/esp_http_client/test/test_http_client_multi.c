@@ -0,0 +1,244 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <lwip/sockets.h>
+#include <esp_http_client.h>
+
+#include "unity.h"
+#include "test_utils.h"
+
+#define TEST_PORT       8072
+#define TEST_CLIENTS    3
+
+/* Stands in for the HTTP server: accepts `clients` connections and reads
+ * their requests before answering any, so the requests only complete if
+ * they were all in flight at the same time. The answers go out in reverse
+ * order. If `respond` is false the connections are held open, unanswered */
+typedef struct {
+    int listen_fd;
+    int clients;
+    bool respond;
+    SemaphoreHandle_t release;
+    SemaphoreHandle_t done;
+} test_server_t;
+
+static bool read_request(int fd)
+{
+    char buf[256];
+    int len = 0, ret;
+
+    do {
+        ret = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (ret <= 0) {
+            return false;
+        }
+        len += ret;
+        buf[len] = 0;
+    } while (strstr(buf, "\r\n\r\n") == NULL && len < sizeof(buf) - 1);
+    return true;
+}
+
+static void test_server_task(void *arg)
+{
+    test_server_t *srv = (test_server_t *)arg;
+    int fds[TEST_CLIENTS];
+    int n;
+
+    for (n = 0; n < srv->clients; n++) {
+        fds[n] = accept(srv->listen_fd, NULL, NULL);
+        if (fds[n] < 0 || !read_request(fds[n])) {
+            break;
+        }
+    }
+    if (!srv->respond) {
+        xSemaphoreTake(srv->release, portMAX_DELAY);
+    }
+    while (n-- > 0) {
+        static const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 6\r\n"
+                                       "Connection: close\r\n\r\nclient";
+        if (srv->respond) {
+            send(fds[n], response, sizeof(response) - 1, 0);
+        }
+        close(fds[n]);
+    }
+    xSemaphoreGive(srv->done);
+    vTaskDelete(NULL);
+}
+
+static void test_server_start(test_server_t *srv, int clients, bool respond)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+
+    test_case_uses_tcpip();
+
+    srv->clients = clients;
+    srv->respond = respond;
+    srv->done = xSemaphoreCreateBinary();
+    srv->release = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(srv->done);
+    TEST_ASSERT_NOT_NULL(srv->release);
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT(srv->listen_fd >= 0);
+    TEST_ASSERT_EQUAL(0, bind(srv->listen_fd, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, listen(srv->listen_fd, TEST_CLIENTS));
+    xTaskCreate(test_server_task, "http_server", 3072, srv, 5, NULL);
+}
+
+static void test_server_stop(test_server_t *srv)
+{
+    xSemaphoreGive(srv->release);
+    TEST_ASSERT(xSemaphoreTake(srv->done, 1000 / portTICK_PERIOD_MS) == pdTRUE);
+    close(srv->listen_fd);
+    vSemaphoreDelete(srv->release);
+    vSemaphoreDelete(srv->done);
+}
+
+typedef struct {
+    int finished;
+    int errors;
+    int body_len;
+    char body[16];
+} test_result_t;
+
+static esp_err_t test_event_handler(esp_http_client_event_t *evt)
+{
+    test_result_t *result = (test_result_t *)evt->user_data;
+
+    switch (evt->event_id) {
+    case HTTP_EVENT_ON_DATA:
+        if (result->body_len + evt->data_len < sizeof(result->body)) {
+            memcpy(result->body + result->body_len, evt->data, evt->data_len);
+            result->body_len += evt->data_len;
+        }
+        break;
+    case HTTP_EVENT_ON_FINISH:
+        result->finished++;
+        break;
+    case HTTP_EVENT_ERROR:
+        result->errors++;
+        break;
+    default:
+        break;
+    }
+    return ESP_OK;
+}
+
+static esp_http_client_handle_t test_client_init(test_result_t *result, int port, int timeout_ms)
+{
+    char url[48];
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/", port);
+    esp_http_client_config_t config = {
+        .url = url,
+        .is_async = true,
+        .timeout_ms = timeout_ms,
+        .event_handler = test_event_handler,
+        .user_data = result,
+    };
+    memset(result, 0, sizeof(test_result_t));
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    TEST_ASSERT_NOT_NULL(client);
+    return client;
+}
+
+/* Returns the number of esp_http_client_multi_perform() calls it took */
+static int test_multi_run(esp_http_client_multi_handle_t multi, int max_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    int running, calls = 0;
+
+    do {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_multi_perform(multi, 50, &running));
+        calls++;
+        TEST_ASSERT(xTaskGetTickCount() - start < pdMS_TO_TICKS(max_ms));
+    } while (running);
+    return calls;
+}
+
+TEST_CASE("esp_http_client multi driver runs concurrent requests", "[ESP HTTP CLIENT]")
+{
+    test_server_t srv;
+    test_result_t results[TEST_CLIENTS];
+    esp_http_client_handle_t clients[TEST_CLIENTS];
+    esp_http_client_multi_handle_t multi = esp_http_client_multi_init();
+    TEST_ASSERT_NOT_NULL(multi);
+
+    test_server_start(&srv, TEST_CLIENTS, true);
+
+    for (int i = 0; i < TEST_CLIENTS; i++) {
+        clients[i] = test_client_init(&results[i], TEST_PORT, 5000);
+        TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_multi_add(multi, clients[i]));
+    }
+    /* Only once */
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_http_client_multi_add(multi, clients[0]));
+
+    int calls = test_multi_run(multi, 5000);
+    printf("%d requests done in %d calls\n", TEST_CLIENTS, calls);
+
+    /* The server answers the last accepted connection first, so every request
+     * was in progress at the same time */
+    for (int i = 0; i < TEST_CLIENTS; i++) {
+        TEST_ASSERT_EQUAL(1, results[i].finished);
+        TEST_ASSERT_EQUAL(0, results[i].errors);
+        TEST_ASSERT_EQUAL(6, results[i].body_len);
+        TEST_ASSERT_EQUAL_MEMORY("client", results[i].body, 6);
+        TEST_ASSERT_EQUAL(200, esp_http_client_get_status_code(clients[i]));
+        /* Finished requests are removed from the driver */
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_http_client_multi_remove(multi, clients[i]));
+        TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_cleanup(clients[i]));
+    }
+
+    test_server_stop(&srv);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_multi_cleanup(multi));
+}
+
+TEST_CASE("esp_http_client multi driver reports refused and timed out requests", "[ESP HTTP CLIENT]")
+{
+    test_server_t srv;
+    test_result_t refused, timed_out;
+    esp_http_client_multi_handle_t multi = esp_http_client_multi_init();
+    TEST_ASSERT_NOT_NULL(multi);
+
+    /* The server takes the request and never answers */
+    test_server_start(&srv, 1, false);
+
+    esp_http_client_handle_t refused_client = test_client_init(&refused, TEST_PORT + 1, 5000);
+    esp_http_client_handle_t timed_out_client = test_client_init(&timed_out, TEST_PORT, 300);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_multi_add(multi, refused_client));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_multi_add(multi, timed_out_client));
+
+    TickType_t start = xTaskGetTickCount();
+    test_multi_run(multi, 2000);
+    TickType_t elapsed = xTaskGetTickCount() - start;
+
+    TEST_ASSERT_EQUAL(1, refused.errors);
+    TEST_ASSERT_EQUAL(0, refused.finished);
+    TEST_ASSERT_EQUAL(1, timed_out.errors);
+    TEST_ASSERT_EQUAL(0, timed_out.finished);
+    TEST_ASSERT(elapsed >= pdMS_TO_TICKS(300));
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_cleanup(refused_client));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_cleanup(timed_out_client));
+    test_server_stop(&srv);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_http_client_multi_cleanup(multi));
+}
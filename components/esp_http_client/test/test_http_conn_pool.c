@@ -0,0 +1,190 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_transport.h"
+#include "http_conn_pool.h"
+
+#include "unity.h"
+
+#ifdef CONFIG_ESP_HTTP_CLIENT_CONN_POOL
+
+#define POOL_SIZE   CONFIG_ESP_HTTP_CLIENT_CONN_POOL_SIZE
+
+/* State of a fake connection, the transports don't touch the network */
+typedef struct {
+    bool readable;      /*!< Set when the server "closed" the idle connection */
+    bool destroyed;
+} test_conn_t;
+
+static int test_poll_read(esp_transport_handle_t t, int timeout_ms)
+{
+    test_conn_t *conn = esp_transport_get_context_data(t);
+    return conn->readable ? 1 : 0;
+}
+
+static int test_destroy(esp_transport_handle_t t)
+{
+    test_conn_t *conn = esp_transport_get_context_data(t);
+    conn->destroyed = true;
+    return 0;
+}
+
+static esp_transport_list_handle_t test_conn_create(test_conn_t *conn, esp_transport_handle_t *transport)
+{
+    esp_transport_list_handle_t list = esp_transport_list_init();
+    TEST_ASSERT_NOT_NULL(list);
+    esp_transport_handle_t t = esp_transport_init();
+    TEST_ASSERT_NOT_NULL(t);
+    esp_transport_set_func(t, NULL, NULL, NULL, NULL, test_poll_read, NULL, test_destroy);
+    esp_transport_set_context_data(t, conn);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_transport_list_add(list, t, "http"));
+    conn->readable = false;
+    conn->destroyed = false;
+    *transport = t;
+    return list;
+}
+
+static http_conn_pool_key_t test_key(const char *scheme, const char *host, int port)
+{
+    http_conn_pool_key_t key = {
+        .scheme = scheme,
+        .host = host,
+        .port = port,
+    };
+    return key;
+}
+
+TEST_CASE("Connection pool reuses a parked connection for the same server only", "[ESP HTTP CLIENT]")
+{
+    test_conn_t conn;
+    esp_transport_handle_t transport, t;
+    esp_transport_list_handle_t list, l;
+    http_conn_pool_key_t key = test_key("http", "example.com", 80);
+    http_conn_pool_key_t other_host = test_key("http", "example.org", 80);
+    http_conn_pool_key_t other_port = test_key("http", "example.com", 8080);
+    http_conn_pool_key_t other_scheme = test_key("https", "example.com", 80);
+    http_conn_pool_key_t same_host = test_key("HTTP", "Example.COM", 80);
+
+    http_conn_pool_flush();
+    list = test_conn_create(&conn, &transport);
+    TEST_ASSERT_TRUE(http_conn_pool_release(&key, list, transport));
+
+    TEST_ASSERT_FALSE(http_conn_pool_acquire(&other_host, &l, &t));
+    TEST_ASSERT_FALSE(http_conn_pool_acquire(&other_port, &l, &t));
+    TEST_ASSERT_FALSE(http_conn_pool_acquire(&other_scheme, &l, &t));
+    TEST_ASSERT_FALSE(conn.destroyed);
+
+    /* Scheme and host names are case insensitive */
+    TEST_ASSERT_TRUE(http_conn_pool_acquire(&same_host, &l, &t));
+    TEST_ASSERT_EQUAL_PTR(list, l);
+    TEST_ASSERT_EQUAL_PTR(transport, t);
+    TEST_ASSERT_FALSE(conn.destroyed);
+
+    /* The connection is handed over once */
+    TEST_ASSERT_FALSE(http_conn_pool_acquire(&key, &l, &t));
+
+    /* A connection closed by the server is dropped instead of being reused */
+    TEST_ASSERT_TRUE(http_conn_pool_release(&key, list, transport));
+    conn.readable = true;
+    TEST_ASSERT_FALSE(http_conn_pool_acquire(&key, &l, &t));
+    TEST_ASSERT_TRUE(conn.destroyed);
+}
+
+TEST_CASE("Connection pool evicts the least recently used connection when full", "[ESP HTTP CLIENT]")
+{
+    static const char *hosts[] = { "host0", "host1", "host2", "host3", "host4", "host5", "host6", "host7", "host8" };
+    test_conn_t conn[POOL_SIZE + 1];
+    esp_transport_handle_t transport, t;
+    esp_transport_list_handle_t list, l;
+
+    http_conn_pool_flush();
+    for (int i = 0; i <= POOL_SIZE; i++) {
+        http_conn_pool_key_t key = test_key("http", hosts[i], 80);
+        list = test_conn_create(&conn[i], &transport);
+        TEST_ASSERT_TRUE(http_conn_pool_release(&key, list, transport));
+        vTaskDelay(1);
+    }
+
+    /* The first one made room for the last one */
+    TEST_ASSERT_TRUE(conn[0].destroyed);
+    http_conn_pool_key_t key = test_key("http", hosts[0], 80);
+    TEST_ASSERT_FALSE(http_conn_pool_acquire(&key, &l, &t));
+
+    for (int i = 1; i <= POOL_SIZE; i++) {
+        key = test_key("http", hosts[i], 80);
+        TEST_ASSERT_FALSE(conn[i].destroyed);
+        TEST_ASSERT_TRUE(http_conn_pool_acquire(&key, &l, &t));
+        esp_transport_list_destroy(l);
+        TEST_ASSERT_TRUE(conn[i].destroyed);
+    }
+}
+
+TEST_CASE("Connection pool closes the connections idle for too long", "[ESP HTTP CLIENT]")
+{
+    test_conn_t conn;
+    esp_transport_handle_t transport, t;
+    esp_transport_list_handle_t list, l;
+    http_conn_pool_key_t key = test_key("http", "example.com", 80);
+
+    http_conn_pool_flush();
+    list = test_conn_create(&conn, &transport);
+    TEST_ASSERT_TRUE(http_conn_pool_release(&key, list, transport));
+
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_ESP_HTTP_CLIENT_CONN_POOL_IDLE_TIMEOUT * 1000 + 100));
+    TEST_ASSERT_FALSE(conn.destroyed);
+    TEST_ASSERT_FALSE(http_conn_pool_acquire(&key, &l, &t));
+    TEST_ASSERT_TRUE(conn.destroyed);
+
+    /* Flushing closes the connections at once */
+    list = test_conn_create(&conn, &transport);
+    TEST_ASSERT_TRUE(http_conn_pool_release(&key, list, transport));
+    http_conn_pool_flush();
+    TEST_ASSERT_TRUE(conn.destroyed);
+    TEST_ASSERT_FALSE(http_conn_pool_acquire(&key, &l, &t));
+}
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+TEST_CASE("Connection pool keeps the latest TLS session of each server", "[ESP HTTP CLIENT]")
+{
+    http_conn_pool_key_t key = test_key("https", "example.com", 443);
+    http_conn_pool_key_t other_host = test_key("https", "example.org", 443);
+    esp_tls_client_session_t *first = calloc(1, sizeof(esp_tls_client_session_t));
+    esp_tls_client_session_t *latest = calloc(1, sizeof(esp_tls_client_session_t));
+    esp_tls_client_session_t *session;
+
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(latest);
+    http_conn_pool_flush();
+
+    /* The session of a server replaces the previous one, the pool frees it */
+    http_conn_pool_store_session(&key, first);
+    http_conn_pool_store_session(&key, latest);
+
+    TEST_ASSERT_NULL(http_conn_pool_take_session(&other_host));
+    session = http_conn_pool_take_session(&key);
+    TEST_ASSERT_EQUAL_PTR(latest, session);
+    TEST_ASSERT_NULL(http_conn_pool_take_session(&key));
+
+    /* Flushing drops the sessions */
+    http_conn_pool_store_session(&key, session);
+    http_conn_pool_flush();
+    TEST_ASSERT_NULL(http_conn_pool_take_session(&key));
+}
+#endif
+
+#endif /* CONFIG_ESP_HTTP_CLIENT_CONN_POOL */
@@ -343,6 +343,21 @@ typedef struct httpd_uri {
      * Pointer to user context data which will be available to handler
      */
     void *user_ctx;
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    /**
+     * Flag for indicating a WebSocket endpoint.
+     * If this flag is true, then method must be HTTP_GET. Otherwise the handshake will not be handled.
+     */
+    bool is_websocket;
+
+    /**
+     * Flag indicating that control frames (PING, PONG, CLOSE) are also passed to the handler.
+     * If this flag is false, PING frames are answered with PONG, PONG frames are discarded
+     * and CLOSE frames are answered and the session closed, all without invoking the handler.
+     */
+    bool handle_ws_control_frames;
+#endif
 } httpd_uri_t;
 
 /**
@@ -1181,6 +1196,154 @@ esp_err_t httpd_queue_work(httpd_handle_t handle, httpd_work_fn_t work, void *ar
  * @}
  */
 
+/* ************** Group: WebSocket ************** */
+/** @name WebSocket
+ * Functions and structs for WebSocket server
+ * @{
+ */
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+
+/* Target descriptor of httpd_ws_queue_frame() for broadcasting to all WebSocket clients */
+#define HTTPD_WS_ALL_CLIENTS    (-1)
+
+/**
+ * @brief Enum for WebSocket packet types (Opcode in the header)
+ * @note Please refer to RFC6455 Section 5.4 for more details
+ */
+typedef enum {
+    HTTPD_WS_TYPE_CONTINUE   = 0x0,
+    HTTPD_WS_TYPE_TEXT       = 0x1,
+    HTTPD_WS_TYPE_BINARY     = 0x2,
+    HTTPD_WS_TYPE_CLOSE      = 0x8,
+    HTTPD_WS_TYPE_PING       = 0x9,
+    HTTPD_WS_TYPE_PONG       = 0xA
+} httpd_ws_type_t;
+
+/**
+ * @brief Enum for client info description
+ */
+typedef enum {
+    HTTPD_WS_CLIENT_INVALID   = 0x0,
+    HTTPD_WS_CLIENT_HTTP      = 0x1,
+    HTTPD_WS_CLIENT_WEBSOCKET = 0x2,
+} httpd_ws_client_info_t;
+
+/**
+ * @brief WebSocket frame format
+ */
+typedef struct httpd_ws_frame {
+    bool final;                 /*!< Final frame:
+                                     For received frames this field indicates whether the `FIN` flag was set.
+                                     For frames to be transmitted, this field is only used if the `fragmented`
+                                     option is set as well. If `fragmented` is false, the `FIN` flag is set
+                                     by default, marking the ws_frame as a complete/unfragmented message
+                                     (esp_http_server doesn't automatically fragment messages) */
+    bool fragmented;            /*!< Indication that the frame allocated for transmission is a message fragment,
+                                     so the `FIN` flag is set manually according to the `final` option.
+                                     This flag is never set for received messages */
+    httpd_ws_type_t type;       /*!< WebSocket frame type */
+    uint8_t *payload;           /*!< Pre-allocated data buffer */
+    size_t len;                 /*!< Length of the WebSocket data */
+} httpd_ws_frame_t;
+
+/**
+ * @brief Receive and parse a WebSocket frame
+ *
+ * The frame header has already been parsed by the server when the handler is
+ * invoked, so calling this with max_len = 0 only fills in the type, the final
+ * flag and the full payload length of the frame. Calling it with a buffer
+ * then receives and unmasks up to max_len bytes of the payload, so that large
+ * frames can be consumed in several calls. Unread payload is discarded once
+ * the handler returns.
+ *
+ * @note    Calling httpd_ws_recv_frame() for a WebSocket frame is only valid
+ *          inside the handler of a URI registered with is_websocket set.
+ *
+ * @param[in]   req         Current request
+ * @param[out]  pkt         WebSocket frame. The payload buffer is provided by the caller and on
+ *                          return `len` holds the number of payload bytes copied into it
+ * @param[in]   max_len     Maximum length for receive, or 0 to only fetch the frame information
+ * @return
+ *  - ESP_OK                    : On successful
+ *  - ESP_FAIL                  : Socket errors occurs
+ *  - ESP_ERR_INVALID_STATE     : Handshake was not done beforehand
+ *  - ESP_ERR_INVALID_ARG       : Argument is invalid (null or non-WebSocket)
+ */
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *pkt, size_t max_len);
+
+/**
+ * @brief Construct and send a WebSocket frame
+ *
+ * @param[in]   req     Current request
+ * @param[in]   pkt     WebSocket frame
+ * @return
+ *  - ESP_OK                    : On successful
+ *  - ESP_FAIL                  : When socket errors occurs
+ *  - ESP_ERR_INVALID_STATE     : Handshake was not done beforehand
+ *  - ESP_ERR_INVALID_ARG       : Argument is invalid (null or non-WebSocket)
+ */
+esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *pkt);
+
+/**
+ * @brief Low level send of a WebSocket frame out of the scope of current request
+ * using internally configured httpd send function
+ *
+ * This API must be called from the context of the server task, i.e. from a
+ * URI handler or from a function queued with httpd_queue_work(). Other tasks
+ * should use httpd_ws_queue_frame() instead.
+ *
+ * @param[in] hd      Server instance data
+ * @param[in] fd      Socket descriptor for sending data
+ * @param[in] frame   WebSocket frame
+ * @return
+ *  - ESP_OK                    : On successful
+ *  - ESP_FAIL                  : When socket errors occurs
+ *  - ESP_ERR_INVALID_STATE     : Handshake was not done beforehand
+ *  - ESP_ERR_INVALID_ARG       : Argument is invalid (null or non-WebSocket)
+ */
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame);
+
+/**
+ * @brief Queue a WebSocket frame for transmission from any task
+ *
+ * The frame header is built and the payload copied into a single buffer
+ * right away, so the caller's frame may be reused as soon as this returns.
+ * The buffer is then sent from the server task through httpd_queue_work().
+ * When broadcasting, the same buffer is written to every WebSocket session,
+ * so the per-client cost is a single send.
+ *
+ * Clients whose send fails are closed.
+ *
+ * @param[in] handle  Server instance data
+ * @param[in] fd      Socket descriptor of the target client, or
+ *                    HTTPD_WS_ALL_CLIENTS to broadcast to every WebSocket session
+ * @param[in] frame   WebSocket frame
+ * @return
+ *  - ESP_OK                    : On successfully queueing the frame
+ *  - ESP_FAIL                  : Failure in ctrl socket
+ *  - ESP_ERR_NO_MEM            : Failed to allocate the frame buffer
+ *  - ESP_ERR_INVALID_ARG       : Argument is invalid
+ */
+esp_err_t httpd_ws_queue_frame(httpd_handle_t handle, int fd, httpd_ws_frame_t *frame);
+
+/**
+ * @brief Checks the supplied socket descriptor if it belongs to any active client
+ * of this server instance and if the websoket protocol is active
+ *
+ * @param[in] hd      Server instance data
+ * @param[in] fd      Socket descriptor
+ * @return
+ *  - HTTPD_WS_CLIENT_INVALID   : This fd is not a client of this httpd
+ *  - HTTPD_WS_CLIENT_HTTP      : This fd is an active client, protocol is not WS
+ *  - HTTPD_WS_CLIENT_WEBSOCKET : This fd is an active client, protocol is WS
+ */
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd);
+
+#endif /* CONFIG_HTTPD_WS_SUPPORT */
+/** End of WebSocket related stuff
+ * @}
+ */
+
 #ifdef __cplusplus
 }
 #endif
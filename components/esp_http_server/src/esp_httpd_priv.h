@@ -128,6 +128,13 @@ struct sock_db {
     uint64_t lru_counter;                   /*!< LRU Counter indicating when the socket was last used */
     char pending_data[PARSER_BLOCK_SIZE];   /*!< Buffer for pending data to be received */
     size_t pending_len;                     /*!< Length of pending data to be received */
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    bool ws_handshake_done;                 /*!< True if it has done WebSocket handshake (if this socket is a valid WS) */
+    bool ws_close;                          /*!< Set to true to close the socket later (when WS Close frame received) */
+    bool ws_control_frames;                 /*!< WebSocket flag indicating that control frames should be passed to user handlers */
+    esp_err_t (*ws_handler)(httpd_req_t *r);    /*!< WebSocket handler, leave to null if it's not WebSocket */
+    void *ws_user_ctx;                      /*!< WebSocket user context */
+#endif
 };
 
 /**
@@ -148,6 +155,13 @@ struct httpd_req_aux {
         const char *value;
     } *resp_hdrs;                                   /*!< Additional headers in response packet */
     struct http_parser_url url_parse_res;           /*!< URL parsing result, used for retrieving URL elements */
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    bool ws_handshake_detect;                       /*!< WebSocket handshake detection flag */
+    httpd_ws_type_t ws_type;                        /*!< WebSocket frame type */
+    bool ws_final;                                  /*!< WebSocket FIN bit (final frame or not) */
+    size_t ws_payload_len;                          /*!< WebSocket payload length of the current frame */
+    uint8_t ws_mask_key[4];                         /*!< WebSocket mask key of the current frame */
+#endif
 };
 
 /**
@@ -524,6 +538,49 @@ int httpd_default_recv(httpd_handle_t hd, int sockfd, char *buf, size_t buf_len,
  * @}
  */
 
+/* ************** Group: WebSocket ************** */
+/** @name WebSocket
+ * Functions for WebSocket header parsing
+ * @{
+ */
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+/**
+ * @brief   This function is for responding a WebSocket handshake
+ *
+ * @param[in] req    Pointer to handshake request that will be handled
+ * @return
+ *  - ESP_OK                                : When handshake is sucessful
+ *  - ESP_ERR_NOT_FOUND                     : When some headers (Sec-WebSocket-*) are not found
+ *  - ESP_ERR_INVALID_VERSION               : The WebSocket version is not "13"
+ *  - ESP_ERR_INVALID_STATE                 : Handshake was done beforehand
+ *  - ESP_ERR_INVALID_ARG                   : Argument is invalid (null or non-WebSocket)
+ *  - ESP_FAIL                              : Socket failures
+ */
+esp_err_t httpd_ws_respond_server_handshake(httpd_req_t *req);
+
+/**
+ * @brief   Receives the header of a WebSocket frame on an upgraded session
+ *          and dispatches it
+ *
+ * Control frames are answered internally (PING with PONG, CLOSE with CLOSE)
+ * unless the URI asked for them, all other frames are passed to the
+ * WebSocket handler of the session. The payload length of the frame is set
+ * as the remaining length of the request, so that whatever the handler does
+ * not consume gets purged by httpd_req_delete().
+ *
+ * @param[in] req    Pointer to the request of the upgraded session
+ * @return
+ *  - ESP_OK    : Frame processed, session stays open
+ *  - ESP_FAIL  : Protocol or socket error, or handler failure
+ */
+esp_err_t httpd_ws_handle_frame(httpd_req_t *req);
+#endif /* CONFIG_HTTPD_WS_SUPPORT */
+
+/** End of WebSocket related functions
+ * @}
+ */
+
 #ifdef __cplusplus
 }
 #endif
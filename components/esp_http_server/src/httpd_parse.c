@@ -299,10 +299,27 @@ static esp_err_t cb_headers_complete(http_parser *parser)
     ESP_LOGD(TAG, LOG_FMT("content length = %zu"), r->content_len);
 
     if (parser->upgrade) {
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+        /* Only upgrades to WebSocket are supported. The handshake itself
+         * is completed in httpd_uri(), once the matching handler is known */
+        char upgrade_hdr_val[sizeof("websocket")];
+        if ((httpd_req_get_hdr_value_str(r, "Upgrade", upgrade_hdr_val,
+                                         sizeof(upgrade_hdr_val)) == ESP_OK) &&
+            (strcasecmp(upgrade_hdr_val, "websocket") == 0)) {
+            ESP_LOGD(TAG, LOG_FMT("got WebSocket upgrade request"));
+            ra->ws_handshake_detect = true;
+        } else {
+            ESP_LOGW(TAG, LOG_FMT("upgrade from HTTP to protocol other than WebSocket not supported"));
+            parser_data->error = HTTPD_XXX_UPGRADE_NOT_SUPPORTED;
+            parser_data->status = PARSING_FAILED;
+            return ESP_FAIL;
+        }
+#else
         ESP_LOGW(TAG, LOG_FMT("upgrade from HTTP not supported"));
         parser_data->error = HTTPD_XXX_UPGRADE_NOT_SUPPORTED;
         parser_data->status = PARSING_FAILED;
         return ESP_FAIL;
+#endif
     }
 
     parser_data->status = PARSING_BODY;
@@ -550,6 +567,12 @@ static void init_req_aux(struct httpd_req_aux *ra, httpd_config_t *config)
     ra->req_hdrs_count = 0;
     ra->resp_hdrs_count = 0;
     memset(ra->resp_hdrs, 0, config->max_resp_headers * sizeof(struct resp_hdr));
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    ra->ws_handshake_detect = false;
+    ra->ws_type = 0;
+    ra->ws_final = false;
+    ra->ws_payload_len = 0;
+#endif
 }
 
 static void httpd_req_cleanup(httpd_req_t *r)
@@ -590,8 +613,22 @@ esp_err_t httpd_req_new(struct httpd_data *hd, struct sock_db *sd)
     /* Copy session info to the request */
     r->sess_ctx = sd->ctx;
     r->free_ctx = sd->free_ctx;
+
+    esp_err_t err;
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    /* Sessions which completed the WebSocket handshake carry
+     * frames instead of HTTP requests from now on */
+    if (sd->ws_handshake_done && sd->ws_handler != NULL) {
+        r->user_ctx = sd->ws_user_ctx;
+        err = httpd_ws_handle_frame(r);
+        if (err != ESP_OK) {
+            httpd_req_cleanup(r);
+        }
+        return err;
+    }
+#endif
     /* Parse request */
-    esp_err_t err = httpd_parse_req(hd);
+    err = httpd_parse_req(hd);
     if (err != ESP_OK) {
         httpd_req_cleanup(r);
     }
@@ -303,6 +303,12 @@ esp_err_t httpd_sess_process(struct httpd_data *hd, int newfd)
     if (httpd_req_delete(hd) != ESP_OK) {
         return ESP_FAIL;
     }
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    if (sd->ws_close) {
+        ESP_LOGD(TAG, LOG_FMT("WebSocket session closed by peer"));
+        return ESP_FAIL;
+    }
+#endif
     ESP_LOGD(TAG, LOG_FMT("success"));
     sd->lru_counter = httpd_sess_get_lru_counter();
     return ESP_OK;
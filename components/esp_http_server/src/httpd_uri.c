@@ -78,6 +78,10 @@ esp_err_t httpd_register_uri_handler(httpd_handle_t handle,
             hd->hd_calls[i]->method   = uri_handler->method;
             hd->hd_calls[i]->handler  = uri_handler->handler;
             hd->hd_calls[i]->user_ctx = uri_handler->user_ctx;
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+            hd->hd_calls[i]->is_websocket = uri_handler->is_websocket;
+            hd->hd_calls[i]->handle_ws_control_frames = uri_handler->handle_ws_control_frames;
+#endif
             ESP_LOGD(TAG, LOG_FMT("[%d] installed %s"), i, uri_handler->uri);
             return ESP_OK;
         }
@@ -214,6 +218,28 @@ esp_err_t httpd_uri(struct httpd_data *hd)
     /* Attach user context data (passed during URI registration) into request */
     req->user_ctx = uri->user_ctx;
 
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+    struct httpd_req_aux *aux = req->aux;
+    if (aux->ws_handshake_detect) {
+        if (!uri->is_websocket || uri->method != HTTP_GET) {
+            ESP_LOGW(TAG, LOG_FMT("URI '%s' is not a WebSocket endpoint"), req->uri);
+            return httpd_resp_send_err(req, HTTPD_XXX_UPGRADE_NOT_SUPPORTED);
+        }
+
+        ESP_LOGD(TAG, LOG_FMT("responding WS handshake to sock %d"), aux->sd->fd);
+        esp_err_t ret = httpd_ws_respond_server_handshake(req);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+
+        /* Frames received on this session from now on go straight to the handler */
+        aux->sd->ws_handshake_done = true;
+        aux->sd->ws_handler = uri->handler;
+        aux->sd->ws_control_frames = uri->handle_ws_control_frames;
+        aux->sd->ws_user_ctx = uri->user_ctx;
+    }
+#endif
+
     /* Invoke handler */
     if (uri->handler(req) != ESP_OK) {
         /* Handler returns error, this socket should be closed */
@@ -0,0 +1,521 @@
+// Copyright 2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include <esp_log.h>
+#include <esp_err.h>
+#include <mbedtls/sha1.h>
+#include <mbedtls/base64.h>
+
+#include <esp_http_server.h>
+#include "esp_httpd_priv.h"
+
+#ifdef CONFIG_HTTPD_WS_SUPPORT
+
+static const char *TAG = "httpd_ws";
+
+/*
+ * Bit masks for WebSocket frames.
+ * Please refer to RFC6455 Section 5.2 for more details.
+ */
+#define HTTPD_WS_FIN_BIT                (1U << 7)
+#define HTTPD_WS_RSV_BITS               (7U << 4)
+#define HTTPD_WS_OPCODE_BITS            (0x0f)
+#define HTTPD_WS_MASK_BIT               (1U << 7)
+#define HTTPD_WS_LENGTH_BITS            (0x7f)
+#define HTTPD_WS_CONTROL_BIT            (1U << 3)
+
+/* Largest payload of a control frame, RFC6455 Section 5.5 */
+#define HTTPD_WS_MAX_CTRL_LEN           125
+
+/* Largest header of a server frame, which is never masked */
+#define HTTPD_WS_MAX_HDR_LEN            10
+
+/* Frames with a payload up to this length are assembled on the stack
+ * together with their header, so that they go out in a single send */
+#define HTTPD_WS_SMALL_FRAME_LEN        128
+
+/* Magic string appended to the client key, RFC6455 Section 1.3 */
+static const char ws_magic_uuid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static esp_err_t httpd_ws_send_all(struct sock_db *sd, const uint8_t *buf, size_t buf_len)
+{
+    while (buf_len > 0) {
+        int ret = sd->send_fn(sd->handle, sd->fd, (const char *)buf, buf_len, 0);
+        if (ret < 0) {
+            ESP_LOGD(TAG, LOG_FMT("error in send_fn"));
+            return ESP_FAIL;
+        }
+        buf     += ret;
+        buf_len -= ret;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t httpd_ws_recv_all(httpd_req_t *req, uint8_t *buf, size_t buf_len)
+{
+    while (buf_len > 0) {
+        int ret = httpd_recv_with_opt(req, (char *)buf, buf_len, false);
+        if (ret <= 0) {
+            ESP_LOGD(TAG, LOG_FMT("error in httpd_recv"));
+            return ESP_FAIL;
+        }
+        buf     += ret;
+        buf_len -= ret;
+    }
+    return ESP_OK;
+}
+
+/* Builds the header of an unmasked server frame into hdr,
+ * which must be at least HTTPD_WS_MAX_HDR_LEN bytes long */
+static size_t httpd_ws_build_hdr(uint8_t *hdr, const httpd_ws_frame_t *frame)
+{
+    size_t hdr_len = 0;
+
+    /* Unless the frame is a fragment, it is a complete message */
+    bool fin = frame->fragmented ? frame->final : true;
+    hdr[hdr_len++] = (fin ? HTTPD_WS_FIN_BIT : 0) | (frame->type & HTTPD_WS_OPCODE_BITS);
+
+    if (frame->len <= 125) {
+        hdr[hdr_len++] = frame->len;
+    } else if (frame->len < 65536) {
+        hdr[hdr_len++] = 126;
+        hdr[hdr_len++] = (frame->len >> 8) & 0xff;
+        hdr[hdr_len++] = frame->len & 0xff;
+    } else {
+        /* Payload length never exceeds 32 bits on this platform */
+        hdr[hdr_len++] = 127;
+        hdr[hdr_len++] = 0;
+        hdr[hdr_len++] = 0;
+        hdr[hdr_len++] = 0;
+        hdr[hdr_len++] = 0;
+        hdr[hdr_len++] = (frame->len >> 24) & 0xff;
+        hdr[hdr_len++] = (frame->len >> 16) & 0xff;
+        hdr[hdr_len++] = (frame->len >> 8) & 0xff;
+        hdr[hdr_len++] = frame->len & 0xff;
+    }
+    return hdr_len;
+}
+
+static esp_err_t httpd_ws_send(struct sock_db *sd, const httpd_ws_frame_t *frame)
+{
+    if (frame->len && frame->payload == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (frame->len <= HTTPD_WS_SMALL_FRAME_LEN) {
+        /* Avoid a separate TCP segment just for the header */
+        uint8_t buf[HTTPD_WS_MAX_HDR_LEN + HTTPD_WS_SMALL_FRAME_LEN];
+        size_t hdr_len = httpd_ws_build_hdr(buf, frame);
+        if (frame->len) {
+            memcpy(buf + hdr_len, frame->payload, frame->len);
+        }
+        return httpd_ws_send_all(sd, buf, hdr_len + frame->len);
+    }
+
+    uint8_t hdr[HTTPD_WS_MAX_HDR_LEN];
+    size_t hdr_len = httpd_ws_build_hdr(hdr, frame);
+    if (httpd_ws_send_all(sd, hdr, hdr_len) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    return httpd_ws_send_all(sd, frame->payload, frame->len);
+}
+
+esp_err_t httpd_ws_respond_server_handshake(httpd_req_t *req)
+{
+    /* Probe if input parameters are valid or not */
+    if (!req || !req->aux) {
+        ESP_LOGW(TAG, LOG_FMT("argument is invalid"));
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct httpd_req_aux *ra = req->aux;
+
+    /* Detect handshake - reject if handshake was ALREADY performed */
+    if (ra->sd->ws_handshake_done) {
+        ESP_LOGW(TAG, LOG_FMT("State is invalid - handshake has been performed"));
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Detect WS version (must be 13) */
+    char version_val[3] = { 0 };
+    if (httpd_req_get_hdr_value_str(req, "Sec-WebSocket-Version", version_val, sizeof(version_val)) != ESP_OK) {
+        ESP_LOGW(TAG, LOG_FMT("\"Sec-WebSocket-Version\" is not found"));
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (strcmp(version_val, "13") != 0) {
+        ESP_LOGW(TAG, LOG_FMT("\"Sec-WebSocket-Version\" is not \"13\", it is: %s"), version_val);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    /* Grab Sec-WebSocket-Key (client key) from the header.
+     * It is the base64 encoding of a 16 byte nonce, i.e. 24 characters */
+    char sec_key_encoded[28] = { 0 };
+    if (httpd_req_get_hdr_value_str(req, "Sec-WebSocket-Key", sec_key_encoded, sizeof(sec_key_encoded)) != ESP_OK) {
+        ESP_LOGW(TAG, LOG_FMT("Cannot find client key"));
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    /* Prepare server key (Sec-WebSocket-Accept), concat the string */
+    char server_raw_text[sizeof(sec_key_encoded) + sizeof(ws_magic_uuid)];
+    strlcpy(server_raw_text, sec_key_encoded, sizeof(server_raw_text));
+    strlcat(server_raw_text, ws_magic_uuid, sizeof(server_raw_text));
+
+    ESP_LOGD(TAG, LOG_FMT("Server key before encoding: %s"), server_raw_text);
+
+    /* Generate SHA-1 first and then encode to Base64 */
+    unsigned char server_key_hash[20] = { 0 };
+    mbedtls_sha1_ret((unsigned char *)server_raw_text, strlen(server_raw_text), server_key_hash);
+
+    unsigned char server_key_encoded[33] = { 0 };
+    size_t key_len = 0;
+    mbedtls_base64_encode(server_key_encoded, sizeof(server_key_encoded), &key_len,
+                          server_key_hash, sizeof(server_key_hash));
+
+    ESP_LOGD(TAG, LOG_FMT("Generated server key: %s"), server_key_encoded);
+
+    /* Prepare the Switching Protocol response */
+    char tx_buf[192] = { 0 };
+    int fmt_len = snprintf(tx_buf, sizeof(tx_buf),
+                           "HTTP/1.1 101 Switching Protocols\r\n"
+                           "Upgrade: websocket\r\n"
+                           "Connection: Upgrade\r\n"
+                           "Sec-WebSocket-Accept: %s\r\n"
+                           "\r\n", server_key_encoded);
+    if (fmt_len < 0 || fmt_len >= sizeof(tx_buf)) {
+        ESP_LOGW(TAG, LOG_FMT("Failed to prepare Tx buffer"));
+        return ESP_FAIL;
+    }
+
+    /* Send off the response */
+    if (httpd_ws_send_all(ra->sd, (const uint8_t *)tx_buf, fmt_len) != ESP_OK) {
+        ESP_LOGW(TAG, LOG_FMT("Failed to send the response"));
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+/* Reads the frame header into the request auxiliary data */
+static esp_err_t httpd_ws_get_frame_hdr(httpd_req_t *req)
+{
+    struct httpd_req_aux *ra = req->aux;
+    uint8_t hdr[8];
+
+    /* Read the first two bytes, holding flags, opcode and short length */
+    if (httpd_ws_recv_all(req, hdr, 2) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    /* No extensions are negotiated, so reserved bits must be cleared */
+    if (hdr[0] & HTTPD_WS_RSV_BITS) {
+        ESP_LOGW(TAG, LOG_FMT("reserved bits set in frame header"));
+        return ESP_FAIL;
+    }
+
+    /* All frames sent by a client must be masked, RFC6455 Section 5.1 */
+    if (!(hdr[1] & HTTPD_WS_MASK_BIT)) {
+        ESP_LOGW(TAG, LOG_FMT("received unmasked frame"));
+        return ESP_FAIL;
+    }
+
+    ra->ws_final = (hdr[0] & HTTPD_WS_FIN_BIT) != 0;
+    ra->ws_type = hdr[0] & HTTPD_WS_OPCODE_BITS;
+
+    /* Opcodes 0x3-0x7 are reserved for further non-control frames */
+    if (!(ra->ws_type & HTTPD_WS_CONTROL_BIT) && ra->ws_type > HTTPD_WS_TYPE_BINARY) {
+        ESP_LOGW(TAG, LOG_FMT("reserved opcode %d"), ra->ws_type);
+        return ESP_FAIL;
+    }
+
+    size_t payload_len = hdr[1] & HTTPD_WS_LENGTH_BITS;
+    if (payload_len == 126) {
+        /* Extended 16-bit length */
+        if (httpd_ws_recv_all(req, hdr, 2) != ESP_OK) {
+            return ESP_FAIL;
+        }
+        payload_len = (hdr[0] << 8) | hdr[1];
+    } else if (payload_len == 127) {
+        /* Extended 64-bit length, of which only the lower half is supported */
+        if (httpd_ws_recv_all(req, hdr, 8) != ESP_OK) {
+            return ESP_FAIL;
+        }
+        if (hdr[0] | hdr[1] | hdr[2] | hdr[3]) {
+            ESP_LOGW(TAG, LOG_FMT("frame too large"));
+            return ESP_FAIL;
+        }
+        payload_len = ((size_t)hdr[4] << 24) | ((size_t)hdr[5] << 16) |
+                      ((size_t)hdr[6] << 8)  | hdr[7];
+    }
+
+    /* Control frames must not be fragmented and carry at most 125 bytes */
+    if ((ra->ws_type & HTTPD_WS_CONTROL_BIT) &&
+        (!ra->ws_final || payload_len > HTTPD_WS_MAX_CTRL_LEN)) {
+        ESP_LOGW(TAG, LOG_FMT("invalid control frame"));
+        return ESP_FAIL;
+    }
+
+    if (httpd_ws_recv_all(req, ra->ws_mask_key, sizeof(ra->ws_mask_key)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    /* The payload is then consumed through httpd_req_recv(), and purged
+     * by httpd_req_delete() if the handler leaves some of it unread */
+    ra->ws_payload_len = payload_len;
+    ra->remaining_len = payload_len;
+    req->content_len = payload_len;
+    return ESP_OK;
+}
+
+/* Answers control frames when the URI did not ask to handle them */
+static esp_err_t httpd_ws_handle_ctrl_frame(httpd_req_t *req)
+{
+    struct httpd_req_aux *ra = req->aux;
+    uint8_t payload[HTTPD_WS_MAX_CTRL_LEN];
+    httpd_ws_frame_t frame = {
+        .payload = payload,
+    };
+
+    if (ra->ws_type == HTTPD_WS_TYPE_PONG) {
+        /* Unsolicited PONG frames serve as heartbeat, nothing to answer */
+        return ESP_OK;
+    }
+
+    if (httpd_ws_recv_frame(req, &frame, sizeof(payload)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    if (ra->ws_type == HTTPD_WS_TYPE_PING) {
+        ESP_LOGD(TAG, LOG_FMT("answering PING with PONG"));
+        frame.type = HTTPD_WS_TYPE_PONG;
+        return httpd_ws_send(ra->sd, &frame);
+    }
+
+    if (ra->ws_type == HTTPD_WS_TYPE_CLOSE) {
+        /* Echo the status code back, as recommended by RFC6455 Section 5.5.1 */
+        ESP_LOGD(TAG, LOG_FMT("answering CLOSE"));
+        frame.type = HTTPD_WS_TYPE_CLOSE;
+        frame.len = MIN(frame.len, 2);
+        ra->sd->ws_close = true;
+        httpd_ws_send(ra->sd, &frame);
+        return ESP_OK;
+    }
+
+    ESP_LOGW(TAG, LOG_FMT("unknown control frame type %d"), ra->ws_type);
+    return ESP_FAIL;
+}
+
+esp_err_t httpd_ws_handle_frame(httpd_req_t *req)
+{
+    struct httpd_req_aux *ra = req->aux;
+    struct sock_db *sd = ra->sd;
+
+    if (httpd_ws_get_frame_hdr(req) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    ESP_LOGD(TAG, LOG_FMT("frame type %d, length %d"), ra->ws_type, ra->ws_payload_len);
+
+    bool is_ctrl = (ra->ws_type & HTTPD_WS_CONTROL_BIT) != 0;
+    if (is_ctrl && !sd->ws_control_frames) {
+        return httpd_ws_handle_ctrl_frame(req);
+    }
+
+    if (sd->ws_handler(req) != ESP_OK) {
+        ESP_LOGW(TAG, LOG_FMT("WebSocket handler execution failed"));
+        return ESP_FAIL;
+    }
+
+    /* The session terminates after a CLOSE frame even
+     * if the handler is the one answering it */
+    if (ra->ws_type == HTTPD_WS_TYPE_CLOSE) {
+        sd->ws_close = true;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_ws_recv_frame(httpd_req_t *req, httpd_ws_frame_t *frame, size_t max_len)
+{
+    if (req == NULL || frame == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!httpd_valid_req(req)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct httpd_req_aux *ra = req->aux;
+    if (!ra->sd->ws_handshake_done) {
+        ESP_LOGW(TAG, LOG_FMT("handshake not done"));
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    frame->type = ra->ws_type;
+    frame->final = ra->ws_final;
+    frame->fragmented = false;
+
+    /* Only report the frame information */
+    if (max_len == 0) {
+        frame->len = ra->ws_payload_len;
+        return ESP_OK;
+    }
+
+    if (frame->payload == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Offset into the payload decides which mask byte applies */
+    size_t offset  = ra->ws_payload_len - ra->remaining_len;
+    size_t to_read = MIN(max_len, ra->remaining_len);
+    size_t read_len = 0;
+
+    while (read_len < to_read) {
+        int ret = httpd_req_recv(req, (char *)frame->payload + read_len, to_read - read_len);
+        if (ret <= 0) {
+            ESP_LOGW(TAG, LOG_FMT("failed to receive payload"));
+            return ESP_FAIL;
+        }
+        read_len += ret;
+    }
+
+    for (size_t i = 0; i < read_len; i++) {
+        frame->payload[i] ^= ra->ws_mask_key[(offset + i) & 3];
+    }
+
+    frame->len = read_len;
+    return ESP_OK;
+}
+
+esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *frame)
+{
+    if (req == NULL || frame == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!httpd_valid_req(req)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct httpd_req_aux *ra = req->aux;
+    if (!ra->sd->ws_handshake_done) {
+        ESP_LOGW(TAG, LOG_FMT("handshake not done"));
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return httpd_ws_send(ra->sd, frame);
+}
+
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame)
+{
+    if (frame == NULL || fd < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct sock_db *sd = httpd_sess_get(hd, fd);
+    if (sd == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!sd->ws_handshake_done) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    return httpd_ws_send(sd, frame);
+}
+
+/**
+ * @brief Frame prepared by httpd_ws_queue_frame(), header and
+ *        payload are kept contiguous in data
+ */
+struct httpd_ws_queued_frame {
+    struct httpd_data *hd;      /*!< Server instance */
+    int fd;                     /*!< Target descriptor, or HTTPD_WS_ALL_CLIENTS */
+    size_t len;                 /*!< Length of header and payload */
+    uint8_t data[];             /*!< Raw frame */
+};
+
+static void httpd_ws_queued_send(struct httpd_ws_queued_frame *qf, struct sock_db *sd)
+{
+    if (!sd->ws_handshake_done || sd->ws_close) {
+        return;
+    }
+
+    if (httpd_ws_send_all(sd, qf->data, qf->len) != ESP_OK) {
+        ESP_LOGW(TAG, LOG_FMT("failed to send to fd %d, closing"), sd->fd);
+        httpd_sess_trigger_close(qf->hd, sd->fd);
+    }
+}
+
+static void httpd_ws_queued_work(void *arg)
+{
+    struct httpd_ws_queued_frame *qf = (struct httpd_ws_queued_frame *) arg;
+
+    if (qf->fd == HTTPD_WS_ALL_CLIENTS) {
+        for (int i = 0; i < qf->hd->config.max_open_sockets; i++) {
+            struct sock_db *sd = &qf->hd->hd_sd[i];
+            if (sd->fd != -1) {
+                httpd_ws_queued_send(qf, sd);
+            }
+        }
+    } else {
+        /* The session may have been closed since the frame was queued */
+        struct sock_db *sd = httpd_sess_get(qf->hd, qf->fd);
+        if (sd) {
+            httpd_ws_queued_send(qf, sd);
+        }
+    }
+    free(qf);
+}
+
+esp_err_t httpd_ws_queue_frame(httpd_handle_t handle, int fd, httpd_ws_frame_t *frame)
+{
+    if (handle == NULL || frame == NULL || (frame->len && frame->payload == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct httpd_ws_queued_frame *qf = malloc(sizeof(*qf) + HTTPD_WS_MAX_HDR_LEN + frame->len);
+    if (qf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    qf->hd  = (struct httpd_data *) handle;
+    qf->fd  = fd;
+    qf->len = httpd_ws_build_hdr(qf->data, frame);
+    if (frame->len) {
+        memcpy(qf->data + qf->len, frame->payload, frame->len);
+        qf->len += frame->len;
+    }
+
+    esp_err_t ret = httpd_queue_work(handle, httpd_ws_queued_work, qf);
+    if (ret != ESP_OK) {
+        free(qf);
+    }
+    return ret;
+}
+
+httpd_ws_client_info_t httpd_ws_get_fd_info(httpd_handle_t hd, int fd)
+{
+    struct sock_db *sess = (fd < 0) ? NULL : httpd_sess_get(hd, fd);
+
+    if (sess == NULL) {
+        return HTTPD_WS_CLIENT_INVALID;
+    }
+    bool is_active_ws = sess->ws_handshake_done && (!sess->ws_close);
+    return is_active_ws ? HTTPD_WS_CLIENT_WEBSOCKET : HTTPD_WS_CLIENT_HTTP;
+}
+
+#endif /* CONFIG_HTTPD_WS_SUPPORT */
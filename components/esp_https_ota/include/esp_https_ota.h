@@ -25,6 +25,11 @@ extern "C" {
  *
  * This function performs HTTPS OTA Firmware upgrade
  *
+ * The partition is erased progressively while the image is received. If the
+ * connection is lost, the download continues from where it stopped with an
+ * HTTP Range request, see CONFIG_OTA_RESUME_MAX_RETRIES. With
+ * CONFIG_OTA_RESUME_ACROSS_RESTARTS it also continues after a restart.
+ *
  * @param[in]  config       pointer to esp_http_client_config_t structure.
  *
  * @note     For secure HTTPS updates, the `cert_pem` member of `config`
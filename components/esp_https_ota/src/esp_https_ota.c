@@ -18,19 +18,467 @@
 #include <esp_https_ota.h>
 #include <esp_ota_ops.h>
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include "sdkconfig.h"
 
+#ifdef CONFIG_OTA_PIPELINE
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#endif
+
+#ifdef CONFIG_OTA_RESUME_ACROSS_RESTARTS
+#include <nvs.h>
+#include <esp_crc.h>
+#endif
+
 #define OTA_BUF_SIZE    CONFIG_OTA_BUF_SIZE
+#define OTA_MAX_RETRIES CONFIG_OTA_RESUME_MAX_RETRIES
 static const char *TAG = "esp_https_ota";
 
+/* The delay before reconnecting doubles with each attempt in a row without data, up to this */
+#define OTA_RETRY_DELAY_MS      CONFIG_OTA_RESUME_RETRY_DELAY_MS
+#define OTA_RETRY_MAX_DELAY_MS  30000
+
+/* Longest ETag or Last-Modified value kept, a longer one can't be used to resume */
+#define OTA_VALIDATOR_SIZE      64
+
+#define HTTP_STATUS_OK              200
+#define HTTP_STATUS_PARTIAL_CONTENT 206
+
+#ifdef CONFIG_OTA_PIPELINE
+#define OTA_PIPELINE_BUF_SIZE   CONFIG_OTA_PIPELINE_BUF_SIZE
+#define OTA_ERASE_AHEAD_SIZE    (2 * SPI_FLASH_SEC_SIZE)
+#define OTA_WRITER_STACK_SIZE   3072
+
+typedef struct {
+    char *data;
+    int len;                    /* In a marker (data == NULL): 0 to flush, -1 to stop */
+} ota_chunk_t;
+
+/* The receiving task fills one buffer while the writer task writes the other one to flash */
+typedef struct {
+    QueueHandle_t free_q;
+    QueueHandle_t full_q;
+    SemaphoreHandle_t idle;     /* Given by the writer task for each marker */
+    ota_chunk_t fill;           /* Buffer being filled, data is NULL if none */
+    esp_err_t err;              /* First error of the writer task */
+    char *buf[2];
+} ota_pipeline_t;
+#endif
+
+#ifdef CONFIG_OTA_RESUME_ACROSS_RESTARTS
+#define OTA_NVS_NAMESPACE       "esp_https_ota"
+#define OTA_NVS_KEY             "resume"
+#define OTA_CHECKPOINT_SIZE     (CONFIG_OTA_RESUME_CHECKPOINT_SECTORS * SPI_FLASH_SEC_SIZE)
+
+/* What is needed to continue the download after a restart. The offset is
+ * sector aligned: the sector after it may be partially written, it is
+ * erased again when the download goes on */
+typedef struct {
+    uint32_t url_crc;
+    uint32_t part_addr;
+    uint32_t image_size;
+    uint32_t offset;
+    char validator[OTA_VALIDATOR_SIZE];
+} ota_resume_state_t;
+#endif
+
+/* Headers of the last response, from the HTTP_EVENT_ON_HEADER events. Empty if not sent */
+typedef struct {
+    char etag[OTA_VALIDATOR_SIZE];
+    char last_modified[OTA_VALIDATOR_SIZE];
+    char content_range[OTA_VALIDATOR_SIZE];
+} ota_response_headers_t;
+
+typedef struct {
+    esp_http_client_handle_t client;
+    const esp_partition_t *partition;
+    esp_ota_handle_t update_handle;
+    uint32_t image_size;        /* 0 if the server didn't tell the size */
+    uint32_t offset;            /* Number of bytes of the image received */
+    uint32_t written;           /* Number of bytes of the image written to the partition */
+    char validator[OTA_VALIDATOR_SIZE]; /* ETag or Last-Modified of the image, sent in If-Range */
+    ota_response_headers_t headers;
+    http_event_handle_cb event_handler; /* The caller's, the events are passed on to it */
+    void *user_data;
+#ifdef CONFIG_OTA_RESUME_ACROSS_RESTARTS
+    ota_resume_state_t saved;
+#endif
+#ifdef CONFIG_OTA_PIPELINE
+    ota_pipeline_t pipeline;
+#endif
+} ota_download_t;
+
 static void http_cleanup(esp_http_client_handle_t client)
 {
     esp_http_client_close(client);
     esp_http_client_cleanup(client);
 }
 
+static void header_copy(const esp_http_client_event_t *evt, const char *key, char *value)
+{
+    if (strcasecmp(evt->header_key, key) == 0 && strlen(evt->header_value) < OTA_VALIDATOR_SIZE) {
+        strcpy(value, evt->header_value);
+    }
+}
+
+static esp_err_t http_event_handler(esp_http_client_event_t *evt)
+{
+    ota_download_t *dl = (ota_download_t *)evt->user_data;
+
+    if (evt->event_id == HTTP_EVENT_ON_HEADER) {
+        header_copy(evt, "ETag", dl->headers.etag);
+        header_copy(evt, "Last-Modified", dl->headers.last_modified);
+        header_copy(evt, "Content-Range", dl->headers.content_range);
+    }
+    if (dl->event_handler == NULL) {
+        return ESP_OK;
+    }
+    evt->user_data = dl->user_data;
+    return dl->event_handler(evt);
+}
+
+/* If-Range only takes a strong validator: an ETag which isn't weak, or else the date */
+static const char *response_validator(const ota_download_t *dl)
+{
+    if (dl->headers.etag[0] && strncmp(dl->headers.etag, "W/", 2) != 0) {
+        return dl->headers.etag;
+    }
+    return dl->headers.last_modified;
+}
+
+#ifdef CONFIG_OTA_RESUME_ACROSS_RESTARTS
+static uint32_t url_crc(esp_http_client_handle_t client)
+{
+    char url[256];
+
+    if (esp_http_client_get_url(client, url, sizeof(url)) != ESP_OK) {
+        return 0;
+    }
+    return crc32_le(0, (const uint8_t *)url, strlen(url));
+}
+
+static void resume_state_load(ota_download_t *dl)
+{
+    nvs_handle handle;
+    ota_resume_state_t state;
+    size_t len = sizeof(state);
+
+    memset(&dl->saved, 0, sizeof(dl->saved));
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    esp_err_t err = nvs_get_blob(handle, OTA_NVS_KEY, &state, &len);
+    nvs_close(handle);
+    if (err != ESP_OK || len != sizeof(state)) {
+        return;
+    }
+    if (state.url_crc != url_crc(dl->client) || state.part_addr != dl->partition->address
+        || state.offset % SPI_FLASH_SEC_SIZE || state.offset >= state.image_size
+        || strnlen(state.validator, OTA_VALIDATOR_SIZE) == OTA_VALIDATOR_SIZE) {
+        ESP_LOGD(TAG, "Saved download state doesn't apply, starting over");
+        return;
+    }
+    dl->saved = state;
+    dl->image_size = state.image_size;
+    dl->offset = state.offset;
+    strcpy(dl->validator, state.validator);
+}
+
+static void resume_state_save(ota_download_t *dl, uint32_t offset)
+{
+    nvs_handle handle;
+
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK) {
+        ESP_LOGW(TAG, "Couldn't open NVS, download progress is not saved");
+        return;
+    }
+    if (dl->saved.part_addr == 0) {
+        dl->saved.url_crc = url_crc(dl->client);
+        dl->saved.part_addr = dl->partition->address;
+        dl->saved.image_size = dl->image_size;
+        strcpy(dl->saved.validator, dl->validator);
+    }
+    dl->saved.offset = offset;
+    if (nvs_set_blob(handle, OTA_NVS_KEY, &dl->saved, sizeof(dl->saved)) != ESP_OK || nvs_commit(handle) != ESP_OK) {
+        ESP_LOGW(TAG, "Couldn't save download progress");
+    }
+    nvs_close(handle);
+}
+
+static void resume_state_clear(ota_download_t *dl)
+{
+    nvs_handle handle;
+
+    memset(&dl->saved, 0, sizeof(dl->saved));
+    if (nvs_open(OTA_NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK) {
+        if (nvs_erase_key(handle, OTA_NVS_KEY) == ESP_OK) {
+            nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+}
+
+/* Save the progress each time the written data covers OTA_CHECKPOINT_SIZE more */
+static void resume_state_checkpoint(ota_download_t *dl)
+{
+    uint32_t offset = dl->written & ~(SPI_FLASH_SEC_SIZE - 1);
+
+    if (dl->image_size && offset >= dl->saved.offset + OTA_CHECKPOINT_SIZE) {
+        resume_state_save(dl, offset);
+    }
+}
+#else
+#define resume_state_load(dl)
+#define resume_state_clear(dl)
+#define resume_state_checkpoint(dl)
+#endif
+
+/**
+ * Send the request for the image from dl->offset on.
+ * Returns ESP_ERR_INVALID_RESPONSE if the server didn't send what was asked for,
+ * then the download has to start over from the beginning of the image.
+ *
+ * A resumed request carries the validator of the image in If-Range: if the image
+ * changed, even keeping its size, the server answers with the whole new one.
+ */
+static esp_err_t http_request_from_offset(ota_download_t *dl)
+{
+    esp_err_t err;
+
+    if (dl->offset) {
+        char range[32];
+        snprintf(range, sizeof(range), "bytes=%u-", dl->offset);
+        esp_http_client_set_header(dl->client, "Range", range);
+    } else {
+        esp_http_client_delete_header(dl->client, "Range");
+    }
+    if (dl->offset && dl->validator[0]) {
+        esp_http_client_set_header(dl->client, "If-Range", dl->validator);
+    } else {
+        esp_http_client_delete_header(dl->client, "If-Range");
+    }
+    memset(&dl->headers, 0, sizeof(dl->headers));
+
+    err = esp_http_client_open(dl->client, 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open HTTP connection: %d", err);
+        return err;
+    }
+    int content_length = esp_http_client_fetch_headers(dl->client);
+    if (content_length < 0) {
+        ESP_LOGE(TAG, "Failed to fetch the response headers");
+        return ESP_ERR_HTTP_FETCH_HEADER;
+    }
+
+    int status = esp_http_client_get_status_code(dl->client);
+    if (dl->offset == 0) {
+        if (status != HTTP_STATUS_OK) {
+            ESP_LOGE(TAG, "Unexpected HTTP status %d", status);
+            return ESP_FAIL;
+        }
+        dl->image_size = content_length;
+        strcpy(dl->validator, response_validator(dl));
+        return ESP_OK;
+    }
+    if (status == HTTP_STATUS_OK && dl->validator[0]) {
+        ESP_LOGW(TAG, "Image changed on the server, starting over");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (status != HTTP_STATUS_PARTIAL_CONTENT) {
+        ESP_LOGW(TAG, "Server can't resume the download (HTTP status %d)", status);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    /* Image changed on the server, or no way to tell */
+    unsigned start, end, total;
+    if (dl->image_size == 0 || content_length != dl->image_size - dl->offset
+        || sscanf(dl->headers.content_range, "bytes %u-%u/%u", &start, &end, &total) != 3
+        || start != dl->offset || total != dl->image_size) {
+        ESP_LOGW(TAG, "Resumed download has unexpected range \"%s\"", dl->headers.content_range);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    const char *validator = response_validator(dl);
+    if (dl->validator[0] && validator[0] && strcmp(validator, dl->validator) != 0) {
+        ESP_LOGW(TAG, "Resumed download is of another image");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    ESP_LOGI(TAG, "Resuming download at offset %u", dl->offset);
+    return ESP_OK;
+}
+
+static esp_err_t ota_write(ota_download_t *dl, const char *data, int len)
+{
+    esp_err_t err = esp_ota_write(dl->update_handle, (const void *)data, len);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error: esp_ota_write failed! err=0x%x", err);
+        return err;
+    }
+    dl->written += len;
+    ESP_LOGD(TAG, "Written image length %u", dl->written);
+    resume_state_checkpoint(dl);
+    return ESP_OK;
+}
+
+#ifdef CONFIG_OTA_PIPELINE
+static void ota_writer_task(void *arg)
+{
+    ota_download_t *dl = (ota_download_t *)arg;
+    ota_pipeline_t *pl = &dl->pipeline;
+    ota_chunk_t chunk;
+    bool erase_ahead = false;
+
+    while (1) {
+        if (xQueueReceive(pl->full_q, &chunk, 0) != pdTRUE) {
+            /* Nothing to write yet, prepare the flash for what comes next. Not after a marker:
+             * the receiving task may be using the OTA handle then */
+            if (erase_ahead && pl->err == ESP_OK) {
+                esp_ota_erase_ahead(dl->update_handle, OTA_ERASE_AHEAD_SIZE);
+            }
+            erase_ahead = false;
+            xQueueReceive(pl->full_q, &chunk, portMAX_DELAY);
+        }
+        if (chunk.data == NULL) {
+            erase_ahead = false;
+            xSemaphoreGive(pl->idle);
+            if (chunk.len < 0) {
+                break;
+            }
+            continue;
+        }
+        if (pl->err == ESP_OK) {
+            pl->err = ota_write(dl, chunk.data, chunk.len);
+            erase_ahead = true;
+        }
+        xQueueSend(pl->free_q, &chunk, portMAX_DELAY);
+    }
+    vTaskDelete(NULL);
+}
+
+static esp_err_t ota_pipeline_start(ota_download_t *dl)
+{
+    ota_pipeline_t *pl = &dl->pipeline;
+
+    pl->free_q = xQueueCreate(2, sizeof(ota_chunk_t));
+    pl->full_q = xQueueCreate(3, sizeof(ota_chunk_t));
+    pl->idle = xSemaphoreCreateBinary();
+    pl->buf[0] = malloc(OTA_PIPELINE_BUF_SIZE);
+    pl->buf[1] = malloc(OTA_PIPELINE_BUF_SIZE);
+    if (!pl->free_q || !pl->full_q || !pl->idle || !pl->buf[0] || !pl->buf[1]) {
+        goto fail;
+    }
+    for (int i = 0; i < 2; i++) {
+        ota_chunk_t chunk = { .data = pl->buf[i] };
+        xQueueSend(pl->free_q, &chunk, 0);
+    }
+    if (xTaskCreate(ota_writer_task, "ota_writer", OTA_WRITER_STACK_SIZE, dl, uxTaskPriorityGet(NULL), NULL) != pdPASS) {
+        goto fail;
+    }
+    return ESP_OK;
+
+fail:
+    ESP_LOGE(TAG, "Couldn't allocate memory for the OTA pipeline");
+    if (pl->free_q) {
+        vQueueDelete(pl->free_q);
+    }
+    if (pl->full_q) {
+        vQueueDelete(pl->full_q);
+    }
+    if (pl->idle) {
+        vSemaphoreDelete(pl->idle);
+    }
+    free(pl->buf[0]);
+    free(pl->buf[1]);
+    memset(pl, 0, sizeof(ota_pipeline_t));
+    return ESP_ERR_NO_MEM;
+}
+
+/* Returns the free space of the buffer being filled, waits for the writer task if needed */
+static int ota_pipeline_buffer(ota_download_t *dl, char **buf)
+{
+    ota_pipeline_t *pl = &dl->pipeline;
+
+    if (pl->fill.data == NULL) {
+        xQueueReceive(pl->free_q, &pl->fill, portMAX_DELAY);
+        pl->fill.len = 0;
+    }
+    *buf = pl->fill.data + pl->fill.len;
+    return OTA_PIPELINE_BUF_SIZE - pl->fill.len;
+}
+
+static esp_err_t ota_pipeline_commit(ota_download_t *dl, int len)
+{
+    ota_pipeline_t *pl = &dl->pipeline;
+
+    pl->fill.len += len;
+    if (pl->fill.len == OTA_PIPELINE_BUF_SIZE) {
+        xQueueSend(pl->full_q, &pl->fill, portMAX_DELAY);
+        pl->fill.data = NULL;
+    }
+    return pl->err;
+}
+
+static esp_err_t ota_pipeline_marker(ota_download_t *dl, int type)
+{
+    ota_pipeline_t *pl = &dl->pipeline;
+    ota_chunk_t marker = { .data = NULL, .len = type };
+
+    if (pl->fill.data) {
+        xQueueSend(pl->fill.len ? pl->full_q : pl->free_q, &pl->fill, portMAX_DELAY);
+        pl->fill.data = NULL;
+    }
+    xQueueSend(pl->full_q, &marker, portMAX_DELAY);
+    xSemaphoreTake(pl->idle, portMAX_DELAY);
+    return pl->err;
+}
+
+/* Waits until everything received is written to flash */
+static esp_err_t ota_pipeline_flush(ota_download_t *dl)
+{
+    return dl->pipeline.free_q ? ota_pipeline_marker(dl, 0) : ESP_OK;
+}
+
+static void ota_pipeline_stop(ota_download_t *dl)
+{
+    ota_pipeline_t *pl = &dl->pipeline;
+
+    if (pl->free_q == NULL) {
+        return;
+    }
+    ota_pipeline_marker(dl, -1);
+    vQueueDelete(pl->free_q);
+    vQueueDelete(pl->full_q);
+    vSemaphoreDelete(pl->idle);
+    free(pl->buf[0]);
+    free(pl->buf[1]);
+    memset(pl, 0, sizeof(ota_pipeline_t));
+}
+#else
+#define ota_pipeline_flush(dl)  ESP_OK
+#endif
+
+/* Start writing the partition over from `offset`, nothing must be left to write */
+static esp_err_t ota_restart_at(ota_download_t *dl, uint32_t offset)
+{
+    if (dl->update_handle) {
+        esp_ota_abort(dl->update_handle);
+        dl->update_handle = 0;
+    }
+    dl->offset = offset;
+    dl->written = offset;
+    if (offset == 0) {
+        dl->validator[0] = '\0';
+        resume_state_clear(dl);
+        return esp_ota_begin(dl->partition, OTA_WITH_SEQUENTIAL_WRITES, &dl->update_handle);
+    }
+    return esp_ota_resume(dl->partition, offset, &dl->update_handle);
+}
+
 esp_err_t esp_https_ota(const esp_http_client_config_t *config)
 {
+    ota_download_t dl = { 0 };
+
     if (!config) {
         ESP_LOGE(TAG, "esp_http_client config not found");
         return ESP_ERR_INVALID_ARG;
@@ -43,93 +491,154 @@ esp_err_t esp_https_ota(const esp_http_client_config_t *config)
     }
 #endif
 
-    esp_http_client_handle_t client = esp_http_client_init(config);
-    if (client == NULL) {
+    /* The response headers are needed to resume the download */
+    esp_http_client_config_t http_config = *config;
+    http_config.event_handler = http_event_handler;
+    http_config.user_data = &dl;
+    dl.event_handler = config->event_handler;
+    dl.user_data = config->user_data;
+
+    dl.client = esp_http_client_init(&http_config);
+    if (dl.client == NULL) {
         ESP_LOGE(TAG, "Failed to initialise HTTP connection");
         return ESP_FAIL;
     }
 
 #if !CONFIG_OTA_ALLOW_HTTP
-    if (esp_http_client_get_transport_type(client) != HTTP_TRANSPORT_OVER_SSL) {
+    if (esp_http_client_get_transport_type(dl.client) != HTTP_TRANSPORT_OVER_SSL) {
         ESP_LOGE(TAG, "Transport is not over HTTPS");
+        esp_http_client_cleanup(dl.client);
         return ESP_FAIL;
     }
 #endif
 
-    esp_err_t err = esp_http_client_open(client, 0);
-    if (err != ESP_OK) {
-        esp_http_client_cleanup(client);
-        ESP_LOGE(TAG, "Failed to open HTTP connection: %d", err);
-        return err;
-    }
-    esp_http_client_fetch_headers(client);
-
-    esp_ota_handle_t update_handle = 0;
-    const esp_partition_t *update_partition = NULL;
     ESP_LOGI(TAG, "Starting OTA...");
-    update_partition = esp_ota_get_next_update_partition(NULL);
-    if (update_partition == NULL) {
+    dl.partition = esp_ota_get_next_update_partition(NULL);
+    if (dl.partition == NULL) {
         ESP_LOGE(TAG, "Passive OTA partition not found");
-        http_cleanup(client);
+        esp_http_client_cleanup(dl.client);
         return ESP_FAIL;
     }
     ESP_LOGI(TAG, "Writing to partition subtype %d at offset 0x%x",
-             update_partition->subtype, update_partition->address);
+             dl.partition->subtype, dl.partition->address);
 
-    err = esp_ota_begin(update_partition, OTA_SIZE_UNKNOWN, &update_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "esp_ota_begin failed, error=%d", err);
-        http_cleanup(client);
-        return err;
+#ifdef CONFIG_OTA_PIPELINE
+    char *upgrade_data_buf = NULL;
+    if (ota_pipeline_start(&dl) != ESP_OK) {
+        esp_http_client_cleanup(dl.client);
+        return ESP_ERR_NO_MEM;
     }
-    ESP_LOGI(TAG, "esp_ota_begin succeeded");
-    ESP_LOGI(TAG, "Please Wait. This may take time");
-
-    esp_err_t ota_write_err = ESP_OK;
+#else
     char *upgrade_data_buf = (char *)malloc(OTA_BUF_SIZE);
     if (!upgrade_data_buf) {
         ESP_LOGE(TAG, "Couldn't allocate memory to upgrade data buffer");
+        esp_http_client_cleanup(dl.client);
         return ESP_ERR_NO_MEM;
     }
-    int binary_file_len = 0;
+#endif
+    int64_t start_time = esp_timer_get_time();
+
+    /* The partition is erased sector by sector while the image is received */
+    resume_state_load(&dl);
+    esp_err_t err = ota_restart_at(&dl, dl.offset);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_begin failed, error=%d", err);
+        goto exit;
+    }
+    ESP_LOGI(TAG, "esp_ota_begin succeeded");
+    ESP_LOGI(TAG, "Please Wait. This may take time");
+
+    int retries = 0;
     while (1) {
-        int data_read = esp_http_client_read(client, upgrade_data_buf, OTA_BUF_SIZE);
-        if (data_read == 0) {
-            ESP_LOGI(TAG, "Connection closed,all data received");
-            break;
+        err = http_request_from_offset(&dl);
+        if (err == ESP_ERR_INVALID_RESPONSE) {
+            esp_http_client_close(dl.client);
+            if ((err = ota_pipeline_flush(&dl)) != ESP_OK || (err = ota_restart_at(&dl, 0)) != ESP_OK) {
+                break;
+            }
+            continue;
         }
-        if (data_read < 0) {
-            ESP_LOGE(TAG, "Error: SSL data read error");
+
+        uint32_t offset_before = dl.offset;
+        while (err == ESP_OK) {
+#ifdef CONFIG_OTA_PIPELINE
+            int buf_size = ota_pipeline_buffer(&dl, &upgrade_data_buf);
+#else
+            int buf_size = OTA_BUF_SIZE;
+#endif
+            int data_read = esp_http_client_read(dl.client, upgrade_data_buf, buf_size);
+            if (data_read == 0 && esp_http_client_is_complete_data_received(dl.client)) {
+                ESP_LOGI(TAG, "Connection closed,all data received");
+                break;
+            }
+            if (data_read <= 0) {
+                ESP_LOGW(TAG, "Connection lost after %u bytes", dl.offset);
+                err = ESP_FAIL;
+                break;
+            }
+#ifdef CONFIG_OTA_PIPELINE
+            err = ota_pipeline_commit(&dl, data_read);
+#else
+            err = ota_write(&dl, upgrade_data_buf, data_read);
+#endif
+            if (err != ESP_OK) {
+                goto exit;
+            }
+            dl.offset += data_read;
+        }
+        esp_http_client_close(dl.client);
+        if (err == ESP_OK) {
             break;
         }
-        if (data_read > 0) {
-            ota_write_err = esp_ota_write( update_handle, (const void *)upgrade_data_buf, data_read);
-            if (ota_write_err != ESP_OK) {
-                break;
+
+        /* Only the attempts in a row which didn't bring any data count */
+        if (dl.offset != offset_before) {
+            retries = 0;
+        }
+        if (dl.image_size == 0 || ++retries > OTA_MAX_RETRIES) {
+            ESP_LOGE(TAG, "Failed to download the image");
+            goto exit;
+        }
+        /* Reconnect at once after a connection which brought data, else give the link time to recover */
+        if (retries > 1) {
+            uint32_t delay_ms = OTA_RETRY_DELAY_MS << (retries - 2 < 15 ? retries - 2 : 15);
+
+            if (delay_ms > OTA_RETRY_MAX_DELAY_MS) {
+                delay_ms = OTA_RETRY_MAX_DELAY_MS;
             }
-            binary_file_len += data_read;
-            ESP_LOGD(TAG, "Written image length %d", binary_file_len);
+            ESP_LOGW(TAG, "Reconnecting in %u ms", delay_ms);
+            vTaskDelay(pdMS_TO_TICKS(delay_ms));
         }
     }
-    free(upgrade_data_buf);
-    http_cleanup(client); 
-    ESP_LOGD(TAG, "Total binary data length writen: %d", binary_file_len);
-    
-    esp_err_t ota_end_err = esp_ota_end(update_handle);
-    if (ota_write_err != ESP_OK) {
-        ESP_LOGE(TAG, "Error: esp_ota_write failed! err=0x%d", err);
-        return ota_write_err;
-    } else if (ota_end_err != ESP_OK) {
-        ESP_LOGE(TAG, "Error: esp_ota_end failed! err=0x%d. Image is invalid", ota_end_err);
-        return ota_end_err;
-    }
-
-    err = esp_ota_set_boot_partition(update_partition);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "esp_ota_set_boot_partition failed! err=0x%d", err);
-        return err;
+
+    if (err == ESP_OK && (err = ota_pipeline_flush(&dl)) == ESP_OK) {
+        ESP_LOGI(TAG, "Image of %u bytes received and written in %d ms", dl.written,
+                 (int)((esp_timer_get_time() - start_time) / 1000));
+        err = esp_ota_end(dl.update_handle);
+        dl.update_handle = 0;
+        /* Neither resuming nor trying again will turn an invalid image into a valid one */
+        resume_state_clear(&dl);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Error: esp_ota_end failed! err=0x%x. Image is invalid", err);
+            goto exit;
+        }
+        err = esp_ota_set_boot_partition(dl.partition);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "esp_ota_set_boot_partition failed! err=0x%x", err);
+            goto exit;
+        }
+        ESP_LOGI(TAG, "esp_ota_set_boot_partition succeeded");
     }
-    ESP_LOGI(TAG, "esp_ota_set_boot_partition succeeded"); 
 
-    return ESP_OK;
+exit:
+#ifdef CONFIG_OTA_PIPELINE
+    ota_pipeline_stop(&dl);
+#else
+    free(upgrade_data_buf);
+#endif
+    if (dl.update_handle) {
+        esp_ota_abort(dl.update_handle);
+    }
+    http_cleanup(dl.client);
+    return err;
 }
@@ -0,0 +1,245 @@
+// Copyright 2018 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <lwip/sockets.h>
+#include <esp_https_ota.h>
+#include <esp_ota_ops.h>
+#include <esp_timer.h>
+
+#include "unity.h"
+#include "test_utils.h"
+
+#if CONFIG_OTA_ALLOW_HTTP && CONFIG_OTA_RESUME_MAX_RETRIES > 0
+
+#define TEST_PORT           8070
+#define TEST_IMAGE_SIZE     (64 * 1024)
+/* Not a multiple of anything, so that the connection drops in the middle of sectors and buffers */
+#define TEST_DROP_EVERY     (10 * 1024 + 123)
+
+/* Stands in for the OTA server: serves image_size bytes with Range support, and
+ * closes the connection after drop_every bytes. The image is the beginning of
+ * the `source` partition, or a made up pattern if there is no source.
+ * Its ETag changes at the change_at-th connection, if set */
+typedef struct {
+    int image_size;
+    int drop_every;
+    const esp_partition_t *source;
+    int change_at;
+    int listen_fd;
+    int connections;
+    int range_requests;
+    int full_responses;
+    SemaphoreHandle_t done;
+} test_server_t;
+
+static void fill_image(const test_server_t *srv, unsigned offset, char *buf, int len)
+{
+    if (srv->source) {
+        esp_partition_read(srv->source, offset, buf, len);
+        return;
+    }
+    for (int i = 0; i < len; i++) {
+        buf[i] = offset + i == 0 ? 0xE9 : (offset + i) * 7;
+    }
+}
+
+static bool serve_one(int fd, test_server_t *srv)
+{
+    char buf[512];
+    int len = 0, ret;
+    unsigned offset = 0;
+
+    do {
+        ret = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (ret <= 0) {
+            return false;
+        }
+        len += ret;
+        buf[len] = 0;
+    } while (strstr(buf, "\r\n\r\n") == NULL && len < sizeof(buf) - 1);
+
+    char etag[16];
+    snprintf(etag, sizeof(etag), "\"v%d\"", srv->change_at && srv->connections >= srv->change_at);
+
+    char *range = strstr(buf, "Range: bytes=");
+    char *if_range = strstr(buf, "If-Range: ");
+    if (range) {
+        srv->range_requests++;
+    }
+    /* The Range only applies to the image the client has the beginning of */
+    if (range && (if_range == NULL || strncmp(if_range + strlen("If-Range: "), etag, strlen(etag)) == 0)) {
+        offset = strtoul(range + strlen("Range: bytes="), NULL, 10);
+        len = snprintf(buf, sizeof(buf), "HTTP/1.1 206 Partial Content\r\nContent-Length: %d\r\n"
+                       "Content-Range: bytes %u-%d/%d\r\nETag: %s\r\n\r\n",
+                       srv->image_size - offset, offset, srv->image_size - 1, srv->image_size, etag);
+    } else {
+        srv->full_responses++;
+        len = snprintf(buf, sizeof(buf), "HTTP/1.1 200 OK\r\nContent-Length: %d\r\nETag: %s\r\n\r\n",
+                       srv->image_size, etag);
+    }
+    send(fd, buf, len, 0);
+
+    unsigned end = srv->drop_every ? offset + srv->drop_every : srv->image_size;
+    if (end > srv->image_size) {
+        end = srv->image_size;
+    }
+    while (offset < end) {
+        len = end - offset > sizeof(buf) ? sizeof(buf) : end - offset;
+        fill_image(srv, offset, buf, len);
+        if (send(fd, buf, len, 0) != len) {
+            return false;
+        }
+        offset += len;
+    }
+    return end == srv->image_size;
+}
+
+static void test_server_task(void *arg)
+{
+    test_server_t *srv = (test_server_t *)arg;
+    bool complete = false;
+
+    while (!complete) {
+        int fd = accept(srv->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            break;
+        }
+        srv->connections++;
+        complete = serve_one(fd, srv);
+        close(fd);
+    }
+    xSemaphoreGive(srv->done);
+    vTaskDelete(NULL);
+}
+
+static void test_server_start(test_server_t *srv)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+
+    test_case_uses_tcpip();
+
+    srv->done = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(srv->done);
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT(srv->listen_fd >= 0);
+    TEST_ASSERT_EQUAL(0, bind(srv->listen_fd, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, listen(srv->listen_fd, 1));
+    xTaskCreate(test_server_task, "ota_server", 3072, srv, 5, NULL);
+}
+
+static void test_server_stop(test_server_t *srv)
+{
+    TEST_ASSERT(xSemaphoreTake(srv->done, 1000 / portTICK_PERIOD_MS) == pdTRUE);
+    close(srv->listen_fd);
+    vSemaphoreDelete(srv->done);
+}
+
+static const esp_http_client_config_t test_config = {
+    .url = "http://127.0.0.1:8070/image.bin",
+};
+
+/* Every byte landed at its place, whichever connection brought it */
+static void test_check_image(const test_server_t *srv)
+{
+    const esp_partition_t *target = esp_ota_get_next_update_partition(NULL);
+    uint8_t *expected = malloc(1024);
+    uint8_t *actual = malloc(1024);
+    TEST_ASSERT_NOT_NULL(expected);
+    TEST_ASSERT_NOT_NULL(actual);
+    for (int offset = 0; offset < srv->image_size; offset += 1024) {
+        TEST_ESP_OK(esp_partition_read(srv->source, offset, expected, 1024));
+        TEST_ESP_OK(esp_partition_read(target, offset, actual, 1024));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, actual, 1024);
+    }
+    free(expected);
+    free(actual);
+}
+
+TEST_CASE("esp_https_ota resumes the download after the connection is lost", "[esp_https_ota]")
+{
+    test_server_t srv = {
+        .image_size = TEST_IMAGE_SIZE,
+        .drop_every = TEST_DROP_EVERY,
+        .source = esp_ota_get_running_partition(),
+    };
+
+    test_server_start(&srv);
+    /* The served image is truncated, so only the transfer can succeed, not the validation */
+    TEST_ASSERT_EQUAL_HEX(ESP_ERR_OTA_VALIDATE_FAILED, esp_https_ota(&test_config));
+    test_server_stop(&srv);
+
+    TEST_ASSERT_EQUAL((TEST_IMAGE_SIZE + TEST_DROP_EVERY - 1) / TEST_DROP_EVERY, srv.connections);
+    TEST_ASSERT_EQUAL(srv.connections - 1, srv.range_requests);
+    TEST_ASSERT_EQUAL(1, srv.full_responses);
+    test_check_image(&srv);
+}
+
+TEST_CASE("esp_https_ota starts over when the image changed on the server", "[esp_https_ota]")
+{
+    test_server_t srv = {
+        .image_size = TEST_IMAGE_SIZE,
+        .drop_every = TEST_DROP_EVERY,
+        .source = esp_ota_get_running_partition(),
+        .change_at = 2,
+    };
+
+    test_server_start(&srv);
+    TEST_ASSERT_EQUAL_HEX(ESP_ERR_OTA_VALIDATE_FAILED, esp_https_ota(&test_config));
+    test_server_stop(&srv);
+
+    /* The first resume gets the whole new image instead, then the download starts over */
+    TEST_ASSERT_EQUAL(2 + (TEST_IMAGE_SIZE + TEST_DROP_EVERY - 1) / TEST_DROP_EVERY, srv.connections);
+    TEST_ASSERT_EQUAL(3, srv.full_responses);
+    TEST_ASSERT_EQUAL(srv.connections - 2, srv.range_requests);
+    test_check_image(&srv);
+}
+
+TEST_CASE("esp_https_ota time to download and write 1 MB", "[esp_https_ota][timeout=120]")
+{
+    const esp_partition_t *target = esp_ota_get_next_update_partition(NULL);
+    test_server_t srv = {
+        .image_size = 1024 * 1024,
+    };
+
+    TEST_ASSERT_NOT_NULL(target);
+    if (srv.image_size > target->size) {
+        srv.image_size = target->size;
+    }
+
+    test_server_start(&srv);
+    int64_t start = esp_timer_get_time();
+    TEST_ASSERT_EQUAL_HEX(ESP_ERR_OTA_VALIDATE_FAILED, esp_https_ota(&test_config));
+    int64_t end = esp_timer_get_time();
+    test_server_stop(&srv);
+
+#ifdef CONFIG_OTA_PIPELINE
+    const char *name = "OTA_PIPELINE_TIME";
+#else
+    const char *name = "OTA_TIME";
+#endif
+    printf("%d KB image\n", srv.image_size / 1024);
+    IDF_LOG_PERFORMANCE(name, "%d ms", (int)((end - start) / 1000));
+}
+
+#endif
@@ -52,7 +52,19 @@ typedef enum {
 	 * sequence of byte and any number of bytes can be sent or retrieved each
 	 * time.
 	 */
-	RINGBUF_TYPE_BYTEBUF
+	RINGBUF_TYPE_BYTEBUF,
+	/**
+	 * Single-producer/single-consumer buffers store items like no-split buffers,
+	 * but take no critical section and no semaphore: only one task or ISR may
+	 * send to the buffer and only one other task or ISR may receive from it.
+	 * A receiving or sending task blocked on the buffer is woken up by a task
+	 * notification, its notification value is used. Items must be returned in
+	 * the order they were retrieved. Only xRingbufferSend(), xRingbufferReceive(),
+	 * xRingbufferReceiveBatch(), vRingbufferReturnItem(), vRingbufferReturnBatch(),
+	 * their FromISR variants and the size and info functions are supported. The
+	 * number of items waiting is not tracked.
+	 */
+	RINGBUF_TYPE_SPSC
 } ringbuf_type_t;
 
 /**
@@ -125,6 +137,76 @@ BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer, const void *pvItem, size
  */
 BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer, const void *pvItem, size_t xItemSize, BaseType_t *pxHigherPriorityTaskWoken);
 
+/**
+ * @brief       Acquire space for an item in the ring buffer
+ *
+ * Attempt to reserve space for an item in a no-split/allow-split ring buffer
+ * so the item can be written in place instead of being copied by
+ * xRingbufferSend(). This function will block until enough free space is
+ * available or until it timesout. The item is never split: when it does not
+ * fit before the end of the buffer, it is placed at its start.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to insert the item into
+ * @param[out]  ppvItem         Set to the space acquired for the item, NULL on failure
+ * @param[in]   xItemSize       Size of the item
+ * @param[in]   xTicksToWait    Ticks to wait for room in the ring buffer.
+ *
+ * @note    A call to xRingbufferSendComplete() is required once the item is written.
+ *          Items sent after this one can't be retrieved until it is completed.
+ * @note    Byte buffers are not supported.
+ * @note    The item can be at most as large as the maximum item size of a no-split ring buffer of the same size.
+ *
+ * @return
+ *      - pdTRUE if succeeded
+ *      - pdFALSE on time-out or when the item is larger than the maximum permissible size of the buffer
+ */
+BaseType_t xRingbufferSendAcquire(RingbufHandle_t xRingbuffer, void **ppvItem, size_t xItemSize, TickType_t xTicksToWait);
+
+/**
+ * @brief       Acquire space for an item in the ring buffer in an ISR
+ *
+ * Attempt to reserve space for an item from an ISR. This function will return
+ * immediately if there is insufficient free space in the buffer.
+ *
+ * @param[in]   xRingbuffer Ring buffer to insert the item into
+ * @param[out]  ppvItem     Set to the space acquired for the item, NULL on failure
+ * @param[in]   xItemSize   Size of the item
+ * @param[out]  pxHigherPriorityTaskWoken   Value pointed to will be set to pdTRUE if the function woke up a higher priority task.
+ *
+ * @note    A call to xRingbufferSendCompleteFromISR() is required once the item is written.
+ *
+ * @return
+ *      - pdTRUE if succeeded
+ *      - pdFALSE when the ring buffer does not have space.
+ */
+BaseType_t xRingbufferSendAcquireFromISR(RingbufHandle_t xRingbuffer, void **ppvItem, size_t xItemSize, BaseType_t *pxHigherPriorityTaskWoken);
+
+/**
+ * @brief       Complete an item acquired with xRingbufferSendAcquire()
+ *
+ * The item becomes available for retrieval once the items acquired before it
+ * are completed too.
+ *
+ * @param[in]   xRingbuffer Ring buffer the item was acquired from
+ * @param[in]   pvItem      Item written, as set by xRingbufferSendAcquire()
+ *
+ * @return
+ *      - pdTRUE if succeeded
+ */
+BaseType_t xRingbufferSendComplete(RingbufHandle_t xRingbuffer, void *pvItem);
+
+/**
+ * @brief       Complete an item acquired with xRingbufferSendAcquireFromISR() in an ISR
+ *
+ * @param[in]   xRingbuffer Ring buffer the item was acquired from
+ * @param[in]   pvItem      Item written, as set by xRingbufferSendAcquireFromISR()
+ * @param[out]  pxHigherPriorityTaskWoken   Value pointed to will be set to pdTRUE if the function woke up a higher priority task.
+ *
+ * @return
+ *      - pdTRUE if succeeded
+ */
+BaseType_t xRingbufferSendCompleteFromISR(RingbufHandle_t xRingbuffer, void *pvItem, BaseType_t *pxHigherPriorityTaskWoken);
+
 /**
  * @brief   Retrieve an item from the ring buffer
  *
@@ -255,6 +337,43 @@ void *xRingbufferReceiveUpTo(RingbufHandle_t xRingbuffer, size_t *pxItemSize, Ti
  */
 void *xRingbufferReceiveUpToFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemSize, size_t xMaxSize);
 
+/**
+ * @brief   Retrieve several items from the ring buffer at once
+ *
+ * Attempt to retrieve up to uxMaxItems items from a no-split or SPSC ring buffer
+ * in a single critical section. This function will block until at least one
+ * item is available or until it timesout, then returns the items available
+ * without blocking any further.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to retrieve the items from
+ * @param[out]  ppvItems        Array filled with the pointers to the retrieved items, in order
+ * @param[out]  pxItemSizes     Array filled with the sizes of the retrieved items, can be NULL
+ * @param[in]   uxMaxItems      Size of the arrays
+ * @param[in]   xTicksToWait    Ticks to wait for items in the ring buffer.
+ *
+ * @note    A call to vRingbufferReturnBatch() or vRingbufferReturnItem() is required after this to free the items retrieved.
+ * @note    Allow-split and byte buffers are not supported.
+ *
+ * @return  Number of items retrieved, 0 on timeout
+ */
+UBaseType_t xRingbufferReceiveBatch(RingbufHandle_t xRingbuffer, void **ppvItems, size_t *pxItemSizes, UBaseType_t uxMaxItems, TickType_t xTicksToWait);
+
+/**
+ * @brief   Retrieve several items from the ring buffer at once in an ISR
+ *
+ * This function returns immediately if there are no items available for retrieval.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to retrieve the items from
+ * @param[out]  ppvItems        Array filled with the pointers to the retrieved items, in order
+ * @param[out]  pxItemSizes     Array filled with the sizes of the retrieved items, can be NULL
+ * @param[in]   uxMaxItems      Size of the arrays
+ *
+ * @note    A call to vRingbufferReturnBatchFromISR() or vRingbufferReturnItemFromISR() is required after this to free the items retrieved.
+ *
+ * @return  Number of items retrieved
+ */
+UBaseType_t xRingbufferReceiveBatchFromISR(RingbufHandle_t xRingbuffer, void **ppvItems, size_t *pxItemSizes, UBaseType_t uxMaxItems);
+
 /**
  * @brief   Return a previously-retrieved item to the ring buffer
  *
@@ -277,6 +396,26 @@ void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem);
  */
 void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, BaseType_t *pxHigherPriorityTaskWoken);
 
+/**
+ * @brief   Return several previously-retrieved items to the ring buffer at once
+ *
+ * @param[in]   xRingbuffer Ring buffer the items were retrieved from
+ * @param[in]   ppvItems    Items that were received earlier, in the order they were received for SPSC buffers
+ * @param[in]   uxItems     Number of items
+ */
+void vRingbufferReturnBatch(RingbufHandle_t xRingbuffer, void **ppvItems, UBaseType_t uxItems);
+
+/**
+ * @brief   Return several previously-retrieved items to the ring buffer at once from an ISR
+ *
+ * @param[in]   xRingbuffer Ring buffer the items were retrieved from
+ * @param[in]   ppvItems    Items that were received earlier, in the order they were received for SPSC buffers
+ * @param[in]   uxItems     Number of items
+ * @param[out]  pxHigherPriorityTaskWoken   Value pointed to will be set to pdTRUE
+ *                                          if the function woke up a higher priority task.
+ */
+void vRingbufferReturnBatchFromISR(RingbufHandle_t xRingbuffer, void **ppvItems, UBaseType_t uxItems, BaseType_t *pxHigherPriorityTaskWoken);
+
 /**
  * @brief   Delete a ring buffer
  *
@@ -28,11 +28,13 @@
 #define rbALLOW_SPLIT_FLAG          ( ( UBaseType_t ) 1 )   //The ring buffer allows items to be split
 #define rbBYTE_BUFFER_FLAG          ( ( UBaseType_t ) 2 )   //The ring buffer is a byte buffer
 #define rbBUFFER_FULL_FLAG          ( ( UBaseType_t ) 4 )   //The ring buffer is currently full (write pointer == free pointer)
+#define rbSPSC_FLAG                 ( ( UBaseType_t ) 8 )   //The ring buffer has a single sender and a single receiver and is lock-free
 
 //Item flags
 #define rbITEM_FREE_FLAG            ( ( UBaseType_t ) 1 )   //Item has been retrieved and returned by application, free to overwrite
 #define rbITEM_DUMMY_DATA_FLAG      ( ( UBaseType_t ) 2 )   //Data from here to end of the ring buffer is dummy data. Restart reading at start of head of the buffer
 #define rbITEM_SPLIT_FLAG           ( ( UBaseType_t ) 4 )   //Valid for RINGBUF_TYPE_ALLOWSPLIT, indicating that rest of the data is wrapped around
+#define rbITEM_ACQUIRED_FLAG        ( ( UBaseType_t ) 8 )   //Item space has been acquired by a sender that has yet to complete it. Items from here on can't be read
 
 typedef struct {
     //This size of this structure must be 32-bit aligned
@@ -69,6 +71,9 @@ struct Ringbuffer_t {
     BaseType_t xItemsWaiting;                   //Number of items/bytes(for byte buffers) currently in ring buffer that have not yet been read
     SemaphoreHandle_t xFreeSpaceSemaphore;      //Binary semaphore, wakes up writing threads when more free space becomes available or when another thread times out attempting to write
     SemaphoreHandle_t xItemsBufferedSemaphore;  //Binary semaphore, indicates there are new packets in the circular buffer. See remark.
+
+    TaskHandle_t xSpscReceiver;                 //SPSC buffers only, task waiting for an item to be sent
+    TaskHandle_t xSpscSender;                   //SPSC buffers only, task waiting for an item to be returned
 };
 
 /*
@@ -97,6 +102,12 @@ static BaseType_t prvCheckItemFitsDefault( Ringbuffer_t *pxRingbuffer, size_t xI
 //Checks if an item will currently fit in a byte buffer
 static BaseType_t prvCheckItemFitsByteBuffer( Ringbuffer_t *pxRingbuffer, size_t xItemSize);
 
+//Checks if an item will currently fit in a no-split/allow-split ring buffer without being split
+static BaseType_t prvCheckItemFitsContiguous( Ringbuffer_t *pxRingbuffer, size_t xItemSize);
+
+//Writes an item header with uxItemFlags and reserves the space of the item. Only call this function after calling prvCheckItemFitsContiguous()
+static uint8_t *prvAcquireItem(Ringbuffer_t *pxRingbuffer, size_t xItemSize, UBaseType_t uxItemFlags);
+
 //Copies an item to a no-split ring buffer. Only call this function after calling prvCheckItemFitsDefault()
 static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
 
@@ -118,6 +129,9 @@ static void prvReturnItemDefault(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
 //Return data to a byte buffer
 static void prvReturnItemByteBuf(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
 
+//Mark an item acquired in a no-split/allow-split ring buffer as written, making it available for retrieval
+static void prvCompleteItem(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
+
 //Get the maximum size an item that can currently have if sent to a no-split ring buffer
 static size_t prvGetCurMaxSizeNoSplit(Ringbuffer_t *pxRingbuffer);
 
@@ -138,6 +152,32 @@ static BaseType_t prvReceiveGeneric(Ringbuffer_t *pxRingbuffer, void **pvItem1,
 //Generic function used to retrieve an item/data from ring buffers in an ISR
 static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer, void **pvItem1, void **pvItem2, size_t *xItemSize1, size_t *xItemSize2, size_t xMaxSize);
 
+//Retrieves up to uxMaxItems items from a no-split ring buffer, returns the number of items retrieved
+static UBaseType_t prvGetItemBatch(Ringbuffer_t *pxRingbuffer, void **ppvItems, size_t *pxItemSizes, UBaseType_t uxMaxItems);
+
+/*
+ * The following functions are used by SPSC ring buffers instead of the ones above.
+ * They are called without any critical section, from the sender or the receiver only.
+ */
+
+//Sends an item to a SPSC ring buffer if it fits. Only call this function from the sender
+static BaseType_t prvSpscSendItem(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
+
+//Retrieves the next item of a SPSC ring buffer, NULL if there is none. Only call this function from the receiver
+static uint8_t *prvSpscReceiveItem(Ringbuffer_t *pxRingbuffer, size_t *pxItemSize);
+
+//Returns an item to a SPSC ring buffer. Only call this function from the receiver
+static void prvSpscReturnItem(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
+
+//Retrieves up to uxMaxItems items from a SPSC ring buffer. Only call this function from the receiver
+static UBaseType_t prvSpscReceiveBatch(Ringbuffer_t *pxRingbuffer, void **ppvItems, size_t *pxItemSizes, UBaseType_t uxMaxItems);
+
+//Notifies the task waiting on the other side of a SPSC ring buffer, if any
+static void prvSpscWake(TaskHandle_t *pxTask, BaseType_t xFromISR, BaseType_t *pxHigherPriorityTaskWoken);
+
+//Get the maximum size an item that can currently have if sent to a SPSC ring buffer
+static size_t prvGetCurMaxSizeSpsc(Ringbuffer_t *pxRingbuffer);
+
 /* ------------------------------------------------ Static Definitions ------------------------------------------- */
 
 static size_t prvGetFreeSize(Ringbuffer_t *pxRingbuffer)
@@ -202,12 +242,34 @@ static BaseType_t prvCheckItemFitsByteBuffer( Ringbuffer_t *pxRingbuffer, size_t
     return (xItemSize <= pxRingbuffer->xSize - (pxRingbuffer->pucWrite - pxRingbuffer->pucFree)) ? pdTRUE : pdFALSE;
 }
 
-static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+static BaseType_t prvCheckItemFitsContiguous( Ringbuffer_t *pxRingbuffer, size_t xItemSize)
+{
+    //Check arguments and buffer state
+    configASSERT(rbCHECK_ALIGNED(pxRingbuffer->pucWrite));              //pucWrite is always aligned in no-split/allow-split ring buffers
+    configASSERT(pxRingbuffer->pucWrite >= pxRingbuffer->pucHead && pxRingbuffer->pucWrite < pxRingbuffer->pucTail);    //Check write pointer is within bounds
+
+    size_t xTotalItemSize = rbALIGN_SIZE(xItemSize) + rbHEADER_SIZE;    //Rounded up aligned item size with header
+    if (pxRingbuffer->pucWrite == pxRingbuffer->pucFree) {
+        //Buffer is either complete empty or completely full
+        return (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG) ? pdFALSE : pdTRUE;
+    }
+    if (pxRingbuffer->pucFree > pxRingbuffer->pucWrite) {
+        //Free space does not wrap around
+        return (xTotalItemSize <= pxRingbuffer->pucFree - pxRingbuffer->pucWrite) ? pdTRUE : pdFALSE;
+    }
+    //Free space wraps around, item must fit either before the tail or after the head
+    if (xTotalItemSize <= pxRingbuffer->pucTail - pxRingbuffer->pucWrite) {
+        return pdTRUE;
+    }
+    return (xTotalItemSize <= pxRingbuffer->pucFree - pxRingbuffer->pucHead) ? pdTRUE : pdFALSE;
+}
+
+static uint8_t *prvAcquireItem(Ringbuffer_t *pxRingbuffer, size_t xItemSize, UBaseType_t uxItemFlags)
 {
     //Check arguments and buffer state
     size_t xAlignedItemSize = rbALIGN_SIZE(xItemSize);                  //Rounded up aligned item size
     size_t xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucWrite;    //Length from pucWrite until end of buffer
-    configASSERT(rbCHECK_ALIGNED(pxRingbuffer->pucWrite));              //pucWrite is always aligned in no-split ring buffers
+    configASSERT(rbCHECK_ALIGNED(pxRingbuffer->pucWrite));              //pucWrite is always aligned in no-split/allow-split ring buffers
     configASSERT(pxRingbuffer->pucWrite >= pxRingbuffer->pucHead && pxRingbuffer->pucWrite < pxRingbuffer->pucTail);    //Check write pointer is within bounds
     configASSERT(xRemLen >= rbHEADER_SIZE);                             //Remaining length must be able to at least fit an item header
 
@@ -219,14 +281,12 @@ static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucIte
         pxRingbuffer->pucWrite = pxRingbuffer->pucHead;     //Reset write pointer to wrap around
     }
 
-    //Item should be guaranteed to fit at this point. Set item header and copy data
+    //Item should be guaranteed to fit at this point. Set item header and reserve the data
     ItemHeader_t *pxHeader = (ItemHeader_t *)pxRingbuffer->pucWrite;
     pxHeader->xItemLen = xItemSize;
-    pxHeader->uxItemFlags = 0;
-    pxRingbuffer->pucWrite += rbHEADER_SIZE;    //Advance pucWrite past header
-    memcpy(pxRingbuffer->pucWrite, pucItem, xItemSize);
-    pxRingbuffer->xItemsWaiting++;
-    pxRingbuffer->pucWrite += xAlignedItemSize; //Advance pucWrite past item to next aligned address
+    pxHeader->uxItemFlags = uxItemFlags;
+    uint8_t *pucData = pxRingbuffer->pucWrite + rbHEADER_SIZE;
+    pxRingbuffer->pucWrite = pucData + xAlignedItemSize;    //Advance pucWrite past header and item to next aligned address
 
     //If current remaining length can't fit a header, wrap around write pointer
     if (pxRingbuffer->pucTail - pxRingbuffer->pucWrite < rbHEADER_SIZE) {
@@ -237,6 +297,15 @@ static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucIte
         //Mark the buffer as full to distinguish with an empty buffer
         pxRingbuffer->uxRingbufferFlags |= rbBUFFER_FULL_FLAG;
     }
+    return pucData;
+}
+
+static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+{
+    //No-split items are always contiguous, copy the item into the space reserved for it
+    uint8_t *pucData = prvAcquireItem(pxRingbuffer, xItemSize, 0);
+    memcpy(pucData, pucItem, xItemSize);
+    pxRingbuffer->xItemsWaiting++;
 }
 
 static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
@@ -327,6 +396,16 @@ static BaseType_t prvCheckItemAvail(Ringbuffer_t *pxRingbuffer)
         return pdFALSE;     //Byte buffers do not allow multiple retrievals before return
     }
     if ((pxRingbuffer->xItemsWaiting > 0) && ((pxRingbuffer->pucRead != pxRingbuffer->pucWrite) || (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG))) {
+        if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) == 0) {
+            //Items are read in order, the next one may still be written in place by its sender
+            ItemHeader_t *pxHeader = (ItemHeader_t *)pxRingbuffer->pucRead;
+            if (pxHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG) {
+                pxHeader = (ItemHeader_t *)pxRingbuffer->pucHead;
+            }
+            if (pxHeader->uxItemFlags & rbITEM_ACQUIRED_FLAG) {
+                return pdFALSE;
+            }
+        }
         return pdTRUE;      //Items/data available for retrieval
     } else {
         return pdFALSE;     //No items/data available for retrieval
@@ -474,6 +553,19 @@ static void prvReturnItemByteBuf(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
     }
 }
 
+static void prvCompleteItem(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
+{
+    //Check arguments and buffer state
+    configASSERT(rbCHECK_ALIGNED(pucItem));
+    configASSERT(pucItem >= pxRingbuffer->pucHead + rbHEADER_SIZE);
+    configASSERT(pucItem <= pxRingbuffer->pucTail);     //Inclusive of pucTail in the case of zero length item at the very end
+
+    ItemHeader_t *pxHeader = (ItemHeader_t *)(pucItem - rbHEADER_SIZE);
+    configASSERT(pxHeader->uxItemFlags & rbITEM_ACQUIRED_FLAG);     //Indicates item was never acquired or has already been completed
+    pxHeader->uxItemFlags &= ~rbITEM_ACQUIRED_FLAG;
+    pxRingbuffer->xItemsWaiting++;
+}
+
 static size_t prvGetCurMaxSizeNoSplit(Ringbuffer_t *pxRingbuffer)
 {
     BaseType_t xFreeSize;
@@ -650,6 +742,223 @@ static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer, void **pv
     return xReturn;
 }
 
+static UBaseType_t prvGetItemBatch(Ringbuffer_t *pxRingbuffer, void **ppvItems, size_t *pxItemSizes, UBaseType_t uxMaxItems)
+{
+    UBaseType_t uxItems = 0;
+    while (uxItems < uxMaxItems && prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
+        BaseType_t xIsSplit;
+        size_t xItemSize;
+        //Third argument (xMaxSize) is unused for no-split buffers
+        ppvItems[uxItems] = pxRingbuffer->pvGetItem(pxRingbuffer, &xIsSplit, 0, &xItemSize);
+        if (pxItemSizes != NULL) {
+            pxItemSizes[uxItems] = xItemSize;
+        }
+        uxItems++;
+    }
+    return uxItems;
+}
+
+/* ------------------------------------------- SPSC Static Definitions ------------------------------------------- */
+/*
+ * SPSC ring buffers store items like no-split buffers do, but do not use critical
+ * sections nor semaphores. pucWrite is only written by the sender and pucFree only
+ * by the receiver, each of them loads the pointer of the other side atomically.
+ * pucRead is private to the receiver. pucWrite never catches up with pucFree, so
+ * the buffer is empty when they are equal and no full flag is needed. A task
+ * blocked on one side registers itself and is woken up by a task notification
+ * from the other side.
+ */
+#define rbSPSC_LOAD( xVar )             __atomic_load_n( &( xVar ), __ATOMIC_ACQUIRE )
+#define rbSPSC_STORE( xVar, xValue )    __atomic_store_n( &( xVar ), ( xValue ), __ATOMIC_RELEASE )
+#define rbSPSC_FENCE()                  __atomic_thread_fence( __ATOMIC_SEQ_CST )
+
+//Pointer to the item following the one at pucItem
+static inline uint8_t *prvSpscNext(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem, size_t xItemSize)
+{
+    uint8_t *pucNext = pucItem + rbHEADER_SIZE + rbALIGN_SIZE(xItemSize);
+    //If remaining length can't fit a header, wrap around
+    if (pxRingbuffer->pucTail - pucNext < rbHEADER_SIZE) {
+        pucNext = pxRingbuffer->pucHead;
+    }
+    return pucNext;
+}
+
+static BaseType_t prvSpscSendItem(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+{
+    uint8_t *pucWrite = pxRingbuffer->pucWrite;
+    uint8_t *pucFree = rbSPSC_LOAD(pxRingbuffer->pucFree);
+    size_t xTotalItemSize = rbALIGN_SIZE(xItemSize) + rbHEADER_SIZE;    //Rounded up aligned item size with header
+    ItemHeader_t *pxHeader = (ItemHeader_t *)pucWrite;
+    uint8_t *pucNext;
+
+    if (pucWrite >= pucFree && xTotalItemSize > pxRingbuffer->pucTail - pucWrite) {
+        //Item does not fit before the tail, it must fit after the head without reaching pucFree
+        if (xTotalItemSize >= pucFree - pxRingbuffer->pucHead) {
+            return pdFALSE;
+        }
+        pxHeader->uxItemFlags = rbITEM_DUMMY_DATA_FLAG;     //Set remaining length as dummy data
+        pxHeader->xItemLen = 0;                             //Dummy data should have no length
+        pxHeader = (ItemHeader_t *)pxRingbuffer->pucHead;
+        pucNext = pxRingbuffer->pucHead + xTotalItemSize;
+    } else {
+        pucNext = prvSpscNext(pxRingbuffer, pucWrite, xItemSize);
+        if (pucWrite < pucFree ? xTotalItemSize >= pucFree - pucWrite : pucNext == pucFree) {
+            return pdFALSE;     //pucWrite would catch up with pucFree
+        }
+    }
+
+    //Write the item, then publish it by moving pucWrite past it
+    pxHeader->xItemLen = xItemSize;
+    pxHeader->uxItemFlags = 0;
+    memcpy((uint8_t *)pxHeader + rbHEADER_SIZE, pucItem, xItemSize);
+    rbSPSC_STORE(pxRingbuffer->pucWrite, pucNext);
+    return pdTRUE;
+}
+
+static uint8_t *prvSpscReceiveItem(Ringbuffer_t *pxRingbuffer, size_t *pxItemSize)
+{
+    uint8_t *pucRead = pxRingbuffer->pucRead;
+    if (pucRead == rbSPSC_LOAD(pxRingbuffer->pucWrite)) {
+        return NULL;    //No items available for retrieval
+    }
+
+    ItemHeader_t *pxHeader = (ItemHeader_t *)pucRead;
+    //Wrap around if dummy data
+    if (pxHeader->uxItemFlags & rbITEM_DUMMY_DATA_FLAG) {
+        pucRead = pxRingbuffer->pucHead;
+        pxHeader = (ItemHeader_t *)pucRead;
+    }
+    configASSERT(pxHeader->xItemLen <= pxRingbuffer->xMaxItemSize);
+    *pxItemSize = pxHeader->xItemLen;
+    pxRingbuffer->pucRead = prvSpscNext(pxRingbuffer, pucRead, pxHeader->xItemLen);
+    return pucRead + rbHEADER_SIZE;
+}
+
+static void prvSpscReturnItem(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
+{
+    ItemHeader_t *pxHeader = (ItemHeader_t *)(pucItem - rbHEADER_SIZE);
+    uint8_t *pucFree = pxRingbuffer->pucFree;
+
+    //Items must be returned in the order they were retrieved
+    configASSERT((uint8_t *)pxHeader == pucFree ||
+                 ((uint8_t *)pxHeader == pxRingbuffer->pucHead && (((ItemHeader_t *)pucFree)->uxItemFlags & rbITEM_DUMMY_DATA_FLAG)));
+    configASSERT(pxHeader->xItemLen <= pxRingbuffer->xMaxItemSize);
+    rbSPSC_STORE(pxRingbuffer->pucFree, prvSpscNext(pxRingbuffer, (uint8_t *)pxHeader, pxHeader->xItemLen));
+}
+
+static UBaseType_t prvSpscReceiveBatch(Ringbuffer_t *pxRingbuffer, void **ppvItems, size_t *pxItemSizes, UBaseType_t uxMaxItems)
+{
+    UBaseType_t uxItems = 0;
+    size_t xItemSize;
+    while (uxItems < uxMaxItems && (ppvItems[uxItems] = prvSpscReceiveItem(pxRingbuffer, &xItemSize)) != NULL) {
+        if (pxItemSizes != NULL) {
+            pxItemSizes[uxItems] = xItemSize;
+        }
+        uxItems++;
+    }
+    return uxItems;
+}
+
+static void prvSpscWake(TaskHandle_t *pxTask, BaseType_t xFromISR, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    //Pairs with the fence of the waiting task, between registering itself and checking the buffer again
+    rbSPSC_FENCE();
+    TaskHandle_t xTask = rbSPSC_LOAD(*pxTask);
+    if (xTask != NULL) {
+        if (xFromISR == pdTRUE) {
+            vTaskNotifyGiveFromISR(xTask, pxHigherPriorityTaskWoken);
+        } else {
+            xTaskNotifyGive(xTask);
+        }
+    }
+}
+
+static BaseType_t prvSpscSend(Ringbuffer_t *pxRingbuffer, const void *pvItem, size_t xItemSize, TickType_t xTicksToWait)
+{
+    BaseType_t xReturn;
+    BaseType_t xWaiting = pdFALSE;
+    TickType_t xTicksEnd = xTaskGetTickCount() + xTicksToWait;
+    TickType_t xTicksRemaining = xTicksToWait;
+    while ((xReturn = prvSpscSendItem(pxRingbuffer, pvItem, xItemSize)) != pdTRUE &&
+           xTicksRemaining != 0 && xTicksRemaining <= xTicksToWait) {   //xTicksToWait will underflow once xTaskGetTickCount() > ticks_end
+        //Register as waiting, then check again in case an item was returned in the meantime
+        rbSPSC_STORE(pxRingbuffer->xSpscSender, xTaskGetCurrentTaskHandle());
+        rbSPSC_FENCE();
+        xWaiting = pdTRUE;
+        if ((xReturn = prvSpscSendItem(pxRingbuffer, pvItem, xItemSize)) == pdTRUE) {
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, xTicksRemaining);
+        if (xTicksToWait != portMAX_DELAY) {
+            xTicksRemaining = xTicksEnd - xTaskGetTickCount();
+        }
+    }
+    if (xWaiting == pdTRUE) {
+        rbSPSC_STORE(pxRingbuffer->xSpscSender, NULL);
+    }
+
+    if (xReturn == pdTRUE) {
+        prvSpscWake(&pxRingbuffer->xSpscReceiver, pdFALSE, NULL);
+    }
+    return xReturn;
+}
+
+static void *prvSpscReceive(Ringbuffer_t *pxRingbuffer, size_t *pxItemSize, TickType_t xTicksToWait)
+{
+    uint8_t *pucItem;
+    BaseType_t xWaiting = pdFALSE;
+    TickType_t xTicksEnd = xTaskGetTickCount() + xTicksToWait;
+    TickType_t xTicksRemaining = xTicksToWait;
+    while ((pucItem = prvSpscReceiveItem(pxRingbuffer, pxItemSize)) == NULL &&
+           xTicksRemaining != 0 && xTicksRemaining <= xTicksToWait) {   //xTicksToWait will underflow once xTaskGetTickCount() > ticks_end
+        //Register as waiting, then check again in case an item was sent in the meantime
+        rbSPSC_STORE(pxRingbuffer->xSpscReceiver, xTaskGetCurrentTaskHandle());
+        rbSPSC_FENCE();
+        xWaiting = pdTRUE;
+        if ((pucItem = prvSpscReceiveItem(pxRingbuffer, pxItemSize)) != NULL) {
+            break;
+        }
+        ulTaskNotifyTake(pdTRUE, xTicksRemaining);
+        if (xTicksToWait != portMAX_DELAY) {
+            xTicksRemaining = xTicksEnd - xTaskGetTickCount();
+        }
+    }
+    if (xWaiting == pdTRUE) {
+        rbSPSC_STORE(pxRingbuffer->xSpscReceiver, NULL);
+    }
+    return pucItem;
+}
+
+static size_t prvGetCurMaxSizeSpsc(Ringbuffer_t *pxRingbuffer)
+{
+    uint8_t *pucWrite = rbSPSC_LOAD(pxRingbuffer->pucWrite);
+    uint8_t *pucFree = rbSPSC_LOAD(pxRingbuffer->pucFree);
+    BaseType_t xFreeSize;
+
+    //pucWrite must stay at least one aligned unit away from pucFree
+    if (pucWrite < pucFree) {
+        xFreeSize = (pucFree - pucWrite) - (portBYTE_ALIGNMENT_MASK + 1);
+    } else {
+        //Select largest contiguous free space as items are never split
+        BaseType_t xSize1 = pxRingbuffer->pucTail - pucWrite;
+        BaseType_t xSize2 = (pucFree - pxRingbuffer->pucHead) - (portBYTE_ALIGNMENT_MASK + 1);
+        if (pucFree == pxRingbuffer->pucHead) {
+            xSize1 -= rbHEADER_SIZE;    //pucWrite would wrap around to pucFree
+        }
+        xFreeSize = (xSize1 > xSize2) ? xSize1 : xSize2;
+    }
+
+    //Items need space for a header
+    xFreeSize -= rbHEADER_SIZE;
+    //Limit free size to be within bounds
+    if (xFreeSize > (BaseType_t)pxRingbuffer->xMaxItemSize) {
+        xFreeSize = pxRingbuffer->xMaxItemSize;
+    } else if (xFreeSize < 0) {
+        xFreeSize = 0;
+    }
+    return xFreeSize;
+}
+
 /* ------------------------------------------------- Public Definitions -------------------------------------------- */
 
 RingbufHandle_t xRingbufferCreate(size_t xBufferSize, ringbuf_type_t xBufferType)
@@ -674,8 +983,6 @@ RingbufHandle_t xRingbufferCreate(size_t xBufferSize, ringbuf_type_t xBufferType
     pxRingbuffer->pucRead = pxRingbuffer->pucHead;
     pxRingbuffer->pucWrite = pxRingbuffer->pucHead;
     pxRingbuffer->xItemsWaiting = 0;
-    pxRingbuffer->xFreeSpaceSemaphore = xSemaphoreCreateBinary();
-    pxRingbuffer->xItemsBufferedSemaphore = xSemaphoreCreateBinary();
     pxRingbuffer->uxRingbufferFlags = 0;
 
     //Initialize type dependent values and function pointers
@@ -709,11 +1016,20 @@ RingbufHandle_t xRingbufferCreate(size_t xBufferSize, ringbuf_type_t xBufferType
         //Byte buffers do not incur any overhead
         pxRingbuffer->xMaxItemSize = pxRingbuffer->xSize;
         pxRingbuffer->xGetCurMaxSize = prvGetCurMaxSizeByteBuf;
+    } else if (xBufferType == RINGBUF_TYPE_SPSC) {
+        pxRingbuffer->uxRingbufferFlags |= rbSPSC_FLAG;
+        //Items are stored like in no-split buffers. The other functions are not used
+        pxRingbuffer->xMaxItemSize = rbALIGN_SIZE(pxRingbuffer->xSize / 2) - rbHEADER_SIZE;
+        pxRingbuffer->xGetCurMaxSize = prvGetCurMaxSizeSpsc;
+        //SPSC buffers do not use semaphores
+        return (RingbufHandle_t)pxRingbuffer;
     } else {
         //Unsupported type
         configASSERT(0);
     }
 
+    pxRingbuffer->xFreeSpaceSemaphore = xSemaphoreCreateBinary();
+    pxRingbuffer->xItemsBufferedSemaphore = xSemaphoreCreateBinary();
     if (pxRingbuffer->xFreeSpaceSemaphore == NULL || pxRingbuffer->xItemsBufferedSemaphore == NULL) {
         goto err;
     }
@@ -753,6 +1069,9 @@ BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer, const void *pvItem, size
     if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && xItemSize == 0) {
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSpscSend(pxRingbuffer, pvItem, xItemSize, xTicksToWait);
+    }
 
     //Attempt to send an item
     BaseType_t xReturn = pdFALSE;
@@ -811,6 +1130,13 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer, const void *pvIte
     if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && xItemSize == 0) {
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        if (prvSpscSendItem(pxRingbuffer, pvItem, xItemSize) != pdTRUE) {
+            return pdFALSE;
+        }
+        prvSpscWake(&pxRingbuffer->xSpscReceiver, pdTRUE, pxHigherPriorityTaskWoken);
+        return pdTRUE;
+    }
 
     //Attempt to send an item
     BaseType_t xReturn;
@@ -838,6 +1164,123 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer, const void *pvIte
     return xReturn;
 }
 
+BaseType_t xRingbufferSendAcquire(RingbufHandle_t xRingbuffer, void **ppvItem, size_t xItemSize, TickType_t xTicksToWait)
+{
+    //Check arguments
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbSPSC_FLAG)) == 0);    //Byte buffers have no item headers to mark the acquired space
+    configASSERT(ppvItem != NULL);
+    *ppvItem = NULL;
+    if (xItemSize > rbALIGN_SIZE(pxRingbuffer->xSize / 2) - rbHEADER_SIZE) {
+        return pdFALSE;     //Data will never ever fit in the queue without being split.
+    }
+
+    //Attempt to acquire space for an item
+    BaseType_t xReturn = pdFALSE;
+    BaseType_t xReturnSemaphore = pdFALSE;
+    TickType_t xTicksEnd = xTaskGetTickCount() + xTicksToWait;
+    TickType_t xTicksRemaining = xTicksToWait;
+    while (xTicksRemaining <= xTicksToWait) {   //xTicksToWait will underflow once xTaskGetTickCount() > ticks_end
+        //Block until more free space becomes available or timeout
+        if (xSemaphoreTake(pxRingbuffer->xFreeSpaceSemaphore, xTicksRemaining) != pdTRUE) {
+            xReturn = pdFALSE;
+            break;
+        }
+        //Semaphore obtained, check if item can fit
+        taskENTER_CRITICAL();
+        if (prvCheckItemFitsContiguous(pxRingbuffer, xItemSize) == pdTRUE) {
+            //Item will fit, reserve its space
+            *ppvItem = prvAcquireItem(pxRingbuffer, xItemSize, rbITEM_ACQUIRED_FLAG);
+            xReturn = pdTRUE;
+            //Check if the free semaphore should be returned to allow other tasks to send
+            if (prvGetFreeSize(pxRingbuffer) > 0) {
+                xReturnSemaphore = pdTRUE;
+            }
+            taskEXIT_CRITICAL();
+            break;
+        }
+        //Item doesn't fit, adjust ticks and take the semaphore again
+        if (xTicksToWait != portMAX_DELAY) {
+            xTicksRemaining = xTicksEnd - xTaskGetTickCount();
+        }
+        taskEXIT_CRITICAL();
+        /*
+         * Gap between critical section and re-acquiring of the semaphore. If
+         * semaphore is given now, priority inversion might occur (see docs)
+         */
+    }
+
+    if (xReturnSemaphore == pdTRUE) {
+        xSemaphoreGive(pxRingbuffer->xFreeSpaceSemaphore);  //Give back semaphore so other tasks can send
+    }
+    return xReturn;
+}
+
+BaseType_t xRingbufferSendAcquireFromISR(RingbufHandle_t xRingbuffer, void **ppvItem, size_t xItemSize, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    //Check arguments
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbSPSC_FLAG)) == 0);    //Byte buffers have no item headers to mark the acquired space
+    configASSERT(ppvItem != NULL);
+    *ppvItem = NULL;
+    if (xItemSize > rbALIGN_SIZE(pxRingbuffer->xSize / 2) - rbHEADER_SIZE) {
+        return pdFALSE;     //Data will never ever fit in the queue without being split.
+    }
+
+    //Attempt to acquire space for an item
+    BaseType_t xReturn;
+    BaseType_t xReturnSemaphore = pdFALSE;
+    taskENTER_CRITICAL();
+    if (prvCheckItemFitsContiguous(pxRingbuffer, xItemSize) == pdTRUE) {
+        *ppvItem = prvAcquireItem(pxRingbuffer, xItemSize, rbITEM_ACQUIRED_FLAG);
+        xReturn = pdTRUE;
+        //Check if the free semaphore should be returned to allow other tasks to send
+        if (prvGetFreeSize(pxRingbuffer) > 0) {
+            xReturnSemaphore = pdTRUE;
+        }
+    } else {
+        xReturn = pdFALSE;
+    }
+    taskEXIT_CRITICAL();
+
+    if (xReturnSemaphore == pdTRUE) {
+        xSemaphoreGiveFromISR(pxRingbuffer->xFreeSpaceSemaphore, pxHigherPriorityTaskWoken);  //Give back semaphore so other tasks can send
+    }
+    return xReturn;
+}
+
+BaseType_t xRingbufferSendComplete(RingbufHandle_t xRingbuffer, void *pvItem)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT(pvItem != NULL);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbSPSC_FLAG)) == 0);
+
+    taskENTER_CRITICAL();
+    prvCompleteItem(pxRingbuffer, (uint8_t *)pvItem);
+    taskEXIT_CRITICAL();
+    //Indicate item was successfully sent
+    xSemaphoreGive(pxRingbuffer->xItemsBufferedSemaphore);
+    return pdTRUE;
+}
+
+BaseType_t xRingbufferSendCompleteFromISR(RingbufHandle_t xRingbuffer, void *pvItem, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT(pvItem != NULL);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbSPSC_FLAG)) == 0);
+
+    taskENTER_CRITICAL();
+    prvCompleteItem(pxRingbuffer, (uint8_t *)pvItem);
+    taskEXIT_CRITICAL();
+    //Indicate item was successfully sent
+    xSemaphoreGiveFromISR(pxRingbuffer->xItemsBufferedSemaphore, pxHigherPriorityTaskWoken);
+    return pdTRUE;
+}
+
 void *xRingbufferReceive(RingbufHandle_t xRingbuffer, size_t *pxItemSize, TickType_t xTicksToWait)
 {
     //Check arguments
@@ -847,6 +1290,13 @@ void *xRingbufferReceive(RingbufHandle_t xRingbuffer, size_t *pxItemSize, TickTy
     //Attempt to retrieve an item
     void *pvTempItem;
     size_t xTempSize;
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        pvTempItem = prvSpscReceive(pxRingbuffer, &xTempSize, xTicksToWait);
+        if (pvTempItem != NULL && pxItemSize != NULL) {
+            *pxItemSize = xTempSize;
+        }
+        return pvTempItem;
+    }
     if (prvReceiveGeneric(pxRingbuffer, &pvTempItem, NULL, &xTempSize, NULL, 0, xTicksToWait) == pdTRUE) {
         if (pxItemSize != NULL) {
             *pxItemSize = xTempSize;
@@ -866,6 +1316,13 @@ void *xRingbufferReceiveFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemSize)
     //Attempt to retrieve an item
     void *pvTempItem;
     size_t xTempSize;
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        pvTempItem = prvSpscReceiveItem(pxRingbuffer, &xTempSize);
+        if (pvTempItem != NULL && pxItemSize != NULL) {
+            *pxItemSize = xTempSize;
+        }
+        return pvTempItem;
+    }
     if (prvReceiveGenericFromISR(pxRingbuffer, &pvTempItem, NULL, &xTempSize, NULL, 0) == pdTRUE) {
         if (pxItemSize != NULL) {
             *pxItemSize = xTempSize;
@@ -991,12 +1448,103 @@ void *xRingbufferReceiveUpToFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemS
     }
 }
 
+UBaseType_t xRingbufferReceiveBatch(RingbufHandle_t xRingbuffer, void **ppvItems, size_t *pxItemSizes, UBaseType_t uxMaxItems, TickType_t xTicksToWait)
+{
+    //Check arguments
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbALLOW_SPLIT_FLAG | rbBYTE_BUFFER_FLAG)) == 0);   //This function should only be called for no-split/SPSC buffers
+    configASSERT(ppvItems != NULL);
+    if (uxMaxItems == 0) {
+        return 0;
+    }
+
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        //Block for the first item only
+        size_t xItemSize;
+        ppvItems[0] = prvSpscReceive(pxRingbuffer, &xItemSize, xTicksToWait);
+        if (ppvItems[0] == NULL) {
+            return 0;
+        }
+        if (pxItemSizes != NULL) {
+            pxItemSizes[0] = xItemSize;
+        }
+        return 1 + prvSpscReceiveBatch(pxRingbuffer, ppvItems + 1, pxItemSizes ? pxItemSizes + 1 : NULL, uxMaxItems - 1);
+    }
+
+    //Attempt to retrieve the items
+    UBaseType_t uxItems = 0;
+    BaseType_t xReturnSemaphore = pdFALSE;
+    TickType_t xTicksEnd = xTaskGetTickCount() + xTicksToWait;
+    TickType_t xTicksRemaining = xTicksToWait;
+    while (xTicksRemaining <= xTicksToWait) {   //xTicksToWait will underflow once xTaskGetTickCount() > ticks_end
+        //Block until more items become available or timeout
+        if (xSemaphoreTake(pxRingbuffer->xItemsBufferedSemaphore, xTicksRemaining) != pdTRUE) {
+            break;  //Timed out attempting to get semaphore
+        }
+
+        //Semaphore obtained, retrieve all the items available in a single critical section
+        taskENTER_CRITICAL();
+        uxItems = prvGetItemBatch(pxRingbuffer, ppvItems, pxItemSizes, uxMaxItems);
+        if (uxItems > 0) {
+            if (pxRingbuffer->xItemsWaiting > 0) {
+                xReturnSemaphore = pdTRUE;
+            }
+            taskEXIT_CRITICAL();
+            break;
+        }
+        //No item available for retrieval, adjust ticks and take the semaphore again
+        if (xTicksToWait != portMAX_DELAY) {
+            xTicksRemaining = xTicksEnd - xTaskGetTickCount();
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    if (xReturnSemaphore == pdTRUE) {
+        xSemaphoreGive(pxRingbuffer->xItemsBufferedSemaphore);  //Give semaphore back so other tasks can retrieve
+    }
+    return uxItems;
+}
+
+UBaseType_t xRingbufferReceiveBatchFromISR(RingbufHandle_t xRingbuffer, void **ppvItems, size_t *pxItemSizes, UBaseType_t uxMaxItems)
+{
+    //Check arguments
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT((pxRingbuffer->uxRingbufferFlags & (rbALLOW_SPLIT_FLAG | rbBYTE_BUFFER_FLAG)) == 0);   //This function should only be called for no-split/SPSC buffers
+    configASSERT(ppvItems != NULL);
+
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvSpscReceiveBatch(pxRingbuffer, ppvItems, pxItemSizes, uxMaxItems);
+    }
+
+    UBaseType_t uxItems;
+    BaseType_t xReturnSemaphore = pdFALSE;
+    taskENTER_CRITICAL();
+    uxItems = prvGetItemBatch(pxRingbuffer, ppvItems, pxItemSizes, uxMaxItems);
+    if (uxItems > 0 && pxRingbuffer->xItemsWaiting > 0) {
+        xReturnSemaphore = pdTRUE;
+    }
+    taskEXIT_CRITICAL();
+
+    if (xReturnSemaphore == pdTRUE) {
+        xSemaphoreGiveFromISR(pxRingbuffer->xItemsBufferedSemaphore, NULL);  //Give semaphore back so other tasks can retrieve
+    }
+    return uxItems;
+}
+
 void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvSpscReturnItem(pxRingbuffer, (uint8_t *)pvItem);
+        prvSpscWake(&pxRingbuffer->xSpscSender, pdFALSE, NULL);
+        return;
+    }
+
     taskENTER_CRITICAL();
     pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)pvItem);
     taskEXIT_CRITICAL();
@@ -1009,12 +1557,68 @@ void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, Bas
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvSpscReturnItem(pxRingbuffer, (uint8_t *)pvItem);
+        prvSpscWake(&pxRingbuffer->xSpscSender, pdTRUE, pxHigherPriorityTaskWoken);
+        return;
+    }
+
     taskENTER_CRITICAL();
     pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)pvItem);
     taskEXIT_CRITICAL();
     xSemaphoreGiveFromISR(pxRingbuffer->xFreeSpaceSemaphore, pxHigherPriorityTaskWoken);
 }
 
+void vRingbufferReturnBatch(RingbufHandle_t xRingbuffer, void **ppvItems, UBaseType_t uxItems)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT(ppvItems != NULL || uxItems == 0);
+    if (uxItems == 0) {
+        return;
+    }
+
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        for (UBaseType_t i = 0; i < uxItems; i++) {
+            prvSpscReturnItem(pxRingbuffer, (uint8_t *)ppvItems[i]);
+        }
+        prvSpscWake(&pxRingbuffer->xSpscSender, pdFALSE, NULL);
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    for (UBaseType_t i = 0; i < uxItems; i++) {
+        pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)ppvItems[i]);
+    }
+    taskEXIT_CRITICAL();
+    xSemaphoreGive(pxRingbuffer->xFreeSpaceSemaphore);
+}
+
+void vRingbufferReturnBatchFromISR(RingbufHandle_t xRingbuffer, void **ppvItems, UBaseType_t uxItems, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer);
+    configASSERT(ppvItems != NULL || uxItems == 0);
+    if (uxItems == 0) {
+        return;
+    }
+
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        for (UBaseType_t i = 0; i < uxItems; i++) {
+            prvSpscReturnItem(pxRingbuffer, (uint8_t *)ppvItems[i]);
+        }
+        prvSpscWake(&pxRingbuffer->xSpscSender, pdTRUE, pxHigherPriorityTaskWoken);
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    for (UBaseType_t i = 0; i < uxItems; i++) {
+        pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)ppvItems[i]);
+    }
+    taskEXIT_CRITICAL();
+    xSemaphoreGiveFromISR(pxRingbuffer->xFreeSpaceSemaphore, pxHigherPriorityTaskWoken);
+}
+
 void vRingbufferDelete(RingbufHandle_t xRingbuffer)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
@@ -1056,6 +1660,8 @@ BaseType_t xRingbufferAddToQueueSetRead(RingbufHandle_t xRingbuffer, QueueSetHan
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
     configASSERT(pxRingbuffer);
 
+    configASSERT((pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) == 0);    //SPSC buffers have no semaphores
+
     BaseType_t xReturn;
     taskENTER_CRITICAL();
     //Cannot add semaphore to queue set if semaphore is not empty. Temporarily hold semaphore
@@ -0,0 +1,72 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+
+#define TEST_BUFFER_SIZE    128
+#define TEST_ITEMS          100
+
+TEST_CASE("Test ring buffer send acquire and complete", "[esp_ringbuf]")
+{
+    RingbufHandle_t rb = xRingbufferCreate(TEST_BUFFER_SIZE, RINGBUF_TYPE_NOSPLIT);
+    void *item1, *item2;
+    uint32_t *item;
+    size_t size;
+
+    TEST_ASSERT_NOT_NULL(rb);
+
+    /* Items are retrieved in order, whatever order they are completed in */
+    TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendAcquire(rb, &item1, sizeof(uint32_t), 0));
+    TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendAcquire(rb, &item2, sizeof(uint32_t), 0));
+    *(uint32_t *)item1 = 1;
+    *(uint32_t *)item2 = 2;
+    xRingbufferSendComplete(rb, item2);
+    TEST_ASSERT_NULL(xRingbufferReceive(rb, &size, 0));
+    xRingbufferSendComplete(rb, item1);
+
+    for (uint32_t i = 1; i <= 2; i++) {
+        item = xRingbufferReceive(rb, &size, 0);
+        TEST_ASSERT_NOT_NULL(item);
+        TEST_ASSERT_EQUAL(sizeof(uint32_t), size);
+        TEST_ASSERT_EQUAL(i, *item);
+        vRingbufferReturnItem(rb, item);
+    }
+
+    /* Items of odd sizes wrap around the end of the buffer */
+    for (uint32_t i = 0; i < TEST_ITEMS; i++) {
+        size_t len = sizeof(uint32_t) + i % 23;
+
+        TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendAcquire(rb, &item1, len, 0));
+        memset(item1, 0xa5, len);
+        *(uint32_t *)item1 = i;
+        xRingbufferSendComplete(rb, item1);
+
+        item = xRingbufferReceive(rb, &size, 0);
+        TEST_ASSERT_NOT_NULL(item);
+        TEST_ASSERT_EQUAL(len, size);
+        TEST_ASSERT_EQUAL(i, *item);
+        vRingbufferReturnItem(rb, item);
+    }
+
+    TEST_ASSERT_EQUAL(pdFALSE, xRingbufferSendAcquire(rb, &item1, TEST_BUFFER_SIZE, 0));
+    TEST_ASSERT_NULL(item1);
+
+    vRingbufferDelete(rb);
+}
@@ -0,0 +1,281 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * Runs a producer thread and a consumer thread on a ring buffer and checks
+ * every item is received once, in order and intact. The producer and the
+ * consumer either block in the task functions or poll the FromISR functions,
+ * as an ISR would. The consumer holds a few items before returning them, or
+ * receives and returns them in batches. The throughput of each mode is printed.
+ *
+ * Then a full buffer of small items is drained by a single thread, item by item
+ * or in batches, to compare the cost of the receiving side alone.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "ringbuf.h"
+
+#define BUFFER_SIZE         1024
+#define DEFAULT_ITEMS       1000000
+#define MAX_ITEM_SIZE       61
+#define HELD_ITEMS          3
+#define BATCH_ITEMS         32
+#define DRAIN_BUFFER_SIZE   4096
+#define DRAIN_ITEM_SIZE     8
+
+typedef struct {
+    const char *name;
+    ringbuf_type_t type;
+    bool from_isr;
+    bool batch;
+} test_mode_t;
+
+static const test_mode_t s_modes[] = {
+    { "no-split, tasks", RINGBUF_TYPE_NOSPLIT, false, false },
+    { "no-split, tasks, batch", RINGBUF_TYPE_NOSPLIT, false, true },
+    { "no-split, ISRs", RINGBUF_TYPE_NOSPLIT, true, false },
+    { "no-split, ISRs, batch", RINGBUF_TYPE_NOSPLIT, true, true },
+    { "SPSC, tasks", RINGBUF_TYPE_SPSC, false, false },
+    { "SPSC, tasks, batch", RINGBUF_TYPE_SPSC, false, true },
+    { "SPSC, ISRs", RINGBUF_TYPE_SPSC, true, false },
+    { "SPSC, ISRs, batch", RINGBUF_TYPE_SPSC, true, true },
+};
+
+static RingbufHandle_t s_rb;
+static const test_mode_t *s_mode;
+static uint32_t s_items;
+
+static size_t item_size(uint32_t seq)
+{
+    return sizeof(uint32_t) + (seq * 7) % (MAX_ITEM_SIZE - sizeof(uint32_t));
+}
+
+static void *producer(void *arg)
+{
+    uint8_t item[MAX_ITEM_SIZE];
+
+    for (uint32_t seq = 0; seq < s_items; seq++) {
+        size_t size = item_size(seq);
+
+        memcpy(item, &seq, sizeof(seq));
+        memset(item + sizeof(seq), (uint8_t)seq, size - sizeof(seq));
+        if (s_mode->from_isr) {
+            BaseType_t woken = pdFALSE;
+            while (xRingbufferSendFromISR(s_rb, item, size, &woken) != pdTRUE) {
+                sched_yield();
+            }
+        } else if (xRingbufferSend(s_rb, item, size, portMAX_DELAY) != pdTRUE) {
+            fprintf(stderr, "send failed at item %u\n", seq);
+            exit(1);
+        }
+    }
+    return NULL;
+}
+
+static void check_item(uint32_t seq, const uint8_t *item, size_t size)
+{
+    uint32_t value;
+
+    memcpy(&value, item, sizeof(value));
+    if (value != seq || size != item_size(seq)) {
+        fprintf(stderr, "item %u received as item %u of %u bytes\n", seq, value, (unsigned)size);
+        exit(1);
+    }
+    for (size_t i = sizeof(seq); i < size; i++) {
+        if (item[i] != (uint8_t)seq) {
+            fprintf(stderr, "item %u corrupted at byte %u\n", seq, (unsigned)i);
+            exit(1);
+        }
+    }
+}
+
+static void return_item(void *item)
+{
+    if (s_mode->from_isr) {
+        BaseType_t woken = pdFALSE;
+        vRingbufferReturnItemFromISR(s_rb, item, &woken);
+    } else {
+        vRingbufferReturnItem(s_rb, item);
+    }
+}
+
+static void *batch_consumer(void *arg)
+{
+    void *items[BATCH_ITEMS];
+    size_t sizes[BATCH_ITEMS];
+    uint32_t seq = 0;
+
+    while (seq < s_items) {
+        UBaseType_t n;
+
+        if (s_mode->from_isr) {
+            while ((n = xRingbufferReceiveBatchFromISR(s_rb, items, sizes, BATCH_ITEMS)) == 0) {
+                sched_yield();
+            }
+        } else {
+            n = xRingbufferReceiveBatch(s_rb, items, sizes, BATCH_ITEMS, portMAX_DELAY);
+        }
+        if (n == 0 || n > BATCH_ITEMS) {
+            fprintf(stderr, "batch receive failed at item %u\n", seq);
+            exit(1);
+        }
+        for (UBaseType_t i = 0; i < n; i++) {
+            check_item(seq++, items[i], sizes[i]);
+        }
+
+        if (s_mode->from_isr) {
+            BaseType_t woken = pdFALSE;
+            vRingbufferReturnBatchFromISR(s_rb, items, n, &woken);
+        } else {
+            vRingbufferReturnBatch(s_rb, items, n);
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    void *held[HELD_ITEMS];
+    uint32_t seq;
+
+    for (seq = 0; seq < s_items; seq++) {
+        size_t size;
+        void *item;
+
+        if (s_mode->from_isr) {
+            while ((item = xRingbufferReceiveFromISR(s_rb, &size)) == NULL) {
+                sched_yield();
+            }
+        } else {
+            item = xRingbufferReceive(s_rb, &size, portMAX_DELAY);
+        }
+        if (item == NULL) {
+            fprintf(stderr, "receive failed at item %u\n", seq);
+            exit(1);
+        }
+        check_item(seq, item, size);
+
+        /* Hold a few items, they are returned in order */
+        if (seq >= HELD_ITEMS) {
+            return_item(held[seq % HELD_ITEMS]);
+        }
+        held[seq % HELD_ITEMS] = item;
+    }
+    for (seq = s_items > HELD_ITEMS ? s_items - HELD_ITEMS : 0; seq < s_items; seq++) {
+        return_item(held[seq % HELD_ITEMS]);
+    }
+    return NULL;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Drains a full buffer, returns the number of items drained */
+static uint32_t drain(RingbufHandle_t rb, bool batch)
+{
+    uint32_t count = 0;
+    size_t size;
+
+    if (batch) {
+        void *items[BATCH_ITEMS];
+        UBaseType_t n;
+
+        while ((n = xRingbufferReceiveBatch(rb, items, NULL, BATCH_ITEMS, 0)) != 0) {
+            vRingbufferReturnBatch(rb, items, n);
+            count += n;
+        }
+    } else {
+        void *item;
+
+        while ((item = xRingbufferReceive(rb, &size, 0)) != NULL) {
+            vRingbufferReturnItem(rb, item);
+            count++;
+        }
+    }
+    return count;
+}
+
+static void drain_bench(const char *name, ringbuf_type_t type, bool batch)
+{
+    RingbufHandle_t rb = xRingbufferCreate(DRAIN_BUFFER_SIZE, type);
+    uint8_t item[DRAIN_ITEM_SIZE] = { 0 };
+    uint32_t total = 0;
+    double elapsed = 0;
+
+    while (total < s_items) {
+        double start;
+
+        while (xRingbufferSend(rb, item, sizeof(item), 0) == pdTRUE)
+            ;
+        start = now();
+        total += drain(rb, batch);
+        elapsed += now() - start;
+    }
+    vRingbufferDelete(rb);
+
+    printf("%-24s %u items in %.3f s, %.0f items/s\n", name, total, elapsed, total / elapsed);
+}
+
+int main(int argc, char **argv)
+{
+    s_items = argc > 1 ? strtoul(argv[1], NULL, 0) : DEFAULT_ITEMS;
+
+    for (size_t m = 0; m < sizeof(s_modes) / sizeof(s_modes[0]); m++) {
+        pthread_t producer_thread, consumer_thread;
+        double start, elapsed;
+
+        s_mode = &s_modes[m];
+        s_rb = xRingbufferCreate(BUFFER_SIZE, s_mode->type);
+        if (!s_rb) {
+            fprintf(stderr, "%s: cannot create the ring buffer\n", s_mode->name);
+            return 1;
+        }
+
+        start = now();
+        pthread_create(&consumer_thread, NULL, s_mode->batch ? batch_consumer : consumer, NULL);
+        pthread_create(&producer_thread, NULL, producer, NULL);
+        pthread_join(producer_thread, NULL);
+        pthread_join(consumer_thread, NULL);
+        elapsed = now() - start;
+
+        if (xRingbufferGetCurFreeSize(s_rb) != xRingbufferGetMaxItemSize(s_rb)) {
+            fprintf(stderr, "%s: the ring buffer is not empty at the end\n", s_mode->name);
+            return 1;
+        }
+        vRingbufferDelete(s_rb);
+
+        printf("%-24s %u items in %.3f s, %.0f items/s\n", s_mode->name, s_items, elapsed, s_items / elapsed);
+    }
+
+    printf("Draining %u byte items:\n", DRAIN_ITEM_SIZE);
+    drain_bench("no-split, item by item", RINGBUF_TYPE_NOSPLIT, false);
+    drain_bench("no-split, batch", RINGBUF_TYPE_NOSPLIT, true);
+    drain_bench("SPSC, item by item", RINGBUF_TYPE_SPSC, false);
+    drain_bench("SPSC, batch", RINGBUF_TYPE_SPSC, true);
+    return 0;
+}
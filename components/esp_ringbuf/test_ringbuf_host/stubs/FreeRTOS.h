@@ -0,0 +1,38 @@
+#pragma once
+
+/* Just enough of FreeRTOS to run the ring buffers on a host, tasks are pthreads */
+
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <assert.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE                  ( ( BaseType_t ) 1 )
+#define pdFALSE                 ( ( BaseType_t ) 0 )
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+
+#define portMAX_DELAY           ( TickType_t ) 0xffffffffUL
+#define portBYTE_ALIGNMENT_MASK ( sizeof( size_t ) - 1 )
+#define portTICK_PERIOD_MS      1
+
+#define configASSERT(x)         assert(x)
+
+typedef struct host_task *TaskHandle_t;
+typedef struct host_sem *SemaphoreHandle_t;
+typedef void *QueueSetHandle_t;
+typedef void *QueueSetMemberHandle_t;
+
+void host_critical_enter(void);
+void host_critical_exit(void);
+
+#define taskENTER_CRITICAL()    host_critical_enter()
+#define taskEXIT_CRITICAL()     host_critical_exit()
+#define portENTER_CRITICAL()    host_critical_enter()
+#define portEXIT_CRITICAL()     host_critical_exit()
@@ -0,0 +1,168 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+struct host_task {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notified;
+};
+
+struct host_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int given;
+};
+
+static pthread_mutex_t s_critical;
+static pthread_once_t s_critical_once = PTHREAD_ONCE_INIT;
+static __thread struct host_task s_task = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0 };
+
+static void critical_init(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&s_critical, &attr);
+}
+
+void host_critical_enter(void)
+{
+    pthread_once(&s_critical_once, critical_init);
+    pthread_mutex_lock(&s_critical);
+}
+
+void host_critical_exit(void)
+{
+    pthread_mutex_unlock(&s_critical);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* Waits on cond for at most ticks milliseconds, returns 0 on time-out */
+static int wait_ticks(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks)
+{
+    struct timespec ts;
+
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return 1;
+    }
+    if (ticks == 0) {
+        return 0;
+    }
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ticks / 1000;
+    ts.tv_nsec += (ticks % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    return pthread_cond_timedwait(cond, lock, &ts) != ETIMEDOUT;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return &s_task;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    uint32_t value;
+
+    pthread_mutex_lock(&s_task.lock);
+    while (!s_task.notified && wait_ticks(&s_task.cond, &s_task.lock, xTicksToWait))
+        ;
+    value = s_task.notified;
+    if (value) {
+        s_task.notified = xClearCountOnExit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&s_task.lock);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+    pthread_mutex_lock(&xTaskToNotify->lock);
+    xTaskToNotify->notified++;
+    pthread_cond_signal(&xTaskToNotify->cond);
+    pthread_mutex_unlock(&xTaskToNotify->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+    xTaskNotifyGive(xTaskToNotify);
+    if (pxHigherPriorityTaskWoken) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(struct host_sem));
+
+    if (sem) {
+        pthread_mutex_init(&sem->lock, NULL);
+        pthread_cond_init(&sem->cond, NULL);
+    }
+    return sem;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    pthread_mutex_destroy(&xSemaphore->lock);
+    pthread_cond_destroy(&xSemaphore->cond);
+    free(xSemaphore);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait)
+{
+    BaseType_t ret;
+
+    pthread_mutex_lock(&xSemaphore->lock);
+    while (!xSemaphore->given && wait_ticks(&xSemaphore->cond, &xSemaphore->lock, xTicksToWait))
+        ;
+    ret = xSemaphore->given ? pdTRUE : pdFALSE;
+    xSemaphore->given = 0;
+    pthread_mutex_unlock(&xSemaphore->lock);
+    return ret;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    BaseType_t ret;
+
+    pthread_mutex_lock(&xSemaphore->lock);
+    ret = xSemaphore->given ? pdFALSE : pdTRUE;
+    xSemaphore->given = 1;
+    pthread_cond_signal(&xSemaphore->cond);
+    pthread_mutex_unlock(&xSemaphore->lock);
+    return ret;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
+
+#define xSemaphoreGiveFromISR(xSemaphore, pxHigherPriorityTaskWoken)    xSemaphoreGive(xSemaphore)
+#define xQueueAddToSet(xQueueOrSemaphore, xQueueSet)                    pdFAIL
+#define xQueueRemoveFromSet(xQueueOrSemaphore, xQueueSet)               pdFAIL
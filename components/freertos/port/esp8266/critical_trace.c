@@ -0,0 +1,215 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_critical_trace.h"
+
+#include "esp_attr.h"
+
+#ifdef CONFIG_FREERTOS_CRITICAL_TRACE
+
+/**
+ * Sites are found by hashing, the first free entry after the hashed one is taken.
+ *
+ * Everything is recorded with the interrupts disabled, flash operations
+ * included, so it runs from IRAM and the number of sites is a power of 2:
+ * the CPU has no divide instruction.
+ */
+#define SITES_BITS      6
+#define SITES_NUM       (1 << SITES_BITS)
+#define SITES_MASK      (SITES_NUM - 1)
+
+extern uint32_t g_esp_ticks_per_us;
+
+static critical_trace_site_t s_sites[SITES_NUM];
+static critical_trace_site_t s_other_site;
+
+static critical_trace_stats_t s_critical;
+static critical_trace_stats_t s_isr;
+
+static inline size_t IRAM_ATTR site_hash(void *caller)
+{
+    return (((uint32_t)caller >> 2) * 2654435761U) >> (32 - SITES_BITS);
+}
+
+static inline void IRAM_ATTR stats_add(critical_trace_stats_t *stats, void *caller, uint32_t cycles)
+{
+    size_t bin = 0;
+
+    for (uint32_t c = cycles >> 6; c && bin < CRITICAL_TRACE_BINS - 1; c >>= 1)
+        bin++;
+
+    stats->count++;
+    stats->total += cycles;
+    stats->hist[bin]++;
+    if (cycles > stats->max) {
+        stats->max = cycles;
+        stats->max_caller = caller;
+    }
+}
+
+/* Called by the port with the interrupts disabled */
+void IRAM_ATTR critical_trace_record(void *caller, void *exit, uint32_t cycles, bool isr)
+{
+    critical_trace_site_t *site = &s_other_site;
+    size_t i;
+
+    stats_add(isr ? &s_isr : &s_critical, caller, cycles);
+
+    if (cycles < CONFIG_FREERTOS_CRITICAL_TRACE_THRESHOLD_US * g_esp_ticks_per_us)
+        return;
+
+    i = site_hash(caller);
+    for (size_t n = 0; n < SITES_NUM; n++) {
+        if (!s_sites[i].caller) {
+            s_sites[i].caller = caller;
+            s_sites[i].isr = isr;
+        }
+        if (s_sites[i].caller == caller) {
+            site = &s_sites[i];
+            break;
+        }
+        i = (i + 1) & SITES_MASK;
+    }
+
+    site->count++;
+    site->total += cycles;
+    if (cycles > site->max) {
+        site->max = cycles;
+        site->max_exit = exit;
+    }
+}
+
+void critical_trace_reset(void)
+{
+    portENTER_CRITICAL();
+
+    memset(s_sites, 0, sizeof(s_sites));
+    memset(&s_other_site, 0, sizeof(s_other_site));
+    memset(&s_critical, 0, sizeof(s_critical));
+    memset(&s_isr, 0, sizeof(s_isr));
+
+    portEXIT_CRITICAL();
+}
+
+size_t critical_trace_get_sites(critical_trace_site_t *sites, size_t max_sites)
+{
+    critical_trace_site_t *copy;
+    size_t n = 0;
+
+    copy = pvPortMalloc((SITES_NUM + 1) * sizeof(critical_trace_site_t));
+    if (!copy)
+        return 0;
+
+    portENTER_CRITICAL();
+    for (size_t i = 0; i < SITES_NUM; i++) {
+        if (s_sites[i].caller)
+            copy[n++] = s_sites[i];
+    }
+    if (s_other_site.count)
+        copy[n++] = s_other_site;
+    portEXIT_CRITICAL();
+
+    /* Insertion sort by the longest interval, there are few sites */
+    for (size_t i = 1; i < n; i++) {
+        critical_trace_site_t site = copy[i];
+        size_t j = i;
+
+        for (; j > 0 && copy[j - 1].max < site.max; j--)
+            copy[j] = copy[j - 1];
+        copy[j] = site;
+    }
+
+    if (n > max_sites)
+        n = max_sites;
+    memcpy(sites, copy, n * sizeof(critical_trace_site_t));
+
+    vPortFree(copy);
+
+    return n;
+}
+
+void critical_trace_get_stats(critical_trace_stats_t *critical, critical_trace_stats_t *isr)
+{
+    portENTER_CRITICAL();
+
+    if (critical)
+        *critical = s_critical;
+    if (isr)
+        *isr = s_isr;
+
+    portEXIT_CRITICAL();
+}
+
+static void stats_dump(const char *name, const critical_trace_stats_t *stats, uint32_t cycles_per_us)
+{
+    if (!stats->count)
+        return;
+
+    printf("%s: %u times, mean %u.%02u us, max %u.%02u us at %p\n", name, stats->count,
+           (uint32_t)(stats->total / stats->count / cycles_per_us),
+           (uint32_t)(stats->total / stats->count % cycles_per_us * 100 / cycles_per_us),
+           stats->max / cycles_per_us, stats->max % cycles_per_us * 100 / cycles_per_us, stats->max_caller);
+
+    for (int i = 0; i < CRITICAL_TRACE_BINS; i++) {
+        uint32_t from = i ? (32 << i) / cycles_per_us : 0;
+
+        if (!stats->hist[i])
+            continue;
+        if (i == CRITICAL_TRACE_BINS - 1)
+            printf("  %7u us <          : %u\n", from, stats->hist[i]);
+        else
+            printf("  %7u - %7u us   : %u\n", from, (64 << i) / cycles_per_us, stats->hist[i]);
+    }
+}
+
+void critical_trace_dump(size_t max_sites)
+{
+    extern int esp_clk_cpu_freq(void);
+    uint32_t cycles_per_us = esp_clk_cpu_freq() / 1000000;
+    critical_trace_stats_t critical, isr;
+    critical_trace_site_t *sites;
+    size_t n;
+
+    critical_trace_get_stats(&critical, &isr);
+    stats_dump("Critical sections", &critical, cycles_per_us);
+    stats_dump("Interrupt handlers", &isr, cycles_per_us);
+
+    sites = pvPortMalloc(max_sites * sizeof(critical_trace_site_t));
+    if (!sites)
+        return;
+
+    n = critical_trace_get_sites(sites, max_sites);
+    printf("Top %u sites by the longest interval of at least %u us:\n", n, CONFIG_FREERTOS_CRITICAL_TRACE_THRESHOLD_US);
+    for (size_t i = 0; i < n; i++) {
+        const critical_trace_site_t *site = &sites[i];
+
+        if (!site->caller)
+            printf("  %-30s", "(other sites)");
+        else if (site->isr)
+            printf("  handler %-10p %11s", site->caller, "");
+        else
+            printf("  caller %-10p exit %-10p", site->caller, site->max_exit);
+        printf(" max %7u us, %8u times, total %10u us\n", site->max / cycles_per_us, site->count,
+               (uint32_t)(site->total / cycles_per_us));
+    }
+
+    vPortFree(sites);
+}
+
+#endif /* CONFIG_FREERTOS_CRITICAL_TRACE */
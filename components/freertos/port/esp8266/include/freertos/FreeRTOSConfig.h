@@ -182,6 +182,26 @@ uint32_t esp_get_time(void);
 
 #define traceINCREASE_TICK_COUNT(_ticks)    esp_increase_tick_cnt(_ticks)
 
+#ifdef CONFIG_FREERTOS_TASK_STATS
+#ifndef __ASSEMBLER__
+uint32_t task_stats_create(void *task);
+void task_stats_delete(void *task);
+void task_stats_ready(uint32_t slot);
+void task_stats_switch(void *task, uint32_t slot);
+#endif /* __ASSEMBLER__ */
+
+/* The slot of the statistics of a task is kept in its task number, see esp_task_stats.h */
+#define traceTASK_CREATE(pxNewTCB)              (pxNewTCB)->uxTaskNumber = task_stats_create(pxNewTCB)
+#define traceTASK_DELETE(pxTCB)                 task_stats_delete(pxTCB)
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)   \
+    do { if ((pxTCB) != pxCurrentTCB) task_stats_ready((pxTCB)->uxTaskNumber); } while (0)
+#define traceTASK_SWITCHED_IN()                 task_stats_switch(pxCurrentTCB, pxCurrentTCB->uxTaskNumber)
+#endif /* CONFIG_FREERTOS_TASK_STATS */
+
+#ifdef CONFIG_ENABLE_FREERTOS_SLEEP
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP
+#endif
+
 #ifndef configIDLE_TASK_STACK_SIZE
 #define configIDLE_TASK_STACK_SIZE CONFIG_FREERTOS_IDLE_TASK_STACKSIZE
 #endif /* configIDLE_TASK_STACK_SIZE */
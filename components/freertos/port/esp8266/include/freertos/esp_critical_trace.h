@@ -0,0 +1,101 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "sdkconfig.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_FREERTOS_CRITICAL_TRACE
+
+#define CRITICAL_TRACE_BINS     20  ///< Bins of the duration histograms
+
+/**
+ * Intervals with the interrupts disabled by one call site since the last reset.
+ *
+ * Only the intervals of at least CONFIG_FREERTOS_CRITICAL_TRACE_THRESHOLD_US
+ * are counted against their site.
+ */
+typedef struct {
+    void        *caller;    ///< Return address of the call disabling the interrupts, or the interrupt handler; NULL for the sites which did not fit in the table
+    void        *max_exit;  ///< Return address of the call enabling them again at the end of the longest interval, NULL for interrupt handlers
+    bool        isr;        ///< "caller" is an interrupt handler
+    uint32_t    count;      ///< Number of intervals
+    uint32_t    max;        ///< Longest interval, in CPU cycles
+    uint64_t    total;      ///< All the intervals together, in CPU cycles
+} critical_trace_site_t;
+
+/**
+ * All the intervals with the interrupts disabled by critical sections, or all
+ * the interrupt handlers, since the last reset, in CPU cycles.
+ */
+typedef struct {
+    uint32_t    count;      ///< Number of intervals
+    uint32_t    max;        ///< Longest interval
+    void        *max_caller;///< Site of the longest interval, as critical_trace_site_t.caller
+    uint64_t    total;      ///< All the intervals together
+
+    /**
+     * Number of intervals by duration: bin 0 counts the intervals shorter than 64 cycles,
+     * bin n the intervals from 32 << n up to 64 << n cycles, the last bin the longer ones.
+     */
+    uint32_t    hist[CRITICAL_TRACE_BINS];
+} critical_trace_stats_t;
+
+/**
+ * @brief Clear the call sites and the histograms
+ */
+void critical_trace_reset(void);
+
+/**
+ * @brief Get the call sites which kept the interrupts disabled the longest
+ *
+ * @param sites Array filled with the call sites, sorted by their longest interval
+ * @param max_sites Size of the array
+ *
+ * @return Number of entries written
+ */
+size_t critical_trace_get_sites(critical_trace_site_t *sites, size_t max_sites);
+
+/**
+ * @brief Get the duration histograms of the critical sections and of the interrupt handlers
+ *
+ * The critical sections are the ones of vPortEnterCritical() and vPortETSIntrLock(),
+ * flash operations included. The interrupt handlers are the ones of _xt_isr_attach().
+ *
+ * @param critical Filled with the statistics of the critical sections, can be NULL
+ * @param isr Filled with the statistics of the interrupt handlers, can be NULL
+ */
+void critical_trace_get_stats(critical_trace_stats_t *critical, critical_trace_stats_t *isr);
+
+/**
+ * @brief Print the histograms and the call sites which kept the interrupts disabled
+ *        the longest to stdout
+ *
+ * @param max_sites Maximum number of call sites printed
+ */
+void critical_trace_dump(size_t max_sites);
+
+#endif /* CONFIG_FREERTOS_CRITICAL_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
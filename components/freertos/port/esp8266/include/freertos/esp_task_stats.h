@@ -0,0 +1,102 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "sdkconfig.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_FREERTOS_TASK_STATS
+
+#define TASK_STATS_ISR_NUM      16  ///< Interrupt sources, as the interrupt numbers of _xt_isr_attach()
+
+/**
+ * Statistics of one task since the last reset, in CPU cycles.
+ */
+typedef struct {
+    TaskHandle_t    handle;                     ///< Task, NULL for the tasks which did not fit in the table
+    char            name[configMAX_TASK_NAME_LEN];
+    UBaseType_t     priority;                   ///< Current priority
+    uint64_t        cycles;                     ///< Time running, without the interrupt handlers
+    uint32_t        switches;                   ///< Number of times it was switched in
+    uint32_t        wakeups;                    ///< Number of times it was made ready and then ran
+    uint32_t        latency_max;                ///< Longest time from being made ready to running
+    uint64_t        latency_total;              ///< All these times together
+} task_stats_t;
+
+/**
+ * Time spent in one kind of code since the last reset, in CPU cycles.
+ */
+typedef struct {
+    uint32_t        count;                      ///< Number of calls
+    uint32_t        max;                        ///< Longest call
+    uint64_t        cycles;                     ///< All the calls together
+} task_stats_time_t;
+
+/**
+ * Statistics of the whole system since the last reset, in CPU cycles.
+ */
+typedef struct {
+    uint64_t            elapsed;                    ///< Time since the last reset
+    uint32_t            switches;                   ///< Context switches to another task
+    task_stats_time_t   isr[TASK_STATS_ISR_NUM];    ///< Interrupt handlers by interrupt number
+    task_stats_time_t   critical;                   ///< Interrupts disabled by vPortEnterCritical()
+} task_stats_system_t;
+
+/**
+ * @brief Clear the statistics of the tasks and of the system
+ */
+void task_stats_reset(void);
+
+/**
+ * @brief Get the statistics of the tasks
+ *
+ * The tasks which did not fit in the table come last, together. The time of
+ * the running task includes its current time slice. The statistics of deleted
+ * tasks are dropped.
+ *
+ * @param tasks Array filled with the statistics
+ * @param max_tasks Size of the array
+ *
+ * @return Number of entries written
+ */
+size_t task_stats_get(task_stats_t *tasks, size_t max_tasks);
+
+/**
+ * @brief Get the statistics of the interrupt handlers and critical sections
+ *
+ * @param stats Filled with the statistics
+ */
+void task_stats_get_system(task_stats_system_t *stats);
+
+/**
+ * @brief Print the CPU usage and the scheduling latency of the tasks, the time
+ *        spent in the interrupt handlers and in critical sections to stdout
+ */
+void task_stats_dump(void);
+
+#endif /* CONFIG_FREERTOS_TASK_STATS */
+
+#ifdef __cplusplus
+}
+#endif
@@ -202,6 +202,26 @@ void _xt_enter_first_task(void);
 
 void esp_increase_tick_cnt(const TickType_t ticks);
 
+#ifdef CONFIG_FREERTOS_TASK_STATS
+/* Time of the interrupt handlers and critical sections in CPU cycles, see task_stats.c */
+void task_stats_isr(int num, uint32_t cycles);
+void task_stats_critical(uint32_t cycles);
+#endif
+
+#ifdef CONFIG_FREERTOS_CRITICAL_TRACE
+/* Interrupts disabled from "caller" to "exit", see critical_trace.c */
+void critical_trace_record(void *caller, void *exit, uint32_t cycles, bool isr);
+#endif
+
+/* Tick interrupt handler */
+void xPortSysTickHandle(void *p);
+
+#ifdef CONFIG_ENABLE_FREERTOS_SLEEP
+/* Tickless idle, see port_tick.c */
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime);
+#define portSUPPRESS_TICKS_AND_SLEEP(xExpectedIdleTime) vPortSuppressTicksAndSleep(xExpectedIdleTime)
+#endif
+
 /* API compatible with esp-idf  */
 #define xTaskCreatePinnedToCore(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pvCreatedTask, tskNO_AFFINITY) \
         xTaskCreate(pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pvCreatedTask)
@@ -140,40 +140,6 @@ void IRAM_ATTR esp_increase_tick_cnt(const TickType_t ticks)
     g_esp_os_ticks += ticks;
 }
 
-void IRAM_ATTR xPortSysTickHandle(void *p)
-{
-    uint32_t us;
-    uint32_t ticks;
-    uint32_t ccount;
-
-    /**
-     * System or application may close interrupt too long, such as the operation of read/write/erase flash.
-     * And then the "ccount" value may be overflow.
-     *
-     * So add code here to calibrate system time.
-     */
-    ccount = soc_get_ccount();
-    us = ccount / g_esp_ticks_per_us;
-  
-    g_esp_os_us += us;
-    g_esp_os_cpu_clk += ccount;
-
-    soc_set_ccount(0);
-    soc_set_ccompare(_xt_tick_divisor);
-
-    ticks = us / 1000 / portTICK_PERIOD_MS;
-
-    if (ticks > 1) {
-        vTaskStepTick(ticks - 1);
-    }
-
-    g_esp_os_ticks++;
-
-    if (xTaskIncrementTick() != pdFALSE) {
-        portYIELD_FROM_ISR();
-    }
-}
-
 /**
  * @brief Return current CPU clock frequency
  */
@@ -239,19 +205,36 @@ void vPortEndScheduler(void)
 
 static char ClosedLv1Isr = 0;
 
-void IRAM_ATTR vPortEnterCritical(void)
+#if defined(CONFIG_FREERTOS_TASK_STATS) || defined(CONFIG_FREERTOS_CRITICAL_TRACE)
+#define PORT_IRQ_OFF_TIME   1
+
+static uint64_t s_critical_start;
+static void *s_critical_caller;
+
+/* CPU cycles since the scheduler started, called with the interrupts disabled */
+static inline uint64_t IRAM_ATTR port_cycles(void)
+{
+    return g_esp_os_cpu_clk + soc_get_ccount();
+}
+#endif
+
+/* "caller" disables the interrupts, it is the return address of the public function */
+static inline void IRAM_ATTR port_enter_critical(void *caller)
 {
     if (NMIIrqIsOn == 0) {
         if (ClosedLv1Isr != 1) {
             portDISABLE_INTERRUPTS();
             ClosedLv1Isr = 1;
+#ifdef PORT_IRQ_OFF_TIME
+            s_critical_caller = caller;
+            s_critical_start = port_cycles();
+#endif
         }
         uxCriticalNesting++;
     }
 }
-/*-----------------------------------------------------------*/
 
-void IRAM_ATTR vPortExitCritical(void)
+static inline void IRAM_ATTR port_exit_critical(void *caller)
 {
     if (NMIIrqIsOn == 0) {
         if (uxCriticalNesting > 0) {
@@ -259,6 +242,15 @@ void IRAM_ATTR vPortExitCritical(void)
 
             if (uxCriticalNesting == 0) {
                 if (ClosedLv1Isr == 1) {
+#ifdef PORT_IRQ_OFF_TIME
+                    uint32_t cycles = port_cycles() - s_critical_start;
+#ifdef CONFIG_FREERTOS_TASK_STATS
+                    task_stats_critical(cycles);
+#endif
+#ifdef CONFIG_FREERTOS_CRITICAL_TRACE
+                    critical_trace_record(s_critical_caller, caller, cycles, false);
+#endif
+#endif
                     ClosedLv1Isr = 0;
                     portENABLE_INTERRUPTS();
                 }
@@ -270,6 +262,17 @@ void IRAM_ATTR vPortExitCritical(void)
     }
 }
 
+void IRAM_ATTR vPortEnterCritical(void)
+{
+    port_enter_critical(__builtin_return_address(0));
+}
+/*-----------------------------------------------------------*/
+
+void IRAM_ATTR vPortExitCritical(void)
+{
+    port_exit_critical(__builtin_return_address(0));
+}
+
 void show_critical_info(void)
 {
     ets_printf("ShowCritical:%u\n", uxCriticalNesting);
@@ -297,7 +300,7 @@ void IRAM_ATTR vPortETSIntrLock(void)
     if (NMIIrqIsOn == 0) {
         uint32_t regval = REG_READ(NMI_INT_ENABLE_REG);
 
-        vPortEnterCritical();
+        port_enter_critical(__builtin_return_address(0));
 
         REG_WRITE(NMI_INT_ENABLE_REG, 0);
 
@@ -326,7 +329,7 @@ void IRAM_ATTR vPortETSIntrUnlock(void)
 
         REG_WRITE(NMI_INT_ENABLE_REG, regval);
 
-        vPortExitCritical();
+        port_exit_critical(__builtin_return_address(0));
     }
 }
 
@@ -367,7 +370,20 @@ void IRAM_ATTR _xt_isr_handler(void)
             soc_clear_int_mask(bit);
 
             s_xt_isr_status = 1;
+#ifdef PORT_IRQ_OFF_TIME
+            uint64_t start = port_cycles();
             s_isr[i].handler(s_isr[i].arg);
+
+            uint32_t cycles = port_cycles() - start;
+#ifdef CONFIG_FREERTOS_TASK_STATS
+            task_stats_isr(i, cycles);
+#endif
+#ifdef CONFIG_FREERTOS_CRITICAL_TRACE
+            critical_trace_record(s_isr[i].handler, NULL, cycles, true);
+#endif
+#else
+            s_isr[i].handler(s_isr[i].arg);
+#endif
             s_xt_isr_status = 0;
 
             mask &= ~bit;
@@ -417,6 +433,14 @@ void esp_internal_idle_hook(void)
 {
     esp_task_wdt_reset();
 
+#ifdef CONFIG_ENABLE_FREERTOS_SLEEP
+    extern int esp_sleep_is_cpu_wait(void);
+
+    /* The CPU waits in vPortSuppressTicksAndSleep() instead, without the tick */
+    if (esp_sleep_is_cpu_wait() && prvGetExpectedIdleTime() >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP)
+        return;
+#endif
+
     esp_sleep_start();
 }
 
@@ -0,0 +1,156 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_attr.h"
+#include "driver/soc.h"
+
+/*
+ * "ccount" counts the CPU cycles since the start of the current tick, the tick
+ * interrupt comes when it reaches "ccompare". The time before the current tick
+ * is in g_esp_os_us, esp_timer_get_time() adds "ccount" to it.
+ *
+ * The start of the tick only moves by whole ticks, the cycles the interrupt
+ * came late stay in "ccount", so neither the time nor the tick count drift.
+ */
+
+#define TICK_US                 (1000000 / configTICK_RATE_HZ)
+
+/* Cycles from "now" for an alarm which was passed before "ccompare" was written */
+#define TICK_ALARM_GUARD        64
+
+/* Longest tickless sleep, "ccount" must not wrap around */
+#define TICKLESS_MAX_CYCLES     (UINT32_MAX / 2)
+
+extern uint32_t _xt_tick_divisor;
+extern uint64_t g_esp_os_ticks;
+extern uint64_t g_esp_os_us;
+extern uint64_t g_esp_os_cpu_clk;
+
+/**
+ * @brief Move the start of the current tick "ticks" ticks forward
+ */
+static inline void IRAM_ATTR tick_advance(uint32_t ticks)
+{
+    const uint32_t cycles = ticks * _xt_tick_divisor;
+
+    g_esp_os_us += (uint64_t)ticks * TICK_US;
+    g_esp_os_cpu_clk += cycles;
+
+    soc_set_ccount(soc_get_ccount() - cycles);
+}
+
+/**
+ * @brief Set the next tick interrupt, called with the interrupts disabled
+ */
+static inline void IRAM_ATTR tick_set_alarm(uint32_t ccompare)
+{
+    soc_set_ccompare(ccompare);
+
+    /* If "ccount" went past it, the interrupt would only come once it wraps around */
+    if ((int32_t)(soc_get_ccount() - ccompare) >= 0)
+        soc_set_ccompare(soc_get_ccount() + TICK_ALARM_GUARD);
+}
+
+void IRAM_ATTR xPortSysTickHandle(void *p)
+{
+    uint32_t ticks;
+
+    /**
+     * System or application may close interrupt too long, such as the operation of read/write/erase flash,
+     * and the idle task may suppress the tick, so more than one tick may have elapsed.
+     */
+    ticks = soc_get_ccount() / _xt_tick_divisor;
+    if (!ticks) {
+        tick_set_alarm(_xt_tick_divisor);
+        return;
+    }
+
+    tick_advance(ticks);
+    tick_set_alarm(_xt_tick_divisor);
+
+    if (ticks > 1) {
+        vTaskStepTick(ticks - 1);
+    }
+
+    g_esp_os_ticks++;
+
+    if (xTaskIncrementTick() != pdFALSE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+#ifdef CONFIG_ENABLE_FREERTOS_SLEEP
+/**
+ * @brief Wait for interrupts without the tick until the idle time is over
+ *
+ * Called by the idle task with the scheduler suspended. The tick interrupt is
+ * set at the end of the idle time, it steps the tick count over the ticks in
+ * between. When another interrupt wakes the CPU up first, the ticks which
+ * have elapsed are stepped over here.
+ */
+void IRAM_ATTR vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime)
+{
+    extern int esp_sleep_is_cpu_wait(void);
+
+    const uint32_t divisor = _xt_tick_divisor;
+    uint64_t os_ticks;
+    uint32_t ticks;
+    esp_irqflag_t flag;
+
+    /* Light sleep covers the idle time by itself */
+    if (!esp_sleep_is_cpu_wait())
+        return;
+
+    if (xExpectedIdleTime > TICKLESS_MAX_CYCLES / divisor)
+        xExpectedIdleTime = TICKLESS_MAX_CYCLES / divisor;
+
+    flag = soc_save_local_irq();
+
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep || soc_get_ccount() + TICK_ALARM_GUARD >= divisor) {
+        soc_restore_local_irq(flag);
+        return;
+    }
+
+    os_ticks = g_esp_os_ticks;
+    tick_set_alarm(xExpectedIdleTime * divisor);
+
+    /* The interrupts are enabled while waiting, the first one is handled before it returns */
+    soc_wait_int();
+
+    soc_save_local_irq();
+
+    if (g_esp_os_ticks == os_ticks) {
+        /**
+         * Another interrupt came first. The last tick is left to the tick interrupt
+         * even if it is already due, it unblocks the tasks.
+         */
+        ticks = soc_get_ccount() / divisor;
+        if (ticks > xExpectedIdleTime - 1)
+            ticks = xExpectedIdleTime - 1;
+        if (ticks) {
+            tick_advance(ticks);
+            vTaskStepTick(ticks);
+        }
+        tick_set_alarm(divisor);
+    }
+
+    soc_restore_local_irq(flag);
+}
+#endif /* CONFIG_ENABLE_FREERTOS_SLEEP */
@@ -0,0 +1,309 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_task_stats.h"
+
+#include "esp_attr.h"
+#include "driver/soc.h"
+
+#ifdef CONFIG_FREERTOS_TASK_STATS
+
+#define SLOT_NUM        (CONFIG_FREERTOS_TASK_STATS_MAX_TASKS + 1)
+#define SLOT_OTHER      0   // tasks which did not fit in the table
+
+typedef struct {
+    TaskHandle_t    handle;         // NULL when the slot is free
+    uint64_t        cycles;
+    uint64_t        latency_total;
+    uint64_t        ready_at;       // made ready and not run yet if not 0
+    uint32_t        latency_max;
+    uint32_t        switches;
+    uint32_t        wakeups;
+} task_slot_t;
+
+extern uint64_t g_esp_os_cpu_clk;
+
+static task_slot_t s_slots[SLOT_NUM];
+static task_slot_t *s_current;
+static TaskHandle_t s_current_task;
+static uint64_t s_switched_in_at;
+static uint64_t s_isr_at_switch;    // s_isr_cycles when the current task was switched in
+static uint64_t s_isr_cycles;       // all the interrupt handlers since boot
+static uint64_t s_reset_at;
+static uint32_t s_switches;
+static task_stats_time_t s_critical;
+static task_stats_time_t s_isr[TASK_STATS_ISR_NUM];
+
+/**
+ * @brief CPU cycles since the scheduler started
+ *
+ * The tick interrupt moves whole ticks from "ccount" to g_esp_os_cpu_clk, their
+ * sum keeps counting.
+ */
+static inline uint64_t IRAM_ATTR stats_now(void)
+{
+    esp_irqflag_t flag = soc_save_local_irq();
+    uint64_t now = g_esp_os_cpu_clk + soc_get_ccount();
+
+    soc_restore_local_irq(flag);
+
+    return now;
+}
+
+static inline void IRAM_ATTR time_add(task_stats_time_t *time, uint64_t cycles)
+{
+    time->count++;
+    time->cycles += cycles;
+    if (cycles > time->max)
+        time->max = cycles > UINT32_MAX ? UINT32_MAX : cycles;
+}
+
+static inline task_slot_t * IRAM_ATTR stats_slot(uint32_t slot)
+{
+    return &s_slots[slot < SLOT_NUM ? slot : SLOT_OTHER];
+}
+
+/* Running time of the current task since it was switched in */
+static inline uint64_t IRAM_ATTR current_cycles(uint64_t now)
+{
+    if (!s_current || (s_current != &s_slots[SLOT_OTHER] && s_current->handle != s_current_task))
+        return 0;
+
+    return now - s_switched_in_at - (s_isr_cycles - s_isr_at_switch);
+}
+
+/* Called by xTaskCreate() in a critical section, the slot is kept as the task number */
+uint32_t task_stats_create(void *task)
+{
+    for (uint32_t i = 1; i < SLOT_NUM; i++) {
+        if (!s_slots[i].handle) {
+            memset(&s_slots[i], 0, sizeof(task_slot_t));
+            s_slots[i].handle = task;
+            return i;
+        }
+    }
+
+    return SLOT_OTHER;
+}
+
+/* Called by vTaskDelete() in a critical section, the task may already be freed */
+void task_stats_delete(void *task)
+{
+    for (uint32_t i = 1; i < SLOT_NUM; i++) {
+        if (s_slots[i].handle == task) {
+            s_slots[i].handle = NULL;
+            break;
+        }
+    }
+}
+
+void IRAM_ATTR task_stats_ready(uint32_t slot)
+{
+    task_slot_t *s = stats_slot(slot);
+
+    if (!s->ready_at)
+        s->ready_at = stats_now();
+}
+
+/* Called by vTaskSwitchContext() in the interrupt handler, even if the task does not change */
+void IRAM_ATTR task_stats_switch(void *task, uint32_t slot)
+{
+    task_slot_t *in;
+    uint64_t now;
+
+    if (task == s_current_task)
+        return;
+
+    now = stats_now();
+    in = stats_slot(slot);
+
+    if (s_current)
+        s_current->cycles += current_cycles(now);
+
+    if (in->ready_at) {
+        uint64_t latency = now - in->ready_at;
+
+        in->wakeups++;
+        in->latency_total += latency;
+        if (latency > in->latency_max)
+            in->latency_max = latency > UINT32_MAX ? UINT32_MAX : latency;
+        in->ready_at = 0;
+    }
+    in->switches++;
+    s_switches++;
+
+    s_current = in;
+    s_current_task = task;
+    s_switched_in_at = now;
+    s_isr_at_switch = s_isr_cycles;
+}
+
+/* Called by _xt_isr_handler() after each handler */
+void IRAM_ATTR task_stats_isr(int num, uint32_t cycles)
+{
+    s_isr_cycles += cycles;
+    time_add(&s_isr[num], cycles);
+}
+
+/* Called by vPortExitCritical() when it enables the interrupts again */
+void IRAM_ATTR task_stats_critical(uint32_t cycles)
+{
+    time_add(&s_critical, cycles);
+}
+
+void task_stats_reset(void)
+{
+    portENTER_CRITICAL();
+
+    for (int i = 0; i < SLOT_NUM; i++) {
+        TaskHandle_t handle = s_slots[i].handle;
+
+        memset(&s_slots[i], 0, sizeof(task_slot_t));
+        s_slots[i].handle = handle;
+    }
+    memset(s_isr, 0, sizeof(s_isr));
+    memset(&s_critical, 0, sizeof(s_critical));
+    s_switches = 0;
+
+    s_reset_at = stats_now();
+    s_switched_in_at = s_reset_at;
+    s_isr_at_switch = s_isr_cycles;
+
+    portEXIT_CRITICAL();
+}
+
+size_t task_stats_get(task_stats_t *tasks, size_t max_tasks)
+{
+    size_t n = 0;
+
+    portENTER_CRITICAL();
+
+    const uint64_t now = stats_now();
+
+    /* The tasks in the table first, the other ones at the end */
+    for (int i = 1; i <= SLOT_NUM && n < max_tasks; i++) {
+        const task_slot_t *slot = &s_slots[i % SLOT_NUM];
+        task_stats_t *task = &tasks[n];
+
+        if (slot == &s_slots[SLOT_OTHER] ? !slot->switches : !slot->handle)
+            continue;
+
+        task->handle = slot->handle;
+        if (slot->handle) {
+            strncpy(task->name, pcTaskGetName(slot->handle), configMAX_TASK_NAME_LEN - 1);
+            task->name[configMAX_TASK_NAME_LEN - 1] = '\0';
+            task->priority = uxTaskPriorityGet(slot->handle);
+        } else {
+            strncpy(task->name, "(other tasks)", configMAX_TASK_NAME_LEN - 1);
+            task->name[configMAX_TASK_NAME_LEN - 1] = '\0';
+            task->priority = 0;
+        }
+        task->cycles = slot->cycles;
+        if (slot == s_current)
+            task->cycles += current_cycles(now);
+        task->switches = slot->switches;
+        task->wakeups = slot->wakeups;
+        task->latency_max = slot->latency_max;
+        task->latency_total = slot->latency_total;
+        n++;
+    }
+
+    portEXIT_CRITICAL();
+
+    return n;
+}
+
+void task_stats_get_system(task_stats_system_t *stats)
+{
+    portENTER_CRITICAL();
+
+    stats->elapsed = stats_now() - s_reset_at;
+    stats->switches = s_switches;
+    memcpy(stats->isr, s_isr, sizeof(s_isr));
+    stats->critical = s_critical;
+
+    portEXIT_CRITICAL();
+}
+
+static uint32_t percent_x100(uint64_t cycles, uint64_t elapsed)
+{
+    return elapsed ? (uint32_t)(cycles * 10000 / elapsed) : 0;
+}
+
+static void time_dump(const char *name, int num, const task_stats_time_t *time, uint64_t elapsed, uint32_t cycles_per_us)
+{
+    uint32_t percent = percent_x100(time->cycles, elapsed);
+
+    if (!time->count)
+        return;
+
+    if (num >= 0)
+        printf("  %s %-3d", name, num);
+    else
+        printf("  %-11s", name);
+    printf(" %3u.%02u%% %10u calls, mean %6u us, max %6u us\n", percent / 100, percent % 100,
+           time->count, (uint32_t)(time->cycles / time->count / cycles_per_us), time->max / cycles_per_us);
+}
+
+void task_stats_dump(void)
+{
+    extern int esp_clk_cpu_freq(void);
+    uint32_t cycles_per_us = esp_clk_cpu_freq() / 1000000;
+    task_stats_system_t system;
+    task_stats_t *tasks;
+    uint64_t isr_cycles = 0;
+    size_t n;
+
+    tasks = pvPortMalloc(SLOT_NUM * sizeof(task_stats_t));
+    if (!tasks)
+        return;
+
+    n = task_stats_get(tasks, SLOT_NUM);
+    task_stats_get_system(&system);
+
+    for (int i = 0; i < TASK_STATS_ISR_NUM; i++)
+        isr_cycles += system.isr[i].cycles;
+
+    printf("%u ms since the last reset, %u context switches, %u.%02u%% in interrupts\n",
+           (uint32_t)(system.elapsed / cycles_per_us / 1000), system.switches,
+           percent_x100(isr_cycles, system.elapsed) / 100, percent_x100(isr_cycles, system.elapsed) % 100);
+
+    printf("%-16s %4s %7s %10s %9s %9s %8s %8s\n",
+           "Task", "Prio", "CPU", "Run us", "Switches", "Wakeups", "Lat avg", "Lat max");
+    for (size_t i = 0; i < n; i++) {
+        const task_stats_t *task = &tasks[i];
+        uint32_t percent = percent_x100(task->cycles, system.elapsed);
+
+        printf("%-16s %4u %3u.%02u%% %10u %9u %9u %5u us %5u us\n",
+               task->name, task->priority, percent / 100, percent % 100,
+               (uint32_t)(task->cycles / cycles_per_us), task->switches, task->wakeups,
+               task->wakeups ? (uint32_t)(task->latency_total / task->wakeups / cycles_per_us) : 0,
+               task->latency_max / cycles_per_us);
+    }
+
+    printf("Interrupts and critical sections:\n");
+    for (int i = 0; i < TASK_STATS_ISR_NUM; i++)
+        time_dump("isr", i, &system.isr[i], system.elapsed, cycles_per_us);
+    time_dump("critical", -1, &system.critical, system.elapsed, cycles_per_us);
+
+    vPortFree(tasks);
+}
+
+#endif /* CONFIG_FREERTOS_TASK_STATS */
@@ -0,0 +1,90 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <unity.h>
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_critical_trace.h"
+#include "esp_clk.h"
+#include "rom/ets_sys.h"
+
+#ifdef CONFIG_FREERTOS_CRITICAL_TRACE
+
+#define TEST_LONG_US    2000
+#define TEST_SHORT_US   500
+
+TEST_CASE("Test critical trace finds the longest critical sections", "[freertos]")
+{
+    const uint32_t cycles_per_us = esp_clk_cpu_freq() / 1000000;
+    critical_trace_stats_t critical, isr;
+    critical_trace_site_t sites[8];
+    size_t n;
+
+    critical_trace_reset();
+
+    portENTER_CRITICAL();
+    ets_delay_us(TEST_LONG_US);
+    portEXIT_CRITICAL();
+
+    vPortETSIntrLock();
+    ets_delay_us(TEST_SHORT_US);
+    vPortETSIntrUnlock();
+
+    /* Some tick interrupts */
+    vTaskDelay(2);
+
+    critical_trace_get_stats(&critical, &isr);
+    TEST_ASSERT_GREATER_OR_EQUAL(2, critical.count);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_LONG_US, critical.max / cycles_per_us);
+    TEST_ASSERT_NOT_EQUAL(0, isr.count);
+
+    uint32_t hist_count = 0;
+    for (int i = 0; i < CRITICAL_TRACE_BINS; i++) {
+        hist_count += critical.hist[i];
+    }
+    TEST_ASSERT_EQUAL(critical.count, hist_count);
+
+    /* Both sections are long enough to be counted against their own site, the longest comes first */
+    n = critical_trace_get_sites(sites, 8);
+    TEST_ASSERT_GREATER_OR_EQUAL(2, n);
+    TEST_ASSERT_NOT_NULL(sites[0].caller);
+    TEST_ASSERT_FALSE(sites[0].isr);
+    TEST_ASSERT_NOT_NULL(sites[0].max_exit);
+    TEST_ASSERT_EQUAL_PTR(critical.max_caller, sites[0].caller);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_LONG_US, sites[0].max / cycles_per_us);
+
+    bool found = false;
+    for (size_t i = 1; i < n; i++) {
+        TEST_ASSERT_LESS_OR_EQUAL(sites[i - 1].max, sites[i].max);
+        if (sites[i].max / cycles_per_us >= TEST_SHORT_US && sites[i].max / cycles_per_us < TEST_LONG_US) {
+            TEST_ASSERT_NOT_EQUAL(sites[0].caller, sites[i].caller);
+            found = true;
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+
+    critical_trace_dump(8);
+
+    critical_trace_reset();
+    critical_trace_get_stats(&critical, NULL);
+    TEST_ASSERT_LESS_OR_EQUAL(1, critical.count);
+}
+
+#endif /* CONFIG_FREERTOS_CRITICAL_TRACE */
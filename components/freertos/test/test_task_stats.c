@@ -0,0 +1,118 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <unity.h>
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_task_stats.h"
+#include "esp_timer.h"
+#include "esp_clk.h"
+#include "rom/ets_sys.h"
+
+#ifdef CONFIG_FREERTOS_TASK_STATS
+
+#define TEST_ROUNDS     5
+#define TEST_BUSY_US    10000
+
+static void busy_task(void *arg)
+{
+    SemaphoreHandle_t done = arg;
+
+    for (int i = 0; i < TEST_ROUNDS; i++) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        int64_t start = esp_timer_get_time();
+        while (esp_timer_get_time() - start < TEST_BUSY_US)
+            ;
+    }
+
+    xSemaphoreGive(done);
+    vTaskSuspend(NULL);
+}
+
+static bool find_task(TaskHandle_t handle, task_stats_t *stats)
+{
+    static task_stats_t tasks[CONFIG_FREERTOS_TASK_STATS_MAX_TASKS + 1];
+    size_t n = task_stats_get(tasks, CONFIG_FREERTOS_TASK_STATS_MAX_TASKS + 1);
+
+    for (size_t i = 0; i < n; i++) {
+        if (tasks[i].handle == handle) {
+            *stats = tasks[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+TEST_CASE("Test task stats count the CPU time and the wakeups", "[freertos]")
+{
+    const uint64_t cycles_per_us = esp_clk_cpu_freq() / 1000000;
+    SemaphoreHandle_t done = xSemaphoreCreateBinary();
+    task_stats_system_t system;
+    task_stats_t stats;
+    TaskHandle_t task;
+
+    TEST_ASSERT_NOT_NULL(done);
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(busy_task, "busy", 2048, done, uxTaskPriorityGet(NULL) + 1, &task));
+
+    task_stats_reset();
+    TEST_ASSERT_TRUE(find_task(task, &stats));
+    TEST_ASSERT_EQUAL_STRING("busy", stats.name);
+    TEST_ASSERT_EQUAL(0, stats.wakeups);
+
+    /* The busy task has a higher priority, it runs as soon as it is notified */
+    for (int i = 0; i < TEST_ROUNDS; i++) {
+        xTaskNotifyGive(task);
+        vTaskDelay(2);
+    }
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(done, portMAX_DELAY));
+
+    TEST_ASSERT_TRUE(find_task(task, &stats));
+    printf("busy: %u us, %u switches, %u wakeups, max latency %u us\n",
+           (uint32_t)(stats.cycles / cycles_per_us), stats.switches, stats.wakeups,
+           (uint32_t)(stats.latency_max / cycles_per_us));
+
+    /* The interrupt handlers are not counted in the time of the task */
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_ROUNDS * TEST_BUSY_US * 9 / 10, stats.cycles / cycles_per_us);
+    TEST_ASSERT_LESS_OR_EQUAL(TEST_ROUNDS * TEST_BUSY_US * 12 / 10, stats.cycles / cycles_per_us);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_ROUNDS, stats.wakeups);
+    TEST_ASSERT_GREATER_OR_EQUAL(stats.wakeups, stats.switches);
+    TEST_ASSERT_LESS_THAN(1000, stats.latency_max / cycles_per_us);
+
+    task_stats_get_system(&system);
+    TEST_ASSERT_GREATER_OR_EQUAL(stats.cycles, system.elapsed);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_ROUNDS, system.switches);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_ROUNDS * TEST_BUSY_US * configTICK_RATE_HZ / 1000000,
+                                 system.isr[ETS_MAX_INUM].count);
+    TEST_ASSERT_NOT_EQUAL(0, system.critical.count);
+    TEST_ASSERT_LESS_OR_EQUAL(system.critical.cycles, system.critical.max);
+
+    task_stats_dump();
+
+    /* The statistics of deleted tasks are dropped */
+    vTaskDelete(task);
+    TEST_ASSERT_FALSE(find_task(task, &stats));
+
+    vSemaphoreDelete(done);
+}
+
+#endif /* CONFIG_FREERTOS_TASK_STATS */
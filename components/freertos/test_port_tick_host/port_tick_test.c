@@ -0,0 +1,369 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * Runs the tick interrupt handler and the tickless idle of the FreeRTOS port
+ * on a simulated CPU: "ccount" counts the simulated cycles, the tick interrupt
+ * comes when it reaches "ccompare", every register access takes a cycle and
+ * interrupts are taken between them. A task blocks for random times, runs
+ * with the interrupts disabled now and then, and other interrupts wake the
+ * CPU up at random.
+ *
+ * Checks that the tick count and g_esp_os_us stay on the time of "ccount",
+ * that only the cycles of the "ccount" writes are lost and that the task is
+ * unblocked on time, with and without tickless idle.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/soc.h"
+
+#define CHECK(cond) \
+    if (!(cond)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        exit(1); \
+    }
+
+#define TICK_US             (1000000 / configTICK_RATE_HZ)
+#define IDLE_TIME_BEFORE_SLEEP  3
+
+#define ISR_CYCLES          50      // interrupt entry and exit
+#define MAX_WAKE_LATENCY    500     // cycles from the tick to the unblocked task
+
+void xPortSysTickHandle(void *p);
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime);
+
+uint32_t _xt_tick_divisor;
+uint64_t g_esp_os_ticks;
+uint64_t g_esp_os_us;
+uint64_t g_esp_os_cpu_clk;
+
+/* Simulated CPU */
+static uint64_t s_cycles;
+static uint64_t s_ccount_base;
+static uint32_t s_ccompare;
+static int s_level;
+static int s_tick_pending;
+static int s_other_pending;
+static uint64_t s_other_at;
+
+static uint64_t s_interrupts;
+static uint64_t s_tick_interrupts;
+static uint64_t s_wakeups;
+static uint64_t s_ccount_writes;
+
+/* Simulated kernel */
+static uint32_t s_tick_count;
+static uint32_t s_next_unblock;
+static int s_task_ready;
+static int s_task_unblocked;
+static uint64_t s_stall_end;    // time the last long interrupt handler or flash operation ended
+static uint64_t s_max_latency;
+
+static uint32_t s_seed = 1;
+
+static uint32_t test_rand(void)
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+static uint64_t other_interval(void)
+{
+    return 1 + (uint64_t)test_rand() % (60ULL * _xt_tick_divisor);
+}
+
+static uint32_t ccount(void)
+{
+    return (uint32_t)(s_cycles - s_ccount_base);
+}
+
+static void run(uint64_t n);
+
+static void other_isr(void)
+{
+    /* Some handlers take long enough for the tick to be due when they return */
+    if (test_rand() % 8 == 0) {
+        run(test_rand() % (2 * _xt_tick_divisor));
+        s_stall_end = g_esp_os_cpu_clk + ccount();
+    }
+
+    if (test_rand() % 8 == 0)
+        s_task_ready = 1;
+}
+
+static void take_interrupts(void)
+{
+    int n = 0;
+
+    while (!s_level && (s_tick_pending || s_other_pending)) {
+        CHECK(++n < 100);
+
+        s_level = 1;
+        s_interrupts++;
+        run(ISR_CYCLES);
+        if (s_tick_pending) {
+            s_tick_interrupts++;
+            xPortSysTickHandle(NULL);
+        } else {
+            s_other_pending = 0;
+            other_isr();
+        }
+        s_level = 0;
+    }
+}
+
+/* Time runs, the interrupts are taken when they are enabled */
+static void run(uint64_t n)
+{
+    const uint64_t end = s_cycles + n;
+
+    take_interrupts();
+
+    while (s_cycles < end) {
+        uint32_t to_compare = s_ccompare - ccount();
+        uint64_t tick = s_cycles + (to_compare ? to_compare : 1ULL << 32);
+        uint64_t next = end;
+
+        if (tick < next)
+            next = tick;
+        if (s_other_at < next)
+            next = s_other_at;
+
+        s_cycles = next;
+        if (next == tick)
+            s_tick_pending = 1;
+        if (next == s_other_at) {
+            s_other_pending = 1;
+            s_other_at = s_cycles + other_interval();
+        }
+        take_interrupts();
+    }
+}
+
+esp_irqflag_t soc_save_local_irq(void)
+{
+    esp_irqflag_t flag = s_level;
+
+    s_level = 1;
+    run(1);
+
+    return flag;
+}
+
+void soc_restore_local_irq(esp_irqflag_t flag)
+{
+    s_level = flag;
+    run(1);
+}
+
+void soc_set_ccompare(uint32_t ticks)
+{
+    /* Writing "ccompare" clears the timer interrupt */
+    s_ccompare = ticks;
+    s_tick_pending = 0;
+    run(1);
+}
+
+uint32_t soc_get_ccompare(void)
+{
+    run(1);
+
+    return s_ccompare;
+}
+
+uint32_t soc_get_ccount(void)
+{
+    uint32_t value = ccount();
+
+    run(1);
+
+    return value;
+}
+
+void soc_set_ccount(uint32_t ticks)
+{
+    s_ccount_base = s_cycles - ticks;
+    s_ccount_writes++;
+    run(1);
+}
+
+void soc_wait_int(void)
+{
+    const uint64_t interrupts = s_interrupts;
+
+    s_level = 0;
+    s_wakeups++;
+
+    take_interrupts();
+    while (interrupts == s_interrupts) {
+        uint32_t to_compare = s_ccompare - ccount();
+        uint64_t tick = to_compare ? to_compare : 1ULL << 32;
+        uint64_t other = s_other_at - s_cycles;
+
+        run(tick < other ? tick : other);
+    }
+}
+
+void vTaskStepTick(const TickType_t xTicksToJump)
+{
+    /* As configASSERT() in tasks.c, the last tick must be an interrupt */
+    CHECK(s_tick_count + xTicksToJump <= s_next_unblock);
+
+    s_tick_count += xTicksToJump;
+    g_esp_os_ticks += xTicksToJump;
+}
+
+BaseType_t xTaskIncrementTick(void)
+{
+    s_tick_count++;
+
+    /* Only the tick interrupt moves the task out of the delayed list */
+    if (s_tick_count < s_next_unblock)
+        return pdFALSE;
+
+    s_task_unblocked = 1;
+
+    return pdTRUE;
+}
+
+eSleepModeStatus eTaskConfirmSleepModeStatus(void)
+{
+    return s_task_ready ? eAbortSleep : eStandardSleep;
+}
+
+int esp_sleep_is_cpu_wait(void)
+{
+    return 1;
+}
+
+void portYIELD_FROM_ISR(void)
+{
+}
+
+static void check_time(void)
+{
+    const uint64_t divisor = _xt_tick_divisor;
+    const uint64_t accounted = g_esp_os_cpu_clk + ccount();
+
+    CHECK(g_esp_os_ticks == s_tick_count);
+    CHECK(g_esp_os_us == (uint64_t)s_tick_count * TICK_US);
+    CHECK(g_esp_os_cpu_clk == s_tick_count * divisor);
+
+    /* Only the cycles between reading and writing "ccount" are lost */
+    CHECK(accounted <= s_cycles);
+    CHECK(s_cycles - accounted <= s_ccount_writes);
+
+    /* The tick is not late */
+    CHECK(ccount() < divisor + 4 * ISR_CYCLES);
+}
+
+static void task_run(void)
+{
+    s_next_unblock = UINT32_MAX;
+    s_task_ready = 0;
+    s_task_unblocked = 0;
+
+    run(test_rand() % (_xt_tick_divisor / 2));
+
+    /**
+     * Now and then a flash operation disables the interrupts for some ticks,
+     * sometimes the tick interrupt then reads "ccount" just before a tick ends.
+     */
+    if (test_rand() % 16 == 0) {
+        esp_irqflag_t flag = soc_save_local_irq();
+
+        if (test_rand() % 2)
+            run(test_rand() % (3 * _xt_tick_divisor));
+        else
+            run((2 + test_rand() % 2) * _xt_tick_divisor - ccount() - ISR_CYCLES - test_rand() % 8);
+        s_stall_end = g_esp_os_cpu_clk + ccount();
+        soc_restore_local_irq(flag);
+    }
+
+    /* Mostly short delays, some longer than the longest tickless sleep */
+    if (test_rand() % 8)
+        s_next_unblock = s_tick_count + 1 + test_rand() % 40;
+    else
+        s_next_unblock = s_tick_count + 1 + test_rand() % 3000;
+}
+
+static void simulate(uint32_t cpu_mhz, uint64_t seconds, int tickless)
+{
+    const uint64_t end = seconds * cpu_mhz * 1000000;
+    uint64_t unblocks = 0;
+
+    _xt_tick_divisor = cpu_mhz * 1000000 / configTICK_RATE_HZ;
+    g_esp_os_ticks = g_esp_os_us = g_esp_os_cpu_clk = 0;
+    s_cycles = s_ccount_base = 0;
+    s_ccompare = _xt_tick_divisor;
+    s_level = s_tick_pending = s_other_pending = 0;
+    s_other_at = other_interval();
+    s_interrupts = s_tick_interrupts = s_wakeups = s_ccount_writes = 0;
+    s_tick_count = 0;
+    s_task_ready = s_task_unblocked = 0;
+    s_max_latency = 0;
+    s_stall_end = 0;
+
+    task_run();
+
+    while (s_cycles < end) {
+        check_time();
+
+        if (s_task_unblocked) {
+            uint64_t due = (uint64_t)s_next_unblock * _xt_tick_divisor;
+            uint64_t latency;
+
+            if (due < s_stall_end)
+                due = s_stall_end;
+            latency = g_esp_os_cpu_clk + ccount() - due;
+
+            CHECK(latency <= MAX_WAKE_LATENCY);
+            if (latency > s_max_latency)
+                s_max_latency = latency;
+            unblocks++;
+            task_run();
+        } else if (s_task_ready) {
+            task_run();
+        } else if (tickless && s_next_unblock - s_tick_count >= IDLE_TIME_BEFORE_SLEEP) {
+            vPortSuppressTicksAndSleep(s_next_unblock - s_tick_count);
+        } else {
+            soc_wait_int();
+        }
+    }
+
+    printf("%3" PRIu32 " MHz, %s: %" PRIu64 " s, %" PRIu64 " unblocks, max latency %" PRIu64 " cycles, "
+           "%" PRIu64 " wakeups/s, %" PRIu64 " tick interrupts/s, %" PRIu64 " cycles lost: OK\n",
+           cpu_mhz, tickless ? "tickless" : "periodic", seconds, unblocks, s_max_latency,
+           s_wakeups / seconds, s_tick_interrupts / seconds, s_cycles - g_esp_os_cpu_clk - ccount());
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t seconds = argc > 1 ? strtoull(argv[1], NULL, 0) : 600;
+
+    if (!seconds)
+        seconds = 1;
+
+    simulate(80, seconds, 0);
+    simulate(80, seconds, 1);
+    simulate(160, seconds, 1);
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+/* The CPU registers are simulated by port_tick_test.c */
+
+#include <stdint.h>
+
+typedef uint32_t esp_irqflag_t;
+
+esp_irqflag_t soc_save_local_irq(void);
+void soc_restore_local_irq(esp_irqflag_t flag);
+void soc_set_ccompare(uint32_t ticks);
+uint32_t soc_get_ccompare(void);
+uint32_t soc_get_ccount(void);
+void soc_set_ccount(uint32_t ticks);
+void soc_wait_int(void);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+typedef uint32_t TickType_t;
+typedef int32_t BaseType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+
+#define configTICK_RATE_HZ      ((TickType_t)CONFIG_FREERTOS_HZ)
+
+void portYIELD_FROM_ISR(void);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef enum {
+    eAbortSleep = 0,
+    eStandardSleep,
+    eNoTasksWaitingTimeout
+} eSleepModeStatus;
+
+void vTaskStepTick(const TickType_t xTicksToJump);
+BaseType_t xTaskIncrementTick(void);
+eSleepModeStatus eTaskConfirmSleepModeStatus(void);
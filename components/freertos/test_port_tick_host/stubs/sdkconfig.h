@@ -0,0 +1,4 @@
+#pragma once
+
+#define CONFIG_FREERTOS_HZ              100
+#define CONFIG_ENABLE_FREERTOS_SLEEP    1
@@ -81,6 +81,27 @@ typedef struct heap_region {
 } heap_region_t;
 
 
+#define HEAP_FREE_HIST_BINS     10  ///< Bins of the free block size histogram
+
+/**
+ * Heap statistics, as filled by heap_caps_get_info()
+ */
+typedef struct multi_heap_info {
+    size_t total_free_bytes;        ///< Total free bytes in the heap
+    size_t total_allocated_bytes;   ///< Total bytes allocated to data in the heap, block headers included
+    size_t largest_free_block;      ///< Size of largest free block in the heap, the largest malloc() which can succeed
+    size_t minimum_free_bytes;      ///< Lifetime minimum free heap size
+    size_t allocated_blocks;        ///< Number of allocated blocks
+    size_t free_blocks;             ///< Number of free blocks
+    size_t total_blocks;            ///< Total number of blocks
+
+    /**
+     * Number of free blocks by size: bin 0 counts the blocks smaller than 32 bytes,
+     * bin n the blocks from 16 << n up to 32 << n bytes, the last bin everything bigger.
+     */
+    size_t free_block_hist[HEAP_FREE_HIST_BINS];
+} multi_heap_info_t;
+
 /**
  * @brief Get the total free size of all the regions that have the given capabilities
  *
@@ -105,6 +126,33 @@ size_t heap_caps_get_free_size(uint32_t caps);
  */
 size_t heap_caps_get_minimum_free_size(uint32_t caps);
 
+/**
+ * @brief Get the largest free block of memory able to be allocated with the given capabilities.
+ *
+ * @param caps Bitwise OR of MALLOC_CAP_* flags indicating the type of memory
+ *
+ * @return Size of largest free block in bytes, which can be passed to heap_caps_malloc()
+ */
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+/**
+ * @brief Get heap info for all regions with the given capabilities.
+ *
+ * Every block of the regions is visited with the heap locked, so the interrupts
+ * are disabled for a time growing with the number of blocks.
+ *
+ * @param info Pointer to a structure which will be filled with the heap statistics
+ * @param caps Bitwise OR of MALLOC_CAP_* flags indicating the type of memory
+ */
+void heap_caps_get_info(multi_heap_info_t *info, uint32_t caps);
+
+/**
+ * @brief Print a summary of all the regions with the given capabilities.
+ *
+ * @param caps Bitwise OR of MALLOC_CAP_* flags indicating the type of memory
+ */
+void heap_caps_print_heap_info(uint32_t caps);
+
 /**
  * @brief Initialize regions of memory to the collection of heaps at runtime.
  *
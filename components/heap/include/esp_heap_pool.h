@@ -0,0 +1,117 @@
+// Copyright 2018-2019 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Pool of fixed-size objects.
+ *
+ * The storage of all the objects is taken from the heap at once when the pool
+ * is created, the free objects are then linked together, so that allocating or
+ * freeing one only takes a few instructions and has no per-object overhead.
+ */
+typedef struct heap_caps_pool *heap_caps_pool_handle_t;
+
+/**
+ * @brief Create a pool of objects
+ *
+ * @param obj_size Size, in bytes, of each object. It is rounded up to the heap alignment.
+ * @param count Number of objects in the pool
+ * @param caps Bitwise OR of MALLOC_CAP_* flags indicating the type of memory of the objects
+ *
+ * @return The pool handle, NULL if there is not enough memory
+ */
+heap_caps_pool_handle_t heap_caps_pool_create(size_t obj_size, size_t count, uint32_t caps);
+
+/**
+ * @brief Delete a pool and release its memory
+ *
+ * All the objects must have been freed before, they become invalid.
+ *
+ * @param pool The pool handle, can be NULL
+ */
+void heap_caps_pool_delete(heap_caps_pool_handle_t pool);
+
+/**
+ * @brief Allocate an object from a pool
+ *
+ * @note This function can be called from an interrupt handler.
+ *
+ * @param pool The pool handle
+ *
+ * @return A pointer to the object, NULL if all the objects are in use
+ */
+void *heap_caps_pool_alloc(heap_caps_pool_handle_t pool);
+
+/**
+ * @brief Give an object back to its pool
+ *
+ * @note This function can be called from an interrupt handler.
+ *
+ * @param pool The pool handle
+ * @param ptr Pointer previously returned by heap_caps_pool_alloc() for this pool. Can be NULL.
+ */
+void heap_caps_pool_free(heap_caps_pool_handle_t pool, void *ptr);
+
+/**
+ * @brief Check if a pointer is an object of a pool
+ *
+ * This is cheap enough to route the free of an unknown pointer to the right pool
+ * or to heap_caps_free().
+ *
+ * @param pool The pool handle
+ * @param ptr Any pointer
+ *
+ * @return true if the pointer lies in the storage of the pool
+ */
+bool heap_caps_pool_owns(heap_caps_pool_handle_t pool, const void *ptr);
+
+/**
+ * @brief Get the size of the objects of a pool, after the alignment round up
+ *
+ * @param pool The pool handle
+ *
+ * @return Size of an object in bytes
+ */
+size_t heap_caps_pool_get_obj_size(heap_caps_pool_handle_t pool);
+
+/**
+ * @brief Get the number of free objects of a pool
+ *
+ * @param pool The pool handle
+ *
+ * @return Number of objects which can still be allocated
+ */
+size_t heap_caps_pool_get_free_count(heap_caps_pool_handle_t pool);
+
+/**
+ * @brief Get the minimum number of free objects a pool ever had
+ *
+ * @param pool The pool handle
+ *
+ * @return Low water mark of the free objects
+ */
+size_t heap_caps_pool_get_minimum_free_count(heap_caps_pool_handle_t pool);
+
+#ifdef __cplusplus
+}
+#endif
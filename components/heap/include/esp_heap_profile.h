@@ -0,0 +1,97 @@
+// Copyright 2018-2019 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "sdkconfig.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_HEAP_PROFILING
+
+#define HEAP_PROFILE_LATENCY_BINS   12  ///< Bins of the latency histograms
+
+/**
+ * Allocations made from one call site since the last reset.
+ *
+ * When "line" is 0, "file" is not a file name but the address of the caller,
+ * as for malloc() and the other libc functions.
+ */
+typedef struct {
+    const char  *file;      ///< Source file of the call, NULL for the sites which did not fit in the table
+    uint32_t    line;       ///< Line of the call
+    uint32_t    count;      ///< Number of successful allocations
+    uint32_t    bytes;      ///< Bytes requested by these allocations
+} heap_profile_site_t;
+
+/**
+ * Time taken by malloc or free since the last reset, in CPU cycles.
+ */
+typedef struct {
+    uint32_t    count;      ///< Number of calls
+    uint32_t    max;        ///< Longest call
+    uint64_t    total;      ///< All the calls together
+
+    /**
+     * Number of calls by duration: bin 0 counts the calls shorter than 64 cycles,
+     * bin n the calls from 32 << n up to 64 << n cycles, the last bin the longer ones.
+     */
+    uint32_t    hist[HEAP_PROFILE_LATENCY_BINS];
+} heap_profile_latency_t;
+
+/**
+ * @brief Clear the statistics of the call sites and the latency histograms
+ */
+void heap_profile_reset(void);
+
+/**
+ * @brief Get the call sites which allocated the most bytes
+ *
+ * @param sites Array filled with the call sites, sorted by allocated bytes
+ * @param max_sites Size of the array
+ *
+ * @return Number of entries written
+ */
+size_t heap_profile_get_sites(heap_profile_site_t *sites, size_t max_sites);
+
+/**
+ * @brief Get the latency histograms of malloc and free
+ *
+ * Every allocation function ends up in malloc, realloc and calloc included.
+ * A realloc counts as a malloc of the new size, also when the block is
+ * resized in place; when it moves, the free of the old block is counted too.
+ * Frees of NULL or invalid pointers are not counted.
+ *
+ * @param malloc_latency Filled with the statistics of malloc, can be NULL
+ * @param free_latency Filled with the statistics of free, can be NULL
+ */
+void heap_profile_get_latency(heap_profile_latency_t *malloc_latency, heap_profile_latency_t *free_latency);
+
+/**
+ * @brief Print the heap summary, the latency histograms and the top call sites to stdout
+ *
+ * @param max_sites Maximum number of call sites printed
+ */
+void heap_profile_dump(size_t max_sites);
+
+#endif /* CONFIG_HEAP_PROFILING */
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +39,14 @@ extern "C" {
     esp_task_wdt_reset();                   \
 }
 
+#define _heap_caps_get_ccount()             \
+({                                          \
+    uint32_t __ccount;                      \
+    __asm__ __volatile__("rsr %0, ccount"   \
+                         : "=a"(__ccount)); \
+    __ccount;                               \
+})
+
 /**
  * @brief Get the total free size of DRAM region
  *
@@ -48,6 +48,19 @@ extern "C" {
 #define mem_blk_set_prev(_mem_blk, _prev) _mem_blk_set_ptr(_mem_blk, _prev, 0, MEM_BLK_TAG)
 #define mem_blk_set_next(_mem_blk, _next) _mem_blk_set_ptr(_mem_blk, _next, 1, MEM_BLK_TRACE)
 
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+/**
+ * Free memory block, it is linked into the free list of its size class
+ */
+typedef struct mem_free_blk {
+    mem_blk_t           blk;        ///< Link to the neighbour blocks, as for any block
+    struct mem_free_blk *free_prev; ///< Previous block of the same free list
+    struct mem_free_blk *free_next; ///< Next block of the same free list
+} mem_free_blk_t;
+
+#define MEM_FREE_BLK_MIN        sizeof(mem_free_blk_t)  ///< Any block must be able to hold the free list links once freed
+#endif
+
 static inline size_t mem_blk_head_size(bool trace)
 {
     return trace ? MEM2_HEAD_SIZE : MEM_HEAD_SIZE;    
@@ -164,6 +177,11 @@ static inline size_t ptr_size(void *ptr)
     return size;
 }
 
+#ifdef CONFIG_HEAP_PROFILING
+void heap_profile_record_malloc(const char *file, size_t line, size_t size, bool done, uint32_t cycles);
+void heap_profile_record_free(uint32_t cycles);
+#endif
+
 #ifdef CONFIG_HEAP_TRACING
 static inline size_t mem2_blk_line(mem2_blk_t *mem2_blk)
 {
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stdio.h>
 #include <string.h>
 #include <assert.h>
 #include <stdbool.h>
@@ -36,6 +37,169 @@ size_t g_heap_region_num;
 int __g_heap_trace_mode = HEAP_TRACE_NONE;
 #endif
 
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+/*
+ * Two level segregated fit: the free blocks are kept in lists by size class.
+ * The first level splits the sizes by powers of 2, the second level splits
+ * each of them in TLSF_SL_COUNT equal ranges. Bitmaps tell which lists hold
+ * any block, so finding a suitable one takes a few bit operations whatever
+ * the number of blocks in the heap.
+ */
+#define TLSF_SL_LOG2            3
+#define TLSF_SL_COUNT           (1 << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT           (TLSF_SL_LOG2 + 2)      /* 2 is log2(HEAP_ALIGN_SIZE) */
+#define TLSF_SMALL_SIZE         (1 << TLSF_FL_SHIFT)    /* Below this size the classes are linear */
+#define TLSF_FL_COUNT           (17 - TLSF_FL_SHIFT + 1)/* Blocks are smaller than 128 KB */
+#define TLSF_FIT_TRIES          4
+
+typedef struct heap_tlsf {
+    uint32_t        fl_bitmap;
+    uint8_t         sl_bitmap[TLSF_FL_COUNT];
+    mem_free_blk_t  *free_list[TLSF_FL_COUNT][TLSF_SL_COUNT];
+} heap_tlsf_t;
+
+static heap_tlsf_t s_heap_tlsf[HEAP_REGIONS_MAX];
+
+/* Index of the most significant bit, x must not be 0. No __builtin_clz, the
+ * ESP8266 doesn't have the instruction and the libgcc routine is not in IRAM */
+static inline int heap_fls(uint32_t x)
+{
+    int n = 0;
+
+    if (x & 0xffff0000) {
+        n += 16;
+        x >>= 16;
+    }
+    if (x & 0xff00) {
+        n += 8;
+        x >>= 8;
+    }
+    if (x & 0xf0) {
+        n += 4;
+        x >>= 4;
+    }
+    if (x & 0xc) {
+        n += 2;
+        x >>= 2;
+    }
+    if (x & 0x2)
+        n += 1;
+
+    return n;
+}
+
+static inline int heap_ffs(uint32_t x)
+{
+    return heap_fls(x & (~x + 1));
+}
+
+static inline void tlsf_mapping(size_t size, int *fl, int *sl)
+{
+    if (size < TLSF_SMALL_SIZE) {
+        *fl = 0;
+        *sl = size / (TLSF_SMALL_SIZE / TLSF_SL_COUNT);
+    } else {
+        int f = heap_fls(size);
+
+        *sl = (size >> (f - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *fl = f - TLSF_FL_SHIFT + 1;
+    }
+}
+
+static void IRAM_ATTR tlsf_insert(size_t num, mem_blk_t *mem_blk)
+{
+    heap_tlsf_t *tlsf = &s_heap_tlsf[num];
+    mem_free_blk_t *free_blk = (mem_free_blk_t *)mem_blk;
+    int fl, sl;
+
+    tlsf_mapping(blk_link_size(mem_blk), &fl, &sl);
+
+    free_blk->free_prev = NULL;
+    free_blk->free_next = tlsf->free_list[fl][sl];
+    if (free_blk->free_next)
+        free_blk->free_next->free_prev = free_blk;
+    tlsf->free_list[fl][sl] = free_blk;
+
+    tlsf->fl_bitmap |= 1 << fl;
+    tlsf->sl_bitmap[fl] |= 1 << sl;
+}
+
+static void IRAM_ATTR tlsf_remove(size_t num, mem_blk_t *mem_blk)
+{
+    heap_tlsf_t *tlsf = &s_heap_tlsf[num];
+    mem_free_blk_t *free_blk = (mem_free_blk_t *)mem_blk;
+    int fl, sl;
+
+    tlsf_mapping(blk_link_size(mem_blk), &fl, &sl);
+
+    if (free_blk->free_next)
+        free_blk->free_next->free_prev = free_blk->free_prev;
+    if (free_blk->free_prev) {
+        free_blk->free_prev->free_next = free_blk->free_next;
+    } else {
+        tlsf->free_list[fl][sl] = free_blk->free_next;
+        if (!free_blk->free_next) {
+            tlsf->sl_bitmap[fl] &= ~(1 << sl);
+            if (!tlsf->sl_bitmap[fl])
+                tlsf->fl_bitmap &= ~(1 << fl);
+        }
+    }
+}
+
+/*
+ * Take a free block of at least "size" bytes out of the lists. Past the first
+ * blocks of its own class, the request is rounded up to the next class, so
+ * that any block of the class found fits.
+ */
+static mem_blk_t IRAM_ATTR *tlsf_take(size_t num, size_t size)
+{
+    heap_tlsf_t *tlsf = &s_heap_tlsf[num];
+    mem_free_blk_t *free_blk;
+    uint32_t sl_map, fl_map;
+    int fl, sl, n;
+
+    /* A few blocks of the class of the request are worth a look first, a
+     * close fit keeps the big blocks for the big requests */
+    tlsf_mapping(size, &fl, &sl);
+    for (n = 0, free_blk = tlsf->free_list[fl][sl]; free_blk && n < TLSF_FIT_TRIES; free_blk = free_blk->free_next, n++) {
+        if (blk_link_size(&free_blk->blk) >= size) {
+            tlsf_remove(num, &free_blk->blk);
+            return &free_blk->blk;
+        }
+    }
+
+    tlsf_mapping(size >= TLSF_SMALL_SIZE ? size + (1 << (heap_fls(size) - TLSF_SL_LOG2)) - 1 : size, &fl, &sl);
+
+    sl_map = fl < TLSF_FL_COUNT ? tlsf->sl_bitmap[fl] & (~0U << sl) : 0;
+    if (!sl_map) {
+        fl_map = fl + 1 < TLSF_FL_COUNT ? tlsf->fl_bitmap & (~0U << (fl + 1)) : 0;
+        if (!fl_map) {
+            /*
+             * Nothing in the bigger classes. When the heap is almost full, the
+             * right block may still be in the class of the request, only worth
+             * a walk in that case.
+             */
+            tlsf_mapping(size, &fl, &sl);
+            for (free_blk = tlsf->free_list[fl][sl]; free_blk; free_blk = free_blk->free_next) {
+                if (blk_link_size(&free_blk->blk) >= size) {
+                    tlsf_remove(num, &free_blk->blk);
+                    return &free_blk->blk;
+                }
+            }
+            return NULL;
+        }
+        fl = heap_ffs(fl_map);
+        sl_map = tlsf->sl_bitmap[fl];
+    }
+    sl = heap_ffs(sl_map);
+
+    free_blk = tlsf->free_list[fl][sl];
+    tlsf_remove(num, &free_blk->blk);
+
+    return &free_blk->blk;
+}
+#endif /* CONFIG_HEAP_ALLOCATOR_TLSF */
+
 /**
  * @brief Initialize regions of memory to the collection of heaps at runtime.
  */
@@ -59,6 +223,11 @@ void esp_heap_caps_init_region(heap_region_t *region, size_t max_num)
 
         g_heap_region[num].free_blk = mem_start;
         g_heap_region[num].min_free_bytes = g_heap_region[num].free_bytes = blk_link_size(mem_start);
+
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+        memset(&s_heap_tlsf[num], 0, sizeof(heap_tlsf_t));
+        tlsf_insert(num, mem_start);
+#endif
     }
     g_heap_region_num = max_num;
 }
@@ -91,6 +260,93 @@ size_t heap_caps_get_minimum_free_size(uint32_t caps)
     return bytes;
 }
 
+static size_t heap_caps_free_hist_bin(size_t size)
+{
+    size_t bin = 0;
+
+    for (size >>= 5; size && bin < HEAP_FREE_HIST_BINS - 1; size >>= 1)
+        bin++;
+
+    return bin;
+}
+
+/**
+ * @brief Get heap info for all regions with the given capabilities.
+ */
+void heap_caps_get_info(multi_heap_info_t *info, uint32_t caps)
+{
+    memset(info, 0, sizeof(multi_heap_info_t));
+
+    for (int num = 0; num < g_heap_region_num; num++) {
+        mem_blk_t *mem_blk;
+
+        if (caps != (caps & g_heap_region[num].caps))
+            continue;
+
+        _heap_caps_lock(num);
+
+        for (mem_blk = (mem_blk_t *)HEAP_ALIGN(g_heap_region[num].start_addr); !mem_blk_is_end(mem_blk);
+             mem_blk = mem_blk_next(mem_blk)) {
+            size_t size = blk_link_size(mem_blk);
+
+            info->total_blocks++;
+            if (mem_blk_is_used(mem_blk)) {
+                info->allocated_blocks++;
+                info->total_allocated_bytes += size;
+            } else {
+                /* What malloc() can get out of it */
+                size_t usable = size - MEM_HEAD_SIZE;
+
+                info->free_blocks++;
+                info->free_block_hist[heap_caps_free_hist_bin(size)]++;
+                if (usable > info->largest_free_block)
+                    info->largest_free_block = usable;
+            }
+        }
+
+        info->total_free_bytes += g_heap_region[num].free_bytes;
+        info->minimum_free_bytes += g_heap_region[num].min_free_bytes;
+
+        _heap_caps_unlock(num);
+    }
+}
+
+/**
+ * @brief Get the largest free block of memory able to be allocated with the given capabilities.
+ */
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    multi_heap_info_t info;
+
+    heap_caps_get_info(&info, caps);
+
+    return info.largest_free_block;
+}
+
+/**
+ * @brief Print a summary of all the regions with the given capabilities.
+ */
+void heap_caps_print_heap_info(uint32_t caps)
+{
+    multi_heap_info_t info;
+
+    heap_caps_get_info(&info, caps);
+
+    printf("Heap summary for capabilities 0x%08x:\n", caps);
+    printf("  free %u allocated %u min_free %u largest_free_block %u\n", info.total_free_bytes,
+           info.total_allocated_bytes, info.minimum_free_bytes, info.largest_free_block);
+    printf("  blocks %u, %u allocated, %u free\n", info.total_blocks, info.allocated_blocks, info.free_blocks);
+    printf("  free blocks by size:\n");
+    for (int i = 0; i < HEAP_FREE_HIST_BINS; i++) {
+        if (i == 0)
+            printf("    %5s < %5u: %u\n", "", 32, info.free_block_hist[i]);
+        else if (i == HEAP_FREE_HIST_BINS - 1)
+            printf("    %5u <      : %u\n", 16 << i, info.free_block_hist[i]);
+        else
+            printf("    %5u - %5u: %u\n", 16 << i, (32 << i) - 1, info.free_block_hist[i]);
+    }
+}
+
 /**
  * @brief Allocate a chunk of memory which has the given capabilities
  */
@@ -101,6 +357,10 @@ void IRAM_ATTR *_heap_caps_malloc(size_t size, uint32_t caps, const char *file,
     uint32_t num;
     uint32_t mem_blk_size;
 
+#ifdef CONFIG_HEAP_PROFILING
+    uint32_t start = _heap_caps_get_ccount();
+#endif
+
     if (size > (HEAP_MAX_SIZE - sizeof(mem2_blk_t) * 2)) {
         ESP_EARLY_LOGV(TAG, "size=%u is oveflow", size);
         return NULL;
@@ -113,8 +373,10 @@ void IRAM_ATTR *_heap_caps_malloc(size_t size, uint32_t caps, const char *file,
     }
 
     for (num = 0; num < g_heap_region_num; num++) {
-        bool trace;
+        bool trace = false;
+#ifndef CONFIG_HEAP_ALLOCATOR_TLSF
         size_t head_size;
+#endif
 
         if ((g_heap_region[num].caps & caps) != caps) {
             ESP_EARLY_LOGV(TAG, "caps in %x, num %d region %x @ %p", caps, num, g_heap_region[num].caps, &g_heap_region[num]);
@@ -128,6 +390,10 @@ void IRAM_ATTR *_heap_caps_malloc(size_t size, uint32_t caps, const char *file,
 #endif
 
         mem_blk_size = ptr2memblk_size(size, trace);
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+        if (mem_blk_size < MEM_FREE_BLK_MIN)
+            mem_blk_size = MEM_FREE_BLK_MIN;
+#endif
 
         ESP_EARLY_LOGV(TAG, "malloc size is %d(%x) blk size is %d(%x) region is %d", size, size,
                             mem_blk_size, mem_blk_size, num);
@@ -135,6 +401,9 @@ void IRAM_ATTR *_heap_caps_malloc(size_t size, uint32_t caps, const char *file,
         if (mem_blk_size > g_heap_region[num].free_bytes)
             goto next_region;
 
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+        mem_blk = tlsf_take(num, mem_blk_size);
+#else
         mem_blk = (mem_blk_t *)g_heap_region[num].free_blk;
 
         ESP_EARLY_LOGV(TAG, "malloc start %p", mem_blk);
@@ -144,8 +413,9 @@ void IRAM_ATTR *_heap_caps_malloc(size_t size, uint32_t caps, const char *file,
                                 mem_blk_is_used(mem_blk), mem_blk_is_traced(mem_blk), blk_link_size(mem_blk));
             mem_blk = mem_blk_next(mem_blk);
         }
+#endif
 
-        ESP_EARLY_LOGV(TAG, "malloc end %p, end %d", mem_blk, mem_blk_is_end(mem_blk));
+        ESP_EARLY_LOGV(TAG, "malloc end %p, end %d", mem_blk, mem_blk ? mem_blk_is_end(mem_blk) : 0);
 
         if (!mem_blk || mem_blk_is_end(mem_blk))
             goto next_region;
@@ -153,9 +423,14 @@ void IRAM_ATTR *_heap_caps_malloc(size_t size, uint32_t caps, const char *file,
         ret_mem = blk2ptr(mem_blk, trace);
         ESP_EARLY_LOGV(TAG, "ret_mem is %p", ret_mem);
 
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+        /* The remainder must be able to hold the free list links */
+        if (blk_link_size(mem_blk) >= mem_blk_size + MEM_FREE_BLK_MIN)
+#else
         head_size = mem_blk_head_size(trace);
 
         if (blk_link_size(mem_blk) >= mem_blk_size + head_size + MEM_BLK_MIN)
+#endif
             next_mem_blk = (mem_blk_t *)((uint8_t *)mem_blk + mem_blk_size);
         else 
             next_mem_blk = mem_blk_next(mem_blk);
@@ -173,6 +448,9 @@ void IRAM_ATTR *_heap_caps_malloc(size_t size, uint32_t caps, const char *file,
 
             mem_blk_set_prev(mem_blk_next(mem_blk), next_mem_blk);
             mem_blk_set_next(mem_blk, next_mem_blk);
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+            tlsf_insert(num, next_mem_blk);
+#endif
         }
 
         mem_blk_set_used(mem_blk);
@@ -181,6 +459,7 @@ void IRAM_ATTR *_heap_caps_malloc(size_t size, uint32_t caps, const char *file,
             ESP_EARLY_LOGV(TAG, "mem_blk1 %p set trace", mem_blk);
         }
 
+#ifndef CONFIG_HEAP_ALLOCATOR_TLSF
         if (g_heap_region[num].free_blk == mem_blk) {
             mem_blk_t *free_blk = mem_blk;
 
@@ -193,6 +472,7 @@ void IRAM_ATTR *_heap_caps_malloc(size_t size, uint32_t caps, const char *file,
         } else {
             ESP_EARLY_LOGV(TAG, "free_blk is %p", g_heap_region[num].free_blk);
         }
+#endif
 
         mem_blk_size = blk_link_size(mem_blk);
         g_heap_region[num].free_bytes -= mem_blk_size;
@@ -216,6 +496,10 @@ next_region:
 
     ESP_EARLY_LOGV(TAG, "malloc return mem %p", ret_mem);
 
+#ifdef CONFIG_HEAP_PROFILING
+    heap_profile_record_malloc(file, line, size, ret_mem != NULL, _heap_caps_get_ccount() - start);
+#endif
+
     return ret_mem;
 }
 
@@ -227,6 +511,9 @@ void IRAM_ATTR _heap_caps_free(void *ptr, const char *file, size_t line)
     int num;
     mem_blk_t *mem_blk;
     mem_blk_t *tmp, *next, *prev, *last;
+#ifdef CONFIG_HEAP_PROFILING
+    uint32_t start = _heap_caps_get_ccount();
+#endif
 
     if ((int)line == 0) {
         ESP_EARLY_LOGV(TAG, "caller func %p", file);
@@ -275,6 +562,9 @@ void IRAM_ATTR _heap_caps_free(void *ptr, const char *file, size_t line)
     last = mem_blk_next(next);
 
     if (prev && !mem_blk_is_used(prev)) {
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+        tlsf_remove(num, prev);
+#endif
         mem_blk_set_next(prev, next);
         mem_blk_set_prev(next, prev);
         tmp = prev;
@@ -282,6 +572,9 @@ void IRAM_ATTR _heap_caps_free(void *ptr, const char *file, size_t line)
         tmp = mem_blk;
 
     if (last && !mem_blk_is_used(next)) {
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+        tlsf_remove(num, next);
+#endif
         mem_blk_set_next(tmp, last);
         mem_blk_set_prev(last, tmp);
     }
@@ -289,12 +582,20 @@ void IRAM_ATTR _heap_caps_free(void *ptr, const char *file, size_t line)
     ESP_EARLY_LOGV(TAG, "ptr2 prev->next=%p next->prev=%p", mem_blk_prev(mem_blk) ? mem_blk_next(mem_blk_prev(mem_blk)) : NULL,
                         mem_blk_prev(mem_blk_next(mem_blk)));
 
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+    tlsf_insert(num, tmp);
+#else
     if ((uint8_t *)mem_blk < (uint8_t *)g_heap_region[num].free_blk) {
         ESP_EARLY_LOGV(TAG, "Free update free block from %p to %p", g_heap_region[num].free_blk, mem_blk);
         g_heap_region[num].free_blk = mem_blk;
     }
+#endif
 
     _heap_caps_unlock(num);
+
+#ifdef CONFIG_HEAP_PROFILING
+    heap_profile_record_free(_heap_caps_get_ccount() - start);
+#endif
 }
 
 /**
@@ -316,6 +617,102 @@ void *_heap_caps_calloc(size_t count, size_t size, uint32_t caps, const char *fi
     return p;
 }
 
+/*
+ * Make the free block "free_blk" of the space between "mem_blk" and "next".
+ */
+static void IRAM_ATTR heap_caps_link_free(size_t num, mem_blk_t *mem_blk, mem_blk_t *free_blk, mem_blk_t *next)
+{
+    free_blk->prev = free_blk->next = NULL;
+
+    mem_blk_set_prev(free_blk, mem_blk);
+    mem_blk_set_next(free_blk, next);
+
+    mem_blk_set_prev(next, free_blk);
+    mem_blk_set_next(mem_blk, free_blk);
+
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+    tlsf_insert(num, free_blk);
+#else
+    if ((uint8_t *)free_blk < (uint8_t *)g_heap_region[num].free_blk)
+        g_heap_region[num].free_blk = free_blk;
+#endif
+}
+
+/*
+ * Resize the block of "mem" without moving it: a shrinking block gives its
+ * tail back, a growing one takes the beginning of the next block if that one
+ * is free and big enough.
+ */
+static bool IRAM_ATTR heap_caps_resize_in_place(size_t num, void *mem, size_t newsize, const char *file, size_t line)
+{
+    bool trace = ptr_is_traced(mem);
+    mem_blk_t *mem_blk = ptr2blk(mem, trace);
+    mem_blk_t *next, *last;
+    size_t mem_blk_size, new_blk_size, split_min;
+    bool next_free;
+
+    new_blk_size = ptr2memblk_size(newsize, trace);
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+    if (new_blk_size < MEM_FREE_BLK_MIN)
+        new_blk_size = MEM_FREE_BLK_MIN;
+    split_min = MEM_FREE_BLK_MIN;
+#else
+    split_min = mem_blk_head_size(trace) + MEM_BLK_MIN;
+#endif
+
+    _heap_caps_lock(num);
+
+    mem_blk_size = blk_link_size(mem_blk);
+    next = mem_blk_next(mem_blk);
+    last = mem_blk_next(next);
+    next_free = last && !mem_blk_is_used(next);
+
+    if (new_blk_size > mem_blk_size && (!next_free || mem_blk_size + blk_link_size(next) < new_blk_size)) {
+        _heap_caps_unlock(num);
+        return false;
+    }
+
+    if (next_free) {
+        /* The free neighbour is rebuilt after the new end of the block, if anything is left of it */
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+        tlsf_remove(num, next);
+#endif
+        mem_blk_set_next(mem_blk, last);
+        mem_blk_set_prev(last, mem_blk);
+
+        if (blk_link_size(mem_blk) >= new_blk_size + split_min)
+            heap_caps_link_free(num, mem_blk, (mem_blk_t *)((uint8_t *)mem_blk + new_blk_size), last);
+    } else if (mem_blk_size >= new_blk_size + split_min) {
+        heap_caps_link_free(num, mem_blk, (mem_blk_t *)((uint8_t *)mem_blk + new_blk_size), next);
+    }
+
+#ifndef CONFIG_HEAP_ALLOCATOR_TLSF
+    if (g_heap_region[num].free_blk == next) {
+        mem_blk_t *free_blk = mem_blk;
+
+        while (free_blk && !mem_blk_is_end(free_blk) && mem_blk_is_used(free_blk)) {
+            free_blk = mem_blk_next(free_blk);
+        }
+
+        ESP_EARLY_LOGV(TAG, "reset free_blk from %p to %p", g_heap_region[num].free_blk, free_blk);
+        g_heap_region[num].free_blk = free_blk;
+    }
+#endif
+
+    if (trace)
+        mem_blk_set_traced((mem2_blk_t *)mem_blk, file, line);
+
+    g_heap_region[num].free_bytes = g_heap_region[num].free_bytes + mem_blk_size - blk_link_size(mem_blk);
+    if (g_heap_region[num].min_free_bytes > g_heap_region[num].free_bytes)
+        g_heap_region[num].min_free_bytes = g_heap_region[num].free_bytes;
+
+    _heap_caps_unlock(num);
+
+    ESP_EARLY_LOGV(TAG, "resize %p from %d to %d bytes in place", mem, mem_blk_size, blk_link_size(mem_blk));
+
+    return true;
+}
+
 /**
  * @brief Reallocate memory previously allocated via heap_caps_(m/c/r/z)alloc().
  */
@@ -323,6 +720,23 @@ void *_heap_caps_realloc(void *mem, size_t newsize, uint32_t caps, const char *f
 {
     void *return_addr = (void *)__builtin_return_address(0);
 
+#ifdef CONFIG_HEAP_PROFILING
+    uint32_t start = _heap_caps_get_ccount();
+#endif
+
+    if (mem && newsize && newsize <= (HEAP_MAX_SIZE - sizeof(mem2_blk_t) * 2)) {
+        size_t num = get_blk_region(mem);
+
+        if (num < g_heap_region_num && (g_heap_region[num].caps & caps) == caps
+            && heap_caps_resize_in_place(num, mem, newsize, file, line)) {
+#ifdef CONFIG_HEAP_PROFILING
+            /* Counted as the malloc a moving realloc would have done */
+            heap_profile_record_malloc(file, line, newsize, true, _heap_caps_get_ccount() - start);
+#endif
+            return mem;
+        }
+    }
+
     void *p = _heap_caps_malloc(newsize, caps, file, line);
     if (p && mem) {
         size_t mem_size = ptr_size(mem);
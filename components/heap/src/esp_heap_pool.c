@@ -0,0 +1,147 @@
+// Copyright 2018-2019 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "esp_heap_caps.h"
+#include "esp_heap_port.h"
+#include "esp_heap_pool.h"
+
+#include "esp_attr.h"
+#include "esp_log.h"
+
+typedef struct pool_obj {
+    struct pool_obj *next;
+} pool_obj_t;
+
+struct heap_caps_pool {
+    pool_obj_t      *free_list;     ///< Free objects, the last freed one first
+    uint8_t         *start;         ///< First object
+    uint8_t         *end;           ///< End of the last object
+    size_t          obj_size;
+
+    size_t          free_count;
+    size_t          min_free_count;
+};
+
+static const char *TAG = "heap_pool";
+
+heap_caps_pool_handle_t heap_caps_pool_create(size_t obj_size, size_t count, uint32_t caps)
+{
+    heap_caps_pool_handle_t pool;
+    size_t head_size = HEAP_ALIGN(sizeof(struct heap_caps_pool));
+
+    if (!obj_size || !count)
+        return NULL;
+
+    if (obj_size < sizeof(pool_obj_t))
+        obj_size = sizeof(pool_obj_t);
+    obj_size = HEAP_ALIGN(obj_size);
+
+    if (count > (SIZE_MAX - head_size) / obj_size)
+        return NULL;
+
+    pool = heap_caps_malloc(head_size + obj_size * count, caps);
+    if (!pool) {
+        ESP_LOGE(TAG, "no memory for %u objects of %u bytes", count, obj_size);
+        return NULL;
+    }
+
+    pool->obj_size = obj_size;
+    pool->start = (uint8_t *)pool + head_size;
+    pool->end = pool->start + obj_size * count;
+    pool->free_count = pool->min_free_count = count;
+
+    /* Link the objects in address order, the first allocations are then contiguous */
+    pool->free_list = NULL;
+    for (size_t i = count; i > 0; i--) {
+        pool_obj_t *obj = (pool_obj_t *)(pool->start + (i - 1) * obj_size);
+
+        obj->next = pool->free_list;
+        pool->free_list = obj;
+    }
+
+    return pool;
+}
+
+void heap_caps_pool_delete(heap_caps_pool_handle_t pool)
+{
+    if (!pool)
+        return;
+
+    if (pool->free_count != (size_t)(pool->end - pool->start) / pool->obj_size)
+        ESP_LOGW(TAG, "pool %p deleted with objects in use", pool);
+
+    heap_caps_free(pool);
+}
+
+void IRAM_ATTR *heap_caps_pool_alloc(heap_caps_pool_handle_t pool)
+{
+    pool_obj_t *obj;
+
+    _heap_caps_lock(0);
+
+    obj = pool->free_list;
+    if (obj) {
+        pool->free_list = obj->next;
+        if (--pool->free_count < pool->min_free_count)
+            pool->min_free_count = pool->free_count;
+    }
+
+    _heap_caps_unlock(0);
+
+    return obj;
+}
+
+void IRAM_ATTR heap_caps_pool_free(heap_caps_pool_handle_t pool, void *ptr)
+{
+    pool_obj_t *obj = ptr;
+
+    if (!ptr)
+        return;
+
+    if (!heap_caps_pool_owns(pool, ptr) || ((uint8_t *)ptr - pool->start) % pool->obj_size) {
+        ESP_EARLY_LOGE(TAG, "free(%p) is not an object of pool %p", ptr, pool);
+        return;
+    }
+
+    _heap_caps_lock(0);
+
+    obj->next = pool->free_list;
+    pool->free_list = obj;
+    pool->free_count++;
+
+    _heap_caps_unlock(0);
+}
+
+bool IRAM_ATTR heap_caps_pool_owns(heap_caps_pool_handle_t pool, const void *ptr)
+{
+    return (const uint8_t *)ptr >= pool->start && (const uint8_t *)ptr < pool->end;
+}
+
+size_t heap_caps_pool_get_obj_size(heap_caps_pool_handle_t pool)
+{
+    return pool->obj_size;
+}
+
+size_t heap_caps_pool_get_free_count(heap_caps_pool_handle_t pool)
+{
+    return pool->free_count;
+}
+
+size_t heap_caps_pool_get_minimum_free_count(heap_caps_pool_handle_t pool)
+{
+    return pool->min_free_count;
+}
@@ -0,0 +1,221 @@
+// Copyright 2018-2019 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "esp_heap_caps.h"
+#include "esp_heap_port.h"
+#include "esp_heap_profile.h"
+#include "priv/esp_heap_caps_priv.h"
+
+#include "esp_attr.h"
+
+#ifdef CONFIG_HEAP_PROFILING
+
+/*
+ * Sites are found by hashing, the first free entry of the few after the hashed one
+ * is taken, or else the allocation is counted against the other sites. It runs with
+ * the heap locked, so the probes are bounded and the number of sites is a power of 2:
+ * the CPU has no divide instruction.
+ */
+#define SITES_NUM       CONFIG_HEAP_PROFILING_SITES
+#define SITES_MASK      (SITES_NUM - 1)
+#define SITES_PROBES    8
+
+_Static_assert((SITES_NUM & SITES_MASK) == 0, "CONFIG_HEAP_PROFILING_SITES is not a power of two");
+
+static heap_profile_site_t s_sites[SITES_NUM];
+static heap_profile_site_t s_other_site;
+
+static heap_profile_latency_t s_malloc_latency;
+static heap_profile_latency_t s_free_latency;
+
+static inline size_t IRAM_ATTR site_hash(const char *file, uint32_t line)
+{
+    return ((((uint32_t)file >> 2) ^ line) * 2654435761U) >> (32 - __builtin_ctz(SITES_NUM));
+}
+
+static void IRAM_ATTR latency_add(heap_profile_latency_t *latency, uint32_t cycles)
+{
+    size_t bin = 0;
+
+    for (uint32_t c = cycles >> 6; c && bin < HEAP_PROFILE_LATENCY_BINS - 1; c >>= 1)
+        bin++;
+
+    latency->count++;
+    latency->total += cycles;
+    latency->hist[bin]++;
+    if (cycles > latency->max)
+        latency->max = cycles;
+}
+
+void IRAM_ATTR heap_profile_record_malloc(const char *file, size_t line, size_t size, bool done, uint32_t cycles)
+{
+    heap_profile_site_t *site = &s_other_site;
+
+    _heap_caps_lock(0);
+
+    latency_add(&s_malloc_latency, cycles);
+
+    if (done) {
+        size_t i = site_hash(file, line);
+
+        for (size_t n = 0; n < SITES_PROBES; n++) {
+            if (!s_sites[i].file) {
+                s_sites[i].file = file;
+                s_sites[i].line = line;
+            }
+            if (s_sites[i].file == file && s_sites[i].line == line) {
+                site = &s_sites[i];
+                break;
+            }
+            i = (i + 1) & SITES_MASK;
+        }
+        site->count++;
+        site->bytes += size;
+    }
+
+    _heap_caps_unlock(0);
+}
+
+void IRAM_ATTR heap_profile_record_free(uint32_t cycles)
+{
+    _heap_caps_lock(0);
+
+    latency_add(&s_free_latency, cycles);
+
+    _heap_caps_unlock(0);
+}
+
+void heap_profile_reset(void)
+{
+    _heap_caps_lock(0);
+
+    memset(s_sites, 0, sizeof(s_sites));
+    memset(&s_other_site, 0, sizeof(s_other_site));
+    memset(&s_malloc_latency, 0, sizeof(s_malloc_latency));
+    memset(&s_free_latency, 0, sizeof(s_free_latency));
+
+    _heap_caps_unlock(0);
+}
+
+void heap_profile_get_latency(heap_profile_latency_t *malloc_latency, heap_profile_latency_t *free_latency)
+{
+    _heap_caps_lock(0);
+
+    if (malloc_latency)
+        *malloc_latency = s_malloc_latency;
+    if (free_latency)
+        *free_latency = s_free_latency;
+
+    _heap_caps_unlock(0);
+}
+
+static int site_cmp(const void *a, const void *b)
+{
+    const heap_profile_site_t *x = a, *y = b;
+
+    return x->bytes < y->bytes ? 1 : x->bytes > y->bytes ? -1 : 0;
+}
+
+size_t heap_profile_get_sites(heap_profile_site_t *sites, size_t max_sites)
+{
+    heap_profile_site_t *copy;
+    size_t n = 0;
+
+    /* Sorted out of the lock, the table may be updated in the meantime */
+    copy = heap_caps_malloc(sizeof(s_sites) + sizeof(heap_profile_site_t), MALLOC_CAP_8BIT);
+    if (!copy)
+        return 0;
+
+    for (size_t i = 0; i < SITES_NUM; i++) {
+        _heap_caps_lock(0);
+        if (s_sites[i].file)
+            copy[n++] = s_sites[i];
+        _heap_caps_unlock(0);
+    }
+    _heap_caps_lock(0);
+    if (s_other_site.count)
+        copy[n++] = s_other_site;
+    _heap_caps_unlock(0);
+
+    qsort(copy, n, sizeof(heap_profile_site_t), site_cmp);
+
+    if (n > max_sites)
+        n = max_sites;
+    memcpy(sites, copy, n * sizeof(heap_profile_site_t));
+
+    heap_caps_free(copy);
+
+    return n;
+}
+
+static void latency_dump(const char *name, const heap_profile_latency_t *latency, uint32_t cycles_per_us)
+{
+    if (!latency->count)
+        return;
+
+    printf("%s: %u calls, mean %u.%02u us, max %u.%02u us\n", name, latency->count,
+           (uint32_t)(latency->total / latency->count / cycles_per_us),
+           (uint32_t)(latency->total / latency->count % cycles_per_us * 100 / cycles_per_us),
+           latency->max / cycles_per_us, latency->max % cycles_per_us * 100 / cycles_per_us);
+
+    for (int i = 0; i < HEAP_PROFILE_LATENCY_BINS; i++) {
+        uint32_t from = i ? (32 << i) / cycles_per_us : 0;
+
+        if (!latency->hist[i])
+            continue;
+        if (i == HEAP_PROFILE_LATENCY_BINS - 1)
+            printf("  %5u us <        : %u\n", from, latency->hist[i]);
+        else
+            printf("  %5u - %5u us   : %u\n", from, (64 << i) / cycles_per_us, latency->hist[i]);
+    }
+}
+
+void heap_profile_dump(size_t max_sites)
+{
+    extern int esp_clk_cpu_freq(void);
+    uint32_t cycles_per_us = esp_clk_cpu_freq() / 1000000;
+    heap_profile_latency_t malloc_latency, free_latency;
+    heap_profile_site_t *sites;
+    size_t n;
+
+    heap_caps_print_heap_info(MALLOC_CAP_8BIT);
+
+    heap_profile_get_latency(&malloc_latency, &free_latency);
+    latency_dump("malloc", &malloc_latency, cycles_per_us);
+    latency_dump("free", &free_latency, cycles_per_us);
+
+    sites = heap_caps_malloc(max_sites * sizeof(heap_profile_site_t), MALLOC_CAP_8BIT);
+    if (!sites)
+        return;
+
+    n = heap_profile_get_sites(sites, max_sites);
+    printf("Top %u call sites by allocated bytes:\n", n);
+    for (size_t i = 0; i < n; i++) {
+        if (!sites[i].file)
+            printf("  %-40s %8u bytes in %6u allocations\n", "(other sites)", sites[i].bytes, sites[i].count);
+        else if (sites[i].line)
+            printf("  %32s:%-7u %8u bytes in %6u allocations\n", sites[i].file, sites[i].line, sites[i].bytes, sites[i].count);
+        else
+            printf("  caller %-33p %8u bytes in %6u allocations\n", sites[i].file, sites[i].bytes, sites[i].count);
+    }
+
+    heap_caps_free(sites);
+}
+
+#endif /* CONFIG_HEAP_PROFILING */
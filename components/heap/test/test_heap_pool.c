@@ -0,0 +1,105 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include "esp_attr.h"
+#include "esp8266/eagle_soc.h"
+
+#include "esp_heap_caps.h"
+#include "esp_heap_pool.h"
+
+#define TEST_POOL_OBJ_SIZE  30
+#define TEST_POOL_COUNT     16
+#define TEST_LOOPS          1000
+
+#define TIME_US_REG 0x3ff20c00
+
+static inline uint32_t get_us(void)
+{
+    return REG_READ(TIME_US_REG);
+}
+
+TEST_CASE("Test Heap pool alloc/free", "[Heap]")
+{
+    void *obj[TEST_POOL_COUNT];
+    size_t free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(TEST_POOL_OBJ_SIZE, TEST_POOL_COUNT, MALLOC_CAP_8BIT);
+
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_EQUAL(32, heap_caps_pool_get_obj_size(pool));
+    TEST_ASSERT_EQUAL(TEST_POOL_COUNT, heap_caps_pool_get_free_count(pool));
+
+    for (int i = 0; i < TEST_POOL_COUNT; i++) {
+        obj[i] = heap_caps_pool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(obj[i]);
+        TEST_ASSERT_TRUE(heap_caps_pool_owns(pool, obj[i]));
+        memset(obj[i], i, TEST_POOL_OBJ_SIZE);
+    }
+    TEST_ASSERT_NULL(heap_caps_pool_alloc(pool));
+    TEST_ASSERT_EQUAL(0, heap_caps_pool_get_minimum_free_count(pool));
+
+    /* Objects must not overlap */
+    for (int i = 0; i < TEST_POOL_COUNT; i++) {
+        for (int j = 0; j < TEST_POOL_OBJ_SIZE; j++) {
+            TEST_ASSERT_EQUAL(i, ((uint8_t *)obj[i])[j]);
+        }
+    }
+
+    void *other = heap_caps_malloc(TEST_POOL_OBJ_SIZE, MALLOC_CAP_8BIT);
+    TEST_ASSERT_FALSE(heap_caps_pool_owns(pool, other));
+    heap_caps_free(other);
+
+    /* The last freed object is given first */
+    heap_caps_pool_free(pool, obj[3]);
+    TEST_ASSERT_EQUAL(1, heap_caps_pool_get_free_count(pool));
+    TEST_ASSERT_EQUAL_PTR(obj[3], heap_caps_pool_alloc(pool));
+
+    for (int i = 0; i < TEST_POOL_COUNT; i++) {
+        heap_caps_pool_free(pool, obj[i]);
+    }
+    TEST_ASSERT_EQUAL(TEST_POOL_COUNT, heap_caps_pool_get_free_count(pool));
+
+    heap_caps_pool_delete(pool);
+    TEST_ASSERT_EQUAL(free_heap, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+}
+
+TEST_CASE("Test Heap pool effectivity", "[Heap]")
+{
+    uint32_t t, pool_us = 0, heap_us = 0;
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(TEST_POOL_OBJ_SIZE, TEST_POOL_COUNT, MALLOC_CAP_8BIT);
+
+    TEST_ASSERT_NOT_NULL(pool);
+
+    for (int i = 0; i < TEST_LOOPS; i++) {
+        t = get_us();
+        void *p = heap_caps_pool_alloc(pool);
+        heap_caps_pool_free(pool, p);
+        pool_us += get_us() - t;
+
+        t = get_us();
+        p = heap_caps_malloc(TEST_POOL_OBJ_SIZE, MALLOC_CAP_8BIT);
+        heap_caps_free(p);
+        heap_us += get_us() - t;
+    }
+
+    printf("Each pool alloc/free costs time %u us, each heap alloc/free costs time %u us\n",
+           pool_us / TEST_LOOPS, heap_us / TEST_LOOPS);
+
+    heap_caps_pool_delete(pool);
+}
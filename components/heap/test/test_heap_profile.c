@@ -0,0 +1,147 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include "esp_heap_caps.h"
+#include "esp_heap_profile.h"
+
+#define TEST_BLOCKS         16
+#define TEST_BLOCK_SIZE     100
+
+TEST_CASE("Test Heap info", "[Heap]")
+{
+    multi_heap_info_t before, after;
+    void *p[TEST_BLOCKS];
+
+    heap_caps_get_info(&before, MALLOC_CAP_8BIT);
+    TEST_ASSERT_EQUAL(heap_caps_get_free_size(MALLOC_CAP_8BIT), before.total_free_bytes);
+    TEST_ASSERT_EQUAL(before.total_blocks, before.allocated_blocks + before.free_blocks);
+    TEST_ASSERT_LESS_OR_EQUAL(before.total_free_bytes, before.largest_free_block);
+
+    size_t hist_blocks = 0;
+    for (int i = 0; i < HEAP_FREE_HIST_BINS; i++) {
+        hist_blocks += before.free_block_hist[i];
+    }
+    TEST_ASSERT_EQUAL(before.free_blocks, hist_blocks);
+
+    void *big = heap_caps_malloc(before.largest_free_block, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(big);
+    heap_caps_free(big);
+
+    /* Every other block freed leaves as many new holes */
+    for (int i = 0; i < TEST_BLOCKS; i++) {
+        p[i] = heap_caps_malloc(TEST_BLOCK_SIZE, MALLOC_CAP_8BIT);
+        TEST_ASSERT_NOT_NULL(p[i]);
+    }
+    for (int i = 0; i < TEST_BLOCKS; i += 2) {
+        heap_caps_free(p[i]);
+    }
+    heap_caps_get_info(&after, MALLOC_CAP_8BIT);
+    TEST_ASSERT_GREATER_OR_EQUAL(before.allocated_blocks + TEST_BLOCKS / 2, after.allocated_blocks);
+
+    heap_caps_print_heap_info(MALLOC_CAP_8BIT);
+
+    for (int i = 1; i < TEST_BLOCKS; i += 2) {
+        heap_caps_free(p[i]);
+    }
+}
+
+#ifdef CONFIG_HEAP_PROFILING
+TEST_CASE("Test Heap profile call sites and latency", "[Heap]")
+{
+    heap_profile_site_t sites[4];
+    heap_profile_latency_t malloc_latency, free_latency;
+    const uint32_t line = __LINE__ + 5;
+
+    heap_profile_reset();
+
+    for (int i = 0; i < TEST_BLOCKS; i++) {
+        void *p = heap_caps_malloc(TEST_BLOCK_SIZE, MALLOC_CAP_8BIT);
+        heap_caps_free(p);
+    }
+
+    heap_profile_get_latency(&malloc_latency, &free_latency);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_BLOCKS, malloc_latency.count);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_BLOCKS, free_latency.count);
+    TEST_ASSERT_NOT_EQUAL(0, malloc_latency.max);
+
+    size_t n = heap_profile_get_sites(sites, 4);
+    bool found = false;
+    for (int i = 0; i < n; i++) {
+        if (sites[i].file && sites[i].line == line) {
+            TEST_ASSERT_EQUAL(TEST_BLOCKS, sites[i].count);
+            TEST_ASSERT_EQUAL(TEST_BLOCKS * TEST_BLOCK_SIZE, sites[i].bytes);
+            found = true;
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+
+    heap_profile_dump(4);
+}
+
+static bool find_site(uint32_t line, heap_profile_site_t *site)
+{
+    heap_profile_site_t sites[8];
+    size_t n = heap_profile_get_sites(sites, 8);
+
+    for (int i = 0; i < n; i++) {
+        if (sites[i].file && sites[i].line == line) {
+            *site = sites[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_CASE("Test Heap profile counts the reallocs done in place", "[Heap]")
+{
+    heap_profile_site_t site;
+    heap_profile_latency_t latency;
+    void *p, *q;
+
+    p = heap_caps_malloc(TEST_BLOCK_SIZE, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(p);
+
+    heap_profile_reset();
+
+    /* Shrinking never moves the block */
+    const uint32_t shrink_line = __LINE__ + 1;
+    q = heap_caps_realloc(p, TEST_BLOCK_SIZE / 2, MALLOC_CAP_8BIT);
+    TEST_ASSERT_EQUAL_PTR(p, q);
+
+    /* The tail given back is free, so growing again fits in place */
+    const uint32_t grow_line = __LINE__ + 1;
+    q = heap_caps_realloc(p, TEST_BLOCK_SIZE, MALLOC_CAP_8BIT);
+    TEST_ASSERT_EQUAL_PTR(p, q);
+
+    heap_profile_get_latency(&latency, NULL);
+    TEST_ASSERT_GREATER_OR_EQUAL(2, latency.count);
+    TEST_ASSERT_NOT_EQUAL(0, latency.max);
+
+    TEST_ASSERT_TRUE(find_site(shrink_line, &site));
+    TEST_ASSERT_EQUAL(1, site.count);
+    TEST_ASSERT_EQUAL(TEST_BLOCK_SIZE / 2, site.bytes);
+    TEST_ASSERT_TRUE(find_site(grow_line, &site));
+    TEST_ASSERT_EQUAL(1, site.count);
+    TEST_ASSERT_EQUAL(TEST_BLOCK_SIZE, site.bytes);
+
+    heap_caps_free(p);
+}
+#endif
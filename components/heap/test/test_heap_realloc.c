@@ -0,0 +1,115 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+
+#include "esp_heap_caps.h"
+
+#define TEST_BUF_SIZE       4096
+#define TEST_STEP_SIZE      64
+#define TEST_PAIRS          8
+
+static void test_fill(uint8_t *p, size_t from, size_t to)
+{
+    for (size_t i = from; i < to; i++) {
+        p[i] = i & 0xff;
+    }
+}
+
+static void test_check(const uint8_t *p, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        TEST_ASSERT_EQUAL_HEX8(i & 0xff, p[i]);
+    }
+}
+
+TEST_CASE("Test Heap realloc shrinks and grows in place", "[Heap]")
+{
+    size_t free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    uint8_t *buf = heap_caps_malloc(TEST_BUF_SIZE, MALLOC_CAP_8BIT);
+
+    TEST_ASSERT_NOT_NULL(buf);
+    test_fill(buf, 0, TEST_BUF_SIZE);
+
+    /* The tail is given back, so the space right after the buffer is free */
+    TEST_ASSERT_EQUAL_PTR(buf, heap_caps_realloc(buf, TEST_STEP_SIZE, MALLOC_CAP_8BIT));
+    TEST_ASSERT_GREATER_OR_EQUAL(free_heap - TEST_STEP_SIZE - 32, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    test_check(buf, TEST_STEP_SIZE);
+
+    /* Growing a buffer never needs the memory of two copies of it */
+    for (size_t size = TEST_STEP_SIZE * 2; size <= TEST_BUF_SIZE; size += TEST_STEP_SIZE) {
+        TEST_ASSERT_EQUAL_PTR(buf, heap_caps_realloc(buf, size, MALLOC_CAP_8BIT));
+        test_fill(buf, size - TEST_STEP_SIZE, size);
+        TEST_ASSERT_GREATER_OR_EQUAL(free_heap - size - 32, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    }
+    test_check(buf, TEST_BUF_SIZE);
+
+    heap_caps_free(buf);
+    TEST_ASSERT_EQUAL(free_heap, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+}
+
+TEST_CASE("Test Heap realloc grows into the holes of a fragmented heap", "[Heap]")
+{
+    size_t free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    uint8_t *a[TEST_PAIRS], *b[TEST_PAIRS];
+    bool adjacent[TEST_PAIRS];
+    int n_adjacent = 0;
+
+    for (int i = 0; i < TEST_PAIRS; i++) {
+        a[i] = heap_caps_malloc(TEST_STEP_SIZE, MALLOC_CAP_8BIT);
+        b[i] = heap_caps_malloc(TEST_STEP_SIZE * 2, MALLOC_CAP_8BIT);
+        TEST_ASSERT_NOT_NULL(a[i]);
+        TEST_ASSERT_NOT_NULL(b[i]);
+        test_fill(a[i], 0, TEST_STEP_SIZE);
+
+        /* Only the block header is between them */
+        adjacent[i] = b[i] > a[i] && b[i] - a[i] <= TEST_STEP_SIZE + 32;
+        if (adjacent[i]) {
+            n_adjacent++;
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(0, n_adjacent);
+
+    /* Leave holes which are each too small for a copy of the grown buffer */
+    for (int i = 0; i < TEST_PAIRS; i++) {
+        heap_caps_free(b[i]);
+    }
+    /* The others are grown last, as they may be moved into a hole */
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < TEST_PAIRS; i++) {
+            if (adjacent[i] != !pass) {
+                continue;
+            }
+            uint8_t *p = heap_caps_realloc(a[i], TEST_STEP_SIZE * 3, MALLOC_CAP_8BIT);
+
+            TEST_ASSERT_NOT_NULL(p);
+            test_check(p, TEST_STEP_SIZE);
+            if (adjacent[i]) {
+                TEST_ASSERT_EQUAL_PTR(a[i], p);
+            }
+            a[i] = p;
+        }
+    }
+    printf("%d of %d buffers grown in place\n", n_adjacent, TEST_PAIRS);
+
+    for (int i = 0; i < TEST_PAIRS; i++) {
+        heap_caps_free(a[i]);
+    }
+    TEST_ASSERT_EQUAL(free_heap, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+}
@@ -0,0 +1,332 @@
+// Copyright 2018-2019 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * Replays an allocation trace on a heap region of the size of the ESP8266
+ * DRAM heap and reports how long each malloc and free took.
+ *
+ * Trace format, one operation per line, '#' starts a comment:
+ *
+ *     m <id> <size>    malloc, the block is known as <id> afterwards
+ *     r <id> <size>    realloc of block <id>
+ *     f <id>           free of block <id>
+ *
+ * Without a trace file, a synthetic workload is replayed: network buffers
+ * with short lifetimes mixed with long lived TLS buffers and small objects.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Only a 32-bit build gives meaningful numbers, see the Makefile */
+#if UINTPTR_MAX != 0xFFFFFFFF
+#error "The heap keeps the block links in uint32_t, build with -m32"
+#endif
+
+#include "esp_heap_caps.h"
+#include "esp_heap_port.h"
+#include "priv/esp_heap_caps_priv.h"
+
+#define HEAP_SIZE           (50 * 1024)
+#define MAX_IDS             8192
+#define SYNTH_OPS           200000
+
+#ifdef CONFIG_HEAP_ALLOCATOR_TLSF
+#define ALLOCATOR_NAME      "tlsf"
+#else
+#define ALLOCATOR_NAME      "first fit"
+#endif
+
+typedef struct {
+    char op;
+    uint16_t id;
+    uint32_t size;
+} trace_op_t;
+
+typedef struct {
+    uint32_t *ns;
+    size_t count;
+    size_t capacity;
+} latency_t;
+
+heap_region_t g_heap_region[HEAP_REGIONS_MAX];
+
+static uint8_t s_heap[HEAP_SIZE] __attribute__((aligned(4)));
+static void *s_ptr[MAX_IDS];
+static uint32_t s_size[MAX_IDS];
+
+void vPortETSIntrLock(void)
+{
+}
+
+void vPortETSIntrUnlock(void)
+{
+}
+
+static uint32_t s_seed = 0x12345678;
+
+static uint32_t rand32(void)
+{
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return s_seed;
+}
+
+static uint32_t rand_range(uint32_t min, uint32_t max)
+{
+    return min + rand32() % (max - min + 1);
+}
+
+static void trace_add(trace_op_t **ops, size_t *n, size_t *cap, char op, int id, uint32_t size)
+{
+    if (*n == *cap) {
+        *cap = *cap ? *cap * 2 : 1024;
+        *ops = realloc(*ops, *cap * sizeof(trace_op_t));
+        if (!*ops) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    (*ops)[*n].op = op;
+    (*ops)[*n].id = id;
+    (*ops)[*n].size = size;
+    (*n)++;
+}
+
+static size_t trace_load(const char *path, trace_op_t **ops)
+{
+    size_t n = 0, cap = 0;
+    char line[128];
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        exit(1);
+    }
+    while (fgets(line, sizeof(line), f)) {
+        char op;
+        unsigned id, size = 0;
+
+        if (line[0] == '#' || sscanf(line, " %c %u %u", &op, &id, &size) < 2) {
+            continue;
+        }
+        if (id >= MAX_IDS || (op != 'm' && op != 'r' && op != 'f')) {
+            fprintf(stderr, "bad trace line: %s", line);
+            exit(1);
+        }
+        trace_add(ops, &n, &cap, op, id, size);
+    }
+    fclose(f);
+    return n;
+}
+
+/*
+ * Each step frees the blocks whose time has come, then allocates a new one:
+ * mostly packet buffers living a few steps, sometimes TLS record buffers
+ * or connection objects living much longer.
+ */
+static size_t trace_generate(trace_op_t **ops)
+{
+    static uint32_t death[MAX_IDS];
+    size_t n = 0, cap = 0;
+    uint32_t live_bytes = 0;
+    static uint32_t sizes[MAX_IDS];
+
+    for (uint32_t step = 1; n < SYNTH_OPS; step++) {
+        for (int id = 0; id < MAX_IDS; id++) {
+            if (death[id] == step) {
+                trace_add(ops, &n, &cap, 'f', id, 0);
+                live_bytes -= sizes[id];
+                death[id] = 0;
+            }
+        }
+
+        int id;
+        for (id = 0; id < MAX_IDS && death[id]; id++) {
+        }
+        if (id == MAX_IDS) {
+            continue;
+        }
+
+        uint32_t kind = rand32() % 100, size, life;
+        if (kind < 60) {
+            size = rand_range(16, 1600);        /* pbuf, TCP segment */
+            life = rand_range(1, 40);
+        } else if (kind < 90) {
+            size = rand_range(8, 160);          /* netconn, timers, small structures */
+            life = rand_range(10, 2000);
+        } else if (kind < 97) {
+            size = rand_range(200, 1200);       /* TLS handshake structures */
+            life = rand_range(50, 500);
+        } else {
+            size = rand_range(2048, 5200);      /* TLS record buffers */
+            life = rand_range(200, 3000);
+        }
+        /* Stay around the high water mark of a busy device, not beyond */
+        if (live_bytes + size > HEAP_SIZE * 3 / 4) {
+            continue;
+        }
+        trace_add(ops, &n, &cap, 'm', id, size);
+        sizes[id] = size;
+        live_bytes += size;
+        death[id] = step + life;
+    }
+    return n;
+}
+
+static uint32_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void latency_add(latency_t *l, uint32_t ns)
+{
+    if (l->count == l->capacity) {
+        l->capacity = l->capacity ? l->capacity * 2 : 1024;
+        l->ns = realloc(l->ns, l->capacity * sizeof(uint32_t));
+        if (!l->ns) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    l->ns[l->count++] = ns;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void latency_report(const char *name, latency_t *l)
+{
+    uint64_t sum = 0;
+
+    if (!l->count) {
+        return;
+    }
+    qsort(l->ns, l->count, sizeof(uint32_t), cmp_u32);
+    for (size_t i = 0; i < l->count; i++) {
+        sum += l->ns[i];
+    }
+    printf("  %-8s %8zu calls, mean %6u ns, p50 %6u ns, p99 %6u ns, max %6u ns\n", name, l->count,
+           (unsigned)(sum / l->count), l->ns[l->count / 2], l->ns[l->count * 99 / 100], l->ns[l->count - 1]);
+}
+
+static void heap_report(void)
+{
+    mem_blk_t *p = (mem_blk_t *)HEAP_ALIGN(g_heap_region[0].start_addr);
+    size_t free_blocks = 0, largest = 0, blocks = 0;
+
+    for (; !mem_blk_is_end(p); p = mem_blk_next(p)) {
+        blocks++;
+        if (!mem_blk_is_used(p)) {
+            free_blocks++;
+            if (blk_link_size(p) > largest) {
+                largest = blk_link_size(p);
+            }
+        }
+    }
+    printf("  heap     %u bytes free, %zu free blocks out of %zu, largest free block %zu bytes\n",
+           (unsigned)g_heap_region[0].free_bytes, free_blocks, blocks, largest);
+}
+
+int main(int argc, char *argv[])
+{
+    trace_op_t *ops = NULL;
+    size_t n_ops;
+    latency_t malloc_ns = { 0 }, free_ns = { 0 }, realloc_ns = { 0 };
+    size_t failed = 0;
+
+    n_ops = argc > 1 ? trace_load(argv[1], &ops) : trace_generate(&ops);
+
+    g_heap_region[0].start_addr = s_heap;
+    g_heap_region[0].total_size = sizeof(s_heap);
+    g_heap_region[0].caps = MALLOC_CAP_8BIT | MALLOC_CAP_32BIT;
+    esp_heap_caps_init_region(g_heap_region, 1);
+
+    for (size_t i = 0; i < n_ops; i++) {
+        trace_op_t *op = &ops[i];
+        uint32_t t;
+
+        switch (op->op) {
+        case 'm':
+            if (s_ptr[op->id]) {
+                fprintf(stderr, "trace op %zu: block %u is already allocated\n", i, op->id);
+                return 1;
+            }
+            t = now_ns();
+            s_ptr[op->id] = _heap_caps_malloc(op->size, MALLOC_CAP_32BIT, __FILE__, __LINE__);
+            latency_add(&malloc_ns, now_ns() - t);
+            if (!s_ptr[op->id]) {
+                failed++;
+            } else {
+                memset(s_ptr[op->id], op->id, op->size);
+                s_size[op->id] = op->size;
+            }
+            break;
+        case 'r': {
+            t = now_ns();
+            void *p = _heap_caps_realloc(s_ptr[op->id], op->size, MALLOC_CAP_32BIT, __FILE__, __LINE__);
+            latency_add(&realloc_ns, now_ns() - t);
+            if (p) {
+                s_ptr[op->id] = p;
+                memset(p, op->id, op->size);
+                s_size[op->id] = op->size;
+            } else if (op->size) {
+                failed++;
+            }
+            break;
+        }
+        case 'f':
+            /* The allocation may have failed */
+            if (!s_ptr[op->id]) {
+                break;
+            }
+            /* An other block overlapping this one would have overwritten it */
+            for (uint32_t j = 0; j < s_size[op->id]; j++) {
+                if (((uint8_t *)s_ptr[op->id])[j] != (uint8_t)op->id) {
+                    fprintf(stderr, "trace op %zu: block %u is corrupted\n", i, op->id);
+                    return 1;
+                }
+            }
+            t = now_ns();
+            _heap_caps_free(s_ptr[op->id], __FILE__, __LINE__);
+            latency_add(&free_ns, now_ns() - t);
+            s_ptr[op->id] = NULL;
+            break;
+        }
+    }
+
+    printf("%s allocator, %zu operations, %zu failed allocations\n", ALLOCATOR_NAME, n_ops, failed);
+    latency_report("malloc", &malloc_ns);
+    latency_report("realloc", &realloc_ns);
+    latency_report("free", &free_ns);
+    heap_report();
+    printf("  low water mark %u bytes free\n", (unsigned)g_heap_region[0].min_free_bytes);
+
+    free(ops);
+    free(malloc_ns.ns);
+    free(free_ns.ns);
+    free(realloc_ns.ns);
+    return 0;
+}
@@ -0,0 +1 @@
+/* The allocation algorithm is selected by the Makefile, one program is built for each */
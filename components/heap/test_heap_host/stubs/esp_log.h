@@ -0,0 +1,7 @@
+#pragma once
+
+#define ESP_EARLY_LOGE(tag, format, ...)    (void)(tag)
+#define ESP_EARLY_LOGW(tag, format, ...)    (void)(tag)
+#define ESP_EARLY_LOGI(tag, format, ...)    (void)(tag)
+#define ESP_EARLY_LOGD(tag, format, ...)    (void)(tag)
+#define ESP_EARLY_LOGV(tag, format, ...)    (void)(tag)
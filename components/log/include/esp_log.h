@@ -20,6 +20,10 @@
 #include "sdkconfig.h"
 #include "rom/ets_sys.h"
 
+#ifdef CONFIG_LOG_ASYNC
+#include "esp_err.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -54,6 +58,9 @@ typedef int (*putchar_like_t)(int ch);
  * LOG_LOCAL_LEVEL to one of the ESP_LOG_* values, before including
  * esp_log.h in this file.
  *
+ * The level of a tag is cached by the address of the tag string, so the tags
+ * passed to the logging functions should be constant strings.
+ *
  * @param tag Tag of the log entries to enable. Must be a non-NULL zero terminated string.
  *            Value "*" resets log level for all tags to the given value.
  *
@@ -78,6 +85,40 @@ void esp_log_level_set(const char* tag, esp_log_level_t level);
  */
 putchar_like_t esp_log_set_putchar(putchar_like_t func);
 
+#ifdef CONFIG_LOG_ASYNC
+/**
+ * @brief Start the task writing out the log entries
+ *
+ * Called at startup. From then on esp_log_write() only formats the entries
+ * into a buffer, and the output function set by esp_log_set_putchar() is
+ * called by the log task.
+ *
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_ERR_NO_MEM if the task can not be created
+ */
+esp_err_t esp_log_async_init(void);
+
+/**
+ * @brief Write out the log entries left in the buffer from the calling task
+ */
+void esp_log_async_flush(void);
+
+/**
+ * @brief Write out the log entries left in the buffer to UART0 with the ROM functions
+ *
+ * Called by the panic handler, with the interrupts disabled.
+ */
+void esp_log_async_panic_flush(void);
+
+/**
+ * @brief Get the number of log entries lost because the buffer was full
+ *
+ * @return the number of entries dropped since startup
+ */
+uint32_t esp_log_async_get_dropped(void);
+#endif /* CONFIG_LOG_ASYNC */
+
 /**
  * @brief Function which returns timestamp to be used in log output
  *
@@ -31,6 +31,7 @@
 
 #ifndef BOOTLOADER_BUILD
 #include "FreeRTOS.h"
+#include "task.h"
 #endif
 
 #ifdef CONFIG_LOG_COLORS
@@ -78,21 +79,104 @@ uint32_t IRAM_ATTR esp_log_early_timestamp()
 #ifdef CONFIG_LOG_SET_LEVEL
 #define GLOBAL_TAG "*"
 
+/* Buckets of the tags set by esp_log_level_set(), a power of two */
+#define TAG_BUCKETS         16
+
+/* Tag pointers whose level is cached, a power of two */
+#define TAG_CACHE_SIZE      CONFIG_LOG_TAG_CACHE_SIZE
+#define TAG_CACHE_PROBES    4
+
+_Static_assert((TAG_CACHE_SIZE & (TAG_CACHE_SIZE - 1)) == 0, "CONFIG_LOG_TAG_CACHE_SIZE is not a power of two");
+
+#define TAG_CACHE_BARRIER() __asm__ __volatile__("" ::: "memory")
+
 typedef struct uncached_tag_entry_{
     SLIST_ENTRY(uncached_tag_entry_) entries; 
     uint8_t level;  // esp_log_level_t as uint8_t
     char tag[0];    // beginning of a zero-terminated string
 } uncached_tag_entry_t;
 
+typedef struct {
+    const char *tag;    // tag pointer passed to esp_log_write(), NULL if unused
+    uint32_t level;     // esp_log_level_t
+} cached_tag_entry_t;
+
 static esp_log_level_t s_global_tag_level = ESP_LOG_VERBOSE;
-static SLIST_HEAD(log_tags_head , uncached_tag_entry_) s_log_uncached_tags = SLIST_HEAD_INITIALIZER(s_log_uncached_tags);
-static uncached_tag_entry_t *s_uncached_tag_entry_prev;
+static SLIST_HEAD(log_tags_head , uncached_tag_entry_) s_log_uncached_tags[TAG_BUCKETS];
+
+/*
+ * Levels of the tags recently logged, found by their pointer without taking the lock.
+ * The sequence is odd while the cache is written, the readers then take the lock instead.
+ */
+static cached_tag_entry_t s_log_cached_tags[TAG_CACHE_SIZE];
+static volatile uint32_t s_log_cache_seq;
+static uint32_t s_log_cache_victim;
 #endif /* CONFIG_LOG_SET_LEVEL */
 
 static _lock_t s_lock;
 static putchar_like_t s_putchar_func = &putchar;
 
+#ifdef CONFIG_LOG_ASYNC
+#define ASYNC_BUF_SIZE      CONFIG_LOG_ASYNC_BUFFER_SIZE
+
+/* Entries longer than this are formatted in the heap, binary records are never longer */
+#define ASYNC_LINE_SIZE     128
+
+/* Entries in the buffer start with their length, and this flag for the binary records */
+#define ASYNC_HDR_BINARY    0x8000
+
+/* Start of the lines holding a binary record, for log_decoder.py */
+#define ASYNC_FRAME_HEAD    "\033L"
+
+/*
+ * Binary record of an entry whose formatting is deferred, followed by its arguments:
+ * 4 bytes for the integers and the pointers, 8 bytes for the 64-bit integers and the
+ * doubles, and the strings copied with their terminating '\0'. All little-endian.
+ */
+typedef struct {
+    uint8_t     level;
+    uint32_t    timestamp;
+    uint32_t    tag;        // address of the tag
+    uint32_t    fmt;        // address of the format string
+} __attribute__((packed)) log_deferred_hdr_t;
+
+typedef enum {
+    LOG_ARG_NONE,
+    LOG_ARG_INT,
+    LOG_ARG_INT64,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_STR,
+    LOG_ARG_INVALID
+} log_arg_type_t;
+
+static uint8_t s_async_buf[ASYNC_BUF_SIZE];
+static size_t s_async_rd;
+static size_t s_async_used;
+/* Bytes of the text entry being written out still in the buffer */
+static size_t s_async_partial;
+/* The end of the text entry being written out was dropped */
+static bool s_async_cut;
+static uint32_t s_async_dropped;
+static uint32_t s_async_dropped_total;
+static TaskHandle_t s_async_task;
+#endif /* CONFIG_LOG_ASYNC */
+
 #ifdef CONFIG_LOG_SET_LEVEL
+static inline uint32_t tag_str_hash(const char *tag)
+{
+    uint32_t hash = 2166136261U;
+
+    while (*tag)
+        hash = (hash ^ (uint8_t)*tag++) * 16777619U;
+
+    return hash & (TAG_BUCKETS - 1);
+}
+
+static inline uint32_t tag_ptr_hash(const char *tag)
+{
+    return (((uint32_t)tag >> 2) * 2654435761U) >> (32 - __builtin_ctz(TAG_CACHE_SIZE));
+}
+
 /**
  * @brief get entry by inputting tag
  */
@@ -100,7 +184,7 @@ static bool esp_log_get_tag_entry(const char *tag, uncached_tag_entry_t **entry)
 {
     uncached_tag_entry_t *it = NULL;
 
-    SLIST_FOREACH(it, &s_log_uncached_tags, entries) {
+    SLIST_FOREACH(it, &s_log_uncached_tags[tag_str_hash(tag)], entries) {
         if (!strcmp(it->tag, tag)) {
             //one tag in the linked list match, update the level
             *entry = it;
@@ -114,14 +198,62 @@ static bool esp_log_get_tag_entry(const char *tag, uncached_tag_entry_t **entry)
 
 static void clear_log_level_list(void)
 {
-    uncached_tag_entry_t *it = NULL;
+    for (int i = 0; i < TAG_BUCKETS; i++) {
+        while (!SLIST_EMPTY(&s_log_uncached_tags[i])) {
+            uncached_tag_entry_t *it = SLIST_FIRST(&s_log_uncached_tags[i]);
 
-    SLIST_FOREACH(it, &s_log_uncached_tags, entries) {
-        SLIST_REMOVE(&s_log_uncached_tags, it, uncached_tag_entry_, entries);
-        free(it);
+            SLIST_REMOVE_HEAD(&s_log_uncached_tags[i], entries);
+            free(it);
+        }
     }
 }
 
+/**
+ * @brief forget the cached levels, called with the lock held
+ */
+static void clear_log_level_cache(void)
+{
+    s_log_cache_seq++;
+    TAG_CACHE_BARRIER();
+
+    memset(s_log_cached_tags, 0, sizeof(s_log_cached_tags));
+
+    TAG_CACHE_BARRIER();
+    s_log_cache_seq++;
+}
+
+/**
+ * @brief cache the level of a tag pointer, called with the lock held
+ */
+static void add_log_level_cache(const char *tag, esp_log_level_t level)
+{
+    uint32_t hash = tag_ptr_hash(tag);
+    cached_tag_entry_t *entry;
+
+    /*
+     * Take a free entry, or else replace each of the probed ones in turn: replacing
+     * always the first one makes the tags logged in a cycle evict each other.
+     */
+    entry = &s_log_cached_tags[(hash + s_log_cache_victim++ % TAG_CACHE_PROBES) & (TAG_CACHE_SIZE - 1)];
+    for (int i = 0; i < TAG_CACHE_PROBES; i++) {
+        cached_tag_entry_t *it = &s_log_cached_tags[(hash + i) & (TAG_CACHE_SIZE - 1)];
+
+        if (!it->tag) {
+            entry = it;
+            break;
+        }
+    }
+
+    s_log_cache_seq++;
+    TAG_CACHE_BARRIER();
+
+    entry->tag = tag;
+    entry->level = level;
+
+    TAG_CACHE_BARRIER();
+    s_log_cache_seq++;
+}
+
 /**
  * @brief get level by inputting tag
  */
@@ -129,23 +261,38 @@ static esp_log_level_t esp_log_get_level(const char *tag)
 {
     esp_log_level_t out_level;
     uncached_tag_entry_t *entry;
+    uint32_t seq = s_log_cache_seq;
 
-    _lock_acquire_recursive(&s_lock);
+    TAG_CACHE_BARRIER();
 
-    if (s_uncached_tag_entry_prev && !strcmp(s_uncached_tag_entry_prev->tag, tag)) {
-        out_level = (esp_log_level_t)s_uncached_tag_entry_prev->level;
-        goto exit;
+    if (!(seq & 1)) {
+        uint32_t hash = tag_ptr_hash(tag);
+
+        for (int i = 0; i < TAG_CACHE_PROBES; i++) {
+            const cached_tag_entry_t *it = &s_log_cached_tags[(hash + i) & (TAG_CACHE_SIZE - 1)];
+
+            if (it->tag == tag) {
+                out_level = (esp_log_level_t)it->level;
+
+                TAG_CACHE_BARRIER();
+                if (seq == s_log_cache_seq)
+                    return out_level;
+                break;
+            }
+        }
     }
 
-    if (esp_log_get_tag_entry(tag, &entry) == true) {
+    _lock_acquire_recursive(&s_lock);
+
+    if (esp_log_get_tag_entry(tag, &entry) == true)
         out_level = (esp_log_level_t)entry->level;
-        s_uncached_tag_entry_prev = entry;
-        goto exit;
-    } else
+    else
         out_level = s_global_tag_level;
 
-exit:
+    add_log_level_cache(tag, out_level);
+
     _lock_release_recursive(&s_lock);
+
     return out_level;
 }
 
@@ -187,9 +334,10 @@ void esp_log_level_set(const char *tag, esp_log_level_t level)
     new_entry->level = level;
     memcpy(new_entry->tag, tag, bytes);
 
-    SLIST_INSERT_HEAD(&s_log_uncached_tags, new_entry, entries);
+    SLIST_INSERT_HEAD(&s_log_uncached_tags[tag_str_hash(tag)], new_entry, entries);
 
 exit:
+    clear_log_level_cache();
     _lock_release_recursive(&s_lock);
 }
 #endif /* CONFIG_LOG_SET_LEVEL */
@@ -238,6 +386,571 @@ out:
 }
 
 #ifndef BOOTLOADER_BUILD
+#ifdef CONFIG_LOG_ASYNC
+#define ASYNC_POS(len)      (buf + ((len) < size ? (len) : size))
+#define ASYNC_LEFT(len)     ((len) < size ? size - (len) : 0)
+
+/**
+ * @brief format a log entry, returns its length like snprintf
+ */
+static int log_async_format(char *buf, size_t size, esp_log_level_t level, const char *tag, const char *fmt, va_list va)
+{
+    size_t len = 0;
+    int ret;
+    char prefix;
+
+#ifdef CONFIG_LOG_COLORS
+    uint32_t color = level >= ESP_LOG_MAX ? 0 : s_log_color[level];
+
+    if (color)
+        len += snprintf(ASYNC_POS(len), ASYNC_LEFT(len), LOG_COLOR_HEAD, color);
+#endif
+
+    prefix = level >= ESP_LOG_MAX ? 'N' : s_log_prefix[level];
+    ret = snprintf(ASYNC_POS(len), ASYNC_LEFT(len), "%c (%d) %s: ", prefix, esp_log_early_timestamp(), tag);
+    if (ret < 0)
+        return ret;
+    len += ret;
+
+    ret = vsnprintf(ASYNC_POS(len), ASYNC_LEFT(len), fmt, va);
+    if (ret < 0)
+        return ret;
+    len += ret;
+
+#ifdef CONFIG_LOG_COLORS
+    if (color)
+        len += snprintf(ASYNC_POS(len), ASYNC_LEFT(len), "%s", LOG_COLOR_END);
+#endif
+    len += snprintf(ASYNC_POS(len), ASYNC_LEFT(len), "\n");
+
+    return len;
+}
+
+#ifndef CONFIG_LOG_ASYNC_FORMAT_CALLER
+/**
+ * @brief parse the conversion specification at "fmt", which points after a '%'
+ *
+ * The precision is set to -1 when there is none, "precision" may be NULL.
+ */
+static log_arg_type_t log_deferred_parse(const char **fmt, int *precision)
+{
+    const char *p = *fmt;
+    int longs = 0;
+    int prec = -1;
+
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+        p++;
+    while (*p >= '0' && *p <= '9')
+        p++;
+    if (*p == '.') {
+        p++;
+        prec = 0;
+        while (*p >= '0' && *p <= '9')
+            prec = prec * 10 + *p++ - '0';
+    }
+    if (precision)
+        *precision = prec;
+
+    for (; *p == 'h' || *p == 'l' || *p == 'z' || *p == 't' || *p == 'j' || *p == 'q'; p++) {
+        if (*p == 'l')
+            longs++;
+        else if (*p == 'j' || *p == 'q')
+            longs = 2;
+    }
+
+    *fmt = p + 1;
+
+    switch (*p) {
+    case '%':
+        return LOG_ARG_NONE;
+    case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+        return longs >= 2 ? LOG_ARG_INT64 : LOG_ARG_INT;
+    case 'p':
+        return LOG_ARG_INT;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        return LOG_ARG_DOUBLE;
+    case 's':
+        return LOG_ARG_STR;
+    default:
+        /* '*', long double, %n and the end of the string */
+        *fmt = p;
+        return LOG_ARG_INVALID;
+    }
+}
+
+/**
+ * @brief pack an entry into a binary record, returns its length or -1 if it has to be formatted
+ */
+static int log_deferred_pack(uint8_t *rec, size_t size, esp_log_level_t level, const char *tag, const char *fmt, va_list va)
+{
+    log_deferred_hdr_t hdr = {
+        .level = level,
+        .timestamp = esp_log_early_timestamp(),
+        .tag = (uint32_t)tag,
+        .fmt = (uint32_t)fmt
+    };
+    size_t len = sizeof(hdr);
+    const char *p = fmt;
+
+    memcpy(rec, &hdr, sizeof(hdr));
+
+    while ((p = strchr(p, '%'))) {
+        log_arg_type_t type;
+        uint32_t i32;
+        uint64_t i64;
+        double d;
+        const char *s;
+        size_t n;
+        int precision;
+
+        p++;
+        type = log_deferred_parse(&p, &precision);
+
+        switch (type) {
+        case LOG_ARG_NONE:
+            continue;
+        case LOG_ARG_INT:
+            i32 = va_arg(va, uint32_t);
+            n = sizeof(i32);
+            s = (const char *)&i32;
+            break;
+        case LOG_ARG_INT64:
+            i64 = va_arg(va, uint64_t);
+            n = sizeof(i64);
+            s = (const char *)&i64;
+            break;
+        case LOG_ARG_DOUBLE:
+            d = va_arg(va, double);
+            n = sizeof(d);
+            s = (const char *)&d;
+            break;
+        case LOG_ARG_STR:
+            /* The string may not be there any more when the record is formatted */
+            s = va_arg(va, const char *);
+            if (!s)
+                s = "(null)";
+            /* With a precision, only that many characters are read, the array may not be terminated */
+            n = (precision < 0 ? strlen(s) : strnlen(s, precision)) + 1;
+            break;
+        default:
+            return -1;
+        }
+
+        if (len + n > size)
+            return -1;
+        if (type == LOG_ARG_STR) {
+            memcpy(rec + len, s, n - 1);
+            rec[len + n - 1] = '\0';
+        } else {
+            memcpy(rec + len, s, n);
+        }
+        len += n;
+    }
+
+    return len;
+}
+#endif /* !CONFIG_LOG_ASYNC_FORMAT_CALLER */
+
+#ifdef CONFIG_LOG_ASYNC_FORMAT_TASK
+static void log_deferred_put_str(putchar_like_t putc_func, const char *s)
+{
+    while (*s)
+        putc_func(*s++);
+}
+
+/**
+ * @brief format a binary record
+ */
+static void log_deferred_print(putchar_like_t putc_func, const uint8_t *rec, size_t len)
+{
+    const uint8_t *end = rec + len;
+    log_deferred_hdr_t hdr;
+    const char *p, *spec;
+    char buf[32];
+
+    memcpy(&hdr, rec, sizeof(hdr));
+    rec += sizeof(hdr);
+
+#ifdef CONFIG_LOG_COLORS
+    uint32_t color = hdr.level >= ESP_LOG_MAX ? 0 : s_log_color[hdr.level];
+
+    if (color) {
+        sprintf(buf, LOG_COLOR_HEAD, color);
+        log_deferred_put_str(putc_func, buf);
+    }
+#endif
+
+    sprintf(buf, "%c (%d) ", hdr.level >= ESP_LOG_MAX ? 'N' : s_log_prefix[hdr.level], hdr.timestamp);
+    log_deferred_put_str(putc_func, buf);
+    log_deferred_put_str(putc_func, (const char *)hdr.tag);
+    log_deferred_put_str(putc_func, ": ");
+
+    for (p = (const char *)hdr.fmt; *p; ) {
+        log_arg_type_t type;
+        const char *out = buf;
+        char spec_buf[16];
+        size_t n;
+        uint32_t i32;
+        uint64_t i64;
+        double d;
+
+        if (*p != '%') {
+            putc_func(*p++);
+            continue;
+        }
+
+        spec = p++;
+        type = log_deferred_parse(&p, NULL);
+        if (type == LOG_ARG_NONE) {
+            putc_func('%');
+            continue;
+        }
+        if (p - spec >= sizeof(spec_buf))
+            break;
+        memcpy(spec_buf, spec, p - spec);
+        spec_buf[p - spec] = '\0';
+
+        switch (type) {
+        case LOG_ARG_INT:
+            if (end - rec < sizeof(i32))
+                goto out;
+            memcpy(&i32, rec, sizeof(i32));
+            rec += sizeof(i32);
+            if (p[-1] == 'p')
+                snprintf(buf, sizeof(buf), spec_buf, (void *)i32);
+            else
+                snprintf(buf, sizeof(buf), spec_buf, i32);
+            break;
+        case LOG_ARG_INT64:
+            if (end - rec < sizeof(i64))
+                goto out;
+            memcpy(&i64, rec, sizeof(i64));
+            rec += sizeof(i64);
+            snprintf(buf, sizeof(buf), spec_buf, i64);
+            break;
+        case LOG_ARG_DOUBLE:
+            if (end - rec < sizeof(d))
+                goto out;
+            memcpy(&d, rec, sizeof(d));
+            rec += sizeof(d);
+            snprintf(buf, sizeof(buf), spec_buf, d);
+            break;
+        case LOG_ARG_STR:
+            n = strnlen((const char *)rec, end - rec);
+            if (n == end - rec)
+                goto out;
+            /* The width and the precision are ignored for the strings longer than the buffer */
+            if (n < sizeof(buf))
+                snprintf(buf, sizeof(buf), spec_buf, (const char *)rec);
+            else
+                out = (const char *)rec;
+            rec += n + 1;
+            break;
+        default:
+            goto out;
+        }
+        log_deferred_put_str(putc_func, out);
+    }
+
+out:
+#ifdef CONFIG_LOG_COLORS
+    if (color)
+        log_deferred_put_str(putc_func, LOG_COLOR_END);
+#endif
+    putc_func('\n');
+}
+#endif /* CONFIG_LOG_ASYNC_FORMAT_TASK */
+
+#ifdef CONFIG_LOG_ASYNC_FORMAT_HOST
+static const char s_base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/**
+ * @brief write out a binary record as a line of base64 after ASYNC_FRAME_HEAD
+ */
+static void log_deferred_print(putchar_like_t putc_func, const uint8_t *rec, size_t len)
+{
+    putc_func(ASYNC_FRAME_HEAD[0]);
+    putc_func(ASYNC_FRAME_HEAD[1]);
+
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = rec[i] << 16;
+
+        if (i + 1 < len)
+            v |= rec[i + 1] << 8;
+        if (i + 2 < len)
+            v |= rec[i + 2];
+
+        putc_func(s_base64[(v >> 18) & 0x3f]);
+        putc_func(s_base64[(v >> 12) & 0x3f]);
+        putc_func(i + 1 < len ? s_base64[(v >> 6) & 0x3f] : '=');
+        putc_func(i + 2 < len ? s_base64[v & 0x3f] : '=');
+    }
+
+    putc_func('\n');
+}
+#endif /* CONFIG_LOG_ASYNC_FORMAT_HOST */
+
+/**
+ * @brief take bytes out of the buffer, or drop them if "dst" is NULL, called in a critical section
+ */
+static void log_async_read(void *dst, size_t len)
+{
+    size_t n = len < ASYNC_BUF_SIZE - s_async_rd ? len : ASYNC_BUF_SIZE - s_async_rd;
+
+    if (dst) {
+        memcpy(dst, &s_async_buf[s_async_rd], n);
+        memcpy((uint8_t *)dst + n, s_async_buf, len - n);
+    }
+
+    s_async_rd = (s_async_rd + len) % ASYNC_BUF_SIZE;
+    s_async_used -= len;
+}
+
+/**
+ * @brief add bytes to the buffer, called in a critical section
+ */
+static void log_async_write_buf(const void *src, size_t len)
+{
+    size_t wr = (s_async_rd + s_async_used) % ASYNC_BUF_SIZE;
+    size_t n = len < ASYNC_BUF_SIZE - wr ? len : ASYNC_BUF_SIZE - wr;
+
+    memcpy(&s_async_buf[wr], src, n);
+    memcpy(s_async_buf, (const uint8_t *)src + n, len - n);
+
+    s_async_used += len;
+}
+
+#ifdef CONFIG_LOG_ASYNC_DROP_OLDEST
+/**
+ * @brief drop the oldest entry, called in a critical section
+ */
+static void log_async_drop_oldest(void)
+{
+    uint16_t hdr;
+
+    if (s_async_partial) {
+        log_async_read(NULL, s_async_partial);
+        s_async_partial = 0;
+        s_async_cut = true;
+    } else {
+        log_async_read(&hdr, sizeof(hdr));
+        log_async_read(NULL, hdr & ~ASYNC_HDR_BINARY);
+    }
+
+    s_async_dropped++;
+}
+#endif
+
+/**
+ * @brief copy an entry into the buffer and wake up the log task
+ */
+static void log_async_put(const void *entry, size_t len, uint16_t flags)
+{
+    size_t size = sizeof(uint16_t) + len;
+    uint16_t hdr = len | flags;
+    bool wake;
+
+    portENTER_CRITICAL();
+
+#ifdef CONFIG_LOG_ASYNC_DROP_OLDEST
+    if (size <= ASYNC_BUF_SIZE) {
+        while (ASYNC_BUF_SIZE - s_async_used < size)
+            log_async_drop_oldest();
+    }
+#endif
+    if (ASYNC_BUF_SIZE - s_async_used < size) {
+        s_async_dropped++;
+        portEXIT_CRITICAL();
+        return;
+    }
+
+    wake = s_async_used == 0;
+    log_async_write_buf(&hdr, sizeof(hdr));
+    log_async_write_buf(entry, len);
+
+    portEXIT_CRITICAL();
+
+    if (wake)
+        xTaskNotifyGive(s_async_task);
+}
+
+/**
+ * @brief write out a binary record, or the next bytes of a text entry, returns false if the buffer was empty
+ */
+static bool log_async_drain(void)
+{
+    uint8_t chunk[ASYNC_LINE_SIZE];
+    uint32_t dropped = 0;
+    bool binary = false;
+    bool cut;
+    uint16_t hdr;
+    size_t n;
+
+    /* The lock is held from taking the bytes until they are written, to keep them in order */
+    _lock_acquire_recursive(&s_lock);
+
+    portENTER_CRITICAL();
+
+    cut = s_async_cut;
+    s_async_cut = false;
+
+    if (!s_async_partial && s_async_used) {
+        log_async_read(&hdr, sizeof(hdr));
+        if (hdr & ASYNC_HDR_BINARY)
+            binary = true;
+        else
+            s_async_partial = hdr;
+    }
+
+    if (binary) {
+        n = hdr & ~ASYNC_HDR_BINARY;
+        log_async_read(chunk, n);
+    } else {
+        n = s_async_partial < sizeof(chunk) ? s_async_partial : sizeof(chunk);
+        log_async_read(chunk, n);
+        s_async_partial -= n;
+    }
+
+    /* The drops are reported once the entries before them are written out */
+    if (!s_async_used) {
+        dropped = s_async_dropped;
+        s_async_dropped_total += s_async_dropped;
+        s_async_dropped = 0;
+    }
+
+    portEXIT_CRITICAL();
+
+    /* The end of the entry was dropped */
+    if (cut)
+        s_putchar_func('\n');
+
+#ifndef CONFIG_LOG_ASYNC_FORMAT_CALLER
+    if (binary)
+        log_deferred_print(s_putchar_func, chunk, n);
+    else
+#endif
+    for (size_t i = 0; i < n; i++)
+        s_putchar_func(chunk[i]);
+
+    if (dropped) {
+        char buf[40];
+
+        sprintf(buf, "(%u log entries dropped)\n", dropped);
+        esp_log_write_str(buf);
+    }
+
+    _lock_release_recursive(&s_lock);
+
+    return n > 0 || dropped;
+}
+
+static void log_async_task(void *arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (log_async_drain());
+    }
+}
+
+static void log_async_write(esp_log_level_t level, const char *tag, const char *fmt, va_list va)
+{
+    char line[ASYNC_LINE_SIZE];
+    char *pbuf = line;
+    va_list copy;
+    int ret;
+
+#ifndef CONFIG_LOG_ASYNC_FORMAT_CALLER
+    va_copy(copy, va);
+    ret = log_deferred_pack((uint8_t *)line, sizeof(line), level, tag, fmt, copy);
+    va_end(copy);
+    if (ret > 0) {
+        log_async_put(line, ret, ASYNC_HDR_BINARY);
+        return;
+    }
+#endif
+
+    va_copy(copy, va);
+    ret = log_async_format(line, sizeof(line), level, tag, fmt, copy);
+    va_end(copy);
+    if (ret < 0)
+        return;
+
+    if (ret >= sizeof(line)) {
+        pbuf = malloc(ret + 1);
+        if (!pbuf) {
+            portENTER_CRITICAL();
+            s_async_dropped++;
+            portEXIT_CRITICAL();
+            return;
+        }
+        log_async_format(pbuf, ret + 1, level, tag, fmt, va);
+    }
+
+    log_async_put(pbuf, ret, 0);
+
+    if (pbuf != line)
+        free(pbuf);
+}
+
+esp_err_t esp_log_async_init(void)
+{
+    if (s_async_task)
+        return ESP_OK;
+
+    if (xTaskCreate(log_async_task, "log", CONFIG_LOG_ASYNC_TASK_STACK_SIZE, NULL,
+                    CONFIG_LOG_ASYNC_TASK_PRIORITY, &s_async_task) != pdPASS)
+        return ESP_ERR_NO_MEM;
+
+    return ESP_OK;
+}
+
+void esp_log_async_flush(void)
+{
+    while (log_async_drain());
+}
+
+void esp_log_async_panic_flush(void)
+{
+    uint8_t chunk[ASYNC_LINE_SIZE];
+    uint16_t hdr;
+    size_t n;
+
+    while (s_async_used) {
+        if (!s_async_partial) {
+            log_async_read(&hdr, sizeof(hdr));
+#ifndef CONFIG_LOG_ASYNC_FORMAT_CALLER
+            if (hdr & ASYNC_HDR_BINARY) {
+                n = hdr & ~ASYNC_HDR_BINARY;
+                log_async_read(chunk, n);
+                log_deferred_print(ets_putc, chunk, n);
+                continue;
+            }
+#endif
+            s_async_partial = hdr;
+        }
+
+        n = s_async_partial < sizeof(chunk) ? s_async_partial : sizeof(chunk);
+        log_async_read(chunk, n);
+        s_async_partial -= n;
+
+        for (size_t i = 0; i < n; i++)
+            ets_putc(chunk[i]);
+    }
+}
+
+uint32_t esp_log_async_get_dropped(void)
+{
+    uint32_t dropped;
+
+    portENTER_CRITICAL();
+    dropped = s_async_dropped_total + s_async_dropped;
+    portEXIT_CRITICAL();
+
+    return dropped;
+}
+#endif /* CONFIG_LOG_ASYNC */
+
 /**
  * @brief Write message into the log
  */
@@ -248,13 +961,23 @@ void esp_log_write(esp_log_level_t level, const char *tag,  const char *fmt, ...
     char *pbuf;
     char prefix;
 
-    _lock_acquire_recursive(&s_lock);
-
 #ifdef CONFIG_LOG_SET_LEVEL
+    /* Filtered out without taking the lock, as long as the level of the tag is cached */
     if (!should_output(level, esp_log_get_level(tag)))
-        goto exit;
+        return;
+#endif
+
+#ifdef CONFIG_LOG_ASYNC
+    if (s_async_task) {
+        va_start(va, fmt);
+        log_async_write(level, tag, fmt, va);
+        va_end(va);
+        return;
+    }
 #endif
 
+    _lock_acquire_recursive(&s_lock);
+
 #ifdef CONFIG_LOG_COLORS
     static char buf[16];
     uint32_t color = level >= ESP_LOG_MAX ? 0 : s_log_color[level];
@@ -0,0 +1,214 @@
+#!/usr/bin/env python
+#
+# ESP8266 deferred log decoder
+#
+# Formats the binary log records written out with CONFIG_LOG_ASYNC_FORMAT_HOST,
+# reading their tags and format strings from the application ELF file. The
+# other lines are written out unchanged.
+#
+# Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from __future__ import print_function, division
+from __future__ import unicode_literals
+import argparse
+import base64
+import binascii
+import io
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+# Start of the lines holding a binary record, ASYNC_FRAME_HEAD in log.c
+FRAME = re.compile(br'\x1bL([A-Za-z0-9+/=]+)\r?\n?$')
+
+# log_deferred_hdr_t: level, timestamp, tag address, format string address
+HEADER = struct.Struct('<BIII')
+
+LEVEL_PREFIX = 'NEWIDV'
+LEVEL_COLOR = [0, 31, 33, 32, 0, 0]
+
+SPEC = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d*))?([hlzjtq]*)(.)')
+
+
+class ElfStrings(object):
+    """ Strings of the sections loaded by the application """
+
+    def __init__(self, elf_file):
+        self.sections = []
+        elf = ELFFile(elf_file)
+        for section in elf.iter_sections():
+            if section['sh_addr'] and section['sh_type'] == 'SHT_PROGBITS':
+                self.sections.append((section['sh_addr'], section.data()))
+
+    def get(self, addr):
+        for start, data in self.sections:
+            if start <= addr < start + len(data):
+                end = data.find(b'\0', addr - start)
+                return data[addr - start:end].decode('utf-8', 'replace')
+        return None
+
+
+class RecordError(Exception):
+    pass
+
+
+class Arguments(object):
+    """ Arguments packed after the header of a record """
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def unpack(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.pos + size > len(self.data):
+            raise RecordError('record too short')
+        value = struct.unpack_from(fmt, self.data, self.pos)[0]
+        self.pos += size
+        return value
+
+    def string(self):
+        end = self.data.find(b'\0', self.pos)
+        if end < 0:
+            raise RecordError('record too short')
+        value = self.data[self.pos:end].decode('utf-8', 'replace')
+        self.pos = end + 1
+        return value
+
+
+def hex_float(value):
+    """ Format a double as %a does, from the hex digits of its bits """
+    digits = binascii.hexlify(struct.pack('>d', value)).decode('ascii')
+    sign = '-' if int(digits[0], 16) & 8 else ''
+    exponent = int(digits[:3], 16) & 0x7ff
+    mantissa = digits[3:].rstrip('0')
+    if exponent == 0x7ff:
+        return sign + ('nan' if mantissa else 'inf')
+    if exponent == 0:
+        if not mantissa:
+            return sign + '0x0p+0'
+        lead, exponent = '0', -1022
+    else:
+        lead, exponent = '1', exponent - 1023
+    return '%s0x%s%s%sp%+d' % (sign, lead, '.' if mantissa else '', mantissa, exponent)
+
+
+def format_arg(args, flags, width, precision, length, conv):
+    """ Format one conversion like newlib printf does """
+    spec = '%' + flags + width + ('.' + precision if precision is not None else '')
+    longs = 2 if 'j' in length or 'q' in length else length.count('l')
+
+    if conv in 'diuxXoc':
+        signed = conv in 'di'
+        if longs >= 2:
+            value = args.unpack('<q' if signed else '<Q')
+        else:
+            value = args.unpack('<i' if signed else '<I')
+            if length == 'hh':
+                value = value & 0xff if not signed else (value & 0xff) - ((value & 0x80) << 1)
+            elif length == 'h':
+                value = value & 0xffff if not signed else (value & 0xffff) - ((value & 0x8000) << 1)
+        if conv == 'c':
+            return (spec + 's') % chr(value & 0xff)
+        return (spec + ('d' if conv == 'u' else conv)) % value
+    if conv == 'p':
+        return (spec + 's') % ('0x%x' % args.unpack('<I'))
+    if conv in 'eEfFgG':
+        return (spec + conv) % args.unpack('<d')
+    if conv in 'aA':
+        value = hex_float(args.unpack('<d'))
+        return (spec + 's') % (value.upper() if conv == 'A' else value)
+    if conv == 's':
+        return (spec + 's') % args.string()
+    raise RecordError('unsupported conversion %%%s' % conv)
+
+
+def decode_record(strings, record, colors):
+    if len(record) < HEADER.size:
+        raise RecordError('record too short')
+    level, timestamp, tag_addr, fmt_addr = HEADER.unpack_from(record)
+
+    tag = strings.get(tag_addr)
+    fmt = strings.get(fmt_addr)
+    if fmt is None:
+        raise RecordError('no format string at 0x%08x' % fmt_addr)
+    if tag is None:
+        tag = '0x%08x' % tag_addr
+
+    args = Arguments(record[HEADER.size:])
+
+    def conversion(match):
+        flags, width, precision, length, conv = match.groups()
+        if conv == '%':
+            return '%'
+        return format_arg(args, flags, width, precision, length, conv)
+
+    message = SPEC.sub(conversion, fmt)
+
+    level = level if level < len(LEVEL_PREFIX) else 0
+    line = '%s (%d) %s: %s' % (LEVEL_PREFIX[level], timestamp, tag, message)
+    if colors and LEVEL_COLOR[level]:
+        line = '\033[0;%dm%s\033[0m' % (LEVEL_COLOR[level], line)
+    return line + '\n'
+
+
+def decode_line(strings, line, colors):
+    """ Decode a line of bytes, returns it as a string """
+    head = line.find(b'\x1bL')
+    match = FRAME.match(line, head) if head >= 0 else None
+    if not match:
+        return line.decode('utf-8', 'replace')
+
+    text = line[:head].decode('utf-8', 'replace')
+    try:
+        return text + decode_record(strings, base64.b64decode(match.group(1)), colors)
+    except (RecordError, binascii.Error, ValueError, TypeError) as e:
+        return text + '<bad log record: %s>\n' % e
+
+
+def main():
+    parser = argparse.ArgumentParser(description='ESP8266 deferred log decoder')
+    parser.add_argument('elf_file', help='ELF file of the application', type=argparse.FileType('rb'))
+    parser.add_argument('input', help='Log captured from the device, stdin by default', nargs='?')
+    parser.add_argument('--port', '-p', help='Serial port to read the log from instead')
+    parser.add_argument('--baud', '-b', help='Serial port baud rate', type=int, default=74880)
+    parser.add_argument('--no-color', help='Do not write out the ANSI color codes', action='store_true')
+    args = parser.parse_args()
+
+    strings = ElfStrings(args.elf_file)
+    colors = not args.no_color
+
+    if args.port:
+        import serial
+        source = serial.serial_for_url(args.port, args.baud)
+    elif args.input:
+        source = io.open(args.input, 'rb')
+    else:
+        source = getattr(sys.stdin, 'buffer', sys.stdin)
+
+    try:
+        while True:
+            line = source.readline()
+            if not line:
+                break
+            sys.stdout.write(decode_line(strings, line, colors))
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
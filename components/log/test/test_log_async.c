@@ -0,0 +1,118 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <unity.h>
+#include "esp_log.h"
+#include "driver/soc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef CONFIG_LOG_ASYNC
+
+#define TEST_ENTRIES        10
+#define TEST_OUTPUT_SIZE    1024
+
+static char s_test_output[TEST_OUTPUT_SIZE];
+static size_t s_test_output_len;
+
+static int test_slow_putchar(int ch)
+{
+    /* As slow as a UART at 115200 baud */
+    ets_delay_us(87);
+
+    if (s_test_output_len < TEST_OUTPUT_SIZE - 1) {
+        s_test_output[s_test_output_len++] = ch;
+    }
+    return ch;
+}
+
+TEST_CASE("Test async log does not wait for the output", "[log]")
+{
+    putchar_like_t old_putchar;
+    uint32_t start, cycles;
+    char entry[16];
+
+    s_test_output_len = 0;
+    esp_log_async_flush();
+    old_putchar = esp_log_set_putchar(test_slow_putchar);
+
+    start = soc_get_ccount();
+    for (int i = 0; i < TEST_ENTRIES; i++) {
+        esp_log_write(ESP_LOG_INFO, "TAG", "Test async entry %d", i);
+    }
+    cycles = (soc_get_ccount() - start) / TEST_ENTRIES;
+
+    esp_log_async_flush();
+    esp_log_set_putchar(old_putchar);
+    s_test_output[s_test_output_len] = '\0';
+
+    printf("%u cycles per log entry\n", cycles);
+
+    /* Writing out an entry of about 30 characters takes more than 200000 cycles */
+    TEST_ASSERT_LESS_THAN(50000, cycles);
+#ifndef CONFIG_LOG_ASYNC_FORMAT_HOST
+    for (int i = 0; i < TEST_ENTRIES; i++) {
+        sprintf(entry, "entry %d", i);
+        TEST_ASSERT_NOT_NULL(strstr(s_test_output, entry));
+    }
+#endif
+}
+
+#ifdef CONFIG_LOG_ASYNC_FORMAT_TASK
+TEST_CASE("Test deferred log formatting", "[log]")
+{
+    putchar_like_t old_putchar;
+    char expected[128];
+    char str[16];
+
+    esp_log_async_flush();
+    old_putchar = esp_log_set_putchar(test_slow_putchar);
+
+    /* The string on the stack is changed before the entry is formatted */
+    strcpy(str, "stack");
+    s_test_output_len = 0;
+    esp_log_write(ESP_LOG_INFO, "TAG", "%d %u %08x %c %lld %.2f %s|%5s|%-4s|%%",
+                  -1, 3000000000U, 0x1234, 'z', -1234567890123LL, 2.25, str, "ab", "cd");
+    strcpy(str, "changed");
+    esp_log_async_flush();
+    s_test_output[s_test_output_len] = '\0';
+
+    sprintf(expected, "%d %u %08x %c %lld %.2f %s|%5s|%-4s|%%",
+            -1, 3000000000U, 0x1234, 'z', -1234567890123LL, 2.25, "stack", "ab", "cd");
+    TEST_ASSERT_NOT_NULL(strstr(s_test_output, expected));
+
+    /* Formatted by the caller */
+    s_test_output_len = 0;
+    esp_log_write(ESP_LOG_INFO, "TAG", "%*d", 6, 42);
+    esp_log_async_flush();
+    s_test_output[s_test_output_len] = '\0';
+    TEST_ASSERT_NOT_NULL(strstr(s_test_output, "TAG:     42"));
+
+    /* Only the characters within the precision are read, the arrays are not terminated */
+    static const char unterminated[4] = { 'a', 'b', 'c', 'd' };
+    s_test_output_len = 0;
+    esp_log_write(ESP_LOG_INFO, "TAG", "%.3s|%.4s|%.*s", unterminated, unterminated, 2, unterminated);
+    esp_log_async_flush();
+    s_test_output[s_test_output_len] = '\0';
+    TEST_ASSERT_NOT_NULL(strstr(s_test_output, "TAG: abc|abcd|ab"));
+
+    esp_log_set_putchar(old_putchar);
+}
+#endif
+
+#endif
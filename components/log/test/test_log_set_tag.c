@@ -22,6 +22,7 @@
 #include <esp_spi_flash.h>
 #include "esp_attr.h"
 #include "esp_log.h"
+#include "driver/soc.h"
 
 
 TEST_CASE("Test set tag level", "[log]")
@@ -62,3 +63,74 @@ TEST_CASE("Test set tag level", "[log]")
         ESP_LOGV(TAG[tag_off], "Test TAG VERBOSE with global level %d", level);
     }
 }
+
+#ifdef CONFIG_LOG_SET_LEVEL
+#define TEST_TAGS           50
+#define TEST_FILTERED_LOGS  1000
+
+static size_t s_test_chars;
+
+static int test_count_putchar(int ch)
+{
+    s_test_chars++;
+    return ch;
+}
+
+/* Writes out the entries still queued by the async mode */
+static void test_log_flush(void)
+{
+#ifdef CONFIG_LOG_ASYNC
+    esp_log_async_flush();
+#endif
+}
+
+TEST_CASE("Test filtered logs with many tags set", "[log]")
+{
+    static char tags[TEST_TAGS][8];
+    putchar_like_t old_putchar;
+    uint32_t start, cycles;
+
+    for (int i = 0; i < TEST_TAGS; i++) {
+        sprintf(tags[i], "TAG-%d", i);
+        esp_log_level_set(tags[i], i & 1 ? ESP_LOG_WARN : ESP_LOG_INFO);
+    }
+
+    test_log_flush();
+    old_putchar = esp_log_set_putchar(test_count_putchar);
+
+    for (int i = 0; i < TEST_TAGS; i++) {
+        s_test_chars = 0;
+        esp_log_write(ESP_LOG_INFO, tags[i], "Test TAG INFO\n");
+        test_log_flush();
+        TEST_ASSERT_EQUAL(!(i & 1), s_test_chars != 0);
+    }
+
+    /* Clears the tags while their levels are cached */
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    s_test_chars = 0;
+    for (int i = 0; i < TEST_TAGS; i++) {
+        esp_log_write(ESP_LOG_INFO, tags[i], "Test TAG INFO\n");
+    }
+    test_log_flush();
+    TEST_ASSERT_EQUAL(0, s_test_chars);
+
+    for (int i = 0; i < TEST_TAGS; i++) {
+        esp_log_level_set(tags[i], ESP_LOG_ERROR);
+    }
+
+    start = soc_get_ccount();
+    for (int i = 0; i < TEST_FILTERED_LOGS; i++) {
+        esp_log_write(ESP_LOG_INFO, tags[i % TEST_TAGS], "Test TAG INFO\n");
+    }
+    cycles = (soc_get_ccount() - start) / TEST_FILTERED_LOGS;
+
+    test_log_flush();
+    esp_log_set_putchar(old_putchar);
+    esp_log_level_set("*", CONFIG_LOG_DEFAULT_LEVEL);
+
+    printf("%u cycles per filtered log\n", cycles);
+    TEST_ASSERT_EQUAL(0, s_test_chars);
+    TEST_ASSERT_LESS_THAN(500, cycles);
+}
+#endif
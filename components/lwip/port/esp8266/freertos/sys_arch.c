@@ -428,6 +428,10 @@ sys_init(void)
     }
   }
 
+#ifdef CONFIG_LWIP_MEMP_POOLS
+  lwip_memp_pool_init();
+#endif
+
   // Create the pthreads key for the per-thread semaphore storage
   pthread_key_create(&sys_thread_sem_key, sys_thread_sem_free);
 
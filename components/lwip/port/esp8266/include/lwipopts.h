@@ -101,8 +101,19 @@
  */
 #define MEM_ALIGNMENT           4
 
+#ifdef CONFIG_LWIP_MEMP_POOLS
+void lwip_memp_pool_init(void);
+void *lwip_memp_pool_malloc(size_t size);
+void lwip_memp_pool_free(void *ptr);
+
+/* With MEMP_MEM_MALLOC, memp_malloc() ends up here with the size of the
+ * memp type, the sizes of the pooled types are served from the pools */
+#define mem_clib_free(s) lwip_memp_pool_free(s)
+#define mem_clib_malloc(s) lwip_memp_pool_malloc(s)
+#else
 #define mem_clib_free(s) heap_caps_free(s)
 #define mem_clib_malloc(s) heap_caps_malloc(s, MALLOC_CAP_8BIT)
+#endif
 #define mem_clib_calloc(n, s) heap_caps_calloc(n, s, MALLOC_CAP_8BIT)
 
 /*
@@ -0,0 +1,100 @@
+// Copyright 2018-2019 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sdkconfig.h"
+
+#ifdef CONFIG_LWIP_MEMP_POOLS
+
+#include "lwip/opt.h"
+#include "lwip/memp.h"
+#include "lwip/priv/memp_priv.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_pool.h"
+#include "esp_log.h"
+
+typedef struct {
+    memp_t  type;
+    size_t  num;
+} memp_pool_config_t;
+
+/* The types allocated and freed for (almost) every packet */
+static const memp_pool_config_t s_pool_config[] = {
+    { MEMP_PBUF,            CONFIG_LWIP_MEMP_POOL_PBUF_NUM },
+#if LWIP_TCP
+    { MEMP_TCP_SEG,         CONFIG_LWIP_MEMP_POOL_TCP_SEG_NUM },
+#endif
+#if !NO_SYS && !LWIP_TCPIP_CORE_LOCKING_INPUT
+    { MEMP_TCPIP_MSG_INPKT, CONFIG_LWIP_MEMP_POOL_TCPIP_MSG_NUM },
+#endif
+#if LWIP_NETCONN || LWIP_SOCKET
+    { MEMP_NETBUF,          CONFIG_LWIP_MEMP_POOL_NETBUF_NUM },
+#endif
+#if LWIP_TIMERS && !LWIP_TIMERS_CUSTOM
+    { MEMP_SYS_TIMEOUT,     CONFIG_LWIP_MEMP_POOL_SYS_TIMEOUT_NUM },
+#endif
+};
+
+#define POOL_NUM    (sizeof(s_pool_config) / sizeof(s_pool_config[0]))
+
+static heap_caps_pool_handle_t s_pool[POOL_NUM];
+static size_t s_pool_size[POOL_NUM];
+
+static const char *TAG = "lwip_pool";
+
+void lwip_memp_pool_init(void)
+{
+    for (size_t i = 0; i < POOL_NUM; i++) {
+        if (s_pool[i] || !s_pool_config[i].num) {
+            continue;
+        }
+        /* The size memp_malloc() asks mem_malloc() for */
+        size_t size = MEMP_SIZE + MEMP_ALIGN_SIZE(memp_pools[s_pool_config[i].type]->size);
+
+        s_pool[i] = heap_caps_pool_create(size, s_pool_config[i].num, MALLOC_CAP_8BIT);
+        if (!s_pool[i]) {
+            ESP_LOGW(TAG, "no pool for memp type %d, the heap is used instead", s_pool_config[i].type);
+            continue;
+        }
+        s_pool_size[i] = size;
+    }
+}
+
+void *lwip_memp_pool_malloc(size_t size)
+{
+    /* Several types may have the same size, any of their pools will do */
+    for (size_t i = 0; i < POOL_NUM; i++) {
+        if (s_pool[i] && s_pool_size[i] == size) {
+            void *p = heap_caps_pool_alloc(s_pool[i]);
+            if (p) {
+                return p;
+            }
+        }
+    }
+
+    return heap_caps_malloc(size, MALLOC_CAP_8BIT);
+}
+
+void lwip_memp_pool_free(void *ptr)
+{
+    for (size_t i = 0; i < POOL_NUM; i++) {
+        if (s_pool[i] && heap_caps_pool_owns(s_pool[i], ptr)) {
+            heap_caps_pool_free(s_pool[i], ptr);
+            return;
+        }
+    }
+
+    heap_caps_free(ptr);
+}
+
+#endif /* CONFIG_LWIP_MEMP_POOLS */
@@ -25,6 +25,11 @@
 
 #include_next <pthread.h>
 
+// Mutex type trying again a few times before blocking, see CONFIG_PTHREAD_MUTEX_ADAPTIVE_SPINS
+#ifndef PTHREAD_MUTEX_ADAPTIVE_NP
+#define PTHREAD_MUTEX_ADAPTIVE_NP   4
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
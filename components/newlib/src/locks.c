@@ -14,68 +14,82 @@
 
 #include <sys/lock.h>
 #include <stdlib.h>
+#include <string.h>
 #include <reent.h>
 
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include "task.h"
 
-/* Initialize the given lock by allocating a new mutex semaphore
-   as the _lock_t value.
+/* The _lock_t value points to a newlib_lock_t, allocated by _lock_init* or
+   lazily by the first _lock_acquire*.
+
+   Taking a free lock or releasing a lock nobody waits for only updates the
+   owner in a short critical section. A binary semaphore is created the first
+   time a task has to wait for the lock, the waiting tasks block on it and
+   the owner gives it when it releases the lock with tasks waiting.
+
+   The owner is counted as a mutex holder by FreeRTOS, so it inherits the
+   priority of the tasks waiting for the lock as with a FreeRTOS mutex.
+*/
+typedef struct {
+    void *owner;            /* TCB of the task holding the lock, LOCK_OWNER_ISR, or NULL when free */
+    uint32_t count;         /* times the owner took the lock */
+    uint32_t waiters;       /* tasks blocked, or about to block, on sem */
+    xSemaphoreHandle sem;   /* created by the first task which has to wait */
+} newlib_lock_t;
+
+#define LOCK_OWNER_ISR ((void *)1)
+
+/* Initialize the given lock by allocating a new newlib_lock_t as the
+   _lock_t value.
 
    Called by _lock_init*, also called by _lock_acquire* to lazily initialize locks that might have
    been initialised (to zero only) before the RTOS scheduler started.
 */
 
-static void lock_init_generic(_lock_t *lock, uint8_t mutex_type) {
-    portENTER_CRITICAL();
+static void lock_init_generic(_lock_t *lock) {
+    newlib_lock_t *new_lock;
+
     if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
         /* nothing to do until the scheduler is running */
-        portEXIT_CRITICAL();
         return;
     }
 
+    new_lock = pvPortMalloc(sizeof(newlib_lock_t));
+    if (!new_lock) {
+        abort(); /* OOM */
+    }
+    memset(new_lock, 0, sizeof(newlib_lock_t));
+
+    portENTER_CRITICAL();
     if (*lock) {
          /* Lock already initialised (either we didn't check earlier,
-          or it got initialised while we were waiting for the
-          spinlock.) */
+          or it got initialised while we were allocating.) */
     }
     else
     {
-        /* Create a new semaphore
-
-           this is a bit of an API violation, as we're calling the
-           private function xQueueCreateMutex(x) directly instead of
-           the xSemaphoreCreateMutex / xSemaphoreCreateRecursiveMutex
-           wrapper functions...
-
-           The better alternative would be to pass pointers to one of
-           the two xSemaphoreCreate___Mutex functions, but as FreeRTOS
-           implements these as macros instead of inline functions
-           (*party like it's 1998!*) it's not possible to do this
-           without writing wrappers. Doing it this way seems much less
-           spaghetti-like.
-        */
-        xSemaphoreHandle new_sem = xQueueCreateMutex(mutex_type);
-        if (!new_sem) {
-            abort(); /* No more semaphores available or OOM */
-        }
-        *lock = (_lock_t)new_sem;
+        *lock = (_lock_t)new_lock;
+        new_lock = NULL;
     }
     portEXIT_CRITICAL();
+
+    if (new_lock) {
+        vPortFree(new_lock);
+    }
 }
 
 void _lock_init(_lock_t *lock) {
     *lock = 0; // In case lock's memory is uninitialized
-    lock_init_generic(lock, queueQUEUE_TYPE_MUTEX);
+    lock_init_generic(lock);
 }
 
 void _lock_init_recursive(_lock_t *lock) {
     *lock = 0; // In case lock's memory is uninitialized
-    lock_init_generic(lock, queueQUEUE_TYPE_RECURSIVE_MUTEX);
+    lock_init_generic(lock);
 }
 
-/* Free the mutex semaphore pointed to by *lock, and zero it out.
+/* Free the newlib_lock_t pointed to by *lock, and zero it out.
 
    Note that FreeRTOS doesn't account for deleting mutexes while they
    are held, and neither do we... so take care not to delete newlib
@@ -85,28 +99,52 @@ void _lock_init_recursive(_lock_t *lock) {
    re-initialised if it is used again. Caller has to avoid doing
    this!
 */
-static void lock_close_generic(_lock_t *lock,  uint8_t mutex_type) {
+static void lock_close_generic(_lock_t *lock) {
+    newlib_lock_t *l;
+
     portENTER_CRITICAL();
-    if (*lock) {
-        xSemaphoreHandle h = (xSemaphoreHandle)(*lock);
-#if (INCLUDE_xSemaphoreGetMutexHolder == 1)
-        configASSERT(xSemaphoreGetMutexHolder(h) == NULL); /* mutex should not be held */
-#endif
-        vSemaphoreDelete(h);
-        *lock = 0;
-    }
+    l = (newlib_lock_t *)(*lock);
+    *lock = 0;
     portEXIT_CRITICAL();
+
+    if (l) {
+        configASSERT(l->owner == NULL); /* lock should not be held */
+        if (l->sem) {
+            vSemaphoreDelete(l->sem);
+        }
+        vPortFree(l);
+    }
 }
 
 void _lock_close(_lock_t *lock) {
-    lock_close_generic(lock, queueQUEUE_TYPE_MUTEX);
+    lock_close_generic(lock);
 }
 
 void _lock_close_recursive(_lock_t *lock) {
-    lock_close_generic(lock, queueQUEUE_TYPE_RECURSIVE_MUTEX);
+    lock_close_generic(lock);
+}
+
+/* Create the semaphore the tasks waiting for the lock block on, if another
+   task did not create it meanwhile. */
+static void lock_create_sem(newlib_lock_t *l) {
+    xSemaphoreHandle sem = xSemaphoreCreateBinary();
+    if (!sem) {
+        abort(); /* No more semaphores available or OOM */
+    }
+
+    portENTER_CRITICAL();
+    if (!l->sem) {
+        l->sem = sem;
+        sem = NULL;
+    }
+    portEXIT_CRITICAL();
+
+    if (sem) {
+        vSemaphoreDelete(sem);
+    }
 }
 
-/* Acquire the mutex semaphore for lock. wait up to delay ticks.
+/* Acquire the lock. wait up to delay ticks.
    mutex_type is queueQUEUE_TYPE_RECURSIVE_MUTEX or queueQUEUE_TYPE_MUTEX
 */
 static int lock_acquire_generic(_lock_t *lock, uint32_t delay, uint8_t mutex_type) {
@@ -114,43 +152,77 @@ static int lock_acquire_generic(_lock_t *lock, uint32_t delay, uint8_t mutex_typ
     if (interrupt_is_disable() == true && !xPortInIsrContext())
         return 0;
 
-    xSemaphoreHandle h = (xSemaphoreHandle)(*lock);
-    if (!h) {
+    newlib_lock_t *l = (newlib_lock_t *)(*lock);
+    if (!l) {
         if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
             return 0; /* locking is a no-op before scheduler is up, so this "succeeds" */
         }
         /* lazy initialise lock - might have had a static initializer in newlib (that we don't use),
            or _lock_init might have been called before the scheduler was running... */
-        lock_init_generic(lock, mutex_type);
-        h = (xSemaphoreHandle)(*lock);
-        configASSERT(h != NULL);
+        lock_init_generic(lock);
+        l = (newlib_lock_t *)(*lock);
+        configASSERT(l != NULL);
     }
 
-    BaseType_t success;
     if (xPortInIsrContext()) {
-        /* In ISR Context */
+        /* In ISR Context, no task can run until the handler returns */
         if (mutex_type == queueQUEUE_TYPE_RECURSIVE_MUTEX) {
             abort(); /* recursive mutexes make no sense in ISR context */
         }
-        BaseType_t higher_task_woken = false;
-        success = xSemaphoreTakeFromISR(h, &higher_task_woken);
-        if (!success && delay > 0) {
-            abort(); /* Tried to block on mutex from ISR, couldn't... rewrite your program to avoid libc interactions in ISRs! */
-        }
-        if (higher_task_woken) {
-            portYIELD_FROM_ISR();
+        if (l->owner) {
+            if (delay > 0) {
+                abort(); /* Tried to block on mutex from ISR, couldn't... rewrite your program to avoid libc interactions in ISRs! */
+            }
+            return -1;
         }
+        l->owner = LOCK_OWNER_ISR;
+        l->count = 1;
+        return 0;
     }
-    else {
-        /* In task context */
-        if (mutex_type == queueQUEUE_TYPE_RECURSIVE_MUTEX) {
-            success = xSemaphoreTakeRecursive(h, delay);
-        } else {
-            success = xSemaphoreTake(h, delay);
+
+    /* In task context */
+    while (1) {
+        BaseType_t success;
+
+        portENTER_CRITICAL();
+        if (!l->owner) {
+            l->owner = pvTaskIncrementMutexHeldCount();
+            l->count = 1;
+            portEXIT_CRITICAL();
+            return 0;
         }
-    }
+        if (mutex_type == queueQUEUE_TYPE_RECURSIVE_MUTEX && l->owner == xTaskGetCurrentTaskHandle()) {
+            l->count++;
+            portEXIT_CRITICAL();
+            return 0;
+        }
+        if (!delay) {
+            portEXIT_CRITICAL();
+            return -1;
+        }
+        if (!l->sem) {
+            portEXIT_CRITICAL();
+            lock_create_sem(l);
+            continue;
+        }
+        /* The owner gives the semaphore when it releases the lock, as it sees this waiter */
+        l->waiters++;
+        if (l->owner != LOCK_OWNER_ISR) {
+            xTaskPriorityInherit(l->owner);
+        }
+        portEXIT_CRITICAL();
 
-    return (success == pdTRUE) ? 0 : -1;
+        success = xSemaphoreTake(l->sem, delay);
+
+        portENTER_CRITICAL();
+        l->waiters--;
+        portEXIT_CRITICAL();
+
+        if (success != pdTRUE) {
+            return -1;
+        }
+        /* The lock may have been taken again before this task ran, try again */
+    }
 }
 
 void _lock_acquire(_lock_t *lock) {
@@ -169,7 +241,7 @@ int _lock_try_acquire_recursive(_lock_t *lock) {
     return lock_acquire_generic(lock, 0, queueQUEUE_TYPE_RECURSIVE_MUTEX);
 }
 
-/* Release the mutex semaphore for lock.
+/* Release the lock.
    mutex_type is queueQUEUE_TYPE_RECURSIVE_MUTEX or queueQUEUE_TYPE_MUTEX
 */
 static void lock_release_generic(_lock_t *lock, uint8_t mutex_type) {
@@ -177,8 +249,8 @@ static void lock_release_generic(_lock_t *lock, uint8_t mutex_type) {
     if (interrupt_is_disable() == true && !xPortInIsrContext())
         return ;
 
-    xSemaphoreHandle h = (xSemaphoreHandle)(*lock);
-    if (h == NULL) {
+    newlib_lock_t *l = (newlib_lock_t *)(*lock);
+    if (l == NULL) {
         /* This is probably because the scheduler isn't running yet,
            or the scheduler just started running and some code was
            "holding" a not-yet-initialised lock... */
@@ -189,16 +261,41 @@ static void lock_release_generic(_lock_t *lock, uint8_t mutex_type) {
         if (mutex_type == queueQUEUE_TYPE_RECURSIVE_MUTEX) {
             abort(); /* indicates logic bug, it shouldn't be possible to lock recursively in ISR */
         }
-        BaseType_t higher_task_woken = false;
-        xSemaphoreGiveFromISR(h, &higher_task_woken);
-        if (higher_task_woken) {
-            portYIELD_FROM_ISR();
+        if (l->owner != LOCK_OWNER_ISR) {
+            return;
+        }
+        l->owner = NULL;
+        l->count = 0;
+        if (l->waiters) {
+            BaseType_t higher_task_woken = false;
+            xSemaphoreGiveFromISR(l->sem, &higher_task_woken);
+            if (higher_task_woken) {
+                portYIELD_FROM_ISR();
+            }
         }
     } else {
-        if (mutex_type == queueQUEUE_TYPE_RECURSIVE_MUTEX) {
-            xSemaphoreGiveRecursive(h);
-        } else {
-            xSemaphoreGive(h);
+        bool wake = false;
+        BaseType_t yield = pdFALSE;
+
+        portENTER_CRITICAL();
+        if (l->owner != xTaskGetCurrentTaskHandle()) {
+            /* Not held by this task, as giving a mutex the task does not hold */
+            portEXIT_CRITICAL();
+            return;
+        }
+        if (--l->count == 0) {
+            yield = xTaskPriorityDisinherit(l->owner);
+            l->owner = NULL;
+            wake = l->waiters != 0;
+        }
+        portEXIT_CRITICAL();
+
+        if (wake) {
+            xSemaphoreGive(l->sem);
+        }
+        if (yield) {
+            /* The priority inherited from the waiters is given back */
+            portYIELD();
         }
     }
 }
@@ -0,0 +1,236 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/lock.h>
+
+#include <unity.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "driver/soc.h"
+
+#define TEST_LOCK_OPS       1000
+#define TEST_STDIO_LINES    1000
+#define TEST_TASK_LOOPS     200
+
+TEST_CASE("Test newlib lock uncontended acquire and release", "[newlib]")
+{
+    _lock_t lock, recursive;
+    SemaphoreHandle_t mutex;
+    uint32_t start, lock_cycles, recursive_cycles, mutex_cycles;
+
+    _lock_init(&lock);
+    _lock_init_recursive(&recursive);
+    mutex = xSemaphoreCreateMutex();
+    TEST_ASSERT_NOT_NULL(mutex);
+
+    /* Load the code in the cache first */
+    _lock_acquire(&lock);
+    _lock_release(&lock);
+    _lock_acquire_recursive(&recursive);
+    _lock_release_recursive(&recursive);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    xSemaphoreGive(mutex);
+
+    start = soc_get_ccount();
+    for (int i = 0; i < TEST_LOCK_OPS; i++) {
+        _lock_acquire(&lock);
+        _lock_release(&lock);
+    }
+    lock_cycles = (soc_get_ccount() - start) / TEST_LOCK_OPS;
+
+    start = soc_get_ccount();
+    for (int i = 0; i < TEST_LOCK_OPS; i++) {
+        _lock_acquire_recursive(&recursive);
+        _lock_release_recursive(&recursive);
+    }
+    recursive_cycles = (soc_get_ccount() - start) / TEST_LOCK_OPS;
+
+    /* What each lock cost when it was a FreeRTOS mutex */
+    start = soc_get_ccount();
+    for (int i = 0; i < TEST_LOCK_OPS; i++) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        xSemaphoreGive(mutex);
+    }
+    mutex_cycles = (soc_get_ccount() - start) / TEST_LOCK_OPS;
+
+    printf("Acquire and release: lock %u cycles, recursive lock %u cycles, FreeRTOS mutex %u cycles\n",
+           lock_cycles, recursive_cycles, mutex_cycles);
+
+    _lock_close(&lock);
+    _lock_close_recursive(&recursive);
+    vSemaphoreDelete(mutex);
+
+    TEST_PERFORMANCE_LESS_THAN(NEWLIB_LOCK_CYCLES_PER_OP, "%d cycles", lock_cycles);
+    TEST_PERFORMANCE_LESS_THAN(NEWLIB_LOCK_CYCLES_PER_OP, "%d cycles", recursive_cycles);
+}
+
+static int discard_write(void *cookie, const char *buf, int size)
+{
+    return size;
+}
+
+TEST_CASE("Test newlib lock stdio throughput", "[newlib]")
+{
+    FILE *f = fwopen(NULL, discard_write);
+    int64_t start, elapsed;
+
+    TEST_ASSERT_NOT_NULL(f);
+
+    /* Each call locks the stream */
+    fprintf(f, "warm up %d\n", 0);
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_STDIO_LINES; i++) {
+        fprintf(f, "line %d\n", i);
+    }
+    elapsed = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < TEST_STDIO_LINES; i++) {
+        fputc('x', f);
+    }
+    printf("%d fprintf() in %d us, %d fputc() in %d us\n", TEST_STDIO_LINES, (int)elapsed,
+           TEST_STDIO_LINES, (int)(esp_timer_get_time() - start));
+
+    fclose(f);
+
+    IDF_LOG_PERFORMANCE("NEWLIB_FPRINTF_PER_SECOND", "%d", (int)(TEST_STDIO_LINES * 1000000LL / elapsed));
+}
+
+typedef struct {
+    _lock_t *lock;
+    volatile uint32_t *counter;
+    SemaphoreHandle_t done;
+} test_lock_arg_t;
+
+static void counter_task(void *p)
+{
+    test_lock_arg_t *arg = (test_lock_arg_t *)p;
+
+    for (int i = 0; i < TEST_TASK_LOOPS; i++) {
+        _lock_acquire_recursive(arg->lock);
+        _lock_acquire_recursive(arg->lock);
+
+        uint32_t counter = *arg->counter;
+        /* Let the other task find the lock held */
+        if (i % 4 == 0) {
+            vTaskDelay(1);
+        }
+        *arg->counter = counter + 1;
+
+        _lock_release_recursive(arg->lock);
+        _lock_release_recursive(arg->lock);
+        taskYIELD();
+    }
+
+    xSemaphoreGive(arg->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Test newlib lock contended by tasks", "[newlib]")
+{
+    const UBaseType_t prio = uxTaskPriorityGet(NULL);
+    volatile uint32_t counter = 0;
+    _lock_t lock;
+    test_lock_arg_t arg = {
+        .lock = &lock,
+        .counter = &counter,
+        .done = xSemaphoreCreateCounting(2, 0)
+    };
+
+    TEST_ASSERT_NOT_NULL(arg.done);
+    _lock_init_recursive(&lock);
+
+    xTaskCreate(counter_task, "lock1", 2048, &arg, prio - 1, NULL);
+    xTaskCreate(counter_task, "lock2", 2048, &arg, prio - 2, NULL);
+
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(arg.done, 5000 / portTICK_PERIOD_MS));
+    }
+    TEST_ASSERT_EQUAL(2 * TEST_TASK_LOOPS, counter);
+
+    TEST_ASSERT_EQUAL(0, _lock_try_acquire_recursive(&lock));
+    _lock_release_recursive(&lock);
+
+    _lock_close_recursive(&lock);
+    vSemaphoreDelete(arg.done);
+}
+
+static void holder_task(void *p)
+{
+    test_lock_arg_t *arg = (test_lock_arg_t *)p;
+
+    _lock_acquire(arg->lock);
+    xSemaphoreGive(arg->done);
+
+    /* Hold the lock until the test task stops waiting for it */
+    while (*arg->counter == 0) {
+        vTaskDelay(1);
+    }
+    _lock_release(arg->lock);
+
+    xSemaphoreGive(arg->done);
+    vTaskDelete(NULL);
+}
+
+static void waiter_task(void *p)
+{
+    test_lock_arg_t *arg = (test_lock_arg_t *)p;
+
+    _lock_acquire(arg->lock);
+    _lock_release(arg->lock);
+
+    xSemaphoreGive(arg->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Test newlib lock holder inherits the priority of the waiters", "[newlib]")
+{
+    const UBaseType_t prio = uxTaskPriorityGet(NULL);
+    volatile uint32_t release = 0;
+    TaskHandle_t holder;
+    _lock_t lock;
+    test_lock_arg_t arg = {
+        .lock = &lock,
+        .counter = &release,
+        .done = xSemaphoreCreateCounting(3, 0)
+    };
+
+    TEST_ASSERT_NOT_NULL(arg.done);
+    _lock_init(&lock);
+
+    xTaskCreate(holder_task, "holder", 2048, &arg, prio - 2, &holder);
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(arg.done, 1000 / portTICK_PERIOD_MS));
+
+    /* The lock is held by another task, it can't be taken without waiting */
+    TEST_ASSERT_EQUAL(-1, _lock_try_acquire(&lock));
+
+    xTaskCreate(waiter_task, "waiter", 2048, &arg, prio - 1, NULL);
+    vTaskDelay(2);
+    TEST_ASSERT_EQUAL(prio - 1, uxTaskPriorityGet(holder));
+
+    release = 1;
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(arg.done, 1000 / portTICK_PERIOD_MS));
+    }
+
+    TEST_ASSERT_EQUAL(0, _lock_try_acquire(&lock));
+    _lock_release(&lock);
+
+    _lock_close(&lock);
+    vSemaphoreDelete(arg.done);
+}
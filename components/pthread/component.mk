@@ -18,4 +18,5 @@ ifeq ($(GCC_NOT_5_2_0), 1)
 COMPONENT_ADD_LDFLAGS += -u pthread_include_pthread_impl
 COMPONENT_ADD_LDFLAGS += -u pthread_include_pthread_cond_impl
 COMPONENT_ADD_LDFLAGS += -u pthread_include_pthread_local_storage_impl
+COMPONENT_ADD_LDFLAGS += -u pthread_include_pthread_rwlock_impl
 endif  # GCC_NOT_5_2_0
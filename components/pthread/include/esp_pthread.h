@@ -15,7 +15,7 @@
 #pragma once
 
 #include "esp_err.h"
-#include <freertos/FreeRTOSConfig.h>
+#include <freertos/FreeRTOS.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,6 +25,9 @@ extern "C" {
 #define PTHREAD_STACK_MIN    CONFIG_PTHREAD_STACK_MIN
 #endif
 
+/** Handle of a pool of worker tasks */
+typedef struct esp_pthread_pool *esp_pthread_pool_handle_t;
+
 /** pthread configuration structure that influences pthread creation */
 typedef struct {
     size_t stack_size;  ///< The stack size of the pthread
@@ -32,8 +35,18 @@ typedef struct {
     bool inherit_cfg;   ///< Inherit this configuration further
     const char* thread_name;  ///< The thread name.
     int pin_to_core;    ///< The core id to pin the thread to. Has the same value range as xCoreId argument of xTaskCreatePinnedToCore.
+    esp_pthread_pool_handle_t pool;  ///< Run the threads on an idle worker of this pool instead of a new task, NULL if none.
 } esp_pthread_cfg_t;
 
+/** pthread worker pool configuration */
+typedef struct {
+    size_t workers;     ///< Number of worker tasks, all created with the pool
+    size_t queue_size;  ///< Number of jobs which can wait for a worker
+    size_t stack_size;  ///< The stack size of the workers in bytes
+    size_t prio;        ///< The workers' priority
+    const char *name;   ///< The workers' name, CONFIG_PTHREAD_TASK_NAME_DEFAULT if NULL
+} esp_pthread_pool_cfg_t;
+
 /**
  * @brief Creates a default pthread configuration based
  * on the values set via menuconfig.
@@ -82,6 +95,72 @@ esp_err_t esp_pthread_set_cfg(const esp_pthread_cfg_t *cfg);
  */
 esp_err_t esp_pthread_get_cfg(esp_pthread_cfg_t *p);
 
+/**
+ * @brief Creates a default pool configuration, 2 workers with the default
+ * pthread stack size and priority set via menuconfig.
+ *
+ * @return
+ *      A default pool configuration structure.
+ */
+esp_pthread_pool_cfg_t esp_pthread_pool_get_default_config(void);
+
+/**
+ * @brief Create a pool of worker tasks
+ *
+ * All the workers are created at once and wait for jobs. Jobs are queued
+ * with esp_pthread_pool_submit(), and the threads created by pthread_create()
+ * (so std::thread and std::async(std::launch::async) too) run on the pool
+ * when it is set in the esp_pthread_cfg_t of the creating thread.
+ *
+ * A thread only runs on the pool if a worker is idle and the pool stack is
+ * large enough, otherwise it gets its own task as usual: a thread must start
+ * at once, it could wait for another one forever otherwise. A thread on the
+ * pool runs with the priority of its configuration and the name of the
+ * workers. It must return from its function rather than call pthread_exit().
+ *
+ * @param cfg The pool configuration
+ * @param pool Set to the handle of the pool
+ *
+ * @return
+ *      - ESP_OK if the pool was created
+ *      - ESP_ERR_NO_MEM if out of memory
+ *      - ESP_ERR_INVALID_ARG if there is no worker, stack_size is less than PTHREAD_STACK_MIN or prio is invalid
+ */
+esp_err_t esp_pthread_pool_create(const esp_pthread_pool_cfg_t *cfg, esp_pthread_pool_handle_t *pool);
+
+/**
+ * @brief Queue a job to the workers of a pool
+ *
+ * The jobs are run in order by the first idle worker. The thread local
+ * storage set by a job is cleared when it returns.
+ *
+ * @param pool The pool
+ * @param func The job function
+ * @param arg The argument of the job function
+ * @param ticks_to_wait Ticks to wait for room in the queue
+ *
+ * @return
+ *      - ESP_OK if the job was queued
+ *      - ESP_ERR_TIMEOUT if the queue stayed full
+ *      - ESP_ERR_INVALID_ARG if pool or func is NULL
+ */
+esp_err_t esp_pthread_pool_submit(esp_pthread_pool_handle_t pool, void (*func)(void *), void *arg,
+                                  TickType_t ticks_to_wait);
+
+/**
+ * @brief Stop the workers of a pool and free it
+ *
+ * The jobs already queued are run first. No job or thread must be started
+ * on the pool meanwhile, nor after.
+ *
+ * @param pool The pool
+ *
+ * @return
+ *      - ESP_OK if the pool was deleted
+ *      - ESP_ERR_INVALID_ARG if pool is NULL
+ */
+esp_err_t esp_pthread_pool_delete(esp_pthread_pool_handle_t pool);
+
 #ifdef __cplusplus
 }
 #endif
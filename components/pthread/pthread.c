@@ -47,6 +47,7 @@ typedef struct esp_pthread_entry {
     TaskHandle_t                join_task;      ///< Handle of the task waiting to join
     enum esp_pthread_task_state state;          ///< pthread task state
     bool                        detached;       ///< True if pthread is detached
+    bool                        pooled;         ///< True if pthread runs on a pool worker
     void                       *retval;         ///< Value supplied to calling thread during join
     void                       *task_arg;       ///< Task arguments
 } esp_pthread_t;
@@ -56,12 +57,13 @@ typedef struct {
     void *(*func)(void *);  ///< user task entry
     void *arg;              ///< user task argument
     esp_pthread_cfg_t cfg;  ///< pthread configuration
+    UBaseType_t prio;       ///< priority of the pthread on a pool worker
 } esp_pthread_task_arg_t;
 
 /** pthread mutex FreeRTOS wrapper */
 typedef struct {
     SemaphoreHandle_t   sem;        ///< Handle of the task waiting to join
-    int                 type;       ///< Mutex type. Currently supported PTHREAD_MUTEX_NORMAL and PTHREAD_MUTEX_RECURSIVE
+    int                 type;       ///< Mutex type. Currently supported PTHREAD_MUTEX_NORMAL, PTHREAD_MUTEX_RECURSIVE, PTHREAD_MUTEX_ERRORCHECK and PTHREAD_MUTEX_ADAPTIVE_NP
 } esp_pthread_mutex_t;
 
 
@@ -114,10 +116,10 @@ static void *pthread_list_find_item(void *(*item_check)(esp_pthread_t *, void *a
     return NULL;
 }
 
-static void *pthread_get_handle_by_desc(esp_pthread_t *item, void *desc)
+static void *pthread_get_desc_by_desc(esp_pthread_t *item, void *desc)
 {
     if (item == desc) {
-        return item->handle;
+        return item;
     }
     return NULL;
 }
@@ -130,14 +132,15 @@ static void *pthread_get_desc_by_handle(esp_pthread_t *item, void *hnd)
     return NULL;
 }
 
-static inline TaskHandle_t pthread_find_handle(pthread_t thread)
+static esp_pthread_t *pthread_find(TaskHandle_t task_handle)
 {
-    return pthread_list_find_item(pthread_get_handle_by_desc, (void *)thread);
+    return pthread_list_find_item(pthread_get_desc_by_handle, task_handle);
 }
 
-static esp_pthread_t *pthread_find(TaskHandle_t task_handle)
+/* Also finds the pthreads on a pool, which have no task handle before they start and after they exit */
+static inline esp_pthread_t *pthread_find_desc(pthread_t thread)
 {
-    return pthread_list_find_item(pthread_get_desc_by_handle, task_handle);
+    return pthread_list_find_item(pthread_get_desc_by_desc, (void *)thread);
 }
 
 static void pthread_delete(esp_pthread_t *pthread)
@@ -189,22 +192,15 @@ esp_pthread_cfg_t esp_pthread_get_default_config(void)
         .prio = CONFIG_PTHREAD_TASK_PRIO_DEFAULT,
         .inherit_cfg = false,
         .thread_name = NULL,
-        .pin_to_core = get_default_pthread_core()
+        .pin_to_core = get_default_pthread_core(),
+        .pool = NULL
     };
 
     return cfg;
 }
 
-static void pthread_task_func(void *arg)
+static void pthread_inherit_cfg(esp_pthread_task_arg_t *task_arg)
 {
-    void *rval = NULL;
-    esp_pthread_task_arg_t *task_arg = (esp_pthread_task_arg_t *)arg;
-
-    ESP_LOGV(TAG, "%s ENTER %p", __FUNCTION__, task_arg->func);
-
-    // wait for start
-    xTaskNotifyWait(0, 0, NULL, portMAX_DELAY);
-
     if (task_arg->cfg.inherit_cfg) {
         /* If inherit option is set, then do a set_cfg() ourselves for future forks,
         but first set thread_name to NULL to enable inheritance of the name too.
@@ -214,6 +210,19 @@ static void pthread_task_func(void *arg)
         cfg->thread_name = NULL;
         esp_pthread_set_cfg(cfg);
     }
+}
+
+static void pthread_task_func(void *arg)
+{
+    void *rval = NULL;
+    esp_pthread_task_arg_t *task_arg = (esp_pthread_task_arg_t *)arg;
+
+    ESP_LOGV(TAG, "%s ENTER %p", __FUNCTION__, task_arg->func);
+
+    // wait for start
+    xTaskNotifyWait(0, 0, NULL, portMAX_DELAY);
+
+    pthread_inherit_cfg(task_arg);
     ESP_LOGV(TAG, "%s START %p", __FUNCTION__, task_arg->func);
     rval = task_arg->func(task_arg->arg);
     ESP_LOGV(TAG, "%s END %p", __FUNCTION__, task_arg->func);
@@ -223,6 +232,31 @@ static void pthread_task_func(void *arg)
     ESP_LOGV(TAG, "%s EXIT", __FUNCTION__);
 }
 
+static bool pthread_exit_internal(void *value_ptr, bool pooled);
+
+/* Runs a pthread on a pool worker, which goes on with other jobs after it */
+static void pthread_pool_func(void *arg)
+{
+    void *rval = NULL;
+    esp_pthread_t *pthread = (esp_pthread_t *)arg;
+    esp_pthread_task_arg_t *task_arg = pthread->task_arg;
+
+    if (xSemaphoreTake(s_threads_mux, portMAX_DELAY) != pdTRUE) {
+        assert(false && "Failed to lock threads list!");
+    }
+    pthread->handle = xTaskGetCurrentTaskHandle();
+    xSemaphoreGive(s_threads_mux);
+
+    vTaskPrioritySet(NULL, task_arg->prio);
+
+    pthread_inherit_cfg(task_arg);
+    ESP_LOGV(TAG, "%s START %p", __FUNCTION__, task_arg->func);
+    rval = task_arg->func(task_arg->arg);
+    ESP_LOGV(TAG, "%s END %p", __FUNCTION__, task_arg->func);
+
+    pthread_exit_internal(rval, true);
+}
+
 int pthread_create(pthread_t *thread, const pthread_attr_t *attr,
                    void *(*start_routine) (void *), void *arg)
 {
@@ -289,6 +323,32 @@ int pthread_create(pthread_t *thread, const pthread_attr_t *attr,
     task_arg->func = start_routine;
     task_arg->arg = arg;
     pthread->task_arg = task_arg;
+
+    if (pthread_cfg && pthread_cfg->pool) {
+        task_arg->prio = prio;
+        pthread->pooled = true;
+
+        if (xSemaphoreTake(s_threads_mux, portMAX_DELAY) != pdTRUE) {
+            assert(false && "Failed to lock threads list!");
+        }
+        SLIST_INSERT_HEAD(&s_threads_list, pthread, list_node);
+        xSemaphoreGive(s_threads_mux);
+
+        if (esp_pthread_pool_run_thread(pthread_cfg->pool, pthread_pool_func, pthread, stack_size) == 0) {
+            *thread = (pthread_t)pthread; // pointer value fit into pthread_t (uint32_t)
+            ESP_LOGV(TAG, "Queued pthread %p to pool", pthread);
+            return 0;
+        }
+
+        /* No idle worker, create a task */
+        if (xSemaphoreTake(s_threads_mux, portMAX_DELAY) != pdTRUE) {
+            assert(false && "Failed to lock threads list!");
+        }
+        SLIST_REMOVE(&s_threads_list, pthread, esp_pthread_entry, list_node);
+        xSemaphoreGive(s_threads_mux);
+        pthread->pooled = false;
+    }
+
     BaseType_t res = xTaskCreatePinnedToCore(&pthread_task_func,
                                              task_name,
                                              // stack_size is in bytes. This transformation ensures that the units are
@@ -342,8 +402,10 @@ int pthread_join(pthread_t thread, void **retval)
     if (xSemaphoreTake(s_threads_mux, portMAX_DELAY) != pdTRUE) {
         assert(false && "Failed to lock threads list!");
     }
-    TaskHandle_t handle = pthread_find_handle(thread);
-    if (!handle) {
+    esp_pthread_t *found = pthread_find_desc(thread);
+    TaskHandle_t handle = found ? found->handle : NULL;
+    bool pooled = found ? found->pooled : false;
+    if (!found) {
         // not found
         ret = ESRCH;
     } else if (pthread->detached) {
@@ -357,7 +419,7 @@ int pthread_join(pthread_t thread, void **retval)
         ret = EDEADLK;
     } else {
         esp_pthread_t *cur_pthread = pthread_find(xTaskGetCurrentTaskHandle());
-        if (cur_pthread && cur_pthread->join_task == handle) {
+        if (handle && cur_pthread && cur_pthread->join_task == handle) {
             // join to each other not allowed
             ret = EDEADLK;
         } else {
@@ -382,7 +444,9 @@ int pthread_join(pthread_t thread, void **retval)
             pthread_delete(pthread);
             xSemaphoreGive(s_threads_mux);
         }
-        vTaskDelete(handle);
+        if (!pooled) {
+            vTaskDelete(handle);
+        }
     }
 
     if (retval) {
@@ -401,8 +465,8 @@ int pthread_detach(pthread_t thread)
     if (xSemaphoreTake(s_threads_mux, portMAX_DELAY) != pdTRUE) {
         assert(false && "Failed to lock threads list!");
     }
-    TaskHandle_t handle = pthread_find_handle(thread);
-    if (!handle) {
+    esp_pthread_t *found = pthread_find_desc(thread);
+    if (!found) {
         ret = ESRCH;
     } else if (pthread->detached) {
         // already detached
@@ -415,15 +479,20 @@ int pthread_detach(pthread_t thread)
         pthread->detached = true;
     } else {
         // pthread already stopped
+        TaskHandle_t handle = pthread->handle;
+        bool pooled = pthread->pooled;
         pthread_delete(pthread);
-        vTaskDelete(handle);
+        if (!pooled) {
+            vTaskDelete(handle);
+        }
     }
     xSemaphoreGive(s_threads_mux);
     ESP_LOGV(TAG, "%s %p EXIT %d", __FUNCTION__, pthread, ret);
     return ret;
 }
 
-void pthread_exit(void *value_ptr)
+/* Returns true if the pthread was detached and its descriptor freed */
+static bool pthread_exit_internal(void *value_ptr, bool pooled)
 {
     bool detached = false;
     /* preemptively clean up thread local storage, rather than
@@ -437,6 +506,9 @@ void pthread_exit(void *value_ptr)
     if (!pthread) {
         assert(false && "Failed to find pthread for current task!");
     }
+    if (pthread->pooled != pooled) {
+        assert(false && "pthread_exit() is not supported on a pool!");
+    }
     if (pthread->task_arg) {
         free(pthread->task_arg);
     }
@@ -454,9 +526,20 @@ void pthread_exit(void *value_ptr)
         } else {
             pthread->state = PTHREAD_TASK_STATE_EXIT;
         }
+        if (pooled) {
+            // the worker goes on with other jobs
+            pthread->handle = NULL;
+        }
     }
     xSemaphoreGive(s_threads_mux);
 
+    return detached;
+}
+
+void pthread_exit(void *value_ptr)
+{
+    bool detached = pthread_exit_internal(value_ptr, false);
+
     ESP_LOGD(TAG, "Task stk_wm = %u", uxTaskGetStackHighWaterMark(NULL));
 
     if (detached) {
@@ -517,7 +600,8 @@ static int mutexattr_check(const pthread_mutexattr_t *attr)
 {
     if (attr->type != PTHREAD_MUTEX_NORMAL &&
         attr->type != PTHREAD_MUTEX_RECURSIVE &&
-        attr->type != PTHREAD_MUTEX_ERRORCHECK) {
+        attr->type != PTHREAD_MUTEX_ERRORCHECK &&
+        attr->type != PTHREAD_MUTEX_ADAPTIVE_NP) {
         return EINVAL;
     }
     return 0;
@@ -604,6 +688,23 @@ static int pthread_mutex_lock_internal(esp_pthread_mutex_t *mux, TickType_t tmo)
         if (xSemaphoreTakeRecursive(mux->sem, tmo) != pdTRUE) {
             return EBUSY;
         }
+    } else if (mux->type == PTHREAD_MUTEX_ADAPTIVE_NP && tmo != 0) {
+        /* With a single core the holder can't run while this task spins, so each
+           spin yields to it instead. If it has a lower priority it only runs
+           once this task blocks and lends it its priority, block right away. */
+        for (int i = 0; i < CONFIG_PTHREAD_MUTEX_ADAPTIVE_SPINS; i++) {
+            if (xSemaphoreTake(mux->sem, 0) == pdTRUE) {
+                return 0;
+            }
+            TaskHandle_t holder = xSemaphoreGetMutexHolder(mux->sem);
+            if (holder && uxTaskPriorityGet(holder) < uxTaskPriorityGet(NULL)) {
+                break;
+            }
+            taskYIELD();
+        }
+        if (xSemaphoreTake(mux->sem, tmo) != pdTRUE) {
+            return EBUSY;
+        }
     } else {
         if (xSemaphoreTake(mux->sem, tmo) != pdTRUE) {
             return EBUSY;
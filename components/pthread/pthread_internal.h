@@ -13,4 +13,8 @@
 // limitations under the License.
 #pragma once
 
+#include "esp_pthread.h"
+
 void pthread_internal_local_storage_destructor_callback(void);
+
+int esp_pthread_pool_run_thread(esp_pthread_pool_handle_t pool, void (*func)(void *), void *arg, size_t stack_size);
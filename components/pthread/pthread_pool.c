@@ -0,0 +1,215 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This module implements pools of worker tasks, created once and running jobs
+// taken from a bounded queue. The pthreads created with a pool in their
+// esp_pthread_cfg_t run on its workers, see pthread_create().
+
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#include "pthread_internal.h"
+#include "esp_pthread.h"
+
+#define LOG_LOCAL_LEVEL CONFIG_LOG_DEFAULT_LEVEL
+#include "esp_log.h"
+const static char *TAG = "esp_pthread";
+
+/** job queued to the workers, a NULL function stops the worker taking it */
+typedef struct {
+    void (*func)(void *);
+    void *arg;
+} esp_pthread_pool_job_t;
+
+struct esp_pthread_pool {
+    QueueHandle_t       queue;      ///< jobs waiting for a worker
+    SemaphoreHandle_t   stopped;    ///< given by each worker when it stops
+    size_t              workers;    ///< number of workers
+    size_t              stack_size; ///< stack size of the workers in bytes
+    UBaseType_t         prio;       ///< priority of the workers
+    int                 free;       ///< workers waiting for a job minus the jobs queued
+};
+
+static void esp_pthread_pool_worker(void *arg)
+{
+    esp_pthread_pool_handle_t pool = (esp_pthread_pool_handle_t)arg;
+    esp_pthread_pool_job_t job;
+
+    while (1) {
+        portENTER_CRITICAL();
+        pool->free++;
+        portEXIT_CRITICAL();
+
+        if (xQueueReceive(pool->queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (!job.func) {
+            break;
+        }
+
+        job.func(job.arg);
+
+        /* The next job must not see the thread local storage of this one */
+        pthread_internal_local_storage_destructor_callback();
+        if (uxTaskPriorityGet(NULL) != pool->prio) {
+            vTaskPrioritySet(NULL, pool->prio);
+        }
+    }
+
+    ESP_LOGD(TAG, "Worker stk_wm = %u", uxTaskGetStackHighWaterMark(NULL));
+
+    xSemaphoreGive(pool->stopped);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t esp_pthread_pool_send(esp_pthread_pool_handle_t pool, void (*func)(void *), void *arg,
+                                       bool idle_only, TickType_t ticks_to_wait)
+{
+    esp_pthread_pool_job_t job = {
+        .func = func,
+        .arg = arg
+    };
+
+    portENTER_CRITICAL();
+    if (idle_only && pool->free <= 0) {
+        portEXIT_CRITICAL();
+        return ESP_ERR_NOT_FOUND;
+    }
+    pool->free--;
+    portEXIT_CRITICAL();
+
+    if (xQueueSend(pool->queue, &job, ticks_to_wait) != pdTRUE) {
+        portENTER_CRITICAL();
+        pool->free++;
+        portEXIT_CRITICAL();
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return ESP_OK;
+}
+
+esp_pthread_pool_cfg_t esp_pthread_pool_get_default_config(void)
+{
+    esp_pthread_pool_cfg_t cfg = {
+        .workers = 2,
+        .queue_size = 4,
+        .stack_size = CONFIG_PTHREAD_TASK_STACK_SIZE_DEFAULT,
+        .prio = CONFIG_PTHREAD_TASK_PRIO_DEFAULT,
+        .name = NULL
+    };
+
+    return cfg;
+}
+
+esp_err_t esp_pthread_pool_create(const esp_pthread_pool_cfg_t *cfg, esp_pthread_pool_handle_t *pool)
+{
+    esp_pthread_pool_handle_t p;
+
+    if (!cfg || !pool || !cfg->workers || cfg->stack_size < PTHREAD_STACK_MIN ||
+        cfg->prio >= configMAX_PRIORITIES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    p = calloc(1, sizeof(struct esp_pthread_pool));
+    if (!p) {
+        return ESP_ERR_NO_MEM;
+    }
+    p->stack_size = cfg->stack_size;
+    p->prio = cfg->prio;
+
+    /* The stop jobs of all the workers fit in the queue */
+    p->queue = xQueueCreate(cfg->queue_size > cfg->workers ? cfg->queue_size : cfg->workers,
+                            sizeof(esp_pthread_pool_job_t));
+    p->stopped = xSemaphoreCreateCounting(cfg->workers, 0);
+    if (!p->queue || !p->stopped) {
+        goto fail;
+    }
+
+    for (p->workers = 0; p->workers < cfg->workers; p->workers++) {
+        BaseType_t res = xTaskCreate(esp_pthread_pool_worker,
+                                     cfg->name ? cfg->name : CONFIG_PTHREAD_TASK_NAME_DEFAULT,
+                                     (cfg->stack_size + sizeof(StackType_t) - 1) / sizeof(StackType_t),
+                                     p,
+                                     cfg->prio,
+                                     NULL);
+        if (res != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create worker!");
+            goto fail;
+        }
+    }
+
+    *pool = p;
+    return ESP_OK;
+
+fail:
+    if (p->workers) {
+        esp_pthread_pool_delete(p);
+        return ESP_ERR_NO_MEM;
+    }
+    if (p->stopped) {
+        vSemaphoreDelete(p->stopped);
+    }
+    if (p->queue) {
+        vQueueDelete(p->queue);
+    }
+    free(p);
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_pthread_pool_submit(esp_pthread_pool_handle_t pool, void (*func)(void *), void *arg,
+                                  TickType_t ticks_to_wait)
+{
+    if (!pool || !func) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return esp_pthread_pool_send(pool, func, arg, false, ticks_to_wait);
+}
+
+esp_err_t esp_pthread_pool_delete(esp_pthread_pool_handle_t pool)
+{
+    if (!pool) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* The workers stop after the jobs already queued */
+    for (size_t i = 0; i < pool->workers; i++) {
+        esp_pthread_pool_send(pool, NULL, NULL, false, portMAX_DELAY);
+    }
+    for (size_t i = 0; i < pool->workers; i++) {
+        xSemaphoreTake(pool->stopped, portMAX_DELAY);
+    }
+
+    vSemaphoreDelete(pool->stopped);
+    vQueueDelete(pool->queue);
+    free(pool);
+
+    return ESP_OK;
+}
+
+/* Called by pthread_create(), the thread must start at once so it only runs on an idle worker */
+int esp_pthread_pool_run_thread(esp_pthread_pool_handle_t pool, void (*func)(void *), void *arg, size_t stack_size)
+{
+    if (stack_size > pool->stack_size) {
+        return EAGAIN;
+    }
+
+    return esp_pthread_pool_send(pool, func, arg, true, portMAX_DELAY) == ESP_OK ? 0 : EAGAIN;
+}
@@ -0,0 +1,288 @@
+// Copyright 2019-2020 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// This is a simple implementation of pthread reader-writer locks on top of a
+// pthread mutex and two condition variables. Writers are preferred: once a
+// writer waits for the lock, new readers wait until no writer is left, so a
+// steady flow of readers can't starve the writers. As a consequence, a thread
+// taking the read lock again while a writer waits deadlocks.
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define LOG_LOCAL_LEVEL CONFIG_LOG_DEFAULT_LEVEL
+#include "esp_log.h"
+const static char *TAG = "esp_pthread";
+
+typedef struct {
+    pthread_mutex_t     mutex;              ///< protects the fields below
+    pthread_cond_t      readers_cond;       ///< readers wait on it while there are writers
+    pthread_cond_t      writers_cond;       ///< writers wait on it while the lock is held
+    uint32_t            readers;            ///< number of threads holding the read lock
+    uint32_t            waiting_writers;    ///< number of writers waiting for the lock
+    TaskHandle_t        writer;             ///< task holding the write lock, NULL if none
+} esp_pthread_rwlock_t;
+
+int pthread_rwlock_init(pthread_rwlock_t *rwlock, const pthread_rwlockattr_t *attr)
+{
+    (void) attr; /* Unused argument as of now */
+
+    if (rwlock == NULL) {
+        return EINVAL;
+    }
+
+    esp_pthread_rwlock_t *rw = (esp_pthread_rwlock_t *) calloc(1, sizeof(esp_pthread_rwlock_t));
+    if (rw == NULL) {
+        return ENOMEM;
+    }
+
+    if (pthread_mutex_init(&rw->mutex, NULL)) {
+        free(rw);
+        return EAGAIN;
+    }
+    if (pthread_cond_init(&rw->readers_cond, NULL)) {
+        pthread_mutex_destroy(&rw->mutex);
+        free(rw);
+        return EAGAIN;
+    }
+    if (pthread_cond_init(&rw->writers_cond, NULL)) {
+        pthread_cond_destroy(&rw->readers_cond);
+        pthread_mutex_destroy(&rw->mutex);
+        free(rw);
+        return EAGAIN;
+    }
+
+    *rwlock = (pthread_rwlock_t) rw; // pointer value fit into pthread_rwlock_t (uint32_t)
+    return 0;
+}
+
+int pthread_rwlock_destroy(pthread_rwlock_t *rwlock)
+{
+    int ret = 0;
+
+    if (rwlock == NULL) {
+        return EINVAL;
+    }
+    if (*rwlock == PTHREAD_RWLOCK_INITIALIZER) {
+        return 0; /* Never used */
+    }
+
+    esp_pthread_rwlock_t *rw = (esp_pthread_rwlock_t *) *rwlock;
+    if (rw == NULL) {
+        return EINVAL;
+    }
+
+    pthread_mutex_lock(&rw->mutex);
+    if (rw->readers || rw->writer || rw->waiting_writers) {
+        ret = EBUSY;
+    }
+    pthread_mutex_unlock(&rw->mutex);
+
+    if (ret == 0) {
+        *rwlock = (pthread_rwlock_t) 0;
+        pthread_cond_destroy(&rw->writers_cond);
+        pthread_cond_destroy(&rw->readers_cond);
+        pthread_mutex_destroy(&rw->mutex);
+        free(rw);
+    }
+
+    return ret;
+}
+
+static int pthread_rwlock_init_if_static(pthread_rwlock_t *rwlock)
+{
+    int res = 0;
+    if (*rwlock == PTHREAD_RWLOCK_INITIALIZER) {
+        portENTER_CRITICAL();
+        if (*rwlock == PTHREAD_RWLOCK_INITIALIZER) {
+            res = pthread_rwlock_init(rwlock, NULL);
+        }
+        portEXIT_CRITICAL();
+    }
+    return res;
+}
+
+static int pthread_rwlock_get(pthread_rwlock_t *rwlock, esp_pthread_rwlock_t **rw)
+{
+    if (rwlock == NULL) {
+        return EINVAL;
+    }
+    int res = pthread_rwlock_init_if_static(rwlock);
+    if (res != 0) {
+        return res;
+    }
+    *rw = (esp_pthread_rwlock_t *) *rwlock;
+    if (*rw == NULL) {
+        return EINVAL;
+    }
+    return 0;
+}
+
+/* "to" is NULL to wait forever, the current time to not wait at all */
+static int pthread_rwlock_rdlock_internal(pthread_rwlock_t *rwlock, const struct timespec *to, bool try)
+{
+    esp_pthread_rwlock_t *rw;
+    int res = pthread_rwlock_get(rwlock, &rw);
+    if (res != 0) {
+        return res;
+    }
+
+    pthread_mutex_lock(&rw->mutex);
+    if (rw->writer == xTaskGetCurrentTaskHandle()) {
+        res = EDEADLK;
+    }
+    while (!res && (rw->writer || rw->waiting_writers)) {
+        if (try) {
+            res = EBUSY;
+        } else {
+            res = pthread_cond_timedwait(&rw->readers_cond, &rw->mutex, to);
+        }
+    }
+    if (!res) {
+        rw->readers++;
+    }
+    pthread_mutex_unlock(&rw->mutex);
+
+    return res;
+}
+
+static int pthread_rwlock_wrlock_internal(pthread_rwlock_t *rwlock, const struct timespec *to, bool try)
+{
+    esp_pthread_rwlock_t *rw;
+    int res = pthread_rwlock_get(rwlock, &rw);
+    if (res != 0) {
+        return res;
+    }
+
+    pthread_mutex_lock(&rw->mutex);
+    if (rw->writer == xTaskGetCurrentTaskHandle()) {
+        res = EDEADLK;
+    } else if (try) {
+        if (rw->writer || rw->readers) {
+            res = EBUSY;
+        }
+    } else {
+        rw->waiting_writers++;
+        while (!res && (rw->writer || rw->readers)) {
+            res = pthread_cond_timedwait(&rw->writers_cond, &rw->mutex, to);
+        }
+        rw->waiting_writers--;
+        if (res && !rw->writer) {
+            if (!rw->waiting_writers) {
+                /* Readers held back by this writer can go */
+                pthread_cond_broadcast(&rw->readers_cond);
+            } else if (!rw->readers) {
+                /* This writer may have been signaled as it timed out, pass it on */
+                pthread_cond_signal(&rw->writers_cond);
+            }
+        }
+    }
+    if (!res) {
+        rw->writer = xTaskGetCurrentTaskHandle();
+    }
+    pthread_mutex_unlock(&rw->mutex);
+
+    return res;
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t *rwlock)
+{
+    return pthread_rwlock_rdlock_internal(rwlock, NULL, false);
+}
+
+int pthread_rwlock_timedrdlock(pthread_rwlock_t *rwlock, const struct timespec *abstime)
+{
+    if (abstime == NULL) {
+        return EINVAL;
+    }
+    return pthread_rwlock_rdlock_internal(rwlock, abstime, false);
+}
+
+int pthread_rwlock_tryrdlock(pthread_rwlock_t *rwlock)
+{
+    return pthread_rwlock_rdlock_internal(rwlock, NULL, true);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t *rwlock)
+{
+    return pthread_rwlock_wrlock_internal(rwlock, NULL, false);
+}
+
+int pthread_rwlock_timedwrlock(pthread_rwlock_t *rwlock, const struct timespec *abstime)
+{
+    if (abstime == NULL) {
+        return EINVAL;
+    }
+    return pthread_rwlock_wrlock_internal(rwlock, abstime, false);
+}
+
+int pthread_rwlock_trywrlock(pthread_rwlock_t *rwlock)
+{
+    return pthread_rwlock_wrlock_internal(rwlock, NULL, true);
+}
+
+int pthread_rwlock_unlock(pthread_rwlock_t *rwlock)
+{
+    esp_pthread_rwlock_t *rw;
+    int res = pthread_rwlock_get(rwlock, &rw);
+    if (res != 0) {
+        return res;
+    }
+
+    pthread_mutex_lock(&rw->mutex);
+    if (rw->writer) {
+        if (rw->writer != xTaskGetCurrentTaskHandle()) {
+            res = EPERM;
+        } else {
+            rw->writer = NULL;
+            if (rw->waiting_writers) {
+                pthread_cond_signal(&rw->writers_cond);
+            } else {
+                pthread_cond_broadcast(&rw->readers_cond);
+            }
+        }
+    } else if (rw->readers) {
+        rw->readers--;
+        if (!rw->readers && rw->waiting_writers) {
+            pthread_cond_signal(&rw->writers_cond);
+        }
+    } else {
+        res = EPERM;
+    }
+    pthread_mutex_unlock(&rw->mutex);
+
+    return res;
+}
+
+int pthread_rwlockattr_init(pthread_rwlockattr_t *attr)
+{
+    ESP_LOGV(TAG, "%s not yet implemented (%p)", __FUNCTION__, attr);
+    return ENOSYS;
+}
+
+int pthread_rwlockattr_destroy(pthread_rwlockattr_t *attr)
+{
+    ESP_LOGV(TAG, "%s not yet implemented (%p)", __FUNCTION__, attr);
+    return ENOSYS;
+}
+
+/* Hook function to force linking this file */
+void pthread_include_pthread_rwlock_impl(void)
+{
+}
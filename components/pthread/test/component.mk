@@ -6,4 +6,7 @@ COMPONENT_SRCDIRS := .
 
 #CXXFLAGS += -H
 
+# std::shared_timed_mutex is C++14
+test_cxx_shared_mutex.o: CXXFLAGS += -std=gnu++14
+
 COMPONENT_ADD_LDFLAGS = -Wl,--whole-archive -l$(COMPONENT_NAME) -Wl,--no-whole-archive
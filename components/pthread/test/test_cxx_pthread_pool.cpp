@@ -0,0 +1,88 @@
+#include <iostream>
+#include <future>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_pthread.h"
+#include "unity.h"
+
+#if __GTHREADS && __GTHREADS_CXX0X
+
+static const char *worker_name = "pool_worker";
+
+static bool on_worker()
+{
+    return strcmp(pcTaskGetTaskName(NULL), worker_name) == 0;
+}
+
+static void counter_job(void *arg)
+{
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+TEST_CASE("pthread pool runs std::async and jobs", "[pthread]")
+{
+    esp_pthread_pool_cfg_t pool_cfg = esp_pthread_pool_get_default_config();
+    esp_pthread_pool_handle_t pool;
+
+    pool_cfg.workers = 2;
+    pool_cfg.name = worker_name;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_pthread_pool_create(&pool_cfg, &pool));
+
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.pool = pool;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_pthread_set_cfg(&cfg));
+
+    /* Give the workers the time to wait for a job */
+    vTaskDelay(2);
+
+    /* The same workers run the threads one after the other */
+    for (int i = 0; i < 10; i++) {
+        std::future<int> f = std::async(std::launch::async, [i] {
+            TEST_ASSERT_TRUE(on_worker());
+            return i * 2;
+        });
+        TEST_ASSERT_EQUAL(i * 2, f.get());
+    }
+
+    /* A detached thread releases its worker */
+    std::thread([] {
+        TEST_ASSERT_TRUE(on_worker());
+    }).detach();
+    vTaskDelay(2);
+
+    /* With more threads than workers, the others get their own task */
+    std::vector<std::future<bool>> futures;
+    for (int i = 0; i < 4; i++) {
+        futures.push_back(std::async(std::launch::async, [] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return on_worker();
+        }));
+    }
+    int pooled = 0;
+    for (auto &f : futures) {
+        pooled += f.get();
+    }
+    std::cout << "Threads run on the pool: " << pooled << " of " << futures.size() << std::endl;
+    TEST_ASSERT_EQUAL(2, pooled);
+
+    cfg.pool = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_pthread_set_cfg(&cfg));
+
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(8, 0);
+    TEST_ASSERT_NOT_NULL(done);
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_pthread_pool_submit(pool, counter_job, done, portMAX_DELAY));
+    }
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(done, 1000 / portTICK_PERIOD_MS));
+    }
+    vSemaphoreDelete(done);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_pthread_pool_delete(pool));
+}
+
+#endif
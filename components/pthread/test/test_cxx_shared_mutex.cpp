@@ -0,0 +1,170 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <vector>
+#include <pthread.h>
+#include <errno.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+
+#if __GTHREADS && __GTHREADS_CXX0X
+
+static std::shared_timed_mutex  shared_mtx;
+static std::atomic<int>         readers;
+static std::atomic<int>         max_readers;
+static std::atomic<int>         writers;
+static int                      shared_value;
+
+static void reader_main()
+{
+    for (int i = 0; i < 10; i++) {
+        std::shared_lock<std::shared_timed_mutex> lock(shared_mtx);
+
+        int now = ++readers;
+        if (now > max_readers) {
+            max_readers = now;
+        }
+        TEST_ASSERT_EQUAL(0, writers);
+        int value = shared_value;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        TEST_ASSERT_EQUAL(value, shared_value);
+        readers--;
+    }
+}
+
+static void writer_main()
+{
+    for (int i = 0; i < 10; i++) {
+        std::unique_lock<std::shared_timed_mutex> lock(shared_mtx);
+
+        TEST_ASSERT_EQUAL(0, readers);
+        TEST_ASSERT_EQUAL(1, ++writers);
+        int value = shared_value;
+        std::this_thread::yield();
+        shared_value = value + 1;
+        writers--;
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+TEST_CASE("C++ shared_timed_mutex readers and writers", "[std::shared_timed_mutex]")
+{
+    std::vector<std::thread> threads;
+
+    readers = 0;
+    max_readers = 0;
+    writers = 0;
+    shared_value = 0;
+
+    for (int i = 0; i < 3; i++) {
+        threads.push_back(std::thread(reader_main));
+    }
+    for (int i = 0; i < 2; i++) {
+        threads.push_back(std::thread(writer_main));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    std::cout << "Readers at the same time: " << max_readers << std::endl;
+    TEST_ASSERT_GREATER_THAN(1, max_readers);
+    TEST_ASSERT_EQUAL(20, shared_value);
+
+    TEST_ASSERT_TRUE(shared_mtx.try_lock_for(std::chrono::milliseconds(10)));
+    TEST_ASSERT_FALSE(shared_mtx.try_lock_shared());
+    shared_mtx.unlock();
+}
+
+static pthread_rwlock_t static_rwlock = PTHREAD_RWLOCK_INITIALIZER;
+
+TEST_CASE("pthread rwlock prefers writers", "[pthread]")
+{
+    std::atomic<bool> written(false);
+
+    TEST_ASSERT_EQUAL(0, pthread_rwlock_rdlock(&static_rwlock));
+    TEST_ASSERT_EQUAL(0, pthread_rwlock_tryrdlock(&static_rwlock));
+    TEST_ASSERT_EQUAL(EBUSY, pthread_rwlock_trywrlock(&static_rwlock));
+
+    std::thread writer([&written]() {
+        TEST_ASSERT_EQUAL(0, pthread_rwlock_wrlock(&static_rwlock));
+        written = true;
+        TEST_ASSERT_EQUAL(EDEADLK, pthread_rwlock_wrlock(&static_rwlock));
+        TEST_ASSERT_EQUAL(0, pthread_rwlock_unlock(&static_rwlock));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    /* New readers wait while a writer waits */
+    std::thread reader([]() {
+        TEST_ASSERT_EQUAL(EBUSY, pthread_rwlock_tryrdlock(&static_rwlock));
+
+        struct timespec to;
+        clock_gettime(CLOCK_REALTIME, &to);
+        to.tv_nsec += 20 * 1000000;
+        if (to.tv_nsec >= 1000000000) {
+            to.tv_sec++;
+            to.tv_nsec -= 1000000000;
+        }
+        TEST_ASSERT_EQUAL(ETIMEDOUT, pthread_rwlock_timedrdlock(&static_rwlock, &to));
+    });
+    reader.join();
+    TEST_ASSERT_FALSE(written);
+
+    TEST_ASSERT_EQUAL(0, pthread_rwlock_unlock(&static_rwlock));
+    TEST_ASSERT_FALSE(written);
+    TEST_ASSERT_EQUAL(0, pthread_rwlock_unlock(&static_rwlock));
+    writer.join();
+    TEST_ASSERT_TRUE(written);
+
+    TEST_ASSERT_EQUAL(EPERM, pthread_rwlock_unlock(&static_rwlock));
+    TEST_ASSERT_EQUAL(0, pthread_rwlock_destroy(&static_rwlock));
+}
+
+static pthread_mutex_t  adaptive_mtx;
+static int              adaptive_count;
+
+static void adaptive_main()
+{
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_EQUAL(0, pthread_mutex_lock(&adaptive_mtx));
+        int count = adaptive_count;
+        std::this_thread::yield();
+        adaptive_count = count + 1;
+        TEST_ASSERT_EQUAL(0, pthread_mutex_unlock(&adaptive_mtx));
+        if (i % 10 == 0) {
+            vTaskDelay(1);
+        }
+    }
+}
+
+TEST_CASE("pthread adaptive mutex", "[pthread]")
+{
+    pthread_mutexattr_t attr;
+    std::vector<std::thread> threads;
+
+    TEST_ASSERT_EQUAL(0, pthread_mutexattr_init(&attr));
+    TEST_ASSERT_EQUAL(0, pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ADAPTIVE_NP));
+    TEST_ASSERT_EQUAL(0, pthread_mutex_init(&adaptive_mtx, &attr));
+    TEST_ASSERT_EQUAL(0, pthread_mutexattr_destroy(&attr));
+
+    adaptive_count = 0;
+    for (int i = 0; i < 3; i++) {
+        threads.push_back(std::thread(adaptive_main));
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    TEST_ASSERT_EQUAL(300, adaptive_count);
+
+    TEST_ASSERT_EQUAL(0, pthread_mutex_trylock(&adaptive_mtx));
+    std::thread([]() {
+        TEST_ASSERT_EQUAL(EBUSY, pthread_mutex_trylock(&adaptive_mtx));
+    }).join();
+    TEST_ASSERT_EQUAL(0, pthread_mutex_unlock(&adaptive_mtx));
+    TEST_ASSERT_EQUAL(0, pthread_mutex_destroy(&adaptive_mtx));
+}
+
+#endif
@@ -288,6 +288,30 @@ esp_err_t esp_transport_set_func(esp_transport_handle_t t,
  */
 esp_err_t esp_transport_set_async_connect_func(esp_transport_handle_t t, connect_async_func _connect_async_func);
 
+/**
+ * @brief      Set the function returning the socket of the transport
+ *
+ * @param[in]  t            The transport handle
+ * @param[in]  _get_socket  The get socket function pointer
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL
+ */
+esp_err_t esp_transport_set_get_socket_func(esp_transport_handle_t t, trans_func _get_socket);
+
+/**
+ * @brief      Get the socket of a connected transport, e.g. to wait for several
+ *             transports at once with select()
+ *
+ * @param[in]  t     The transport handle
+ *
+ * @return
+ *     - The socket file descriptor
+ *     - (-1) if the transport is not connected or does not expose its socket
+ */
+int esp_transport_get_socket(esp_transport_handle_t t);
+
 /**
  * @brief      Set parent transport function to the handle
  *
@@ -132,6 +132,30 @@ void esp_transport_ssl_set_alpn_protocol(esp_transport_handle_t t, const char **
  */
 void esp_transport_ssl_skip_common_name_check(esp_transport_handle_t t);
 
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+/**
+ * @brief      Set the client session to be resumed by the next connection
+ *
+ * @note       The session is only referenced, it must stay valid until the
+ *             connection is established. Pass NULL to disable resumption.
+ *
+ * @param      t               ssl transport
+ * @param[in]  client_session  Session obtained from esp_transport_ssl_get_client_session()
+ */
+void esp_transport_ssl_set_client_session(esp_transport_handle_t t, esp_tls_client_session_t *client_session);
+
+/**
+ * @brief      Get a copy of the session of the established connection
+ *
+ * @param      t     ssl transport
+ *
+ * @return
+ *      - Pointer to the session, must be freed with esp_tls_free_client_session()
+ *      - NULL if the transport is not connected or on failure
+ */
+esp_tls_client_session_t *esp_transport_ssl_get_client_session(esp_transport_handle_t t);
+#endif
+
 /**
  * @brief      Set PSK key and hint for PSK server/client verification in esp-tls component.
  *             Important notes:
@@ -1,5 +1,10 @@
 #include "unity.h"
+#include "test_utils.h"
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "esp_task.h"
 #include "esp_transport.h"
 #include "esp_transport_tcp.h"
 #include "esp_transport_ssl.h"
@@ -26,3 +31,89 @@ TEST_CASE("tcp_transport: using ws transport separately", "[tcp_transport][leaks
     TEST_ASSERT_EQUAL(ESP_OK, esp_transport_destroy(ws));
     TEST_ASSERT_EQUAL(ESP_OK, esp_transport_destroy(tcp));
 }
+
+#define TEST_PORT           8071
+
+static int test_listen(int port)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+
+    test_case_uses_tcpip();
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQUAL(0, bind(fd, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, listen(fd, 1));
+    return fd;
+}
+
+/* Drive the non-blocking connect until it is done, the result is 1 or -1 */
+static int test_connect_async(esp_transport_handle_t tcp, int port)
+{
+    int ret;
+    for (int i = 0; i < 100; i++) {
+        ret = esp_transport_connect_async(tcp, "127.0.0.1", port, 0);
+        if (ret != 0) {
+            return ret;
+        }
+        vTaskDelay(1);
+    }
+    return ret;
+}
+
+TEST_CASE("tcp_transport: non-blocking connect in progress, then connected", "[tcp_transport]")
+{
+    const UBaseType_t prio = uxTaskPriorityGet(NULL);
+    int listen_fd = test_listen(TEST_PORT);
+    esp_transport_handle_t tcp = esp_transport_tcp_init();
+    TEST_ASSERT_NOT_NULL(tcp);
+    TEST_ASSERT_EQUAL(-1, esp_transport_get_socket(tcp));
+
+    /* The handshake needs the tcpip task, which can't run before this task waits */
+    vTaskPrioritySet(NULL, ESP_TASK_TCPIP_PRIO + 1);
+    int ret = esp_transport_connect_async(tcp, "127.0.0.1", TEST_PORT, 0);
+    vTaskPrioritySet(NULL, prio);
+    TEST_ASSERT_EQUAL(0, ret);
+    TEST_ASSERT(esp_transport_get_socket(tcp) >= 0);
+
+    TEST_ASSERT_EQUAL(1, test_connect_async(tcp, TEST_PORT));
+    /* Once connected, it stays so */
+    TEST_ASSERT_EQUAL(1, esp_transport_connect_async(tcp, "127.0.0.1", TEST_PORT, 0));
+
+    int fd = accept(listen_fd, NULL, NULL);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQUAL(4, esp_transport_write(tcp, "ping", 4, 100));
+    char buf[4];
+    TEST_ASSERT_EQUAL(4, recv(fd, buf, sizeof(buf), 0));
+    TEST_ASSERT_EQUAL_MEMORY("ping", buf, 4);
+
+    close(fd);
+    TEST_ASSERT_EQUAL(0, esp_transport_close(tcp));
+    TEST_ASSERT_EQUAL(-1, esp_transport_get_socket(tcp));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_transport_destroy(tcp));
+    close(listen_fd);
+}
+
+TEST_CASE("tcp_transport: non-blocking connect refused", "[tcp_transport]")
+{
+    esp_transport_handle_t tcp = esp_transport_tcp_init();
+    TEST_ASSERT_NOT_NULL(tcp);
+
+    test_case_uses_tcpip();
+
+    /* Nothing listens on the port, the server resets the connection */
+    TEST_ASSERT_EQUAL(-1, test_connect_async(tcp, TEST_PORT + 1));
+    TEST_ASSERT_EQUAL(-1, esp_transport_get_socket(tcp));
+
+    /* A later attempt starts over */
+    int listen_fd = test_listen(TEST_PORT + 1);
+    TEST_ASSERT_EQUAL(1, test_connect_async(tcp, TEST_PORT + 1));
+
+    TEST_ASSERT_EQUAL(0, esp_transport_close(tcp));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_transport_destroy(tcp));
+    close(listen_fd);
+}
@@ -42,6 +42,7 @@ struct esp_transport_item_t {
     poll_func       _poll_write;    /*!< Poll and write */
     trans_func      _destroy;       /*!< Destroy and free transport */
     connect_async_func _connect_async;      /*!< non-blocking connect function of this transport */
+    trans_func      _get_socket;    /*!< Function returning the underlying socket */
     payload_transfer_func  _parent_transfer;        /*!< Function returning underlying transport layer */
     esp_tls_error_handle_t     error_handle;            /*!< Pointer to esp-tls error handle */
 
@@ -283,6 +284,30 @@ esp_err_t esp_transport_set_async_connect_func(esp_transport_handle_t t, connect
     return ESP_OK;
 }
 
+esp_err_t esp_transport_set_get_socket_func(esp_transport_handle_t t, trans_func _get_socket)
+{
+    if (t == NULL) {
+        return ESP_FAIL;
+    }
+    t->_get_socket = _get_socket;
+    return ESP_OK;
+}
+
+int esp_transport_get_socket(esp_transport_handle_t t)
+{
+    if (t && t->_get_socket) {
+        return t->_get_socket(t);
+    }
+    if (t && t->_parent_transfer) {
+        /* Layered transports (e.g. websocket) share the socket of the one below */
+        esp_transport_handle_t parent = t->_parent_transfer(t);
+        if (parent != t) {
+            return esp_transport_get_socket(parent);
+        }
+    }
+    return -1;
+}
+
 esp_err_t esp_transport_set_parent_transport_func(esp_transport_handle_t t, payload_transfer_func _parent_transport)
 {
     if (t == NULL) {
@@ -133,7 +133,12 @@ static int ssl_write(esp_transport_handle_t t, const char *buffer, int len, int
     transport_ssl_t *ssl = esp_transport_get_context_data(t);
 
     if ((poll = esp_transport_poll_write(t, timeout_ms)) <= 0) {
-        ESP_LOGW(TAG, "Poll timeout or error, errno=%s, fd=%d, timeout_ms=%d", strerror(errno), ssl->tls->sockfd, timeout_ms);
+        if (poll == 0 && timeout_ms == 0) {
+            /* Non-blocking caller, the socket buffer is full: expected, it retries later */
+            ESP_LOGD(TAG, "Not writable yet, fd=%d", ssl->tls->sockfd);
+        } else {
+            ESP_LOGW(TAG, "Poll timeout or error, errno=%s, fd=%d, timeout_ms=%d", strerror(errno), ssl->tls->sockfd, timeout_ms);
+        }
         return poll;
     }
     ret = esp_tls_conn_write(ssl->tls, (const unsigned char *) buffer, len);
@@ -155,6 +160,10 @@ static int ssl_read(esp_transport_handle_t t, char *buffer, int len, int timeout
         }
     }
     ret = esp_tls_conn_read(ssl->tls, (unsigned char *)buffer, len);
+    if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
+        /* Non-blocking connection, the rest of the record has not arrived yet */
+        return 0;
+    }
     if (ret < 0) {
         ESP_LOGE(TAG, "esp_tls_conn_read error, errno=%s", strerror(errno));
         esp_transport_set_errors(t, ssl->tls->error_handle);
@@ -173,9 +182,20 @@ static int ssl_close(esp_transport_handle_t t)
         esp_tls_conn_delete(ssl->tls);
         ssl->ssl_initialized = false;
     }
+    ssl->tls = NULL;
+    ssl->conn_state = TRANS_SSL_INIT;
     return ret;
 }
 
+static int ssl_get_socket(esp_transport_handle_t t)
+{
+    transport_ssl_t *ssl = esp_transport_get_context_data(t);
+    if (ssl->ssl_initialized && ssl->tls) {
+        return ssl->tls->sockfd;
+    }
+    return -1;
+}
+
 static int ssl_destroy(esp_transport_handle_t t)
 {
     transport_ssl_t *ssl = esp_transport_get_context_data(t);
@@ -279,6 +299,25 @@ void esp_transport_ssl_skip_common_name_check(esp_transport_handle_t t)
     }
 }
 
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+void esp_transport_ssl_set_client_session(esp_transport_handle_t t, esp_tls_client_session_t *client_session)
+{
+    transport_ssl_t *ssl = esp_transport_get_context_data(t);
+    if (t && ssl) {
+        ssl->cfg.client_session = client_session;
+    }
+}
+
+esp_tls_client_session_t *esp_transport_ssl_get_client_session(esp_transport_handle_t t)
+{
+    transport_ssl_t *ssl = esp_transport_get_context_data(t);
+    if (t && ssl && ssl->ssl_initialized && ssl->tls) {
+        return esp_tls_get_client_session(ssl->tls);
+    }
+    return NULL;
+}
+#endif
+
 esp_transport_handle_t esp_transport_ssl_init(void)
 {
     esp_transport_handle_t t = esp_transport_init();
@@ -287,6 +326,7 @@ esp_transport_handle_t esp_transport_ssl_init(void)
     esp_transport_set_context_data(t, ssl);
     esp_transport_set_func(t, ssl_connect, ssl_read, ssl_write, ssl_close, ssl_poll_read, ssl_poll_write, ssl_destroy);
     esp_transport_set_async_connect_func(t, ssl_connect_async);
+    esp_transport_set_get_socket_func(t, ssl_get_socket);
     return t;
 }
 
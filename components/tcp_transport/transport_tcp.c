@@ -14,6 +14,8 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <errno.h>
 
 #include "lwip/sockets.h"
 #include "lwip/dns.h"
@@ -28,8 +30,15 @@
 
 static const char *TAG = "TRANS_TCP";
 
+typedef enum {
+    TRANS_TCP_INIT = 0,
+    TRANS_TCP_CONNECTING,
+    TRANS_TCP_CONNECTED,
+} transport_tcp_conn_state_t;
+
 typedef struct {
     int sock;
+    transport_tcp_conn_state_t conn_state;
 } transport_tcp_t;
 
 static int resolve_dns(const char *host, struct sockaddr_in *ip) {
@@ -89,6 +98,73 @@ static int tcp_connect(esp_transport_handle_t t, const char *host, int port, int
     return tcp->sock;
 }
 
+static int tcp_connect_async(esp_transport_handle_t t, const char *host, int port, int timeout_ms)
+{
+    struct sockaddr_in remote_ip;
+    struct timeval tv = { 0 };
+    transport_tcp_t *tcp = esp_transport_get_context_data(t);
+
+    if (tcp->conn_state == TRANS_TCP_INIT) {
+        bzero(&remote_ip, sizeof(struct sockaddr_in));
+
+        // Name resolution is still blocking
+        if (inet_pton(AF_INET, host, &remote_ip.sin_addr) != 1) {
+            if (resolve_dns(host, &remote_ip) < 0) {
+                return -1;
+            }
+        }
+
+        tcp->sock = socket(PF_INET, SOCK_STREAM, 0);
+        if (tcp->sock < 0) {
+            ESP_LOGE(TAG, "Error create socket");
+            return -1;
+        }
+        fcntl(tcp->sock, F_SETFL, fcntl(tcp->sock, F_GETFL, 0) | O_NONBLOCK);
+
+        remote_ip.sin_family = AF_INET;
+        remote_ip.sin_port = htons(port);
+
+        ESP_LOGD(TAG, "[sock=%d],connecting to server IP:%s,Port:%d...",
+                 tcp->sock, ipaddr_ntoa((const ip_addr_t*)&remote_ip.sin_addr.s_addr), port);
+        if (connect(tcp->sock, (struct sockaddr *)(&remote_ip), sizeof(struct sockaddr)) != 0 && errno != EINPROGRESS) {
+            ESP_LOGE(TAG, "connect() failed, errno=%d", errno);
+            goto error;
+        }
+        tcp->conn_state = TRANS_TCP_CONNECTING;
+    }
+    if (tcp->conn_state == TRANS_TCP_CONNECTING) {
+        fd_set writeset;
+        FD_ZERO(&writeset);
+        FD_SET(tcp->sock, &writeset);
+        // The connection is established once the socket becomes writable
+        int ret = select(tcp->sock + 1, NULL, &writeset, NULL, esp_transport_utils_ms_to_timeval(timeout_ms, &tv));
+        if (ret < 0) {
+            goto error;
+        } else if (ret == 0) {
+            return 0;
+        }
+        int sock_errno = 0;
+        uint32_t optlen = sizeof(sock_errno);
+        if (getsockopt(tcp->sock, SOL_SOCKET, SO_ERROR, &sock_errno, &optlen) < 0 || sock_errno != 0) {
+            ESP_LOGE(TAG, "Non blocking connect failed, errno=%d", sock_errno);
+            goto error;
+        }
+        tcp->conn_state = TRANS_TCP_CONNECTED;
+    }
+    return 1;
+error:
+    close(tcp->sock);
+    tcp->sock = -1;
+    tcp->conn_state = TRANS_TCP_INIT;
+    return -1;
+}
+
+static int tcp_get_socket(esp_transport_handle_t t)
+{
+    transport_tcp_t *tcp = esp_transport_get_context_data(t);
+    return tcp->sock;
+}
+
 static int tcp_write(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms)
 {
     int poll;
@@ -167,6 +243,7 @@ static int tcp_close(esp_transport_handle_t t)
         ret = close(tcp->sock);
         tcp->sock = -1;
     }
+    tcp->conn_state = TRANS_TCP_INIT;
     return ret;
 }
 
@@ -185,6 +262,8 @@ esp_transport_handle_t esp_transport_tcp_init(void)
     ESP_TRANSPORT_MEM_CHECK(TAG, tcp, return NULL);
     tcp->sock = -1;
     esp_transport_set_func(t, tcp_connect, tcp_read, tcp_write, tcp_close, tcp_poll_read, tcp_poll_write, tcp_destroy);
+    esp_transport_set_async_connect_func(t, tcp_connect_async);
+    esp_transport_set_get_socket_func(t, tcp_get_socket);
     esp_transport_set_context_data(t, tcp);
 
     return t;
@@ -537,6 +537,60 @@ static void https_async(void)
     esp_http_client_cleanup(client);
 }
 
+static esp_err_t _http_multi_event_handler(esp_http_client_event_t *evt)
+{
+    switch(evt->event_id) {
+        case HTTP_EVENT_ERROR:
+            ESP_LOGE(TAG, "Request %d failed", (int)evt->user_data);
+            break;
+        case HTTP_EVENT_ON_FINISH:
+            ESP_LOGI(TAG, "Request %d finished, status = %d", (int)evt->user_data,
+                    esp_http_client_get_status_code(evt->client));
+            break;
+        default:
+            break;
+    }
+    return ESP_OK;
+}
+
+/*
+ *  http_async_multi() runs several requests at the same time from this single task,
+ *  the responses are handled in the event handler.
+ */
+static void http_async_multi(void)
+{
+    const char *urls[] = {
+        "http://httpbin.org/get",
+        "http://httpbin.org/delay/1",
+        "https://postman-echo.com/get",
+    };
+    esp_http_client_handle_t clients[sizeof(urls) / sizeof(urls[0])];
+    esp_http_client_multi_handle_t multi = esp_http_client_multi_init();
+    int running = 0;
+
+    for (int i = 0; i < sizeof(urls) / sizeof(urls[0]); i++) {
+        esp_http_client_config_t config = {
+            .url = urls[i],
+            .event_handler = _http_multi_event_handler,
+            .user_data = (void *)i,
+            .is_async = true,
+            .timeout_ms = 5000,
+        };
+        clients[i] = esp_http_client_init(&config);
+        esp_http_client_multi_add(multi, clients[i]);
+    }
+    do {
+        if (esp_http_client_multi_perform(multi, 1000, &running) != ESP_OK) {
+            break;
+        }
+    } while (running > 0);
+
+    for (int i = 0; i < sizeof(urls) / sizeof(urls[0]); i++) {
+        esp_http_client_cleanup(clients[i]);
+    }
+    esp_http_client_multi_cleanup(multi);
+}
+
 static void https_with_invalid_url(void)
 {
     esp_http_client_config_t config = {
@@ -637,6 +691,7 @@ static void http_test_task(void *pvParameters)
     http_download_chunk();
     http_perform_as_stream_reader();
     https_async();
+    http_async_multi();
     https_with_invalid_url();
     http_native_request();
 
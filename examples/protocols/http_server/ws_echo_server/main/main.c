@@ -0,0 +1,159 @@
+/* WebSocket Echo Server Example
+
+   This example code is in the Public Domain (or CC0 licensed, at your option.)
+
+   Unless required by applicable law or agreed to in writing, this
+   software is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+   CONDITIONS OF ANY KIND, either express or implied.
+*/
+
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_event.h"
+#include "protocol_examples_common.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include <esp_http_server.h>
+
+static const char *TAG = "ws_echo_server";
+
+static TaskHandle_t broadcast_task = NULL;
+
+/* Pushes a counter to every WebSocket client. This runs outside of the
+ * server task, so frames are handed over with httpd_ws_queue_frame() */
+static void broadcast_counter(void *arg)
+{
+    httpd_handle_t server = (httpd_handle_t) arg;
+    unsigned counter = 0;
+    char buf[24];
+
+    while (1) {
+        httpd_ws_frame_t ws_pkt = {
+            .type    = HTTPD_WS_TYPE_TEXT,
+            .payload = (uint8_t *)buf,
+            .len     = snprintf(buf, sizeof(buf), "tick %u", counter++),
+        };
+        if (httpd_ws_queue_frame(server, HTTPD_WS_ALL_CLIENTS, &ws_pkt) != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to queue broadcast");
+        }
+        vTaskDelay(100 / portTICK_PERIOD_MS);
+    }
+}
+
+/* This handler echoes back the received WebSocket text frames */
+static esp_err_t echo_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) {
+        ESP_LOGI(TAG, "Handshake done, the new connection was opened");
+        return ESP_OK;
+    }
+
+    uint8_t buf[128] = { 0 };
+    httpd_ws_frame_t ws_pkt = {
+        .payload = buf,
+    };
+
+    /* Fetch the frame length first */
+    esp_err_t ret = httpd_ws_recv_frame(req, &ws_pkt, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "httpd_ws_recv_frame failed to get frame len with %d", ret);
+        return ret;
+    }
+    if (ws_pkt.len >= sizeof(buf)) {
+        ESP_LOGW(TAG, "Frame of %d bytes is too long, ignoring", ws_pkt.len);
+        return ESP_OK;
+    }
+
+    ret = httpd_ws_recv_frame(req, &ws_pkt, sizeof(buf) - 1);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "httpd_ws_recv_frame failed with %d", ret);
+        return ret;
+    }
+    ESP_LOGI(TAG, "Got packet with message: %s", ws_pkt.payload);
+
+    if (ws_pkt.type == HTTPD_WS_TYPE_TEXT &&
+        strcmp((char *)ws_pkt.payload, "Trigger broadcast") == 0 &&
+        broadcast_task == NULL) {
+        xTaskCreate(broadcast_counter, "ws_broadcast", 2048, req->handle, 5, &broadcast_task);
+    }
+
+    return httpd_ws_send_frame(req, &ws_pkt);
+}
+
+static const httpd_uri_t ws = {
+    .uri        = "/ws",
+    .method     = HTTP_GET,
+    .handler    = echo_handler,
+    .user_ctx   = NULL,
+    .is_websocket = true
+};
+
+static httpd_handle_t start_webserver(void)
+{
+    httpd_handle_t server = NULL;
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+
+    // Start the httpd server
+    ESP_LOGI(TAG, "Starting server on port: '%d'", config.server_port);
+    if (httpd_start(&server, &config) == ESP_OK) {
+        // Registering the ws handler
+        ESP_LOGI(TAG, "Registering URI handlers");
+        httpd_register_uri_handler(server, &ws);
+        return server;
+    }
+
+    ESP_LOGI(TAG, "Error starting server!");
+    return NULL;
+}
+
+static void stop_webserver(httpd_handle_t server)
+{
+    if (broadcast_task) {
+        vTaskDelete(broadcast_task);
+        broadcast_task = NULL;
+    }
+    // Stop the httpd server
+    httpd_stop(server);
+}
+
+static httpd_handle_t server = NULL;
+
+static void disconnect_handler(void* arg, esp_event_base_t event_base,
+                               int32_t event_id, void* event_data)
+{
+    httpd_handle_t* server = (httpd_handle_t*) arg;
+    if (*server) {
+        ESP_LOGI(TAG, "Stopping webserver");
+        stop_webserver(*server);
+        *server = NULL;
+    }
+}
+
+static void connect_handler(void* arg, esp_event_base_t event_base,
+                            int32_t event_id, void* event_data)
+{
+    httpd_handle_t* server = (httpd_handle_t*) arg;
+    if (*server == NULL) {
+        ESP_LOGI(TAG, "Starting webserver");
+        *server = start_webserver();
+    }
+}
+
+void app_main()
+{
+    ESP_ERROR_CHECK(nvs_flash_init());
+    ESP_ERROR_CHECK(esp_netif_init());
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+
+    ESP_ERROR_CHECK(example_connect());
+
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &connect_handler, &server));
+    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &disconnect_handler, &server));
+
+    server = start_webserver();
+}
@@ -21,6 +21,10 @@
 #include "freertos/task.h"
 #include "driver/uart.h"
 #include "rom/uart.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_profile.h"
+#include "esp_task_stats.h"
+#include "esp_critical_trace.h"
 #include "cmd_system.h"
 #include "sdkconfig.h"
 
@@ -32,6 +36,9 @@ static const char *TAG = "cmd_system";
 
 static void register_free();
 static void register_heap();
+static void register_heap_prof();
+static void register_task_stats();
+static void register_critical_trace();
 static void register_version();
 static void register_restart();
 static void register_make();
@@ -43,6 +50,9 @@ void register_system()
 {
     register_free();
     register_heap();
+    register_heap_prof();
+    register_task_stats();
+    register_critical_trace();
     register_version();
     register_restart();
     register_make();
@@ -139,6 +149,146 @@ static void register_heap()
 
 }
 
+/** 'heap_prof' command prints the heap fragmentation, and with heap profiling
+ * enabled, the time taken by malloc/free and the call sites allocating the most */
+
+static struct {
+    struct arg_int *sites;
+    struct arg_lit *reset;
+    struct arg_end *end;
+} heap_prof_args;
+
+static int heap_prof(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &heap_prof_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, heap_prof_args.end, argv[0]);
+        return 1;
+    }
+
+#ifdef CONFIG_HEAP_PROFILING
+    int sites = heap_prof_args.sites->count ? heap_prof_args.sites->ival[0] : 10;
+
+    heap_profile_dump(sites > 0 ? sites : 10);
+    if (heap_prof_args.reset->count) {
+        heap_profile_reset();
+    }
+#else
+    heap_caps_print_heap_info(MALLOC_CAP_8BIT);
+    if (heap_prof_args.sites->count || heap_prof_args.reset->count) {
+        printf("Enable CONFIG_HEAP_PROFILING for the call sites and the latency\n");
+    }
+#endif
+    return 0;
+}
+
+static void register_heap_prof()
+{
+    heap_prof_args.sites = arg_int0("n", "sites", "<n>", "Number of call sites printed, 10 by default");
+    heap_prof_args.reset = arg_lit0("r", "reset", "Clear the statistics after printing them");
+    heap_prof_args.end = arg_end(2);
+
+    const esp_console_cmd_t cmd = {
+        .command = "heap_prof",
+        .help = "Print the free blocks of the heap by size, the malloc/free latency "
+                "and the call sites allocating the most bytes",
+        .hint = NULL,
+        .func = &heap_prof,
+        .argtable = &heap_prof_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/** 'task_stats' command prints the CPU time and the scheduling latency of each task,
+ * and the time spent in the interrupt handlers and in critical sections */
+
+static struct {
+    struct arg_lit *reset;
+    struct arg_end *end;
+} task_stats_args;
+
+static int task_stats(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &task_stats_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, task_stats_args.end, argv[0]);
+        return 1;
+    }
+
+#ifdef CONFIG_FREERTOS_TASK_STATS
+    task_stats_dump();
+    if (task_stats_args.reset->count) {
+        task_stats_reset();
+    }
+#else
+    printf("Enable CONFIG_FREERTOS_TASK_STATS for the task statistics\n");
+#endif
+    return 0;
+}
+
+static void register_task_stats()
+{
+    task_stats_args.reset = arg_lit0("r", "reset", "Clear the statistics after printing them");
+    task_stats_args.end = arg_end(1);
+
+    const esp_console_cmd_t cmd = {
+        .command = "task_stats",
+        .help = "Print the CPU usage, context switches and wakeup latency of the tasks, "
+                "and the time spent in each interrupt handler and in critical sections",
+        .hint = NULL,
+        .func = &task_stats,
+        .argtable = &task_stats_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
+/** 'critical_trace' command prints how long the interrupts were disabled, and the
+ * call sites which disabled them the longest */
+
+static struct {
+    struct arg_int *sites;
+    struct arg_lit *reset;
+    struct arg_end *end;
+} critical_trace_args;
+
+static int critical_trace(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &critical_trace_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, critical_trace_args.end, argv[0]);
+        return 1;
+    }
+
+#ifdef CONFIG_FREERTOS_CRITICAL_TRACE
+    int sites = critical_trace_args.sites->count ? critical_trace_args.sites->ival[0] : 10;
+
+    critical_trace_dump(sites > 0 ? sites : 10);
+    if (critical_trace_args.reset->count) {
+        critical_trace_reset();
+    }
+#else
+    printf("Enable CONFIG_FREERTOS_CRITICAL_TRACE for the critical section trace\n");
+#endif
+    return 0;
+}
+
+static void register_critical_trace()
+{
+    critical_trace_args.sites = arg_int0("n", "sites", "<n>", "Number of call sites printed, 10 by default");
+    critical_trace_args.reset = arg_lit0("r", "reset", "Clear the trace after printing it");
+    critical_trace_args.end = arg_end(2);
+
+    const esp_console_cmd_t cmd = {
+        .command = "critical_trace",
+        .help = "Print histograms of the time with the interrupts disabled by critical "
+                "sections and interrupt handlers, and the call sites of the longest ones",
+        .hint = NULL,
+        .func = &critical_trace,
+        .argtable = &critical_trace_args
+    };
+    ESP_ERROR_CHECK( esp_console_cmd_register(&cmd) );
+}
+
 /** 'tasks' command prints the list of tasks and related information */
 #if WITH_TASKS_INFO
 